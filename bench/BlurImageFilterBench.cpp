@@ -160,3 +160,10 @@ DEF_BENCH(return new BlurImageFilterBench(BLUR_SIGMA_LARGE, BLUR_SIGMA_LARGE, tr
 DEF_BENCH(return new BlurImageFilterBench(BLUR_SIGMA_LARGE, BLUR_SIGMA_LARGE, false, true, true);)
 DEF_BENCH(return new BlurImageFilterBench(BLUR_SIGMA_HUGE, BLUR_SIGMA_HUGE, true, true, true);)
 DEF_BENCH(return new BlurImageFilterBench(BLUR_SIGMA_HUGE, BLUR_SIGMA_HUGE, false, true, true);)
+
+// A sweep over the sigmas between the small and huge cases above.
+DEF_BENCH(return new BlurImageFilterBench(2.0f, 2.0f, false, false, false);)
+DEF_BENCH(return new BlurImageFilterBench(5.0f, 5.0f, false, false, false);)
+DEF_BENCH(return new BlurImageFilterBench(20.0f, 20.0f, false, false, false);)
+DEF_BENCH(return new BlurImageFilterBench(40.0f, 40.0f, false, false, false);)
+DEF_BENCH(return new BlurImageFilterBench(100.0f, 100.0f, false, false, false);)
@@ -13,6 +13,7 @@
 #include "include/core/SkString.h"
 #include "include/private/SkChecksum.h"
 #include "include/private/SkTemplates.h"
+#include "src/core/SkTaskGroup.h"
 
 #include "bench/gUniqueGlyphIDs.h"
 
@@ -142,6 +143,52 @@ private:
 };
 DEF_BENCH( return new FontCacheBench(); )
 
+///////////////////////////////////////////////////////////////////////////////
+
+// Many threads measuring short runs with a handful of fonts; every call looks up its strike.
+class FontCacheThreadedBench : public Benchmark {
+    SkString fName;
+    const int fThreads;
+
+public:
+    explicit FontCacheThreadedBench(int threads) : fThreads(threads) {
+        fName.printf("fontcache_threaded_%d", threads);
+    }
+
+protected:
+    const char* onGetName() override {
+        return fName.c_str();
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        SkTaskGroup().batch(fThreads, [&](int thread) {
+            SkFont fonts[3];
+            for (int i = 0; i < 3; ++i) {
+                fonts[i].setSize(12 + 2 * i);
+                fonts[i].setEdging(SkFont::Edging::kAntiAlias);
+            }
+
+            const uint16_t* glyphs = gUniqueGlyphIDs;
+            const int count = std::min(count_glyphs(glyphs), 8);
+            for (int i = 0; i < loops; ++i) {
+                const SkFont& font = fonts[(i + thread) % 3];
+                (void)font.measureText(glyphs, count * sizeof(uint16_t),
+                                       SkTextEncoding::kGlyphID);
+            }
+        });
+    }
+
+private:
+    typedef Benchmark INHERITED;
+};
+DEF_BENCH( return new FontCacheThreadedBench(1); )
+DEF_BENCH( return new FontCacheThreadedBench(8); )
+DEF_BENCH( return new FontCacheThreadedBench(32); )
+
 // undefine this to run the efficiency test
 //DEF_BENCH( return new FontCacheEfficiency(); )
 
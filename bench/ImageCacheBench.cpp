@@ -6,7 +6,9 @@
  */
 
 #include "bench/Benchmark.h"
+#include "include/core/SkString.h"
 #include "src/core/SkResourceCache.h"
+#include "src/core/SkTaskGroup.h"
 
 namespace {
 static void* gGlobalAddress;
@@ -72,6 +74,58 @@ private:
     typedef Benchmark INHERITED;
 };
 
+// Many threads hitting in a thread-safe cache at once, as when raster threads look up the same
+// decoded and scaled images.
+class ImageCacheContentionBench : public Benchmark {
+    SkShardedResourceCache fCache;
+    const int              fThreads;
+    SkString               fName;
+
+    enum {
+        CACHE_COUNT = 500
+    };
+public:
+    ImageCacheContentionBench(int shards, int threads)
+        : fCache(shards, CACHE_COUNT * 100)
+        , fThreads(threads) {
+        fName.printf("imagecache_contention_%dshards_%dthreads", shards, threads);
+    }
+
+protected:
+    const char* onGetName() override {
+        return fName.c_str();
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+
+    void onDelayedSetup() override {
+        for (int i = 0; i < CACHE_COUNT; ++i) {
+            fCache.add(new TestRec(TestKey(i), i));
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        SkTaskGroup().batch(fThreads, [&](int thread) {
+            for (int i = 0; i < loops; ++i) {
+                TestKey key((i * 31 + thread) % CACHE_COUNT);
+                SkDEBUGCODE(bool found =) fCache.find(key, TestRec::Visitor, nullptr);
+                SkASSERT(found);
+            }
+        });
+    }
+
+private:
+    typedef Benchmark INHERITED;
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 
 DEF_BENCH( return new ImageCacheBench(); )
+
+DEF_BENCH( return new ImageCacheContentionBench( 1,  1); )
+DEF_BENCH( return new ImageCacheContentionBench( 1,  8); )
+DEF_BENCH( return new ImageCacheContentionBench(16,  8); )
+DEF_BENCH( return new ImageCacheContentionBench( 1, 32); )
+DEF_BENCH( return new ImageCacheContentionBench(16, 32); )
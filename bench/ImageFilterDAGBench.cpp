@@ -160,7 +160,44 @@ private:
     typedef Benchmark INHERITED;
 };
 
+// Exercise a merge of several drop shadows, whose blurs do not depend on each other and can be
+// computed concurrently on the raster backend (run with --threads to see the difference).
+class ImageFilterIndependentBranchesBench : public Benchmark {
+public:
+    ImageFilterIndependentBranchesBench() {}
+
+protected:
+    const char* onGetName() override {
+        return "image_filter_dag_independent_branches";
+    }
+
+    void onDraw(int loops, SkCanvas* canvas) override {
+        const SkRect rect = SkRect::Make(SkIRect::MakeWH(400, 400));
+
+        for (int j = 0; j < loops; j++) {
+            // Unlike the benches above, rebuild the filters each time so every draw misses the
+            // global image filter cache and the branches really are computed.
+            sk_sp<SkImageFilter> inputs[kNumInputs];
+            for (int i = 0; i < kNumInputs; ++i) {
+                inputs[i] = SkImageFilters::DropShadowOnly(4.0f * i, 4.0f * i, 5.0f + 5.0f * i,
+                                                           5.0f + 5.0f * i, SK_ColorBLACK,
+                                                           nullptr);
+            }
+            SkPaint paint;
+            paint.setColor(SK_ColorBLUE);
+            paint.setImageFilter(SkImageFilters::Merge(inputs, kNumInputs));
+            canvas->drawRect(rect, paint);
+        }
+    }
+
+private:
+    static const int kNumInputs = 4;
+
+    typedef Benchmark INHERITED;
+};
+
 DEF_BENCH(return new ImageFilterDAGBench;)
 DEF_BENCH(return new ImageMakeWithFilterDAGBench;)
 DEF_BENCH(return new ImageFilterDisplacedBlur;)
 DEF_BENCH(return new ImageFilterXfermodeIn;)
+DEF_BENCH(return new ImageFilterIndependentBranchesBench;)
@@ -6,12 +6,14 @@
  */
 
 #include "bench/Benchmark.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkPath.h"
 #include "include/core/SkShader.h"
 #include "include/core/SkString.h"
 #include "include/pathops/SkPathOps.h"
 #include "include/private/SkTArray.h"
 #include "include/utils/SkRandom.h"
+#include "src/pathops/SkPathOpsCommon.h"
 
 class PathOpsBench : public Benchmark {
     SkString    fName;
@@ -96,3 +98,113 @@ static SkPath makerects() {
 }
 
 DEF_BENCH( return new PathOpsSimplifyBench("rects", makerects()); )
+
+// Overlapping polygons scattered over a tile, like the inputs to a map's land-use union.
+static SkPath makepolygon(SkRandom* rand) {
+    SkScalar cx = rand->nextRangeScalar(0, 400);
+    SkScalar cy = rand->nextRangeScalar(0, 400);
+    int sides = 3 + rand->nextULessThan(6);
+    SkPath path;
+    for (int i = 0; i < sides; ++i) {
+        SkScalar angle = SK_ScalarPI * 2 * i / sides;
+        SkScalar radius = rand->nextRangeScalar(10, 40);
+        SkPoint pt = {cx + radius * SkScalarCos(angle), cy + radius * SkScalarSin(angle)};
+        if (!i) {
+            path.moveTo(pt);
+        } else {
+            path.lineTo(pt);
+        }
+    }
+    path.close();
+    return path;
+}
+
+class PathOpsBuilderBench : public Benchmark {
+    SkString                    fName;
+    SkTArray<SkPath>            fPaths;
+    std::unique_ptr<SkExecutor> fExecutor;
+    bool                        fMixed;
+
+public:
+    PathOpsBuilderBench(int count, bool mixed, int threads) : fMixed(mixed) {
+        fName.printf("pathops_builder_%s_%d_%dthreads", mixed ? "mixed" : "union", count,
+                     threads);
+        SkRandom rand;
+        for (int i = 0; i < count; ++i) {
+            fPaths.push_back(makepolygon(&rand));
+        }
+        if (threads > 0) {
+            fExecutor = SkExecutor::MakeFIFOThreadPool(threads);
+        }
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+
+protected:
+    const char* onGetName() override {
+        return fName.c_str();
+    }
+
+    void onDraw(int loops, SkCanvas* canvas) override {
+        for (int i = 0; i < loops; i++) {
+            SkOpBuilder builder;
+            for (int j = 0; j < fPaths.count(); ++j) {
+                // Every tenth polygon is cut out, which keeps the builder off its all-union path.
+                SkPathOp op = fMixed && j % 10 == 9 ? kDifference_SkPathOp : kUnion_SkPathOp;
+                builder.add(fPaths[j], op);
+            }
+            SkPath result;
+            builder.resolve(&result, fExecutor.get());
+        }
+    }
+
+private:
+    typedef Benchmark INHERITED;
+};
+
+DEF_BENCH( return new PathOpsBuilderBench(200, false, 0); )
+DEF_BENCH( return new PathOpsBuilderBench(200, false, 4); )
+DEF_BENCH( return new PathOpsBuilderBench(200, true, 0); )
+DEF_BENCH( return new PathOpsBuilderBench(200, true, 4); )
+
+class PathOpsSimplifyExecutorBench : public Benchmark {
+    SkString                    fName;
+    SkPath                      fPath;
+    std::unique_ptr<SkExecutor> fExecutor;
+
+public:
+    PathOpsSimplifyExecutorBench(int count, int threads) {
+        fName.printf("pathops_simplify_polygons_%d_%dthreads", count, threads);
+        SkRandom rand;
+        for (int i = 0; i < count; ++i) {
+            fPath.addPath(makepolygon(&rand));
+        }
+        if (threads > 0) {
+            fExecutor = SkExecutor::MakeFIFOThreadPool(threads);
+        }
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+
+protected:
+    const char* onGetName() override {
+        return fName.c_str();
+    }
+
+    void onDraw(int loops, SkCanvas* canvas) override {
+        for (int i = 0; i < loops; i++) {
+            SkPath result;
+            SimplifyWithExecutor(fPath, &result, fExecutor.get());
+        }
+    }
+
+private:
+    typedef Benchmark INHERITED;
+};
+
+DEF_BENCH( return new PathOpsSimplifyExecutorBench(100, 0); )
+DEF_BENCH( return new PathOpsSimplifyExecutorBench(100, 4); )
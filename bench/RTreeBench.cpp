@@ -15,6 +15,7 @@
 static const SkScalar GENERATE_EXTENTS = 1000.0f;
 static const int NUM_BUILD_RECTS = 500;
 static const int NUM_QUERY_RECTS = 5000;
+static const int NUM_BATCH_QUERIES = 256;
 static const int GRID_WIDTH = 100;
 
 typedef SkRect (*MakeRectProc)(SkRandom&, int, int);
@@ -22,8 +23,13 @@ typedef SkRect (*MakeRectProc)(SkRandom&, int, int);
 // Time how long it takes to build an R-Tree.
 class RTreeBuildBench : public Benchmark {
 public:
-    RTreeBuildBench(const char* name, MakeRectProc proc) : fProc(proc) {
+    RTreeBuildBench(const char* name, MakeRectProc proc, int numRects = NUM_BUILD_RECTS)
+            : fProc(proc)
+            , fNumRects(numRects) {
         fName.printf("rtree_%s_build", name);
+        if (numRects != NUM_BUILD_RECTS) {
+            fName.appendf("_%d", numRects);
+        }
     }
 
     bool isSuitableFor(Backend backend) override {
@@ -36,19 +42,20 @@ protected:
     }
     void onDraw(int loops, SkCanvas* canvas) override {
         SkRandom rand;
-        SkAutoTMalloc<SkRect> rects(NUM_BUILD_RECTS);
-        for (int i = 0; i < NUM_BUILD_RECTS; ++i) {
-            rects[i] = fProc(rand, i, NUM_BUILD_RECTS);
+        SkAutoTMalloc<SkRect> rects(fNumRects);
+        for (int i = 0; i < fNumRects; ++i) {
+            rects[i] = fProc(rand, i, fNumRects);
         }
 
         for (int i = 0; i < loops; ++i) {
             SkRTree tree;
-            tree.insert(rects.get(), NUM_BUILD_RECTS);
+            tree.insert(rects.get(), fNumRects);
             SkASSERT(rects != nullptr);  // It'd break this bench if the tree took ownership of rects.
         }
     }
 private:
     MakeRectProc fProc;
+    int fNumRects;
     SkString fName;
     typedef Benchmark INHERITED;
 };
@@ -95,6 +102,59 @@ private:
     typedef Benchmark INHERITED;
 };
 
+// Time how long it takes to perform a batch of tile-sized queries on an R-Tree,
+// either one at a time or all at once with the batched search().
+class RTreeBatchQueryBench : public Benchmark {
+public:
+    RTreeBatchQueryBench(const char* name, MakeRectProc proc, bool batched)
+            : fProc(proc)
+            , fBatched(batched) {
+        fName.printf("rtree_%s_query%d_%s", name, NUM_BATCH_QUERIES, batched ? "batch" : "each");
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+protected:
+    const char* onGetName() override {
+        return fName.c_str();
+    }
+    void onDelayedSetup() override {
+        SkRandom rand;
+        SkAutoTMalloc<SkRect> rects(NUM_QUERY_RECTS);
+        for (int i = 0; i < NUM_QUERY_RECTS; ++i) {
+            rects[i] = fProc(rand, i, NUM_QUERY_RECTS);
+        }
+        fTree.insert(rects.get(), NUM_QUERY_RECTS);
+
+        // A 16x16 grid of tiles covering the rects, like SkParallelPlayback would query.
+        const SkScalar tile = GENERATE_EXTENTS / 16;
+        for (int i = 0; i < NUM_BATCH_QUERIES; ++i) {
+            fQueries[i] = SkRect::MakeXYWH((i % 16) * tile, (i / 16) * tile, tile, tile);
+        }
+    }
+
+    void onDraw(int loops, SkCanvas* canvas) override {
+        for (int i = 0; i < loops; ++i) {
+            std::vector<int> hits[NUM_BATCH_QUERIES];
+            if (fBatched) {
+                fTree.search(fQueries, NUM_BATCH_QUERIES, hits);
+            } else {
+                for (int j = 0; j < NUM_BATCH_QUERIES; ++j) {
+                    fTree.search(fQueries[j], &hits[j]);
+                }
+            }
+        }
+    }
+private:
+    SkRTree fTree;
+    SkRect fQueries[NUM_BATCH_QUERIES];
+    MakeRectProc fProc;
+    bool fBatched;
+    SkString fName;
+    typedef Benchmark INHERITED;
+};
+
 static inline SkRect make_XYordered_rects(SkRandom& rand, int index, int numRects) {
     SkRect out;
     out.fLeft   = SkIntToScalar(index % GRID_WIDTH);
@@ -131,8 +191,15 @@ DEF_BENCH(return new RTreeBuildBench("XY", &make_XYordered_rects));
 DEF_BENCH(return new RTreeBuildBench("YX", &make_YXordered_rects));
 DEF_BENCH(return new RTreeBuildBench("random", &make_random_rects));
 DEF_BENCH(return new RTreeBuildBench("concentric", &make_concentric_rects));
+DEF_BENCH(return new RTreeBuildBench("XY", &make_XYordered_rects, 100000));
+DEF_BENCH(return new RTreeBuildBench("random", &make_random_rects, 100000));
 
 DEF_BENCH(return new RTreeQueryBench("XY", &make_XYordered_rects));
 DEF_BENCH(return new RTreeQueryBench("YX", &make_YXordered_rects));
 DEF_BENCH(return new RTreeQueryBench("random", &make_random_rects));
 DEF_BENCH(return new RTreeQueryBench("concentric", &make_concentric_rects));
+
+DEF_BENCH(return new RTreeBatchQueryBench("XY", &make_XYordered_rects, false));
+DEF_BENCH(return new RTreeBatchQueryBench("XY", &make_XYordered_rects, true));
+DEF_BENCH(return new RTreeBatchQueryBench("random", &make_random_rects, false));
+DEF_BENCH(return new RTreeBatchQueryBench("random", &make_random_rects, true));
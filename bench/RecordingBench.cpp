@@ -52,6 +52,16 @@ void RecordingBench::onDraw(int loops, SkCanvas*) {
 DeserializePictureBench::DeserializePictureBench(const char* name, sk_sp<SkData> data)
     : fName(name)
     , fEncodedPicture(std::move(data))
+    , fRegion(SkRect::MakeEmpty())
+    , fUseRegion(false)
+{}
+
+DeserializePictureBench::DeserializePictureBench(const char* name, sk_sp<SkData> data,
+                                                 const SkRect& region)
+    : fName(name)
+    , fEncodedPicture(std::move(data))
+    , fRegion(region)
+    , fUseRegion(true)
 {}
 
 const char* DeserializePictureBench::onGetName() {
@@ -68,6 +78,10 @@ SkIPoint DeserializePictureBench::onGetSize() {
 
 void DeserializePictureBench::onDraw(int loops, SkCanvas*) {
     for (int i = 0; i < loops; ++i) {
-        SkPicture::MakeFromData(fEncodedPicture.get());
+        if (fUseRegion) {
+            SkPicture::MakeFromData(fEncodedPicture.get(), fRegion);
+        } else {
+            SkPicture::MakeFromData(fEncodedPicture.get());
+        }
     }
 }
@@ -43,6 +43,8 @@ private:
 class DeserializePictureBench : public Benchmark {
 public:
     DeserializePictureBench(const char* name, sk_sp<SkData> encodedPicture);
+    // Deserializes just the part of the picture inside region.
+    DeserializePictureBench(const char* name, sk_sp<SkData> encodedPicture, const SkRect& region);
 
 protected:
     const char* onGetName() override;
@@ -53,6 +55,8 @@ protected:
 private:
     SkString      fName;
     sk_sp<SkData> fEncodedPicture;
+    SkRect        fRegion;
+    bool          fUseRegion;
 
     typedef Benchmark INHERITED;
 };
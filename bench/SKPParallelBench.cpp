@@ -0,0 +1,85 @@
+/*
+ * Copyright 2020 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "bench/SKPParallelBench.h"
+#include "include/core/SkCanvas.h"
+#include "src/core/SkParallelPlayback.h"
+#include "tools/flags/CommandLineFlags.h"
+
+static DEFINE_int(parallelTileW, 256, "Tile width  used for parallel SKP playback.");
+static DEFINE_int(parallelTileH, 256, "Tile height used for parallel SKP playback.");
+
+namespace {
+    // SkTaskGroup::wait() borrows the waiting thread to run tasks too.  We hide our pool's
+    // borrow() so exactly fThreads threads play back tiles while the bench thread waits.
+    class NoBorrowExecutor final : public SkExecutor {
+    public:
+        explicit NoBorrowExecutor(int threads) : fPool(SkExecutor::MakeFIFOThreadPool(threads)) {}
+        void add(std::function<void(void)> work) override { fPool->add(std::move(work)); }
+
+    private:
+        std::unique_ptr<SkExecutor> fPool;
+    };
+}
+
+SKPParallelBench::SKPParallelBench(const char* name, const SkPicture* pic, const SkIRect& clip,
+                                   int threads, bool doLooping)
+    : fPic(SkRef(pic))
+    , fClip(clip)
+    , fThreads(threads)
+    , fName(name)
+    , fDoLooping(doLooping) {
+    fUniqueName.printf("%s_parallel_%d", name, threads);
+}
+
+const char* SKPParallelBench::onGetName() {
+    return fName.c_str();
+}
+
+const char* SKPParallelBench::onGetUniqueName() {
+    return fUniqueName.c_str();
+}
+
+void SKPParallelBench::onPerCanvasPreDraw(SkCanvas* canvas) {
+    fDevBounds = canvas->getDeviceClipBounds();
+    SkAssertResult(!fDevBounds.isEmpty());
+
+    fBitmap.allocPixels(canvas->imageInfo().makeWH(fDevBounds.width(), fDevBounds.height()));
+    fBitmap.eraseColor(SK_ColorTRANSPARENT);
+
+    fMatrix = canvas->getTotalMatrix();
+    fMatrix.postTranslate(-fDevBounds.fLeft, -fDevBounds.fTop);
+
+    fExecutor = std::make_unique<NoBorrowExecutor>(fThreads);
+}
+
+void SKPParallelBench::onPerCanvasPostDraw(SkCanvas* canvas) {
+    // Draw the last playback into the bench's canvas in case we're saving the images.
+    canvas->save();
+    canvas->resetMatrix();
+    canvas->drawBitmap(fBitmap, fDevBounds.fLeft, fDevBounds.fTop);
+    canvas->restore();
+
+    fExecutor.reset();
+    fBitmap.reset();
+}
+
+bool SKPParallelBench::isSuitableFor(Backend backend) {
+    return backend == kRaster_Backend;
+}
+
+SkIPoint SKPParallelBench::onGetSize() {
+    return SkIPoint::Make(fClip.width(), fClip.height());
+}
+
+void SKPParallelBench::onDraw(int loops, SkCanvas*) {
+    SkASSERT(fDoLooping || 1 == loops);
+    while (loops --> 0) {
+        SkParallelPlayback(fPic.get(), fBitmap.pixmap(), fMatrix,
+                           {FLAGS_parallelTileW, FLAGS_parallelTileH}, fExecutor.get());
+    }
+}
@@ -0,0 +1,58 @@
+/*
+ * Copyright 2020 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SKPParallelBench_DEFINED
+#define SKPParallelBench_DEFINED
+
+#include "bench/Benchmark.h"
+#include "include/core/SkBitmap.h"
+#include "include/core/SkExecutor.h"
+#include "include/core/SkMatrix.h"
+#include "include/core/SkPicture.h"
+
+#include <memory>
+
+/**
+ * Runs an SkPicture as a benchmark by repeatedly playing it back with SkParallelPlayback on a
+ * pool of a fixed number of threads.  Comparing runs with different thread counts shows how well
+ * parallel playback scales with cores.
+ */
+class SKPParallelBench : public Benchmark {
+public:
+    SKPParallelBench(const char* name, const SkPicture*, const SkIRect& devClip, int threads,
+                     bool doLooping);
+
+    int calculateLoops(int defaultLoops) const override {
+        return fDoLooping ? defaultLoops : 1;
+    }
+
+protected:
+    const char* onGetName() override;
+    const char* onGetUniqueName() override;
+    void onPerCanvasPreDraw(SkCanvas*) override;
+    void onPerCanvasPostDraw(SkCanvas*) override;
+    bool isSuitableFor(Backend backend) override;
+    void onDraw(int loops, SkCanvas* canvas) override;
+    SkIPoint onGetSize() override;
+
+private:
+    sk_sp<const SkPicture> fPic;
+    const SkIRect fClip;
+    const int fThreads;
+    SkString fName;
+    SkString fUniqueName;
+    const bool fDoLooping;
+
+    std::unique_ptr<SkExecutor> fExecutor;
+    SkBitmap fBitmap;        // We play back into this, then draw it to the bench's canvas.
+    SkIRect  fDevBounds;
+    SkMatrix fMatrix;
+
+    typedef Benchmark INHERITED;
+};
+
+#endif
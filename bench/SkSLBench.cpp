@@ -5,6 +5,7 @@
  * found in the LICENSE file.
  */
 #include "bench/Benchmark.h"
+#include "include/effects/SkRuntimeEffect.h"
 #include "src/sksl/SkSLCompiler.h"
 
 class SkSLBench : public Benchmark {
@@ -46,8 +47,68 @@ private:
     typedef Benchmark INHERITED;
 };
 
+// What a new GPU context pays before its first shader: constructing a Compiler, then compiling a
+// fragment program (which loads the modules that program needs).
+class SkSLCompilerStartupBench : public Benchmark {
+protected:
+    const char* onGetName() override {
+        return "sksl_compiler_startup";
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        for (int i = 0; i < loops; i++) {
+            SkSL::Compiler compiler;
+            SkSL::Program::Settings settings;
+            std::unique_ptr<SkSL::Program> program = compiler.convertProgram(
+                                                    SkSL::Program::kFragment_Kind,
+                                                    "void main() { sk_FragColor = half4(1); }",
+                                                    settings);
+            if (!program) {
+                printf("%s\n", compiler.errorText().c_str());
+                SK_ABORT("shader compilation failed");
+            }
+        }
+    }
+
+private:
+    typedef Benchmark INHERITED;
+};
+
+// Repeatedly makes the same runtime effect, as happens when deserializing pictures that use one.
+class SkRuntimeEffectMakeBench : public Benchmark {
+protected:
+    const char* onGetName() override {
+        return "sksl_runtime_effect_make";
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        SkString src("uniform half4 gColor;"
+                     "void main(float2 p, inout half4 color) { color = gColor * half(p.x); }");
+        for (int i = 0; i < loops; i++) {
+            auto[effect, errorText] = SkRuntimeEffect::Make(src);
+            if (!effect) {
+                printf("%s\n", errorText.c_str());
+                SK_ABORT("runtime effect compilation failed");
+            }
+        }
+    }
+
+private:
+    typedef Benchmark INHERITED;
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 
+DEF_BENCH(return new SkSLCompilerStartupBench(); )
+DEF_BENCH(return new SkRuntimeEffectMakeBench(); )
 DEF_BENCH(return new SkSLBench("tiny", "void main() { sk_FragColor = half4(1); }"); )
 DEF_BENCH(return new SkSLBench("huge", R"(
     uniform half2 uDstTextureUpperLeft_Stage1;
@@ -7,9 +7,12 @@
 
 #include "bench/Benchmark.h"
 #include "include/utils/SkRandom.h"
+#include "src/core/SkVM.h"
 #include "src/sksl/SkSLByteCode.h"
 #include "src/sksl/SkSLCompiler.h"
 #include "src/sksl/SkSLInterpreter.h"
+#include "src/sksl/SkSLVMGenerator.h"
+#include "src/sksl/ir/SkSLFunctionDefinition.h"
 
 // Without this build flag, this bench isn't runnable.
 #if defined(SK_ENABLE_SKSL_INTERPRETER)
@@ -75,6 +78,80 @@ private:
     typedef Benchmark INHERITED;
 };
 
+#endif // SK_ENABLE_SKSL_INTERPRETER
+
+// Benchmarks the same programs lowered to SkVM by SkSL::ProgramToSkVM, for comparison.
+class SkSLVMCFBench : public Benchmark {
+public:
+    SkSLVMCFBench(SkSL::String name, int pixels, const char* src)
+        : fName(SkStringPrintf("sksl_vm_cf_%d_%s", pixels, name.c_str()))
+        , fSrc(src)
+        , fCount(pixels) {}
+
+protected:
+    const char* onGetName() override {
+        return fName.c_str();
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+
+    void onDelayedSetup() override {
+        SkSL::Compiler compiler;
+        SkSL::Program::Settings settings;
+        auto program = compiler.convertProgram(SkSL::Program::kGeneric_Kind, fSrc, settings);
+        SkAssertResult(program && compiler.optimize(*program));
+
+        const SkSL::FunctionDefinition* main = nullptr;
+        for (const auto& e : *program) {
+            if (e.fKind == SkSL::ProgramElement::kFunction_Kind &&
+                ((const SkSL::FunctionDefinition&) e).fDeclaration.fName == "main") {
+                main = &(const SkSL::FunctionDefinition&) e;
+            }
+        }
+        SkASSERT(main);
+
+        skvm::Builder b;
+        skvm::Arg ptrs[4];
+        skvm::Val color[4];
+        for (int i = 0; i < 4; ++i) {
+            ptrs[i] = b.varying<float>();
+            color[i] = b.load32(ptrs[i]).id;
+        }
+        SkAssertResult(SkSL::ProgramToSkVM(*program, *main, &b, {}, SkMakeSpan(color)));
+        for (int i = 0; i < 4; ++i) {
+            b.store32(ptrs[i], skvm::I32{color[i]});
+        }
+        fProgram = b.done();
+
+        SkRandom rnd;
+        fPixels.resize(fCount * 4);
+        for (float& c : fPixels) {
+            c = rnd.nextF();
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        for (int i = 0; i < loops; i++) {
+            fProgram.eval(fCount, fPixels.data() + 0 * fCount,
+                                  fPixels.data() + 1 * fCount,
+                                  fPixels.data() + 2 * fCount,
+                                  fPixels.data() + 3 * fCount);
+        }
+    }
+
+private:
+    SkString fName;
+    SkSL::String fSrc;
+    skvm::Program fProgram;
+
+    int fCount;
+    std::vector<float> fPixels;
+
+    typedef Benchmark INHERITED;
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 
 const char* kLumaToAlphaSrc = R"(
@@ -146,6 +223,10 @@ const char* kHighContrastFilterSrc = R"(
     }
 )";
 
+#if defined(SK_ENABLE_SKSL_INTERPRETER)
 DEF_BENCH(return new SkSLInterpreterCFBench("lumaToAlpha", 256, kLumaToAlphaSrc));
 DEF_BENCH(return new SkSLInterpreterCFBench("hcf", 256, kHighContrastFilterSrc));
 #endif // SK_ENABLE_SKSL_INTERPRETER
+
+DEF_BENCH(return new SkSLVMCFBench("lumaToAlpha", 256, kLumaToAlphaSrc));
+DEF_BENCH(return new SkSLVMCFBench("hcf", 256, kHighContrastFilterSrc));
@@ -9,11 +9,14 @@
 #include "src/core/SkOpts.h"
 #include "src/core/SkVM.h"
 #include "tools/SkVMBuilders.h"
+#include <array>
 
 namespace {
 
-    enum Mode {Opts, RP, F32, I32_Naive, I32, I32_SWAR};
-    static const char* kMode_name[] = { "Opts", "RP","F32", "I32_Naive", "I32", "I32_SWAR" };
+    // RP runs SkRasterPipeline's lowp srcover on 8888, RP_F32 its highp srcover on RGBA F32.
+    enum Mode {Opts, RP, RP_F32, F32, I32_Naive, I32, I32_SWAR};
+    static const char* kMode_name[] = { "Opts", "RP", "RP_F32", "F32",
+                                        "I32_Naive", "I32", "I32_SWAR" };
 
 }
 
@@ -48,10 +51,35 @@ private:
             fPipeline.append(SkRasterPipeline::store_8888, &fDstCtx);
         }
 
+        if (fMode == RP_F32) {
+            // The same colors as fSrc and fDst above, as RGBA floats.
+            const float src[] = { 0x56/255.0f, 0x34/255.0f, 0x12/255.0f, 0x7f/255.0f },
+                        dst[] = { 0x54/255.0f, 0x76/255.0f, 0x98/255.0f, 0xff/255.0f };
+            for (int i = 0; i < fPixels; i++) {
+                fSrcF.insert(fSrcF.end(), std::begin(src), std::end(src));
+                fDstF.insert(fDstF.end(), std::begin(dst), std::end(dst));
+            }
+            fSrcCtx = { fSrcF.data(), 0 };
+            fDstCtx = { fDstF.data(), 0 };
+            fPipeline.append(SkRasterPipeline::load_f32    , &fSrcCtx);
+            fPipeline.append(SkRasterPipeline::load_f32_dst, &fDstCtx);
+            fPipeline.append(SkRasterPipeline::srcover);
+            fPipeline.append(SkRasterPipeline::store_f32, &fDstCtx);
+        }
+
         // Trigger one run now so we can do a quick correctness check.
         this->draw(1,nullptr);
-        for (int i = 0; i < fPixels; i++) {
-            SkASSERTF(fDst[i] == 0xff5e6f80, "Want 0xff5e6f80, got %08x", fDst[i]);
+        if (fMode == RP_F32) {
+            for (int i = 0; i < fPixels; i++) {
+                SkASSERTF(SkScalarNearlyEqual(fDstF[4*i+0], 0x80/255.0f, 1/255.0f) &&
+                          SkScalarNearlyEqual(fDstF[4*i+3], 1.0f,        1/255.0f),
+                          "Want 0x80/255 red and opaque alpha, got %g and %g",
+                          fDstF[4*i+0], fDstF[4*i+3]);
+            }
+        } else {
+            for (int i = 0; i < fPixels; i++) {
+                SkASSERTF(fDst[i] == 0xff5e6f80, "Want 0xff5e6f80, got %08x", fDst[i]);
+            }
         }
     }
 
@@ -59,7 +87,7 @@ private:
         while (loops --> 0) {
             if (fMode == Opts) {
                 SkOpts::blit_row_s32a_opaque(fDst.data(), fSrc.data(), fPixels, 0xff);
-            } else if (fMode == RP) {
+            } else if (fMode == RP || fMode == RP_F32) {
                 fPipeline.run(0,0,fPixels,1);
             } else {
                 fProgram.eval(fPixels, fSrc.data(), fDst.data());
@@ -72,6 +100,8 @@ private:
     SkString              fName;
     std::vector<uint32_t> fSrc,
                           fDst;
+    std::vector<float>    fSrcF,
+                          fDstF;
     skvm::Program         fProgram;
 
     SkRasterPipeline_MemoryCtx fSrcCtx,
@@ -95,6 +125,14 @@ DEF_BENCH(return (new SkVMBench{ 256, RP});)
 DEF_BENCH(return (new SkVMBench{1024, RP});)
 DEF_BENCH(return (new SkVMBench{4096, RP});)
 
+DEF_BENCH(return (new SkVMBench{   1, RP_F32});)
+DEF_BENCH(return (new SkVMBench{   4, RP_F32});)
+DEF_BENCH(return (new SkVMBench{  15, RP_F32});)
+DEF_BENCH(return (new SkVMBench{  63, RP_F32});)
+DEF_BENCH(return (new SkVMBench{ 256, RP_F32});)
+DEF_BENCH(return (new SkVMBench{1024, RP_F32});)
+DEF_BENCH(return (new SkVMBench{4096, RP_F32});)
+
 DEF_BENCH(return (new SkVMBench{   1, F32});)
 DEF_BENCH(return (new SkVMBench{   4, F32});)
 DEF_BENCH(return (new SkVMBench{  15, F32});)
@@ -161,3 +199,67 @@ private:
 };
 DEF_BENCH(return new SkVM_Overhead{ true};)
 DEF_BENCH(return new SkVM_Overhead{false};)
+
+// Runs srcover over thousands of short spans, as SkVMBlitter does for text, hairlines, and AA
+// edges, either with one Program::eval() call per span or all at once with evalSpans().
+class SkVM_Spans : public Benchmark {
+public:
+    SkVM_Spans(int width, bool batched)
+        : fWidth(width)
+        , fBatched(batched)
+        , fName(SkStringPrintf("SkVM_Spans_%d_%s", width, batched ? "evalSpans" : "eval"))
+    {}
+
+private:
+    static constexpr int kSpans = 4096;
+
+    const char* onGetName() override { return fName.c_str(); }
+    bool isSuitableFor(Backend backend) override { return backend == kNonRendering_Backend; }
+
+    void onDelayedSetup() override {
+        this->setUnits(kSpans * fWidth);
+        fSrc.resize(kSpans * fWidth, 0x7f123456);
+        fDst.resize(kSpans * fWidth, 0xff987654);
+        fArgs .resize(kSpans);
+        fSpans.resize(kSpans);
+        fProgram = SrcoverBuilder_I32{}.done();
+
+        // Trigger one run now so we can do a quick correctness check.
+        this->draw(1,nullptr);
+        for (uint32_t dst : fDst) {
+            SkASSERTF(dst == 0xff5e6f80, "Want 0xff5e6f80, got %08x", dst);
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        while (loops --> 0) {
+            if (fBatched) {
+                // evalSpans() may clobber args (when interpreted), so we set them up every time.
+                for (int i = 0; i < kSpans; i++) {
+                    fArgs [i] = { fSrc.data() + i*fWidth, fDst.data() + i*fWidth };
+                    fSpans[i] = { fWidth, fArgs[i].data() };
+                }
+                fProgram.evalSpans(fSpans.data(), kSpans);
+            } else {
+                for (int i = 0; i < kSpans; i++) {
+                    fProgram.eval(fWidth, fSrc.data() + i*fWidth, fDst.data() + i*fWidth);
+                }
+            }
+        }
+    }
+
+    int                               fWidth;
+    bool                              fBatched;
+    SkString                          fName;
+    std::vector<uint32_t>             fSrc,
+                                      fDst;
+    std::vector<std::array<void*, 2>> fArgs;
+    std::vector<skvm::Program::Span>  fSpans;
+    skvm::Program                     fProgram;
+};
+DEF_BENCH(return (new SkVM_Spans{ 1, false});)
+DEF_BENCH(return (new SkVM_Spans{ 1,  true});)
+DEF_BENCH(return (new SkVM_Spans{ 4, false});)
+DEF_BENCH(return (new SkVM_Spans{ 4,  true});)
+DEF_BENCH(return (new SkVM_Spans{15, false});)
+DEF_BENCH(return (new SkVM_Spans{15,  true});)
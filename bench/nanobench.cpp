@@ -19,6 +19,7 @@
 #include "bench/ResultsWriter.h"
 #include "bench/SKPAnimationBench.h"
 #include "bench/SKPBench.h"
+#include "bench/SKPParallelBench.h"
 #include "bench/SkGlyphCacheBench.h"
 #include "include/android/SkBitmapRegionDecoder.h"
 #include "include/codec/SkAndroidCodec.h"
@@ -30,11 +31,13 @@
 #include "include/core/SkString.h"
 #include "include/core/SkSurface.h"
 #include "include/core/SkTime.h"
+#include "include/private/SkTHash.h"
 #include "src/core/SkAutoMalloc.h"
 #include "src/core/SkColorSpacePriv.h"
 #include "src/core/SkLeanWindows.h"
 #include "src/core/SkOSFile.h"
 #include "src/core/SkTaskGroup.h"
+#include "src/core/SkThreadedBMPDevice.h"
 #include "src/core/SkTraceEvent.h"
 #include "src/utils/SkJSONWriter.h"
 #include "src/utils/SkOSPath.h"
@@ -117,6 +120,12 @@ static DEFINE_string(zoom, "1.0,0",
 static DEFINE_bool(bbh, true, "Build a BBH for SKPs?");
 static DEFINE_bool(mpd, true, "Use MultiPictureDraw for the SKPs?");
 static DEFINE_bool(loopSKP, true, "Loop SKPs like we do for micro benches?");
+static DEFINE_int(deserialTile, 0,
+                  "If >0, also bench deserializing only the top-left NxN tile of each SKP, "
+                  "re-serialized from a recording with a BBH.");
+static DEFINE_string(parallelSKP, "",
+                     "If set, also play back each SKP with SkParallelPlayback on thread pools of "
+                     "each of these sizes (e.g. 1 2 4 8), reporting speedup over the first.");
 static DEFINE_int(flushEvery, 10, "Flush --outResultsFile every Nth run.");
 static DEFINE_bool(gpuStats, false, "Print GPU stats after each gpu benchmark?");
 static DEFINE_bool(gpuStatsDump, false, "Dump GPU states after each benchmark to json");
@@ -166,6 +175,9 @@ static DEFINE_int_2(threads, j, -1,
                "Run threadsafe tests on a threadpool with this many extra threads, "
                "defaulting to one extra thread per core.");
 
+static DEFINE_int(threadedTiles, 16,
+                  "Number of horizontal tiles (and threads) the 8888-threaded config rasterizes.");
+
 static DEFINE_string2(writePath, w, "", "If set, write bitmaps here as .pngs.");
 
 static DEFINE_string(key, "",
@@ -206,6 +218,29 @@ bool Target::capturePixels(SkBitmap* bmp) {
     return true;
 }
 
+struct ThreadedRasterTarget : public Target {
+    explicit ThreadedRasterTarget(const Config& c) : Target(c) {}
+    SkBitmap bitmap;
+    std::unique_ptr<SkCanvas> canvas;
+
+    bool init(SkImageInfo info, Benchmark* bench) override {
+        if (!this->bitmap.tryAllocPixelsFlags(info, SkBitmap::kZeroPixels_AllocFlag)) {
+            return false;
+        }
+        this->canvas = std::make_unique<SkCanvas>(
+                sk_make_sp<SkThreadedBMPDevice>(this->bitmap, FLAGS_threadedTiles));
+        return true;
+    }
+    // Draws are only recorded until we flush, so flush anything left over (e.g. the clear)
+    // before the timer starts, and everything the bench drew before it stops.
+    SkCanvas* beginTiming(SkCanvas* canvas) override {
+        canvas->flush();
+        return canvas;
+    }
+    void endTiming() override { this->canvas->flush(); }
+    SkCanvas* getCanvas() const override { return this->canvas.get(); }
+};
+
 struct GPUTarget : public Target {
     explicit GPUTarget(const Config& c) : Target(c) {}
     ContextInfo contextInfo;
@@ -483,7 +518,8 @@ static void create_config(const SkCommandLineConfig* config, SkTArray<Config>* c
             sampleCount,
             ctxType,
             ctxOverrides,
-            gpuConfig->getUseDIText()
+            gpuConfig->getUseDIText(),
+            false
         };
 
         configs->push_back(target);
@@ -499,7 +535,7 @@ static void create_config(const SkCommandLineConfig* config, SkTArray<Config>* c
             }                                                                  \
             Config config = {                                                  \
                 SkString(#name), Benchmark::backend, color, alpha, colorSpace, \
-                0, kBogusContextType, kBogusContextOverrides, false            \
+                0, kBogusContextType, kBogusContextOverrides, false, false     \
             };                                                                 \
             configs->push_back(config);                                        \
             return;                                                            \
@@ -525,6 +561,20 @@ static void create_config(const SkCommandLineConfig* config, SkTArray<Config>* c
 
     #undef CPU_CONFIG
 
+    // 8888, rasterized by SkThreadedBMPDevice on --threadedTiles threads.
+    if (config->getTag().equals("8888-threaded")) {
+        if (!FLAGS_cpu) {
+            SkDebugf("Skipping config '%s' as requested.\n", config->getTag().c_str());
+            return;
+        }
+        Config threaded = {
+            config->getTag(), Benchmark::kRaster_Backend, kN32_SkColorType, kPremul_SkAlphaType,
+            nullptr, 0, kBogusContextType, kBogusContextOverrides, false, true
+        };
+        configs->push_back(threaded);
+        return;
+    }
+
     SkDebugf("Unknown config '%s'.\n", config->getTag().c_str());
 }
 
@@ -566,6 +616,9 @@ static Target* is_enabled(Benchmark* bench, const Config& config) {
     case Benchmark::kGPU_Backend:
         target = new GPUTarget(config);
         break;
+    case Benchmark::kRaster_Backend:
+        target = config.threadedRaster ? new ThreadedRasterTarget(config) : new Target(config);
+        break;
     default:
         target = new Target(config);
         break;
@@ -655,6 +708,15 @@ public:
         }
         fUseMPDs.push_back() = false;
 
+        for (int i = 0; i < FLAGS_parallelSKP.count(); i++) {
+            if (1 != sscanf(FLAGS_parallelSKP[i], "%d", &fParallelThreads.push_back()) ||
+                fParallelThreads.back() < 1) {
+                SkDebugf("Can't parse %s from --parallelSKP as a thread count.\n",
+                         FLAGS_parallelSKP[i]);
+                exit(1);
+            }
+        }
+
         // Prepare the images for decoding
         if (!CollectImages(FLAGS_images, &fImages)) {
             exit(1);
@@ -685,6 +747,17 @@ public:
         return SkPicture::MakeFromStream(stream.get());
     }
 
+    // The SKPs we read off disk don't have a BBH.  Re-record so they grow one.
+    static sk_sp<SkPicture> RecordWithBBH(sk_sp<SkPicture> pic) {
+        SkRTreeFactory factory;
+        SkPictureRecorder recorder;
+        pic->playback(recorder.beginRecording(pic->cullRect().width(),
+                                              pic->cullRect().height(),
+                                              &factory,
+                                              0));
+        return recorder.finishRecordingAsPicture();
+    }
+
     static sk_sp<SkPicture> ReadSVGPicture(const char* path) {
         sk_sp<SkData> data(SkData::MakeFromFileName(path));
         if (!data) {
@@ -790,6 +863,26 @@ public:
             return new DeserializePictureBench(name.c_str(), std::move(data));
         }
 
+        // And, if asked, as DeserializePictureBenchs that load only one tile.
+        while (FLAGS_deserialTile > 0 && fCurrentDeserialTile < fSKPs.count()) {
+            const SkString& path = fSKPs[fCurrentDeserialTile++];
+            sk_sp<SkPicture> pic = ReadPicture(path.c_str());
+            if (!pic) {
+                continue;
+            }
+            // Recording with a BBH makes the serialized picture carry an op index.
+            sk_sp<SkData> data = RecordWithBBH(std::move(pic))->serialize();
+            SkString name = SkStringPrintf("%s_tile%d", SkOSPath::Basename(path.c_str()).c_str(),
+                                           FLAGS_deserialTile);
+            fSourceType = "skp";
+            fBenchType  = "deserial";
+            fSKPBytes = static_cast<double>(data->size());
+            fSKPOps   = 0;
+            return new DeserializePictureBench(name.c_str(), std::move(data),
+                                               SkRect::MakeIWH(FLAGS_deserialTile,
+                                                               FLAGS_deserialTile));
+        }
+
         // Then once each for each scale as SKPBenches (playback).
         while (fCurrentScale < fScales.count()) {
             while (fCurrentSKP < fSKPs.count()) {
@@ -802,14 +895,7 @@ public:
 
                 while (fCurrentUseMPD < fUseMPDs.count()) {
                     if (FLAGS_bbh) {
-                        // The SKP we read off disk doesn't have a BBH.  Re-record so it grows one.
-                        SkRTreeFactory factory;
-                        SkPictureRecorder recorder;
-                        pic->playback(recorder.beginRecording(pic->cullRect().width(),
-                                                              pic->cullRect().height(),
-                                                              &factory,
-                                                              0));
-                        pic = recorder.finishRecordingAsPicture();
+                        pic = RecordWithBBH(std::move(pic));
                     }
                     SkString name = SkOSPath::Basename(path.c_str());
                     fSourceType = "skp";
@@ -836,6 +922,28 @@ public:
             fCurrentScale++;
         }
 
+        // Then once for each --parallelSKP thread count as SKPParallelBenches.
+        while (!fParallelThreads.empty() && fCurrentParallelSKP < fSKPs.count()) {
+            const SkString& path = fSKPs[fCurrentParallelSKP];
+            if (fCurrentParallelThreads == 0) {
+                // SkParallelPlayback schedules tiles by searching the BBH, so always build one.
+                if (sk_sp<SkPicture> pic = ReadPicture(path.c_str())) {
+                    fParallelPicture = RecordWithBBH(std::move(pic));
+                }
+            }
+            if (fParallelPicture && fCurrentParallelThreads < fParallelThreads.count()) {
+                SkString name = SkOSPath::Basename(path.c_str());
+                fSourceType = "skp";
+                fBenchType  = "parallel_playback";
+                return new SKPParallelBench(name.c_str(), fParallelPicture.get(), fClip,
+                                            fParallelThreads[fCurrentParallelThreads++],
+                                            FLAGS_loopSKP);
+            }
+            fParallelPicture = nullptr;
+            fCurrentParallelThreads = 0;
+            fCurrentParallelSKP++;
+        }
+
         // Now loop over each skp again if we have an animation
         if (fZoomMax != 1.0f && fZoomPeriodMs > 0) {
             while (fCurrentAnimSKP < fSKPs.count()) {
@@ -1057,6 +1165,10 @@ public:
             log.appendString("clip",
                     SkStringPrintf("%d %d %d %d", fClip.fLeft, fClip.fTop,
                                                   fClip.fRight, fClip.fBottom).c_str());
+            if (int threads = this->currentParallelThreads()) {
+                log.appendString("threads", SkStringPrintf("%d", threads).c_str());
+                return;
+            }
             SkASSERT_RELEASE(fCurrentScale < fScales.count());  // debugging paranoia
             log.appendString("scale", SkStringPrintf("%.2g", fScales[fCurrentScale]).c_str());
             if (fCurrentUseMPD > 0) {
@@ -1067,6 +1179,13 @@ public:
         }
     }
 
+    // How many threads the current SKPParallelBench plays back on, or 0 for any other bench.
+    int currentParallelThreads() const {
+        return 0 == strcmp(fBenchType, "parallel_playback") && fCurrentParallelThreads > 0
+                ? fParallelThreads[fCurrentParallelThreads - 1]
+                : 0;
+    }
+
     void fillCurrentMetrics(NanoJSONResultsWriter& log) const {
         if (0 == strcmp(fBenchType, "recording")) {
             log.appendMetric("bytes", fSKPBytes);
@@ -1095,6 +1214,8 @@ private:
     SkTArray<SkString> fSVGs;
     SkTArray<SkString> fTextBlobTraces;
     SkTArray<bool>     fUseMPDs;
+    SkTArray<int>      fParallelThreads;
+    sk_sp<SkPicture>   fParallelPicture;
     SkTArray<SkString> fImages;
     SkTArray<SkColorType, true> fColorTypes;
     SkScalar           fZoomMax;
@@ -1106,6 +1227,7 @@ private:
     const char* fBenchType;   // How we bench it: micro, recording, playback, ...
     int fCurrentRecording = 0;
     int fCurrentDeserialPicture = 0;
+    int fCurrentDeserialTile = 0;
     int fCurrentScale = 0;
     int fCurrentSKP = 0;
     int fCurrentSVG = 0;
@@ -1119,6 +1241,8 @@ private:
     int fCurrentSubsetType = 0;
     int fCurrentSampleSize = 0;
     int fCurrentAnimSKP = 0;
+    int fCurrentParallelSKP = 0;
+    int fCurrentParallelThreads = 0;
 };
 
 // Some runs (mostly, Valgrind) are so slow that the bot framework thinks we've hung.
@@ -1230,6 +1354,8 @@ int main(int argc, char** argv) {
 
     int runs = 0;
     BenchmarkStream benchStream;
+    // The first median time and thread count we see for each parallel SKP and config.
+    SkTHashMap<SkString, std::pair<double, int>> parallelBaselines;
     log.beginObject("results");
     AutoreleasePool pool;
     while (Benchmark* b = benchStream.next()) {
@@ -1351,6 +1477,17 @@ int main(int argc, char** argv) {
             }
             log.endArray(); // samples
             benchStream.fillCurrentMetrics(log);
+            double speedup = 0;
+            int baselineThreads = 0;
+            if (int threads = benchStream.currentParallelThreads()) {
+                SkString key = SkStringPrintf("%s %s", bench->getName(), config);
+                if (!parallelBaselines.find(key)) {
+                    parallelBaselines.set(key, {stats.median, threads});
+                }
+                std::tie(speedup, baselineThreads) = *parallelBaselines.find(key);
+                speedup /= stats.median;
+                log.appendMetric("speedup", speedup);
+            }
             if (gpuStatsDump) {
                 // dump to json, only SKPBench currently returns valid keys / values
                 SkASSERT(keys.count() == values.count());
@@ -1414,6 +1551,11 @@ int main(int argc, char** argv) {
                         );
             }
 
+            if (speedup > 0 && !FLAGS_csv) {
+                SkDebugf("\t%.2fx speedup over %d thread(s)\t%s\t%s\n",
+                         speedup, baselineThreads, bench->getUniqueName(), config);
+            }
+
             if (FLAGS_gpuStats && Benchmark::kGPU_Backend == configs[i].backend) {
                 target->dumpStats();
             }
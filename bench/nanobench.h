@@ -28,6 +28,7 @@ struct Config {
     sk_gpu_test::GrContextFactory::ContextType ctxType;
     sk_gpu_test::GrContextFactory::ContextOverrides ctxOverrides;
     bool useDFText;
+    bool threadedRaster;
 };
 
 struct Target {
@@ -73,7 +74,7 @@ struct Target {
     /** Writes gathered stats using SkDebugf. */
     virtual void dumpStats() {}
 
-    SkCanvas* getCanvas() const {
+    virtual SkCanvas* getCanvas() const {
         if (!surface.get()) {
             return nullptr;
         }
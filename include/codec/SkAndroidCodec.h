@@ -274,6 +274,34 @@ public:
         return this->getAndroidPixels(info, pixels, rowBytes);
     }
 
+    enum class ResampleFilter {
+        /**
+         *  Mitchell-Netravali cubic (B = C = 1/3). A good default for photographs.
+         */
+        kMitchell,
+
+        /**
+         *  Three-lobed Lanczos. Sharper than kMitchell, but may ring around hard edges.
+         */
+        kLanczos3,
+    };
+
+    /**
+     *  Decode the image resized to any size no larger than getInfo(), filtering it down with
+     *  a high quality resampling filter rather than the integer sampling of fSampleSize.
+     *
+     *  If the codec can scale natively, as JPEG does in eighths, the image is first decoded at
+     *  the smallest native size that is at least as large as info. The decoded rows are then
+     *  resampled as the codec produces them, so only a few rows of the image are in memory at
+     *  once rather than the whole image.
+     *
+     *  @param info Must be kRGBA_8888 or kBGRA_8888, and kPremul or kOpaque.
+     *  @return Result kSuccess, or another value explaining the type of failure.
+     *          kInvalidScale if info is empty or larger than getInfo().
+     */
+    SkCodec::Result getResampledPixels(const SkImageInfo& info, void* pixels, size_t rowBytes,
+                                       ResampleFilter filter = ResampleFilter::kMitchell);
+
     SkCodec* codec() const { return fCodec.get(); }
 
 protected:
@@ -287,6 +315,9 @@ protected:
             size_t rowBytes, const AndroidOptions& options) = 0;
 
 private:
+    // getResampledPixels() for a dst in the encoded orientation.
+    SkCodec::Result resample(const SkPixmap& dst, ResampleFilter filter);
+
     const SkImageInfo               fInfo;
     const ExifOrientationBehavior   fOrientationBehavior;
     std::unique_ptr<SkCodec>        fCodec;
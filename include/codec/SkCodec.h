@@ -26,6 +26,7 @@
 
 class SkColorSpace;
 class SkData;
+class SkExecutor;
 class SkFrameHolder;
 class SkPngChunkReader;
 class SkSampler;
@@ -287,6 +288,7 @@ public:
             , fSubset(nullptr)
             , fFrameIndex(0)
             , fPriorFrame(kNoFrame)
+            , fExecutor(nullptr)
         {}
 
         ZeroInitialized            fZeroInitialized;
@@ -330,6 +332,15 @@ public:
          *  If set to kNoFrame, the codec will decode any necessary required frame(s) first.
          */
         int                        fPriorFrame;
+
+        /**
+         *  If not NULL, getPixels() may decode independent parts of the image concurrently on
+         *  this executor's threads. Currently this is only done for JPEGs whose scan is split
+         *  by restart markers.
+         *
+         *  The executor is unowned and must remain valid until getPixels() returns.
+         */
+        SkExecutor*                fExecutor;
     };
 
     /**
@@ -33,6 +33,12 @@ public:
      */
     virtual void search(const SkRect& query, std::vector<int>* results) const = 0;
 
+    /**
+     * Populate results[i] with the indices of bounding boxes intersecting queries[i], for each of
+     * the N queries.  Hierarchies may answer many queries at once faster than one at a time.
+     */
+    virtual void search(const SkRect queries[], int N, std::vector<int> results[]) const;
+
     /**
      * Return approximate size in memory of *this.
      */
@@ -97,6 +97,17 @@ public:
      */
     static void PurgeFontCache();
 
+    /**
+     *  Loads pre-rasterized glyphs from a strike bundle file (see tools/strike_bundle.cpp) into
+     *  the font cache, so that the first draws of those fonts need not rasterize them. The file
+     *  is memory mapped while it is read. Strikes for fonts that are not installed, or whose
+     *  installed version differs from the one the bundle was made with, are skipped.
+     *
+     *  Returns the number of strikes loaded, or -1 if the file could not be read or is not a
+     *  strike bundle.
+     */
+    static int PreloadFontCache(const char bundlePath[]);
+
     /**
      *  Scaling bitmaps with the kHigh_SkFilterQuality setting is
      *  expensive, so the result is saved in the global Scaled Image
@@ -63,6 +63,10 @@ public:
         may be used to provide user context to procs->fPictureProc; procs->fPictureProc
         is called with a pointer to data, data byte length, and user context.
 
+        Encoded images and other bulk payloads are referenced from data rather than copied
+        where the format allows, so data created with SkData::MakeFromFileName() lets the
+        operating system page in only what is drawn.
+
         @param data   container for serial data
         @param procs  custom serial data decoders; may be nullptr
         @return       SkPicture constructed from data
@@ -70,6 +74,22 @@ public:
     static sk_sp<SkPicture> MakeFromData(const SkData* data,
                                          const SkDeserialProcs* procs = nullptr);
 
+    /** Recreates the part of SkPicture serialized into data that draws inside region.
+        Returns constructed SkPicture if successful; otherwise, returns nullptr.
+
+        If the serialized SkPicture was recorded with an SkBBHFactory, only the drawing
+        commands that may draw inside region are deserialized. Otherwise, this deserializes
+        every command, as MakeFromData() does. Either way, the returned SkPicture draws the
+        same as the whole picture inside region, and its cullRect() is within region.
+
+        @param data    container for serial data
+        @param region  bounds to load, in the picture's coordinates
+        @param procs   custom serial data decoders; may be nullptr
+        @return        SkPicture constructed from the part of data inside region
+    */
+    static sk_sp<SkPicture> MakeFromData(const SkData* data, const SkRect& region,
+                                         const SkDeserialProcs* procs = nullptr);
+
     /**
 
         @param data   pointer to serial data
@@ -239,8 +259,12 @@ private:
 
     void serialize(SkWStream*, const SkSerialProcs*, class SkRefCntSet* typefaces,
         bool textBlobsOnly=false) const;
+    // If backing is not null, stream reads backing's bytes and its position is an offset into it.
+    // If region is not null, we load only the part of the picture inside it.
     static sk_sp<SkPicture> MakeFromStream(SkStream*, const SkDeserialProcs*,
-                                           class SkTypefacePlayback*);
+                                           class SkTypefacePlayback*,
+                                           const SkData* backing = nullptr,
+                                           const SkRect* region = nullptr);
     friend class SkPictureData;
 
     /** Return true if the SkStream/Buffer represents a serialized picture, and
@@ -263,7 +287,8 @@ private:
     static bool IsValidPictInfo(const struct SkPictInfo& info);
     static sk_sp<SkPicture> Forwardport(const struct SkPictInfo&,
                                         const class SkPictureData*,
-                                        class SkReadBuffer* buffer);
+                                        class SkReadBuffer* buffer,
+                                        const SkRect* region = nullptr);
 
     struct SkPictInfo createHeader() const;
     class SkPictureData* backport() const;
@@ -52,6 +52,10 @@ class SK_API SkSurfaceProps {
 public:
     enum Flags {
         kUseDeviceIndependentFonts_Flag = 1 << 0,
+        // Raster only: evaluate image filters one fixed-size tile of output at a time, so the
+        // intermediate images are bounded by the tile size instead of the layer size. Tiles may
+        // be filtered concurrently on the default SkExecutor.
+        kTiledImageFilters_Flag         = 1 << 1,
     };
     /** Deprecated alias used by Chromium. Will be removed. */
     static const Flags kUseDistanceFieldFonts_Flag = kUseDeviceIndependentFonts_Flag;
@@ -72,6 +76,10 @@ public:
         return SkToBool(fFlags & kUseDeviceIndependentFonts_Flag);
     }
 
+    bool isTiledImageFilters() const {
+        return SkToBool(fFlags & kTiledImageFilters_Flag);
+    }
+
     bool operator==(const SkSurfaceProps& that) const {
         return fFlags == that.fFlags && fPixelGeometry == that.fPixelGeometry;
     }
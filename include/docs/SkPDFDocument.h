@@ -195,15 +195,24 @@ struct Metadata {
     /** Executor to handle threaded work within PDF Backend. If this is nullptr,
         then all work will be done serially on the main thread. To have worker
         threads assist with various tasks, set this to a valid SkExecutor
-        instance. Currently used for executing Deflate algorithm in parallel.
+        instance. Used to finish, deflate and write pages and images in
+        parallel.
 
-        If set, the PDF output will be non-reproducible in the order and
-        internal numbering of objects, but should render the same.
+        The output is byte-for-byte the same as without an executor:
+        objects are numbered and written in the same order, and each
+        stream is deflated as a whole.
 
         Experimental.
     */
     SkExecutor* fExecutor = nullptr;
 
+    /** Deflate compression level for streams and images, from 0 (none) through 1 (fastest)
+        to 9 (smallest).  The default, -1, is zlib's default level.
+
+        Experimental.
+    */
+    int fCompressionLevel = -1;
+
     /** Preferred Subsetter. Only respected if both are compiled in.
 
         The Sfntly subsetter is deprecated.
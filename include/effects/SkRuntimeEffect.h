@@ -18,6 +18,7 @@
 
 class GrShaderCaps;
 class SkColorFilter;
+class SkData;
 class SkMatrix;
 class SkShader;
 
@@ -75,6 +76,8 @@ public:
 
     // [Effect, ErrorText]
     // If successful, Effect != nullptr, otherwise, ErrorText contains the reason for failure.
+    // Recently made effects are cached, so calling Make with the same SkSL again is cheap, and
+    // returns the same effect.
     using EffectResult = std::tuple<sk_sp<SkRuntimeEffect>, SkString>;
 
     static EffectResult Make(SkString sksl);
@@ -127,6 +130,14 @@ public:
 
     ByteCodeResult toByteCode(const void* inputs);
 
+    // [Program, ErrorText]
+    // If successful, Program != nullptr, otherwise, ErrorText contains the reason for failure.
+    // The program has its 'in' variables specialized to the values in 'inputs', and is optimized,
+    // ready for SkSL::ProgramToSkVM.
+    using ProgramResult = std::tuple<std::unique_ptr<SkSL::Program>, SkString>;
+
+    ProgramResult toProgram(const void* inputs);
+
     static void RegisterFlattenables();
 
     ~SkRuntimeEffect();
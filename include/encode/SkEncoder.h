@@ -22,6 +22,15 @@ public:
      */
     bool encodeRows(int numRows);
 
+    /**
+     *  Encode the next |rows.height()| rows of input, reading them from |rows| rather than
+     *  the src.  This is how to feed an encoder made from an SkImageInfo, a band at a time,
+     *  so the whole image never needs to be in memory.  |rows| must match the src in width,
+     *  color type, alpha type, and color space, and must not be empty.  As above, rows past
+     *  the end of the image are ignored.  |rows| need only remain valid during this call.
+     */
+    bool encodeRows(const SkPixmap& rows);
+
     virtual ~SkEncoder() {}
 
 protected:
@@ -34,9 +43,19 @@ protected:
         , fStorage(storageBytes)
     {}
 
-    const SkPixmap&        fSrc;
+    // Returns the pixels of row y, which must be one of the rows being encoded.
+    const void* srcRow(int y) const {
+        return fRows.addr() ? fRows.addr(0, y - fRowsTop) : fSrc.addr(0, y);
+    }
+
+    // When made from an SkImageInfo, fSrc has no pixels, and rows come from fRows instead.
+    const SkPixmap         fSrc;
     int                    fCurrRow;
     SkAutoTMalloc<uint8_t> fStorage;
+
+private:
+    SkPixmap fRows;         // The rows passed to encodeRows(const SkPixmap&), if any.
+    int      fRowsTop = 0;  // The row of the image that is fRows' first row.
 };
 
 #endif
@@ -61,6 +61,14 @@ public:
          *  In the second case, the encoder supports linear or legacy blending.
          */
         AlphaOption fAlphaOption = AlphaOption::kIgnore;
+
+        /**
+         *  If positive, a restart marker is written after every |fRestartRows| rows of MCUs
+         *  (8 or 16 rows of pixels each, depending on |fDownsample|).  This makes the file
+         *  slightly larger, but lets decoders decode bands of it independently, as SkCodec
+         *  does when given an executor.
+         */
+        int fRestartRows = 0;
     };
 
     /**
@@ -82,6 +90,21 @@ public:
     static std::unique_ptr<SkEncoder> Make(SkWStream* dst, const SkPixmap& src,
                                            const Options& options);
 
+    /**
+     *  Create a jpeg encoder that will encode an image described by |info| to the |dst|
+     *  stream, reading its pixels a band at a time from SkEncoder::encodeRows(const SkPixmap&).
+     *  Compressed data is written to |dst| as rows are encoded.
+     *
+     *  So that the whole image is never held in memory, this uses standard Huffman tables
+     *  rather than computing optimal ones, making the output slightly larger than Encode()'s.
+     *
+     *  |dst| is unowned but must remain valid for the lifetime of the object.
+     *
+     *  This returns nullptr on an invalid or unsupported |info|.
+     */
+    static std::unique_ptr<SkEncoder> Make(SkWStream* dst, const SkImageInfo& info,
+                                           const Options& options);
+
     ~SkJpegEncoder() override;
 
 protected:
@@ -90,6 +113,10 @@ protected:
 private:
     SkJpegEncoder(std::unique_ptr<SkJpegEncoderMgr>, const SkPixmap& src);
 
+    // src need not have pixels, in which case they are passed to encodeRows().
+    static std::unique_ptr<SkEncoder> MakeEncoder(SkWStream* dst, const SkPixmap& src,
+                                                  const Options& options);
+
     std::unique_ptr<SkJpegEncoderMgr> fEncoderMgr;
     typedef SkEncoder INHERITED;
 };
@@ -11,6 +11,7 @@
 #include "include/core/SkDataTable.h"
 #include "include/encode/SkEncoder.h"
 
+class SkExecutor;
 class SkPngEncoderMgr;
 class SkWStream;
 
@@ -59,6 +60,16 @@ public:
          *  and the (2i + 1)-th entry is the text for the i-th comment.
          */
         sk_sp<SkDataTable> fComments;
+
+        /**
+         *  If set, the image data is deflated in independent blocks on this executor's threads,
+         *  rather than by libpng on the calling thread.  Rows are filtered by Skia, using the
+         *  same heuristic as libpng to choose among fFilterFlags.  The output is slightly
+         *  larger than without an executor.
+         *
+         *  The executor is unowned and must remain valid for the lifetime of the encoder.
+         */
+        SkExecutor* fExecutor = nullptr;
     };
 
     /**
@@ -80,6 +91,18 @@ public:
     static std::unique_ptr<SkEncoder> Make(SkWStream* dst, const SkPixmap& src,
                                            const Options& options);
 
+    /**
+     *  Create a png encoder that will encode an image described by |info| to the |dst|
+     *  stream, reading its pixels a band at a time from SkEncoder::encodeRows(const SkPixmap&).
+     *  Compressed data is written to |dst| as rows are encoded.
+     *
+     *  |dst| is unowned but must remain valid for the lifetime of the object.
+     *
+     *  This returns nullptr on an invalid or unsupported |info|.
+     */
+    static std::unique_ptr<SkEncoder> Make(SkWStream* dst, const SkImageInfo& info,
+                                           const Options& options);
+
     ~SkPngEncoder() override;
 
 protected:
@@ -87,6 +110,10 @@ protected:
 
     SkPngEncoder(std::unique_ptr<SkPngEncoderMgr>, const SkPixmap& src);
 
+    // src need not have pixels, in which case they are passed to encodeRows().
+    static std::unique_ptr<SkEncoder> MakeEncoder(SkWStream* dst, const SkPixmap& src,
+                                                  const Options& options);
+
     std::unique_ptr<SkPngEncoderMgr> fEncoderMgr;
     typedef SkEncoder INHERITED;
 };
@@ -566,6 +566,15 @@ public:
     // Using cached shader blobs on a different device or driver are undefined.
     bool precompileShader(const SkData& key, const SkData& data);
 
+    // Translates a batch of the key/data pairs described above into this backend's own shader
+    // code (GLSL for OpenGL), and stores the results in the PersistentCache under the same keys.
+    // Programs built later find the translated code in the cache and skip the SkSL compiler. The
+    // SkSL front end and code generation run concurrently on GrContextOptions::fExecutor, if one
+    // was supplied. Nothing is sent to the GPU, so this is suitable for warming a cache ahead of
+    // time. Returns the number of entries stored; entries this backend can't translate (and all
+    // entries on backends that don't support translation) are skipped.
+    int precompileShaders(const sk_sp<SkData> keys[], const sk_sp<SkData> data[], int count);
+
 #ifdef SK_ENABLE_DUMP_GPU
     /** Returns a string with detailed information about the context & GPU, in JSON format. */
     SkString dump() const;
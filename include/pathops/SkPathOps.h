@@ -11,6 +11,7 @@
 #include "include/private/SkTArray.h"
 #include "include/private/SkTDArray.h"
 
+class SkExecutor;
 class SkPath;
 struct SkRect;
 
@@ -101,6 +102,16 @@ public:
       */
     bool resolve(SkPath* result);
 
+    /** Like resolve(result), but spreads the work over the executor's threads: when all the
+        operators are unions, the paths are simplified in parallel, and the intersections between
+        contours are found in parallel. The result is identical to resolve(result).
+
+        @param result The product of the operands.
+        @param executor Runs the parallel work; if null, this is the same as resolve(result).
+        @return True if the operation succeeded.
+      */
+    bool resolve(SkPath* result, SkExecutor* executor);
+
 private:
     SkTArray<SkPath> fPathRefs;
     SkTDArray<SkPathOp> fOps;
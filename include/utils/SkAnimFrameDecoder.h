@@ -0,0 +1,131 @@
+/*
+ * Copyright 2020 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkAnimFrameDecoder_DEFINED
+#define SkAnimFrameDecoder_DEFINED
+
+#include "include/codec/SkCodec.h"
+#include "include/core/SkData.h"
+#include "include/core/SkImageInfo.h"
+#include "include/core/SkRefCnt.h"
+#include "include/private/SkMutex.h"
+#include "include/private/SkSemaphore.h"
+
+#include <memory>
+#include <vector>
+
+class SkExecutor;
+class SkImage;
+class SkTaskGroup;
+
+/**
+ *  Decodes the frames of an animated image for a client that walks through them in order, such
+ *  as a transcoder. While the client works on one frame, the next few are decoded on an
+ *  SkExecutor. Every few frames are kept once decoded, so seeking only has to decode from the
+ *  nearest kept frame.
+ *
+ *  Frames that do not depend on a previous frame are decoded concurrently. A frame that depends
+ *  on another is decoded after it, on the same thread as any other frames it needs.
+ *
+ *  getFrame() may be called from any thread.
+ */
+class SK_API SkAnimFrameDecoder {
+public:
+    struct Options {
+        /**
+         *  If set, the frames after the last one requested are decoded on this executor's
+         *  threads. If not, frames are only decoded on the thread that asks for them.
+         *
+         *  The executor is unowned and must remain valid for the lifetime of the decoder.
+         */
+        SkExecutor* fExecutor = nullptr;
+
+        /**
+         *  How many frames after the last one requested are decoded ahead of time, wrapping
+         *  around to the first frame. Ignored without fExecutor.
+         */
+        int fLookahead = 2;
+
+        /**
+         *  Every frame whose index is a multiple of this is kept once decoded. Zero keeps none,
+         *  in which case seeking back may decode the animation from its start.
+         */
+        int fKeyframeInterval = 16;
+    };
+
+    /**
+     *  Returns nullptr if data is not an image SkCodec can decode.
+     */
+    static std::unique_ptr<SkAnimFrameDecoder> Make(sk_sp<SkData> data, const Options& options);
+
+    ~SkAnimFrameDecoder();
+
+    /**
+     *  The info of the images returned by getFrame(), as reported by SkCodec::getInfo().
+     */
+    const SkImageInfo& imageInfo() const { return fInfo; }
+
+    /**
+     *  Returns 1 for a still image.
+     */
+    int frameCount() const { return fFrameCount; }
+
+    /**
+     *  As reported by SkCodec::getFrameInfo(), which is empty for a still image.
+     */
+    const std::vector<SkCodec::FrameInfo>& frameInfos() const { return fFrameInfos; }
+
+    /**
+     *  Returns the frame at index, waiting for it to be decoded if necessary, or nullptr if it
+     *  could not be decoded. The frames after it are queued to be decoded next.
+     */
+    sk_sp<SkImage> getFrame(int index);
+
+private:
+    enum class State {
+        kIdle,      // Decoded if fImage is set, else not.
+        kQueued,    // Scheduled on the executor, but not started.
+        kDecoding,  // Claimed by a decode in progress.
+    };
+
+    struct Frame {
+        sk_sp<SkImage> fImage;
+        State          fState = State::kIdle;
+    };
+
+    SkAnimFrameDecoder(sk_sp<SkData>, std::unique_ptr<SkCodec>, const Options&);
+
+    // Decodes the frame at index along with any frames it needs that are neither kept nor
+    // being decoded elsewhere. If onlyIfQueued, nothing is done unless the frame is kQueued.
+    sk_sp<SkImage> decode(int index, bool onlyIfQueued);
+
+    int requiredFrame(int index) const;
+    bool isKept(int index) const SK_REQUIRES(fMutex);
+    void waitForFrame() SK_REQUIRES(fMutex);
+    void signalFrames() SK_REQUIRES(fMutex);
+
+    std::unique_ptr<SkCodec> acquireCodec();
+    void releaseCodec(std::unique_ptr<SkCodec>);
+
+    const sk_sp<SkData>             fData;
+    const Options                   fOptions;
+    SkImageInfo                     fInfo;
+    std::vector<SkCodec::FrameInfo> fFrameInfos;
+    int                             fFrameCount;
+
+    SkMutex                               fMutex;
+    std::vector<Frame>                    fFrames   SK_GUARDED_BY(fMutex);
+    std::vector<std::unique_ptr<SkCodec>> fCodecs   SK_GUARDED_BY(fMutex);
+    int                                   fCurrent  SK_GUARDED_BY(fMutex);
+    int                                   fWaiters  SK_GUARDED_BY(fMutex);
+    SkSemaphore                           fFrameDone;
+
+    // Declared last so it is destroyed first, while the rest is still valid for its tasks.
+    std::unique_ptr<SkTaskGroup>          fTasks;
+};
+
+#endif
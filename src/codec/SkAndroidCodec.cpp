@@ -8,9 +8,12 @@
 #include "include/codec/SkAndroidCodec.h"
 #include "include/codec/SkCodec.h"
 #include "include/core/SkPixmap.h"
+#include "include/private/SkTemplates.h"
 #include "src/codec/SkAndroidCodecAdapter.h"
 #include "src/codec/SkCodecPriv.h"
+#include "src/codec/SkRowResampler.h"
 #include "src/codec/SkSampledCodec.h"
+#include "src/core/SkAutoPixmapStorage.h"
 #include "src/core/SkPixmapPriv.h"
 
 static bool is_valid_sample_size(int sampleSize) {
@@ -413,3 +416,96 @@ SkCodec::Result SkAndroidCodec::getAndroidPixels(const SkImageInfo& info, void*
         size_t rowBytes) {
     return this->getAndroidPixels(info, pixels, rowBytes, nullptr);
 }
+
+static SkRowResampler::Filter to_row_filter(SkAndroidCodec::ResampleFilter filter) {
+    switch (filter) {
+        case SkAndroidCodec::ResampleFilter::kMitchell: return SkRowResampler::Filter::kMitchell;
+        case SkAndroidCodec::ResampleFilter::kLanczos3: return SkRowResampler::Filter::kLanczos3;
+    }
+    SkUNREACHABLE;
+}
+
+SkCodec::Result SkAndroidCodec::getResampledPixels(const SkImageInfo& info, void* pixels,
+                                                   size_t rowBytes, ResampleFilter filter) {
+    if (!pixels || rowBytes < info.minRowBytes()) {
+        return SkCodec::kInvalidParameters;
+    }
+    if (info.isEmpty() || info.width() > fInfo.width() || info.height() > fInfo.height()) {
+        return SkCodec::kInvalidScale;
+    }
+    if ((info.colorType() != kRGBA_8888_SkColorType &&
+         info.colorType() != kBGRA_8888_SkColorType) ||
+        (info.alphaType() != kPremul_SkAlphaType && info.alphaType() != kOpaque_SkAlphaType)) {
+        return SkCodec::kInvalidConversion;
+    }
+
+    SkPixmap dst(info, pixels, rowBytes);
+    if (ExifOrientationBehavior::kIgnore == fOrientationBehavior) {
+        return this->resample(dst, filter);
+    }
+
+    SkCodec::Result result;
+    auto decode = [this, filter, &result](const SkPixmap& pm) {
+        result = this->resample(pm, filter);
+        return acceptable_result(result);
+    };
+
+    if (SkPixmapPriv::Orient(dst, fCodec->getOrigin(), decode)) {
+        return result;
+    }
+
+    // Orient returned false. If resample succeeded, then Orient failed internally.
+    if (acceptable_result(result)) {
+        return SkCodec::kInternalError;
+    }
+
+    return result;
+}
+
+SkCodec::Result SkAndroidCodec::resample(const SkPixmap& dst, ResampleFilter filter) {
+    // Let the codec do as much of the work as it can. Ask for the smallest native scale that
+    // is no smaller than dst; codecs that cannot scale report their full size for all of them.
+    SkISize srcSize = fCodec->dimensions();
+    for (int numerator = 1; numerator < 8; ++numerator) {
+        const SkISize scaled = fCodec->getScaledDimensions(numerator / 8.0f);
+        if (scaled.width() >= dst.width() && scaled.height() >= dst.height()) {
+            srcSize = scaled;
+            break;
+        }
+    }
+    if (srcSize == dst.dimensions()) {
+        return fCodec->getPixels(dst);
+    }
+
+    const SkImageInfo srcInfo = dst.info().makeDimensions(srcSize);
+    SkRowResampler resampler(srcSize, dst, to_row_filter(filter));
+
+    SkCodec::Result result = fCodec->startScanlineDecode(srcInfo);
+    if (SkCodec::kSuccess == result &&
+            SkCodec::kTopDown_SkScanlineOrder == fCodec->getScanlineOrder()) {
+        SkAutoTMalloc<uint32_t> row(srcSize.width());
+        for (int y = 0; y < srcSize.height(); ++y) {
+            // A row the codec could not decode is filled in by it, and stands in for the rest.
+            if (SkCodec::kSuccess == result &&
+                    1 != fCodec->getScanlines(row.get(), 1, srcInfo.minRowBytes())) {
+                result = SkCodec::kIncompleteInput;
+            }
+            resampler.addRow(row.get());
+        }
+        return result;
+    }
+
+    // Codecs that cannot produce their rows in order are decoded whole, at the native scale.
+    SkAutoPixmapStorage src;
+    if (!src.tryAlloc(srcInfo)) {
+        return SkCodec::kInternalError;
+    }
+    result = fCodec->getPixels(src);
+    if (!acceptable_result(result)) {
+        return result;
+    }
+    for (int y = 0; y < srcSize.height(); ++y) {
+        resampler.addRow(src.addr32(0, y));
+    }
+    return result;
+}
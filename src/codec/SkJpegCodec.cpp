@@ -16,8 +16,13 @@
 #include "src/codec/SkCodecPriv.h"
 #include "src/codec/SkJpegDecoderMgr.h"
 #include "src/codec/SkParseEncodedOrigin.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/pdf/SkJpegInfo.h"
 
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
 // stdio is needed for libjpeg-turbo
 #include <stdio.h>
 #include "src/codec/SkJpegUtility.h"
@@ -40,6 +45,9 @@ bool SkJpegCodec::IsJpeg(const void* buffer, size_t bytesRead) {
 const uint32_t kExifHeaderSize = 14;
 const uint32_t kExifMarker = JPEG_APP0 + 1;
 
+// Hack for testing: counts the images this thread has decoded in bands.
+thread_local int gSkJpegBandedDecodes{0};
+
 static bool is_orientation_marker(jpeg_marker_struct* marker, SkEncodedOrigin* orientation) {
     if (kExifMarker != marker->marker || marker->data_length < kExifHeaderSize) {
         return false;
@@ -531,6 +539,12 @@ SkCodec::Result SkJpegCodec::onGetPixels(const SkImageInfo& dstInfo,
         return kUnimplemented;
     }
 
+    if (options.fExecutor &&
+        this->decodeInBands(dstInfo, dst, dstRowBytes, options.fExecutor)) {
+        gSkJpegBandedDecodes++;
+        return kSuccess;
+    }
+
     // Get a pointer to the decompress info since we will use it quite frequently
     jpeg_decompress_struct* dinfo = fDecoderMgr->dinfo();
 
@@ -566,6 +580,218 @@ SkCodec::Result SkJpegCodec::onGetPixels(const SkImageInfo& dstInfo,
     return kSuccess;
 }
 
+/*
+ * Where the entropy coded data of a sequential jpeg's first scan is, and the restart markers
+ * within it.
+ */
+struct JpegScanLayout {
+    size_t              fHeightOffset;  // of the image height in the SOF segment
+    size_t              fScanStart;     // of the first byte after the SOS segment
+    size_t              fScanEnd;       // of the marker that ends the scan
+    std::vector<size_t> fRestarts;      // of each RSTn marker, in order
+};
+
+static bool read_scan_layout(const uint8_t* data, size_t size, JpegScanLayout* layout) {
+    // Walk the marker segments after SOI up to and including the first SOS.
+    bool foundSOF = false;
+    size_t i = 2;
+    for (;;) {
+        if (i + 4 > size || 0xFF != data[i]) {
+            return false;
+        }
+        const uint8_t marker = data[i + 1];
+        if (0xFF == marker) {
+            // Fill byte.
+            i++;
+            continue;
+        }
+        const size_t length = (data[i + 2] << 8) | data[i + 3];
+        if (length < 2 || i + 2 + length > size) {
+            return false;
+        }
+        if (0xC0 == marker || 0xC1 == marker) {
+            if (length < 7) {
+                return false;
+            }
+            // The SOF segment is the length, the precision, then the height.
+            layout->fHeightOffset = i + 5;
+            foundSOF = true;
+        }
+        i += 2 + length;
+        if (0xDA == marker) {
+            break;
+        }
+    }
+    if (!foundSOF) {
+        return false;
+    }
+
+    // In entropy coded data, 0xFF is followed by a stuffed zero, a fill byte, or a marker.
+    layout->fScanStart = i;
+    while (i + 1 < size) {
+        const uint8_t* ff = (const uint8_t*) memchr(data + i, 0xFF, size - 1 - i);
+        if (!ff) {
+            break;
+        }
+        i = ff - data;
+        const uint8_t next = data[i + 1];
+        if (0x00 == next) {
+            i += 2;
+        } else if (0xFF == next) {
+            i += 1;
+        } else if (JPEG_RST0 <= next && next <= JPEG_RST0 + 7) {
+            if (next - JPEG_RST0 != (int) (layout->fRestarts.size() % 8)) {
+                return false;
+            }
+            layout->fRestarts.push_back(i);
+            i += 2;
+        } else {
+            layout->fScanEnd = i;
+            return true;
+        }
+    }
+    // The scan is truncated.
+    return false;
+}
+
+// Bands are made of whole units: the fewest rows of MCUs that start and end at restart markers.
+// The rows of a band depend on the row of chroma samples on either side of it, so each band is
+// decoded with an extra unit above and below, which is thrown away.
+static constexpr int kMinUnitsPerBand   = 4;
+static constexpr int kMinPixelsPerBand  = 1 << 18;
+static constexpr int kMaxBands          = 32;
+
+bool SkJpegCodec::decodeInBands(const SkImageInfo& dstInfo, void* dst, size_t rowBytes,
+                                SkExecutor* executor) {
+    jpeg_decompress_struct* dinfo = fDecoderMgr->dinfo();
+    if (0 == dinfo->restart_interval || dinfo->progressive_mode ||
+        dinfo->comps_in_scan != dinfo->num_components ||
+        dinfo->scale_num != dinfo->scale_denom ||
+        JCS_CMYK == dinfo->out_color_space ||
+        (this->colorXform() && 4 != dstInfo.bytesPerPixel())) {
+        return false;
+    }
+    const uint8_t* data = (const uint8_t*) this->stream()->getMemoryBase();
+    if (!data || !this->stream()->hasLength()) {
+        return false;
+    }
+    const size_t size = this->stream()->getLength();
+
+    const int width  = this->dimensions().width(),
+              height = this->dimensions().height();
+    SkASSERT(dstInfo.dimensions() == this->dimensions());
+
+    // A scan of one component has one block per MCU, however it is sampled.
+    const int mcuWidth  = 1 == dinfo->comps_in_scan ? DCTSIZE
+                                                    : dinfo->max_h_samp_factor * DCTSIZE,
+              mcuHeight = 1 == dinfo->comps_in_scan ? DCTSIZE
+                                                    : dinfo->max_v_samp_factor * DCTSIZE;
+    const int mcusPerRow = (width + mcuWidth - 1) / mcuWidth,
+              mcuRows    = (height + mcuHeight - 1) / mcuHeight;
+    const int restartInterval = dinfo->restart_interval;
+
+    int a = restartInterval, b = mcusPerRow;
+    while (b) {
+        int t = a % b;
+        a = b;
+        b = t;
+    }
+    const int64_t unitMCUs = (int64_t) restartInterval / a * mcusPerRow;
+    const int unitHeight = SkToInt(unitMCUs / mcusPerRow) * mcuHeight;
+    const int units = (height + unitHeight - 1) / unitHeight;
+    const int bands = std::min({ kMaxBands, units / kMinUnitsPerBand,
+                                 SkToInt((int64_t) width * height / kMinPixelsPerBand) });
+    if (bands < 2) {
+        return false;
+    }
+
+    JpegScanLayout layout;
+    const int64_t mcus = (int64_t) mcusPerRow * mcuRows;
+    if (!read_scan_layout(data, size, &layout) ||
+        (int64_t) layout.fRestarts.size() != (mcus - 1) / restartInterval) {
+        return false;
+    }
+
+    std::atomic<bool> failed{false};
+    SkTaskGroup(*executor).batch(bands, [&](int band) {
+        const int firstUnit = units *  band      / bands,
+                  endUnit   = units * (band + 1) / bands,
+                  firstDecodedUnit = std::max(firstUnit - 1, 0),
+                  endDecodedUnit   = std::min(endUnit + 1, units);
+        const int firstRow = firstUnit * unitHeight,
+                  endRow   = std::min(endUnit * unitHeight, height),
+                  firstDecodedRow = firstDecodedUnit * unitHeight,
+                  endDecodedRow   = std::min(endDecodedUnit * unitHeight, height);
+
+        // Make a jpeg of just the decoded units: the same headers with a smaller height, the
+        // entropy coded data between their restart markers, renumbered to start at RST0, and
+        // an EOI.
+        const int firstRestart = SkToInt(firstDecodedUnit * unitMCUs / restartInterval),
+                  endRestart   = SkToInt(endDecodedUnit   * unitMCUs / restartInterval);
+        const size_t scanStart = 0 == firstRestart ? layout.fScanStart
+                                                   : layout.fRestarts[firstRestart - 1] + 2,
+                     scanEnd   = endDecodedUnit == units ? layout.fScanEnd
+                                                         : layout.fRestarts[endRestart - 1];
+        const size_t bandSize = layout.fScanStart + (scanEnd - scanStart) + 2;
+        SkAutoTMalloc<uint8_t> bandData(bandSize);
+        memcpy(bandData.get(), data, layout.fScanStart);
+        memcpy(bandData.get() + layout.fScanStart, data + scanStart, scanEnd - scanStart);
+        bandData[bandSize - 2] = 0xFF;
+        bandData[bandSize - 1] = JPEG_EOI;
+
+        const int bandHeight = endDecodedRow - firstDecodedRow;
+        bandData[layout.fHeightOffset    ] = (uint8_t) (bandHeight >> 8);
+        bandData[layout.fHeightOffset + 1] = (uint8_t) bandHeight;
+        const int lastRestart = endDecodedUnit == units ? SkToInt(layout.fRestarts.size())
+                                                        : endRestart - 1;
+        for (int i = firstRestart; i < lastRestart; i++) {
+            const size_t offset = layout.fScanStart + (layout.fRestarts[i] - scanStart) + 1;
+            bandData[offset] = (uint8_t) (JPEG_RST0 + ((i - firstRestart) & 7));
+        }
+
+        // Rows above firstRow only prime the upsampler. Like everything else that needs freeing,
+        // this is allocated before the setjmp() below, which a libjpeg error would longjmp past.
+        // Bands aren't scaled, and no output color space has more than 4 bytes per pixel.
+        SkAutoTMalloc<uint8_t> discarded((size_t) width * 4);
+
+        SkMemoryStream bandStream(bandData.get(), bandSize, false);
+        JpegDecoderMgr decoderMgr(&bandStream);
+        skjpeg_error_mgr::AutoPushJmpBuf jmp(decoderMgr.errorMgr());
+        if (setjmp(jmp)) {
+            failed = true;
+            return;
+        }
+        decoderMgr.init();
+        jpeg_decompress_struct* bandInfo = decoderMgr.dinfo();
+        if (JPEG_HEADER_OK != jpeg_read_header(bandInfo, true)) {
+            failed = true;
+            return;
+        }
+        bandInfo->out_color_space    = dinfo->out_color_space;
+        bandInfo->dither_mode        = dinfo->dither_mode;
+        bandInfo->dct_method         = dinfo->dct_method;
+        bandInfo->do_fancy_upsampling = dinfo->do_fancy_upsampling;
+        if (!jpeg_start_decompress(bandInfo)) {
+            failed = true;
+            return;
+        }
+
+        SkASSERT(get_row_bytes(bandInfo) <= (size_t) width * 4);
+        for (int y = firstDecodedRow; y < endRow; y++) {
+            JSAMPLE* row = y < firstRow ? discarded.get()
+                                        : SkTAddOffset<JSAMPLE>(dst, y * rowBytes);
+            if (1 != jpeg_read_scanlines(bandInfo, &row, 1)) {
+                failed = true;
+                return;
+            }
+            if (y >= firstRow && this->colorXform()) {
+                this->applyColorXform(row, row, width);
+            }
+        }
+    });
+    return !failed;
+}
+
 bool SkJpegCodec::allocateStorage(const SkImageInfo& dstInfo) {
     int dstWidth = dstInfo.width();
 
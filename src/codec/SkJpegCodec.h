@@ -109,6 +109,14 @@ private:
     bool SK_WARN_UNUSED_RESULT allocateStorage(const SkImageInfo& dstInfo);
     int readRows(const SkImageInfo& dstInfo, void* dst, size_t rowBytes, int count, const Options&);
 
+    /*
+     * Decodes the whole image as independent bands of rows on executor's threads, if the scan
+     * is split by restart markers at the start of rows. Returns false, having written nothing
+     * that matters, if the image cannot be decoded this way.
+     */
+    bool decodeInBands(const SkImageInfo& dstInfo, void* dst, size_t rowBytes,
+                       SkExecutor* executor);
+
     /*
      * Scanline decoding.
      */
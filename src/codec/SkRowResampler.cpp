@@ -0,0 +1,153 @@
+/*
+ * Copyright 2020 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "src/codec/SkRowResampler.h"
+
+#include "include/private/SkNx.h"
+#include "include/private/SkTemplates.h"
+
+#include <algorithm>
+#include <cmath>
+
+static float filter_radius(SkRowResampler::Filter filter) {
+    return filter == SkRowResampler::Filter::kLanczos3 ? 3.0f : 2.0f;
+}
+
+static float evaluate_filter(SkRowResampler::Filter filter, float x) {
+    x = std::fabs(x);
+    switch (filter) {
+        case SkRowResampler::Filter::kMitchell:
+            // The general cubic with B = C = 1/3 plugged in.
+            if (x < 1) {
+                return (7 * x * x * x - 12 * x * x + 16.0f / 3) / 6;
+            }
+            if (x < 2) {
+                return (-7.0f / 3 * x * x * x + 12 * x * x - 20 * x + 32.0f / 3) / 6;
+            }
+            return 0;
+        case SkRowResampler::Filter::kLanczos3: {
+            if (x < 1e-6f) {
+                return 1;
+            }
+            if (x >= 3) {
+                return 0;
+            }
+            const float pix = SK_FloatPI * x;
+            return 3 * std::sin(pix) * std::sin(pix / 3) / (pix * pix);
+        }
+    }
+    SkUNREACHABLE;
+}
+
+void SkRowResampler::ComputeContributions(int srcLength, int dstLength, Filter filter,
+                                          std::vector<Contribution>* contributions,
+                                          std::vector<float>* weights) {
+    const float scale = (float)dstLength / srcLength;
+    // When shrinking, the filter is stretched to cover every source pixel that maps to a
+    // destination pixel, so nothing is skipped.
+    const float stretch = std::min(1.0f, scale);
+    const float radius  = filter_radius(filter) / stretch;
+
+    contributions->resize(dstLength);
+    weights->clear();
+    for (int i = 0; i < dstLength; ++i) {
+        const float center = (i + 0.5f) / scale - 0.5f;
+        const int first = std::max(0, (int)std::ceil(center - radius)),
+                  last  = std::min(srcLength - 1, (int)std::floor(center + radius));
+
+        Contribution& c = (*contributions)[i];
+        c.fFirst   = first;
+        c.fCount   = last - first + 1;
+        c.fWeights = SkToInt(weights->size());
+
+        // Taps that would fall outside the source are dropped and the rest renormalized.
+        float sum = 0;
+        for (int j = first; j <= last; ++j) {
+            const float w = evaluate_filter(filter, (j - center) * stretch);
+            weights->push_back(w);
+            sum += w;
+        }
+        if (sum == 0) {
+            // Only possible in a corner case of rounding; take the nearest pixel.
+            c.fFirst = SkTPin((int)std::round(center), 0, srcLength - 1);
+            c.fCount = 1;
+            weights->resize(c.fWeights);
+            weights->push_back(1);
+            continue;
+        }
+        for (int j = 0; j < c.fCount; ++j) {
+            (*weights)[c.fWeights + j] /= sum;
+        }
+    }
+}
+
+SkRowResampler::SkRowResampler(SkISize srcSize, const SkPixmap& dst, Filter filter)
+        : fSrcSize(srcSize)
+        , fDst(dst) {
+    SkASSERT(!srcSize.isEmpty() && !dst.dimensions().isEmpty());
+    SkASSERT(dst.info().bytesPerPixel() == 4);
+
+    ComputeContributions(srcSize.width(),  dst.width(),  filter, &fColumns, &fColumnWeights);
+    ComputeContributions(srcSize.height(), dst.height(), filter, &fRows,    &fRowWeights);
+
+    fRingRows = 1;
+    for (const Contribution& c : fRows) {
+        fRingRows = std::max(fRingRows, c.fCount);
+    }
+    fRing.reset(new float[(size_t)fRingRows * dst.width() * 4]);
+}
+
+void SkRowResampler::filterRow(const uint32_t* src, float* dst) const {
+    for (int x = 0; x < fDst.width(); ++x) {
+        const Contribution& c = fColumns[x];
+        const float* weights = fColumnWeights.data() + c.fWeights;
+        Sk4f sum(0);
+        for (int i = 0; i < c.fCount; ++i) {
+            sum += weights[i] * SkNx_cast<float>(Sk4b::Load(src + c.fFirst + i));
+        }
+        sum.store(dst + 4 * x);
+    }
+}
+
+void SkRowResampler::writeRow(int y) {
+    const Contribution& c = fRows[y];
+    const float* weights = fRowWeights.data() + c.fWeights;
+    const size_t ringRowFloats = (size_t)fDst.width() * 4;
+
+    SkAutoSTMalloc<16, const float*> rows(c.fCount);
+    for (int i = 0; i < c.fCount; ++i) {
+        rows[i] = fRing.get() + ((c.fFirst + i) % fRingRows) * ringRowFloats;
+    }
+
+    uint32_t* dst = fDst.writable_addr32(0, y);
+    for (int x = 0; x < fDst.width(); ++x) {
+        Sk4f sum(0);
+        for (int i = 0; i < c.fCount; ++i) {
+            sum += weights[i] * Sk4f::Load(rows[i] + 4 * x);
+        }
+        // Negative lobes can push values outside of what premultiplied pixels can hold.
+        const Sk4f alpha(SkTPin(sum[3], 0.0f, 255.0f));
+        sum = Sk4f::Min(Sk4f::Max(sum, Sk4f(0)), alpha);
+        SkNx_cast<uint8_t>(sum + 0.5f).store(dst + x);
+    }
+}
+
+void SkRowResampler::addRow(const void* row) {
+    SkASSERT(fSrcRow < fSrcSize.height());
+
+    this->filterRow(static_cast<const uint32_t*>(row),
+                    fRing.get() + (size_t)(fSrcRow % fRingRows) * fDst.width() * 4);
+    fSrcRow++;
+
+    while (fDstRow < fDst.height()) {
+        const Contribution& c = fRows[fDstRow];
+        if (c.fFirst + c.fCount > fSrcRow) {
+            break;
+        }
+        this->writeRow(fDstRow++);
+    }
+}
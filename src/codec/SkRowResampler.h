@@ -0,0 +1,72 @@
+/*
+ * Copyright 2020 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkRowResampler_DEFINED
+#define SkRowResampler_DEFINED
+
+#include "include/core/SkPixmap.h"
+#include "include/core/SkSize.h"
+
+#include <memory>
+#include <vector>
+
+/**
+ *  Resizes an image with a separable filter, taking the source one row at a time from top to
+ *  bottom. Each source row is filtered horizontally as it arrives, and only as many filtered rows
+ *  as the vertical filter spans are kept, so the memory used does not depend on the source height.
+ *  A row of the destination is written as soon as the last source row it needs has been added.
+ *
+ *  Pixels are four 8-bit channels with alpha last, either premultiplied or opaque.
+ */
+class SkRowResampler {
+public:
+    enum class Filter {
+        kMitchell,  // Mitchell-Netravali cubic, B = C = 1/3.
+        kLanczos3,  // Sharper, but may ring around hard edges.
+    };
+
+    // dst must stay valid until every source row has been added.
+    SkRowResampler(SkISize srcSize, const SkPixmap& dst, Filter filter);
+
+    // Adds the next row of the source, which is srcSize.width() pixels long.
+    void addRow(const void* row);
+
+    // The number of rows added so far.
+    int rowsAdded() const { return fSrcRow; }
+
+private:
+    struct Contribution {
+        int fFirst;   // The first source pixel or row.
+        int fCount;   // How many follow it, including itself.
+        int fWeights; // Where the weights start in the weights array.
+    };
+
+    static void ComputeContributions(int srcLength, int dstLength, Filter filter,
+                                     std::vector<Contribution>* contributions,
+                                     std::vector<float>* weights);
+
+    void filterRow(const uint32_t* src, float* dst) const;
+    void writeRow(int y);
+
+    const SkISize             fSrcSize;
+    const SkPixmap            fDst;
+
+    std::vector<Contribution> fColumns;
+    std::vector<float>        fColumnWeights;
+    std::vector<Contribution> fRows;
+    std::vector<float>        fRowWeights;
+
+    // The horizontally filtered source rows the next destination rows need; source row y is
+    // kept at (y % fRingRows).
+    int                       fRingRows;
+    std::unique_ptr<float[]>  fRing;
+
+    int                       fSrcRow = 0;
+    int                       fDstRow = 0;
+};
+
+#endif  // SkRowResampler_DEFINED
@@ -16,3 +16,9 @@ void SkBBoxHierarchy::insert(const SkRect rects[], const Metadata[], int N) {
     // Ignore Metadata.
     this->insert(rects, N);
 }
+
+void SkBBoxHierarchy::search(const SkRect queries[], int N, std::vector<int> results[]) const {
+    for (int i = 0; i < N; i++) {
+        this->search(queries[i], &results[i]);
+    }
+}
@@ -8,6 +8,8 @@
 #include "include/core/SkBBHFactory.h"
 #include "src/core/SkBigPicture.h"
 #include "src/core/SkPictureCommon.h"
+#include "src/core/SkPictureData.h"
+#include "src/core/SkPictureRecord.h"
 #include "src/core/SkRecord.h"
 #include "src/core/SkRecordDraw.h"
 #include "src/core/SkTraceEvent.h"
@@ -39,6 +41,39 @@ void SkBigPicture::playback(SkCanvas* canvas, AbortCallback* callback) const {
                  callback);
 }
 
+void SkBigPicture::playbackOps(SkCanvas* canvas, const std::vector<int>& ops) const {
+    SkASSERT(canvas);
+    SkRecordDrawOps(*fRecord,
+                    canvas,
+                    this->drawablePicts(),
+                    nullptr,
+                    this->drawableCount(),
+                    ops,
+                    nullptr);
+}
+
+void SkBigPicture::playbackWithIndex(SkPictureRecord* recorder,
+                                     SkTArray<SkPictureOpIndexEntry>* index) const {
+    SkASSERT(recorder && index);
+    SkAutoTMalloc<SkRect> bounds(fRecord->count());
+    SkAutoTMalloc<SkBBoxHierarchy::Metadata> meta(fRecord->count());
+    SkRecordFillBounds(fCullRect, *fRecord, bounds, meta);
+
+    // This matches SkRecordDraw() without a BBH, one op at a time.
+    SkAutoCanvasRestore saveRestore(recorder, true);
+    SkRecords::Draw draw(recorder, this->drawablePicts(), nullptr, this->drawableCount());
+    for (int i = 0; i < fRecord->count(); i++) {
+        const size_t begin = recorder->writeStream().bytesWritten();
+        fRecord->visit(i, draw);
+        const size_t end = recorder->writeStream().bytesWritten();
+
+        // Ops that recorded nothing (e.g. were quick-rejected) or draw nowhere need no entry.
+        if (begin < end && !bounds[i].isEmpty()) {
+            index->push_back({SkToU32(begin), SkToU32(end), bounds[i]});
+        }
+    }
+}
+
 void SkBigPicture::partialPlayback(SkCanvas* canvas,
                                    int start,
                                    int stop,
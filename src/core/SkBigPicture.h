@@ -12,11 +12,16 @@
 #include "include/core/SkRect.h"
 #include "include/private/SkNoncopyable.h"
 #include "include/private/SkOnce.h"
+#include "include/private/SkTArray.h"
 #include "include/private/SkTemplates.h"
 
+#include <vector>
+
 class SkBBoxHierarchy;
 class SkMatrix;
+class SkPictureRecord;
 class SkRecord;
+struct SkPictureOpIndexEntry;
 
 // An implementation of SkPicture supporting an arbitrary number of drawing commands.
 class SkBigPicture final : public SkPicture {
@@ -53,6 +58,14 @@ public:
                          int start,
                          int stop,
                          const SkMatrix& initialCTM) const;
+// Used by SkParallelPlayback
+    // Plays back only these ops, e.g. those found by searching bbh() for one tile.
+    void playbackOps(SkCanvas*, const std::vector<int>& ops) const;
+// Used by SkPicture::backport()
+    // Plays back like playback(), noting in index where each op lands in recorder's op data
+    // and where it can draw.
+    void playbackWithIndex(SkPictureRecord* recorder,
+                           SkTArray<SkPictureOpIndexEntry>* index) const;
 // Used by GrRecordReplaceDraw
     const SkBBoxHierarchy* bbh() const { return fBBH.get(); }
     const SkRecord*     record() const { return fRecord.get(); }
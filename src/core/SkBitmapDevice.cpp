@@ -22,6 +22,7 @@
 #include "src/core/SkRasterClip.h"
 #include "src/core/SkSpecialImage.h"
 #include "src/core/SkStrikeCache.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/core/SkTLazy.h"
 
 struct Bounder {
@@ -616,6 +617,63 @@ private:
 
 }  // anonymous ns
 
+static constexpr int kImageFilterTileSize = 512;
+// How many tiles are filtered before their results are drawn. This bounds the memory in use, while
+// leaving enough tiles to keep several threads busy.
+static constexpr int kImageFilterTilesInFlight = 8;
+
+void SkBitmapDevice::drawSpecialTiled(SkSpecialImage* src, int x, int y, const SkPaint& paint,
+                                      const SkMatrix& filterMatrix, const SkIRect& filterClip) {
+    const SkImageFilter_Base* filter = as_IFB(paint.getImageFilter());
+    SkPaint tilePaint(paint);
+    tilePaint.setImageFilter(nullptr);
+
+    const int tilesX = (filterClip.width()  + kImageFilterTileSize - 1) / kImageFilterTileSize,
+              tilesY = (filterClip.height() + kImageFilterTileSize - 1) / kImageFilterTileSize,
+              tileCount = tilesX * tilesY;
+
+    struct Tile {
+        SkIRect               fBounds;
+        sk_sp<SkSpecialImage> fImage;
+        SkIPoint              fOffset;
+    };
+    for (int first = 0; first < tileCount; first += kImageFilterTilesInFlight) {
+        Tile tiles[kImageFilterTilesInFlight];
+        const int count = std::min(kImageFilterTilesInFlight, tileCount - first);
+
+        // Each tile is its own filter evaluation with the tile as the clip, so every stage only
+        // computes the tile plus whatever border its onFilterNodeBounds() asks of its inputs.
+        SkTaskGroup().batch(count, [&](int i) {
+            Tile& tile = tiles[i];
+            const int t = first + i;
+            tile.fBounds = SkIRect::MakeXYWH(filterClip.fLeft + (t % tilesX) * kImageFilterTileSize,
+                                             filterClip.fTop  + (t / tilesX) * kImageFilterTileSize,
+                                             kImageFilterTileSize, kImageFilterTileSize);
+            SkAssertResult(tile.fBounds.intersect(filterClip));
+
+            // A cache of its own still lets a tile share subgraphs within the DAG, but its
+            // intermediates go away with it instead of filling up the global cache.
+            sk_sp<SkImageFilterCache> cache(
+                    SkImageFilterCache::Create(SkImageFilterCache::kDefaultTransientSize));
+            SkImageFilter_Base::Context ctx(filterMatrix, tile.fBounds, cache.get(),
+                                            fBitmap.colorType(), fBitmap.colorSpace(), src);
+            tile.fOffset = SkIPoint::Make(0, 0);
+            tile.fImage = filter->filterImage(ctx).imageAndOffset(&tile.fOffset);
+        });
+
+        for (int i = 0; i < count; ++i) {
+            const Tile& tile = tiles[i];
+            SkBitmap resultBM;
+            if (!tile.fImage || !tile.fImage->getROPixels(&resultBM)) {
+                continue;
+            }
+            // Results may cover more than their tile; clip so no pixel is drawn twice.
+            SkAutoDeviceClipRestore autoClipRestore(this, tile.fBounds.makeOffset(x, y));
+            this->drawSprite(resultBM, x + tile.fOffset.x(), y + tile.fOffset.y(), tilePaint);
+        }
+    }
+}
+
 void SkBitmapDevice::drawSpecial(SkSpecialImage* src, int x, int y, const SkPaint& origPaint,
                                  SkImage* clipImage, const SkMatrix& clipMatrix) {
     SkASSERT(!src->isTextureBacked());
@@ -629,6 +687,14 @@ void SkBitmapDevice::drawSpecial(SkSpecialImage* src, int x, int y, const SkPain
         const SkMatrix matrix = SkMatrix::Concat(
             SkMatrix::MakeTrans(SkIntToScalar(-x), SkIntToScalar(-y)), this->localToDevice());
         const SkIRect clipBounds = fRCStack.rc().getBounds().makeOffset(-x, -y);
+        if (!clipImage && this->surfaceProps().isTiledImageFilters() &&
+            (clipBounds.width() > kImageFilterTileSize ||
+             clipBounds.height() > kImageFilterTileSize) &&
+            as_IFB(paint->getImageFilter())->canBeTiled()) {
+            this->drawSpecialTiled(src, x, y, *paint, matrix, clipBounds);
+            return;
+        }
+
         sk_sp<SkImageFilterCache> cache(this->getImageFilterCache());
         SkImageFilter_Base::Context ctx(matrix, clipBounds, cache.get(), fBitmap.colorType(),
                                         fBitmap.colorSpace(), src);
@@ -144,6 +144,7 @@ private:
     friend class SkDrawIter;
     friend class SkDrawTiler;
     friend class SkSurface_Raster;
+    friend class SkThreadedBMPDevice; // to copy fRCStack.rc() for multi-threaded drawing
 
     class BDDraw;
 
@@ -158,6 +159,11 @@ private:
 
     SkImageFilterCache* getImageFilterCache() override;
 
+    // Filters src with the image filter on paint, which is set, tile by tile, and draws the result
+    // of each tile clipped to it. See SkSurfaceProps::kTiledImageFilters_Flag.
+    void drawSpecialTiled(SkSpecialImage* src, int x, int y, const SkPaint& paint,
+                          const SkMatrix& filterMatrix, const SkIRect& filterClip);
+
     SkBitmap    fBitmap;
     void*       fRasterHandle = nullptr;
     SkRasterClipStack  fRCStack;
@@ -87,8 +87,13 @@ inline bool SkCpu::Supports(uint32_t mask) {
     // FMA doesn't fit neatly into this total ordering.
     // It's available on Haswell+ just like AVX2, but it's technically a different bit.
     // TODO: circle back on this if we find ourselves limited by lack of compile-time FMA
+    #if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SKX
+    features |= SKX;
+    #endif
 
-    #if defined(SK_CPU_LIMIT_AVX)
+    #if defined(SK_CPU_LIMIT_HSW)
+    features &= (SSE1 | SSE2 | SSE3 | SSSE3 | SSE41 | SSE42 | AVX | HSW);
+    #elif defined(SK_CPU_LIMIT_AVX)
     features &= (SSE1 | SSE2 | SSE3 | SSSE3 | SSE41 | SSE42 | AVX);
     #elif defined(SK_CPU_LIMIT_SSE41)
     features &= (SSE1 | SSE2 | SSE3 | SSSE3 | SSE41);
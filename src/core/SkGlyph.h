@@ -292,6 +292,7 @@ private:
     friend class SkScalerContext_DW;
     friend class SkScalerContext_GDI;
     friend class SkScalerContext_Mac;
+    friend class SkStrikeBundle;
     friend class SkStrikeClient;
     friend class SkStrikeServer;
     friend class SkTestScalerContext;
@@ -8,6 +8,8 @@
 #include "include/core/SkGraphics.h"
 
 #include "include/core/SkCanvas.h"
+#include "include/core/SkData.h"
+#include "include/core/SkFontMgr.h"
 #include "include/core/SkMath.h"
 #include "include/core/SkMatrix.h"
 #include "include/core/SkPath.h"
@@ -23,6 +25,7 @@
 #include "src/core/SkOpts.h"
 #include "src/core/SkResourceCache.h"
 #include "src/core/SkScalerContext.h"
+#include "src/core/SkStrikeBundle.h"
 #include "src/core/SkStrikeCache.h"
 #include "src/core/SkTSearch.h"
 #include "src/core/SkTypefaceCache.h"
@@ -132,3 +135,12 @@ void SkGraphics::PurgeFontCache() {
     SkStrikeCache::GlobalStrikeCache()->purgeAll();
     SkTypefaceCache::PurgeAll();
 }
+
+int SkGraphics::PreloadFontCache(const char bundlePath[]) {
+    sk_sp<SkData> bundle = SkData::MakeFromFileName(bundlePath);
+    if (!bundle) {
+        return -1;
+    }
+    return SkStrikeBundle::Load(bundle->data(), bundle->size(),
+                                SkStrikeCache::GlobalStrikeCache(), SkFontMgr::RefDefault().get());
+}
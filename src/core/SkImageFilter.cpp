@@ -8,17 +8,22 @@
 #include "include/core/SkImageFilter.h"
 
 #include "include/core/SkCanvas.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkRect.h"
 #include "include/effects/SkComposeImageFilter.h"
+#include "include/private/SkMutex.h"
 #include "include/private/SkSafe32.h"
+#include "include/private/SkSemaphore.h"
 #include "src/core/SkFuzzLogging.h"
 #include "src/core/SkImageFilterCache.h"
 #include "src/core/SkImageFilter_Base.h"
 #include "src/core/SkLocalMatrixImageFilter.h"
 #include "src/core/SkMatrixImageFilter.h"
+#include "src/core/SkOpts.h"
 #include "src/core/SkReadBuffer.h"
 #include "src/core/SkSpecialImage.h"
 #include "src/core/SkSpecialSurface.h"
+#include "src/core/SkTDynamicHash.h"
 #include "src/core/SkValidationUtils.h"
 #include "src/core/SkWriteBuffer.h"
 #if SK_SUPPORT_GPU
@@ -32,6 +37,7 @@
 #include "src/gpu/GrTextureProxy.h"
 #include "src/gpu/SkGr.h"
 #endif
+#include <algorithm>
 #include <atomic>
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -207,6 +213,87 @@ void SkImageFilter_Base::flatten(SkWriteBuffer& buffer) const {
     buffer.writeUInt(fCropRect.flags());
 }
 
+namespace {
+
+// A raster result that one thread is computing and others may be waiting for. This is what makes
+// a subgraph shared by several concurrently evaluated inputs (see prefilterInputs()) get computed
+// only once: the first thread to miss the cache computes it, and the rest wait for its result.
+//
+// Waiting can't deadlock because a thread only ever waits on a filter below the ones it is
+// computing, and the graph has no cycles. That holds as long as no thread picks up unrelated
+// queued work in the middle of computing a filter, so filters must use ForEachConcurrently()
+// rather than SkTaskGroup::wait() to split up their work.
+struct InFlight : public SkNVRefCnt<InFlight> {
+    InFlight(const SkImageFilterCacheKey& key, const SkImageFilterCache* cache)
+        : fKey(key), fCache(cache) {}
+
+    const SkImageFilterCacheKey      fKey;
+    const SkImageFilterCache* const  fCache;
+    SkSemaphore                      fDone;
+    int                              fWaiters = 0;  // Guarded by in_flight_mutex().
+    skif::FilterResult<For::kOutput> fResult;
+
+    static const SkImageFilterCacheKey& GetKey(const InFlight& inFlight) { return inFlight.fKey; }
+    static uint32_t Hash(const SkImageFilterCacheKey& key) {
+        return SkOpts::hash(&key, sizeof(key));
+    }
+};
+
+// Each entry is owned by the thread computing it, which removes it when done.
+using InFlightMap = SkTDynamicHash<InFlight, SkImageFilterCacheKey>;
+
+SkMutex& in_flight_mutex() {
+    static SkMutex& mutex = *(new SkMutex);
+    return mutex;
+}
+
+InFlightMap& in_flight() {
+    static InFlightMap& map = *(new InFlightMap);
+    return map;
+}
+
+// Returns true with the result if it was in the cache or another thread has just computed it.
+// Otherwise returns false, and if 'claimed' is set the caller must compute the result and pass it
+// to finish_in_flight().
+bool find_or_claim_in_flight(const SkImageFilterCacheKey& key, SkImageFilterCache* cache,
+                             skif::FilterResult<For::kOutput>* result, sk_sp<InFlight>* claimed) {
+    sk_sp<InFlight> other;
+    {
+        SkAutoMutexExclusive lock(in_flight_mutex());
+        if (InFlight* found = in_flight().find(key)) {
+            if (found->fCache != cache) {
+                return false;
+            }
+            other = sk_ref_sp(found);
+            other->fWaiters++;
+        } else if (cache->get(key, result)) {
+            // The result was stored after our first look, but before its claim was released.
+            return true;
+        } else {
+            *claimed = sk_make_sp<InFlight>(key, cache);
+            in_flight().add(claimed->get());
+            return false;
+        }
+    }
+    other->fDone.wait();
+    *result = other->fResult;
+    return true;
+}
+
+void finish_in_flight(const SkImageFilterCacheKey& key, sk_sp<InFlight> claimed,
+                      const skif::FilterResult<For::kOutput>& result) {
+    claimed->fResult = result;
+    int waiters;
+    {
+        SkAutoMutexExclusive lock(in_flight_mutex());
+        in_flight().remove(key);
+        waiters = claimed->fWaiters;
+    }
+    claimed->fDone.signal(waiters);
+}
+
+}  // namespace
+
 skif::FilterResult<For::kOutput> SkImageFilter_Base::filterImage(const skif::Context& context) const {
     // TODO (michaelludwig) - Old filters have an implicit assumption that the source image
     // (originally passed separately) has an origin of (0, 0). SkComposeImageFilter makes an effort
@@ -229,6 +316,12 @@ skif::FilterResult<For::kOutput> SkImageFilter_Base::filterImage(const skif::Con
         return result;
     }
 
+    sk_sp<InFlight> claimed;
+    if (context.cache() && !context.gpuBacked() &&
+        find_or_claim_in_flight(key, context.cache(), &result, &claimed)) {
+        return result;
+    }
+
     result = this->onFilterImage(context);
 
 #if SK_SUPPORT_GPU
@@ -243,6 +336,9 @@ skif::FilterResult<For::kOutput> SkImageFilter_Base::filterImage(const skif::Con
     if (context.cache()) {
         context.cache()->set(key, this, result);
     }
+    if (claimed) {
+        finish_in_flight(key, std::move(claimed), result);
+    }
 
     return result;
 }
@@ -315,6 +411,20 @@ bool SkImageFilter_Base::canHandleComplexCTM() const {
     return true;
 }
 
+bool SkImageFilter_Base::canBeTiled() const {
+    if (!this->onCanBeTiled()) {
+        return false;
+    }
+    const int count = this->countInputs();
+    for (int i = 0; i < count; ++i) {
+        const SkImageFilter_Base* input = as_IFB(this->getInput(i));
+        if (input && !input->canBeTiled()) {
+            return false;
+        }
+    }
+    return true;
+}
+
 void SkImageFilter::CropRect::applyTo(const SkIRect& imageBounds, const SkMatrix& ctm,
                                       bool embiggen, SkIRect* cropped) const {
     *cropped = imageBounds;
@@ -555,6 +665,60 @@ template skif::FilterResult<For::kInput> SkImageFilter_Base::filterInput(int, co
 template skif::FilterResult<For::kInput0> SkImageFilter_Base::filterInput(int, const skif::Context&) const;
 template skif::FilterResult<For::kInput1> SkImageFilter_Base::filterInput(int, const skif::Context&) const;
 
+void SkImageFilter_Base::prefilterInputs(const skif::Context& ctx) const {
+    // The cache is how the results get back to getInputFilteredImage(). GPU-backed filters all
+    // record into the same context, so there is nothing to gain from splitting them up.
+    if (!ctx.cache() || ctx.gpuBacked() || !ctx.isValid()) {
+        return;
+    }
+
+    // The same filter may be used for several inputs; it only needs to be computed once.
+    SkSTArray<4, const SkImageFilter_Base*> inputs;
+    for (int i = 0; i < this->countInputs(); ++i) {
+        const SkImageFilter_Base* input = as_IFB(this->getInput(i));
+        if (input && std::find(inputs.begin(), inputs.end(), input) == inputs.end()) {
+            inputs.push_back(input);
+        }
+    }
+    if (inputs.count() < 2) {
+        return;
+    }
+
+    const skif::Context inputCtx = this->mapContext(ctx);
+    ForEachConcurrently(inputs.count(), [&](int i) {
+        (void)inputs[i]->filterImage(inputCtx);
+    });
+}
+
+void SkImageFilter_Base::ForEachConcurrently(int count, std::function<void(int)> fn) {
+    // Tasks claim indices until none are left. The tasks can outlive this call if this thread
+    // claims everything first, so what they share is ref counted.
+    struct Claims : public SkNVRefCnt<Claims> {
+        explicit Claims(int count) : fCount(count) {}
+
+        const int        fCount;
+        std::atomic<int> fNext{0};
+        SkSemaphore      fDone;
+    };
+    auto claims = sk_make_sp<Claims>(count);
+    auto run = [claims, &fn] {
+        for (int i = claims->fNext++; i < claims->fCount; i = claims->fNext++) {
+            fn(i);
+            claims->fDone.signal();
+        }
+    };
+
+    SkExecutor& executor = SkExecutor::GetDefault();
+    for (int i = 1; i < count; ++i) {
+        executor.add(run);
+    }
+    run();
+    // Everything left has been claimed by a running task, so this only waits on work in progress.
+    for (int i = 0; i < count; ++i) {
+        claims->fDone.wait();
+    }
+}
+
 SkImageFilter_Base::Context SkImageFilter_Base::mapContext(const Context& ctx) const {
     // We don't recurse through the child input filters because that happens automatically
     // as part of the filterImage() evaluation. In this case, we want the bounds for the
@@ -15,6 +15,8 @@
 
 #include "src/core/SkImageFilterTypes.h"
 
+#include <functional>
+
 class GrFragmentProcessor;
 class GrRecordingContext;
 
@@ -129,6 +131,13 @@ public:
      */
     bool canHandleComplexCTM() const;
 
+    /**
+     *  Returns true iff the filter and all of its (non-null) inputs produce each output pixel
+     *  only from the input that onFilterNodeBounds() maps it to, so that the DAG can be evaluated
+     *  one tile of output at a time with the same results.
+     */
+    bool canBeTiled() const;
+
     /**
      * Return an image filter representing this filter applied with the given ctm. This will modify
      * the DAG as needed if this filter does not support complex CTMs and 'ctm' is not simple. The
@@ -149,6 +158,14 @@ public:
 
     uint32_t uniqueID() const { return fUniqueID; }
 
+    /**
+     *  Calls fn(0) through fn(count - 1) on the default SkExecutor, with this thread doing its
+     *  share, and returns when they are all done. Unlike SkTaskGroup::wait(), this never picks up
+     *  unrelated queued work while it waits, which filterImage() relies on to wait for results
+     *  another thread is computing. Filters should use this to split up their own work.
+     */
+    static void ForEachConcurrently(int count, std::function<void(int)> fn);
+
 protected:
     class Common {
     public:
@@ -235,6 +252,14 @@ protected:
         return this->filterInput<For::kInput1>(1, context);
     }
 
+    // Helper for filters that evaluate all of their inputs with the same 'context' and that could
+    // compute them in any order. On the raster backend with a cache, this evaluates the distinct
+    // inputs concurrently on the default SkExecutor and leaves the results in the cache, so the
+    // getInputFilteredImage() calls that follow only look them up. Otherwise it does nothing.
+    // A filter shared deeper in the inputs' subgraphs is computed once; the other inputs that need
+    // it wait for that result.
+    void prefilterInputs(const skif::Context& context) const;
+
     // DEPRECATED - Remove once cropping is handled by a separate filter
     const CropRect* getCropRectIfSet() const {
         return this->cropRectIsSet() ? &fCropRect : nullptr;
@@ -334,6 +359,13 @@ private:
      */
     virtual bool onCanHandleComplexCTM() const { return false; }
 
+    /**
+     *  Return false if the output of this filter depends on where the clip of its context is, and
+     *  not just on the input within onFilterNodeBounds(), e.g. because it wraps around the bounds
+     *  of its input.
+     */
+    virtual bool onCanBeTiled() const { return true; }
+
     /**
      *  Return true if this filter would transform transparent black pixels to a color other than
      *  transparent black. When false, optimizations can be taken to discard regions known to be
@@ -14,10 +14,15 @@
 #include "include/private/SkTo.h"
 #include "src/core/SkArenaAlloc.h"
 #include "src/core/SkGaussFilter.h"
+#include "src/core/SkTaskGroup.h"
 
+#include <algorithm>
 #include <cmath>
 #include <climits>
 
+// Hack for testing: blur one line at a time on the calling thread.
+thread_local bool gSkSerialMaskBlur{false};
+
 namespace {
 static const double kPi = 3.14159265358979323846264338327950288;
 
@@ -89,13 +94,20 @@ public:
 
     int    border()     const { return fBorder; }
 
+    // The vectorized scan computes the final scale in 32-bit lanes, so it can't represent a weight
+    // of exactly 1.0, which is what a window of one produces.
+    bool canScan4() const { return fWeight < (static_cast<uint64_t>(1) << 32); }
+
 public:
-    class Scan {
+    // Sum is uint32_t to blur one line at a time, or Sk4u to blur four lines in lockstep. In the
+    // latter case the buffers hold four interleaved lanes and each destination pixel written is
+    // four adjacent bytes.
+    template <typename Sum> class Scan {
     public:
         Scan(uint64_t weight, int noChangeCount,
-             uint32_t* buffer0, uint32_t* buffer0End,
-             uint32_t* buffer1, uint32_t* buffer1End,
-             uint32_t* buffer2, uint32_t* buffer2End)
+             Sum* buffer0, Sum* buffer0End,
+             Sum* buffer1, Sum* buffer1End,
+             Sum* buffer2, Sum* buffer2End)
             : fWeight{weight}
             , fNoChangeCount{noChangeCount}
             , fBuffer0{buffer0}
@@ -112,20 +124,20 @@ public:
             auto buffer1Cursor = fBuffer1;
             auto buffer2Cursor = fBuffer2;
 
-            std::memset(fBuffer0, 0x00, (fBuffer2End - fBuffer0) * sizeof(*fBuffer0));
+            std::fill(fBuffer0, fBuffer2End, Sum(0));
 
-            uint32_t sum0 = 0;
-            uint32_t sum1 = 0;
-            uint32_t sum2 = 0;
+            Sum sum0 = 0;
+            Sum sum1 = 0;
+            Sum sum2 = 0;
 
             // Consume the source generating pixels.
             for (AlphaIter src = srcBegin; src < srcEnd; ++src, dst += dstStride) {
-                uint32_t leadingEdge = *src;
+                Sum leadingEdge = *src;
                 sum0 += leadingEdge;
                 sum1 += sum0;
                 sum2 += sum1;
 
-                *dst = this->finalScale(sum2);
+                this->finalScale(sum2, dst);
 
                 sum2 -= *buffer2Cursor;
                 *buffer2Cursor = sum1;
@@ -142,12 +154,12 @@ public:
 
             // The leading edge is off the right side of the mask.
             for (int i = 0; i < fNoChangeCount; i++) {
-                uint32_t leadingEdge = 0;
+                Sum leadingEdge = 0;
                 sum0 += leadingEdge;
                 sum1 += sum0;
                 sum2 += sum1;
 
-                *dst = this->finalScale(sum2);
+                this->finalScale(sum2, dst);
 
                 sum2 -= *buffer2Cursor;
                 *buffer2Cursor = sum1;
@@ -165,7 +177,7 @@ public:
             }
 
             // Starting from the right, fill in the rest of the buffer.
-            std::memset(fBuffer0, 0, (fBuffer2End - fBuffer0) * sizeof(*fBuffer0));
+            std::fill(fBuffer0, fBuffer2End, Sum(0));
 
             sum0 = sum1 = sum2 = 0;
 
@@ -173,12 +185,12 @@ public:
             AlphaIter src = srcEnd;
             while (dstCursor > dst) {
                 dstCursor -= dstStride;
-                uint32_t leadingEdge = *(--src);
+                Sum leadingEdge = *(--src);
                 sum0 += leadingEdge;
                 sum1 += sum0;
                 sum2 += sum1;
 
-                *dstCursor = this->finalScale(sum2);
+                this->finalScale(sum2, dstCursor);
 
                 sum2 -= *buffer2Cursor;
                 *buffer2Cursor = sum1;
@@ -197,35 +209,44 @@ public:
     private:
         static constexpr uint64_t kHalf = static_cast<uint64_t>(1) << 31;
 
-        uint8_t finalScale(uint32_t sum) const {
-            return SkTo<uint8_t>((fWeight * sum + kHalf) >> 32);
+        void finalScale(uint32_t sum, uint8_t* dst) const {
+            *dst = SkTo<uint8_t>((fWeight * sum + kHalf) >> 32);
+        }
+
+        // The same rounding as above: the high half of the 64-bit product, plus one if the low
+        // half is at least kHalf.
+        void finalScale(const Sk4u& sum, uint8_t* dst) const {
+            SkASSERT(fWeight < (static_cast<uint64_t>(1) << 32));
+            Sk4u weight = static_cast<uint32_t>(fWeight);
+            SkNx_cast<uint8_t>(sum.mulHi(weight) + ((sum * weight) >> 31)).store(dst);
         }
 
-        uint64_t  fWeight;
-        int       fNoChangeCount;
-        uint32_t* fBuffer0;
-        uint32_t* fBuffer0End;
-        uint32_t* fBuffer1;
-        uint32_t* fBuffer1End;
-        uint32_t* fBuffer2;
-        uint32_t* fBuffer2End;
+        uint64_t fWeight;
+        int      fNoChangeCount;
+        Sum*     fBuffer0;
+        Sum*     fBuffer0End;
+        Sum*     fBuffer1;
+        Sum*     fBuffer1End;
+        Sum*     fBuffer2;
+        Sum*     fBuffer2End;
     };
 
-    Scan makeBlurScan(int width, uint32_t* buffer) const {
-        uint32_t* buffer0, *buffer0End, *buffer1, *buffer1End, *buffer2, *buffer2End;
+    template <typename Sum> Scan<Sum> makeBlurScan(int width, Sum* buffer) const {
+        Sum* buffer0, *buffer0End, *buffer1, *buffer1End, *buffer2, *buffer2End;
         buffer0 = buffer;
         buffer0End = buffer1 = buffer0 + fPass0Size;
         buffer1End = buffer2 = buffer1 + fPass1Size;
         buffer2End = buffer2 + fPass2Size;
         int noChangeCount = fSlidingWindow > width ? fSlidingWindow - width : 0;
 
-        return Scan(
+        return Scan<Sum>(
             fWeight, noChangeCount,
             buffer0, buffer0End,
             buffer1, buffer1End,
             buffer2, buffer2End);
     }
 
+private:
     uint64_t fWeight;
     int      fBorder;
     int      fSlidingWindow;
@@ -234,6 +255,82 @@ public:
     int      fPass2Size;
 };
 
+// Walks four lines of a mask in lockstep, reading one Sk4u of alpha per step.
+template <typename AlphaIter> class AlphaIter4 {
+public:
+    AlphaIter4(AlphaIter iter, uint32_t lineBytes) : fIters{iter, iter, iter, iter} {
+        for (int k = 1; k < 4; k++) {
+            fIters[k] >>= k * lineBytes;
+        }
+    }
+    AlphaIter4& operator++() {
+        for (AlphaIter& iter : fIters) { ++iter; }
+        return *this;
+    }
+    AlphaIter4& operator--() {
+        for (AlphaIter& iter : fIters) { --iter; }
+        return *this;
+    }
+    Sk4u operator*() const { return {*fIters[0], *fIters[1], *fIters[2], *fIters[3]}; }
+    bool operator<(const AlphaIter4& that) const { return fIters[0] < that.fIters[0]; }
+
+private:
+    AlphaIter fIters[4];
+};
+
+// Splitting the passes across threads only pays off for large masks.
+static constexpr int kMinPixelsPerTask = 1 << 16;
+static constexpr int kMaxTasks = 32;
+
+// Blurs lineCount lines of srcW pixels; the first spans [srcBegin, srcEnd) and each following one
+// starts lineBytes after the last.
+// Line y is written to dst + y, dstLength pixels of dstStride bytes apart; so the output is
+// transposed, and four adjacent lines land in four adjacent bytes, which lets them go through
+// the vector scan together.
+template <typename AlphaIter>
+static void blur_lines(const PlanGauss& plan, int srcW,
+                       AlphaIter srcBegin, AlphaIter srcEnd, uint32_t lineBytes, int lineCount,
+                       uint8_t* dst, int dstStride, int dstLength) {
+    const int groupSize = plan.canScan4() && !gSkSerialMaskBlur ? 4 : 1;
+    const int groupCount = (lineCount + groupSize - 1) / groupSize;
+
+    int64_t pixels = (int64_t)lineCount * dstLength;
+    int taskCount = (int)std::min<int64_t>(pixels / kMinPixelsPerTask, kMaxTasks);
+    taskCount = gSkSerialMaskBlur ? 1 : SkTPin(taskCount, 1, std::max(groupCount, 1));
+
+    auto blurGroups = [&](int task) {
+        int lineStart = groupSize * (groupCount *  task      / taskCount),
+            lineEnd   = std::min(groupSize * (groupCount * (task + 1) / taskCount), lineCount);
+
+        AlphaIter begin = srcBegin,
+                  end   = srcEnd;
+        begin >>= lineStart * lineBytes;
+        end   >>= lineStart * lineBytes;
+        int y = lineStart;
+        if (groupSize == 4) {
+            SkAutoTMalloc<Sk4u> buffer(plan.bufferSize());
+            auto scan = plan.makeBlurScan(srcW, buffer.get());
+            for (; y + 4 <= lineEnd; y += 4, begin >>= 4 * lineBytes, end >>= 4 * lineBytes) {
+                scan.blur(AlphaIter4<AlphaIter>(begin, lineBytes),
+                          AlphaIter4<AlphaIter>(end, lineBytes),
+                          dst + y, dstStride, dst + y + (int64_t)dstStride * dstLength);
+            }
+        }
+        // A window of one has no buffers, but the scan still touches the first entry.
+        SkAutoTMalloc<uint32_t> buffer(std::max<size_t>(plan.bufferSize(), 1));
+        auto scan = plan.makeBlurScan(srcW, buffer.get());
+        for (; y < lineEnd; y++, begin >>= lineBytes, end >>= lineBytes) {
+            scan.blur(begin, end, dst + y, dstStride, dst + y + (int64_t)dstStride * dstLength);
+        }
+    };
+
+    if (taskCount == 1) {
+        blurGroups(0);
+    } else {
+        SkTaskGroup().batch(taskCount, blurGroups);
+    }
+}
+
 } // namespace
 
 // NB 135 is the largest sigma that will not cause a buffer full of 255 mask values to overflow
@@ -984,9 +1081,6 @@ SkIPoint SkMaskBlurFilter::blur(const SkMask& src, SkMask* dst) const {
         dstH = dst->fBounds.height();
     SkASSERT(srcW >= 0 && srcH >= 0 && dstW >= 0 && dstH >= 0);
 
-    auto bufferSize = std::max(planW.bufferSize(), planH.bufferSize());
-    auto buffer = alloc.makeArrayDefault<uint32_t>(bufferSize);
-
     // Blur both directions.
     int tmpW = srcH,
         tmpH = dstW;
@@ -994,43 +1088,30 @@ SkIPoint SkMaskBlurFilter::blur(const SkMask& src, SkMask* dst) const {
     auto tmp = alloc.makeArrayDefault<uint8_t>(tmpW * tmpH);
 
     // Blur horizontally, and transpose.
-    const PlanGauss::Scan& scanW = planW.makeBlurScan(srcW, buffer);
     switch (src.fFormat) {
         case SkMask::kBW_Format: {
             const uint8_t* bwStart = src.fImage;
             auto start = SkMask::AlphaIter<SkMask::kBW_Format>(bwStart, 0);
             auto end = SkMask::AlphaIter<SkMask::kBW_Format>(bwStart + (srcW / 8), srcW % 8);
-            for (int y = 0; y < srcH; ++y, start >>= src.fRowBytes, end >>= src.fRowBytes) {
-                auto tmpStart = &tmp[y];
-                scanW.blur(start, end, tmpStart, tmpW, tmpStart + tmpW * tmpH);
-            }
+            blur_lines(planW, srcW, start, end, src.fRowBytes, srcH, tmp, tmpW, tmpH);
         } break;
         case SkMask::kA8_Format: {
             const uint8_t* a8Start = src.fImage;
             auto start = SkMask::AlphaIter<SkMask::kA8_Format>(a8Start);
             auto end = SkMask::AlphaIter<SkMask::kA8_Format>(a8Start + srcW);
-            for (int y = 0; y < srcH; ++y, start >>= src.fRowBytes, end >>= src.fRowBytes) {
-                auto tmpStart = &tmp[y];
-                scanW.blur(start, end, tmpStart, tmpW, tmpStart + tmpW * tmpH);
-            }
+            blur_lines(planW, srcW, start, end, src.fRowBytes, srcH, tmp, tmpW, tmpH);
         } break;
         case SkMask::kARGB32_Format: {
             const uint32_t* argbStart = reinterpret_cast<const uint32_t*>(src.fImage);
             auto start = SkMask::AlphaIter<SkMask::kARGB32_Format>(argbStart);
             auto end = SkMask::AlphaIter<SkMask::kARGB32_Format>(argbStart + srcW);
-            for (int y = 0; y < srcH; ++y, start >>= src.fRowBytes, end >>= src.fRowBytes) {
-                auto tmpStart = &tmp[y];
-                scanW.blur(start, end, tmpStart, tmpW, tmpStart + tmpW * tmpH);
-            }
+            blur_lines(planW, srcW, start, end, src.fRowBytes, srcH, tmp, tmpW, tmpH);
         } break;
         case SkMask::kLCD16_Format: {
             const uint16_t* lcdStart = reinterpret_cast<const uint16_t*>(src.fImage);
             auto start = SkMask::AlphaIter<SkMask::kLCD16_Format>(lcdStart);
             auto end = SkMask::AlphaIter<SkMask::kLCD16_Format>(lcdStart + srcW);
-            for (int y = 0; y < srcH; ++y, start >>= src.fRowBytes, end >>= src.fRowBytes) {
-                auto tmpStart = &tmp[y];
-                scanW.blur(start, end, tmpStart, tmpW, tmpStart + tmpW * tmpH);
-            }
+            blur_lines(planW, srcW, start, end, src.fRowBytes, srcH, tmp, tmpW, tmpH);
         } break;
         default:
             SK_ABORT("Unhandled format.");
@@ -1038,14 +1119,9 @@ SkIPoint SkMaskBlurFilter::blur(const SkMask& src, SkMask* dst) const {
 
     // Blur vertically (scan in memory order because of the transposition),
     // and transpose back to the original orientation.
-    const PlanGauss::Scan& scanH = planH.makeBlurScan(tmpW, buffer);
-    for (int y = 0; y < tmpH; y++) {
-        auto tmpStart = &tmp[y * tmpW];
-        auto dstStart = &dst->fImage[y];
-
-        scanH.blur(tmpStart, tmpStart + tmpW,
-                   dstStart, dst->fRowBytes, dstStart + dst->fRowBytes * dstH);
-    }
+    blur_lines(planH, tmpW, SkMask::AlphaIter<SkMask::kA8_Format>(tmp),
+               SkMask::AlphaIter<SkMask::kA8_Format>(tmp + tmpW), tmpW, tmpH,
+               dst->fImage, dst->fRowBytes, dstH);
 
     return {SkTo<int32_t>(borderW), SkTo<int32_t>(borderH)};
 }
@@ -0,0 +1,97 @@
+/*
+ * Copyright 2020 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "src/core/SkParallelPlayback.h"
+
+#include "include/core/SkCanvas.h"
+#include "include/core/SkExecutor.h"
+#include "include/core/SkPicture.h"
+#include "include/core/SkPixmap.h"
+#include "src/core/SkBigPicture.h"
+#include "src/core/SkPicturePriv.h"
+#include "src/core/SkRecordDraw.h"
+#include "src/core/SkTaskGroup.h"
+
+#include <algorithm>
+#include <vector>
+
+void SkParallelPlayback(const SkPicture* picture, const SkPixmap& dst, const SkMatrix& matrix,
+                        SkISize tileSize, SkExecutor* executor, const SkSurfaceProps* props) {
+    SkASSERT(picture);
+    SkMatrix inverse;
+    if (dst.bounds().isEmpty() || tileSize.isEmpty() || !matrix.invert(&inverse)) {
+        return;  // Nothing would draw.
+    }
+
+    const SkBigPicture* big = SkPicturePriv::AsSkBigPicture(sk_ref_sp(picture));
+    const SkBBoxHierarchy* bbh = big ? big->bbh() : nullptr;
+
+    struct Tile {
+        SkIRect          bounds;
+        std::vector<int> ops;   // Only used when we have a bbh.
+    };
+    std::vector<Tile> tiles;
+    for (int y = 0; y < dst.height(); y += tileSize.height()) {
+        for (int x = 0; x < dst.width(); x += tileSize.width()) {
+            Tile tile;
+            tile.bounds = SkIRect::MakeXYWH(x, y, tileSize.width(), tileSize.height());
+            SkAssertResult(tile.bounds.intersect(dst.bounds()));
+            tiles.push_back(std::move(tile));
+        }
+    }
+
+    if (bbh) {
+        // These are the queries SkRecordDraw would make for each tile's canvas:
+        // getLocalClipBounds() outsets the device clip by a pixel for antialiasing,
+        // then maps it back into the picture's space.  We search for all tiles at once.
+        std::vector<SkRect>           queries(tiles.size());
+        std::vector<std::vector<int>> ops    (tiles.size());
+        for (size_t i = 0; i < tiles.size(); i++) {
+            queries[i] = inverse.mapRect(SkRect::Make(tiles[i].bounds.makeOutset(1, 1)));
+        }
+        bbh->search(queries.data(), (int)queries.size(), ops.data());
+
+        // Skip tiles no op touches.
+        size_t live = 0;
+        for (size_t i = 0; i < tiles.size(); i++) {
+            if (!ops[i].empty()) {
+                tiles[live].bounds = tiles[i].bounds;
+                tiles[live].ops    = std::move(ops[i]);
+                live++;
+            }
+        }
+        tiles.resize(live);
+
+        // Tiles with the most ops tend to take the longest, so start those first.
+        std::stable_sort(tiles.begin(), tiles.end(), [](const Tile& a, const Tile& b) {
+            return a.ops.size() > b.ops.size();
+        });
+    }
+
+    SkTaskGroup tg(executor ? *executor : SkExecutor::GetDefault());
+    for (const Tile& tile : tiles) {
+        tg.add([&, t = &tile] {
+            SkPixmap subset;
+            SkAssertResult(dst.extractSubset(&subset, t->bounds));
+
+            std::unique_ptr<SkCanvas> canvas = SkCanvas::MakeRasterDirect(
+                    subset.info(), subset.writable_addr(), subset.rowBytes(), props);
+            if (!canvas) {
+                return;
+            }
+            canvas->translate(-t->bounds.x(), -t->bounds.y());
+            canvas->concat(matrix);
+
+            if (bbh) {
+                big->playbackOps(canvas.get(), t->ops);
+            } else {
+                picture->playback(canvas.get());
+            }
+        });
+    }
+    tg.wait();
+}
@@ -0,0 +1,36 @@
+/*
+ * Copyright 2020 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkParallelPlayback_DEFINED
+#define SkParallelPlayback_DEFINED
+
+#include "include/core/SkMatrix.h"
+#include "include/core/SkSize.h"
+
+class SkExecutor;
+class SkPicture;
+class SkPixmap;
+class SkSurfaceProps;
+
+/**
+ *  Plays picture back into dst as if by drawPicture(picture, &matrix) on a canvas over dst, but
+ *  split into tiles of tileSize that are played back concurrently on executor.
+ *
+ *  Each tile gets its own raster canvas over its subset of dst's pixels, so tiles never share
+ *  pixels, and all of them share the picture's immutable SkRecord without copying it.  When the
+ *  picture has a bounding box hierarchy (e.g. from SkRTreeFactory), we search it once per tile
+ *  up front, skip tiles no op touches, start the busiest tiles first, and replay only each tile's
+ *  ops.  Otherwise every tile plays back the whole picture, clipped to the tile.
+ *
+ *  Returns once every tile has been drawn.  When executor is nullptr we use
+ *  SkExecutor::GetDefault(), which runs everything on the calling thread unless one was set.
+ */
+void SkParallelPlayback(const SkPicture* picture, const SkPixmap& dst, const SkMatrix& matrix,
+                        SkISize tileSize, SkExecutor* executor = nullptr,
+                        const SkSurfaceProps* props = nullptr);
+
+#endif//SkParallelPlayback_DEFINED
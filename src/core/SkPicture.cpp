@@ -11,6 +11,7 @@
 #include "include/core/SkPictureRecorder.h"
 #include "include/core/SkSerialProcs.h"
 #include "include/private/SkTo.h"
+#include "src/core/SkBigPicture.h"
 #include "src/core/SkMathPriv.h"
 #include "src/core/SkPictureCommon.h"
 #include "src/core/SkPictureData.h"
@@ -119,7 +120,8 @@ bool SkPicture::BufferIsSKP(SkReadBuffer* buffer, SkPictInfo* pInfo) {
 
 sk_sp<SkPicture> SkPicture::Forwardport(const SkPictInfo& info,
                                         const SkPictureData* data,
-                                        SkReadBuffer* buffer) {
+                                        SkReadBuffer* buffer,
+                                        const SkRect* region) {
     if (!data) {
         return nullptr;
     }
@@ -128,7 +130,15 @@ sk_sp<SkPicture> SkPicture::Forwardport(const SkPictInfo& info,
     }
     SkPicturePlayback playback(data);
     SkPictureRecorder r;
-    playback.draw(r.beginRecording(info.fCullRect), nullptr/*no callback*/, buffer);
+    if (region) {
+        SkRect cull = info.fCullRect;
+        if (!cull.intersect(*region)) {
+            cull.setEmpty();
+        }
+        playback.drawQuery(r.beginRecording(cull), cull, buffer);
+    } else {
+        playback.draw(r.beginRecording(info.fCullRect), nullptr/*no callback*/, buffer);
+    }
     return r.finishRecordingAsPicture();
 }
 
@@ -149,12 +159,23 @@ sk_sp<SkPicture> SkPicture::MakeFromData(const SkData* data, const SkDeserialPro
     if (!data) {
         return nullptr;
     }
-    SkMemoryStream stream(data->data(), data->size());
-    return MakeFromStream(&stream, procs, nullptr);
+    SkMemoryStream stream(sk_ref_sp(data));
+    return MakeFromStream(&stream, procs, nullptr, data);
+}
+
+sk_sp<SkPicture> SkPicture::MakeFromData(const SkData* data, const SkRect& region,
+                                         const SkDeserialProcs* procs) {
+    if (!data) {
+        return nullptr;
+    }
+    SkMemoryStream stream(sk_ref_sp(data));
+    return MakeFromStream(&stream, procs, nullptr, data, &region);
 }
 
 sk_sp<SkPicture> SkPicture::MakeFromStream(SkStream* stream, const SkDeserialProcs* procsPtr,
-                                           SkTypefacePlayback* typefaces) {
+                                           SkTypefacePlayback* typefaces,
+                                           const SkData* backing,
+                                           const SkRect* region) {
     SkPictInfo info;
     if (!StreamIsSKP(stream, &info)) {
         return nullptr;
@@ -170,8 +191,8 @@ sk_sp<SkPicture> SkPicture::MakeFromStream(SkStream* stream, const SkDeserialPro
     switch (trailingStreamByteAfterPictInfo) {
         case kPictureData_TrailingStreamByteAfterPictInfo: {
             std::unique_ptr<SkPictureData> data(
-                    SkPictureData::CreateFromStream(stream, info, procs, typefaces));
-            return Forwardport(info, data.get(), nullptr);
+                    SkPictureData::CreateFromStream(stream, info, procs, typefaces, backing));
+            return Forwardport(info, data.get(), nullptr, region);
         }
         case kCustom_TrailingStreamByteAfterPictInfo: {
             int32_t ssize;
@@ -217,10 +238,18 @@ sk_sp<SkPicture> SkPicturePriv::MakeFromBuffer(SkReadBuffer& buffer) {
 SkPictureData* SkPicture::backport() const {
     SkPictInfo info = this->createHeader();
     SkPictureRecord rec(info.fCullRect.roundOut(), 0/*flags*/);
+    SkTArray<SkPictureOpIndexEntry> opIndex;
     rec.beginRecording();
-        this->playback(&rec);
+        // Pictures recorded with a BBH are meant to be drawn a region at a time,
+        // so we index their ops to let MakeFromData() load just a region, too.
+        const SkBigPicture* big = this->asSkBigPicture();
+        if (big && big->bbh()) {
+            big->playbackWithIndex(&rec, &opIndex);
+        } else {
+            this->playback(&rec);
+        }
     rec.endRecording();
-    return new SkPictureData(rec, info);
+    return new SkPictureData(rec, info, std::move(opIndex));
 }
 
 void SkPicture::serialize(SkWStream* stream, const SkSerialProcs* procs) const {
@@ -10,10 +10,10 @@
 #include "include/core/SkImageGenerator.h"
 #include "include/core/SkTypeface.h"
 #include "include/private/SkTo.h"
-#include "src/core/SkAutoMalloc.h"
 #include "src/core/SkPicturePriv.h"
 #include "src/core/SkPictureRecord.h"
 #include "src/core/SkReadBuffer.h"
+#include "src/core/SkSafeMath.h"
 #include "src/core/SkTextBlobPriv.h"
 #include "src/core/SkWriteBuffer.h"
 
@@ -38,8 +38,10 @@ void SkPictureData::initForPlayback() const {
 }
 
 SkPictureData::SkPictureData(const SkPictureRecord& record,
-                             const SkPictInfo& info)
-    : fPictures(record.getPictures())
+                             const SkPictInfo& info,
+                             SkTArray<SkPictureOpIndexEntry> opIndex)
+    : fOpIndex(std::move(opIndex))
+    , fPictures(record.getPictures())
     , fDrawables(record.getDrawables())
     , fTextBlobs(record.getTextBlobs())
     , fVertices(record.getVertices())
@@ -187,6 +189,35 @@ void SkPictureData::flattenToBuffer(SkWriteBuffer& buffer, bool textBlobsOnly) c
     }
 }
 
+// Pads stream so the payload written next starts at a multiple of 4 bytes into the stream,
+// letting loaders reading the stream from memory use the payload in place.
+// This is a count byte followed by that many zeros.
+static void write_payload_padding(SkWStream* stream) {
+    const size_t pad = (4 - (stream->bytesWritten() + 1) % 4) % 4;
+    stream->write8(SkToU8(pad));
+    stream->write("\0\0\0", pad);
+}
+
+static bool skip_payload_padding(SkStream* stream) {
+    uint8_t pad;
+    return stream->readU8(&pad) && pad < 4 && stream->skip(pad) == pad;
+}
+
+// Returns the next size bytes of stream as a subset of backing, or nullptr if we can't share them.
+// We only share 4-byte aligned payloads, as SkReadBuffer requires.
+static sk_sp<SkData> share_payload(SkStream* stream, size_t size, const SkData* backing) {
+    if (!backing) {
+        return nullptr;
+    }
+    const size_t offset = stream->getPosition();
+    if (offset > backing->size() || size > backing->size() - offset ||
+        !SkIsAlign4((uintptr_t)backing->bytes() + offset) ||
+        stream->skip(size) != size) {
+        return nullptr;
+    }
+    return SkData::MakeSubset(backing, offset, size);
+}
+
 // SkPictureData::serialize() will write out paints, and then write out an array of typefaces
 // (unique set). However, paint's serializer will respect SerialProcs, which can cause us to
 // call that custom typefaceproc on *every* typeface, not just on the unique ones. To avoid this,
@@ -208,8 +239,14 @@ void SkPictureData::serialize(SkWStream* stream, const SkSerialProcs& procs,
                               SkRefCntSet* topLevelTypeFaceSet, bool textBlobsOnly) const {
     // This can happen at pretty much any time, so might as well do it first.
     write_tag_size(stream, SK_PICT_READER_TAG, fOpData->size());
+    write_payload_padding(stream);
     stream->write(fOpData->bytes(), fOpData->size());
 
+    if (!fOpIndex.empty()) {
+        write_tag_size(stream, SK_PICT_OP_INDEX_TAG, fOpIndex.count());
+        stream->write(fOpIndex.begin(), fOpIndex.count() * sizeof(SkPictureOpIndexEntry));
+    }
+
     // We serialize all typefaces into the typeface section of the top-level picture.
     SkRefCntSet localTypefaceSet;
     SkRefCntSet* typefaceSet = topLevelTypeFaceSet ? topLevelTypeFaceSet : &localTypefaceSet;
@@ -246,6 +283,7 @@ void SkPictureData::serialize(SkWStream* stream, const SkSerialProcs& procs,
 
     // Write the buffer.
     write_tag_size(stream, SK_PICT_BUFFER_SIZE_TAG, buffer.bytesWritten());
+    write_payload_padding(stream);
     buffer.writeToStream(stream);
 
     // Write sub-pictures by calling serialize again.
@@ -288,15 +326,38 @@ bool SkPictureData::parseStreamTag(SkStream* stream,
                                    uint32_t tag,
                                    uint32_t size,
                                    const SkDeserialProcs& procs,
-                                   SkTypefacePlayback* topLevelTFPlayback) {
+                                   SkTypefacePlayback* topLevelTFPlayback,
+                                   const SkData* backing) {
+    const bool padded = fInfo.getVersion() >= SkPicturePriv::kAlignedPayloads_Version;
     switch (tag) {
         case SK_PICT_READER_TAG:
             SkASSERT(nullptr == fOpData);
-            fOpData = SkData::MakeFromStream(stream, size);
+            if (padded && !skip_payload_padding(stream)) {
+                return false;
+            }
+            fOpData = share_payload(stream, size, backing);
+            if (!fOpData) {
+                fOpData = SkData::MakeFromStream(stream, size);
+            }
             if (!fOpData) {
                 return false;
             }
             break;
+        case SK_PICT_OP_INDEX_TAG: {
+            SkASSERT(fOpIndex.empty());
+            SkSafeMath safe;
+            const size_t bytes = safe.mul(size, sizeof(SkPictureOpIndexEntry));
+            // Make sure a corrupt count can't make us allocate more than the stream holds.
+            if (!safe || !SkTFitsIn<int>(size) ||
+                (stream->hasLength() && stream->hasPosition() &&
+                 stream->getLength() - stream->getPosition() < bytes)) {
+                return false;
+            }
+            fOpIndex.reset(SkToInt(size));
+            if (stream->read(fOpIndex.begin(), bytes) != bytes) {
+                return false;
+            }
+        } break;
         case SK_PICT_FACTORY_TAG: {
             if (!stream->readU32(&size)) { return false; }
             fFactoryPlayback = std::make_unique<SkFactoryPlayback>(size);
@@ -328,7 +389,7 @@ bool SkPictureData::parseStreamTag(SkStream* stream,
             fPictures.reserve(SkToInt(size));
 
             for (uint32_t i = 0; i < size; i++) {
-                auto pic = SkPicture::MakeFromStream(stream, &procs, topLevelTFPlayback);
+                auto pic = SkPicture::MakeFromStream(stream, &procs, topLevelTFPlayback, backing);
                 if (!pic) {
                     return false;
                 }
@@ -336,13 +397,25 @@ bool SkPictureData::parseStreamTag(SkStream* stream,
             }
         } break;
         case SK_PICT_BUFFER_SIZE_TAG: {
-            SkAutoMalloc storage(size);
-            if (stream->read(storage.get(), size) != size) {
+            if (padded && !skip_payload_padding(stream)) {
                 return false;
             }
+            // When we can share the buffer with backing, so can the encoded images in it.
+            // Vertices are still decoded into storage of their own.
+            sk_sp<SkData> storage = share_payload(stream, size, backing);
+            const bool shared = storage != nullptr;
+            if (!shared) {
+                storage = SkData::MakeFromStream(stream, size);
+                if (!storage) {
+                    return false;
+                }
+            }
 
-            SkReadBuffer buffer(storage.get(), size);
+            SkReadBuffer buffer(storage->data(), size);
             buffer.setVersion(fInfo.getVersion());
+            if (shared) {
+                buffer.setBackingData(backing);
+            }
 
             if (!fFactoryPlayback) {
                 return false;
@@ -446,14 +519,9 @@ void SkPictureData::parseBufferTag(SkReadBuffer& buffer, uint32_t tag, uint32_t
             new_array_from_buffer(buffer, size, fImages, create_image_from_buffer);
             break;
         case SK_PICT_READER_TAG: {
-            // Preflight check that we can initialize all data from the buffer
-            // before allocating it.
-            if (!buffer.validateCanReadN<uint8_t>(size)) {
-                return;
-            }
-            auto data(SkData::MakeUninitialized(size));
-            if (!buffer.readByteArray(data->writable_data(), size) ||
-                !buffer.validate(nullptr == fOpData)) {
+            // readByteArrayAsData() checks that the buffer holds all the data before allocating.
+            sk_sp<SkData> data = buffer.readByteArrayAsData();
+            if (!buffer.validate(data && data->size() == size && nullptr == fOpData)) {
                 return;
             }
             SkASSERT(nullptr == fOpData);
@@ -474,13 +542,14 @@ void SkPictureData::parseBufferTag(SkReadBuffer& buffer, uint32_t tag, uint32_t
 SkPictureData* SkPictureData::CreateFromStream(SkStream* stream,
                                                const SkPictInfo& info,
                                                const SkDeserialProcs& procs,
-                                               SkTypefacePlayback* topLevelTFPlayback) {
+                                               SkTypefacePlayback* topLevelTFPlayback,
+                                               const SkData* backing) {
     std::unique_ptr<SkPictureData> data(new SkPictureData(info));
     if (!topLevelTFPlayback) {
         topLevelTFPlayback = &data->fTFPlayback;
     }
 
-    if (!data->parseStream(stream, procs, topLevelTFPlayback)) {
+    if (!data->parseStream(stream, procs, topLevelTFPlayback, backing)) {
         return nullptr;
     }
     return data.release();
@@ -499,7 +568,8 @@ SkPictureData* SkPictureData::CreateFromBuffer(SkReadBuffer& buffer,
 
 bool SkPictureData::parseStream(SkStream* stream,
                                 const SkDeserialProcs& procs,
-                                SkTypefacePlayback* topLevelTFPlayback) {
+                                SkTypefacePlayback* topLevelTFPlayback,
+                                const SkData* backing) {
     for (;;) {
         uint32_t tag;
         if (!stream->readU32(&tag)) { return false; }
@@ -509,7 +579,7 @@ bool SkPictureData::parseStream(SkStream* stream,
 
         uint32_t size;
         if (!stream->readU32(&size)) { return false; }
-        if (!this->parseStreamTag(stream, tag, size, procs, topLevelTFPlayback)) {
+        if (!this->parseStreamTag(stream, tag, size, procs, topLevelTFPlayback, backing)) {
             return false; // we're invalid
         }
     }
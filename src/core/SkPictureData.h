@@ -55,6 +55,7 @@ public:
 #define SK_PICT_TYPEFACE_TAG   SkSetFourByteTag('t', 'p', 'f', 'c')
 #define SK_PICT_PICTURE_TAG    SkSetFourByteTag('p', 'c', 't', 'r')
 #define SK_PICT_DRAWABLE_TAG   SkSetFourByteTag('d', 'r', 'a', 'w')
+#define SK_PICT_OP_INDEX_TAG   SkSetFourByteTag('o', 'i', 'd', 'x')
 
 // This tag specifies the size of the ReadBuffer, needed for the following tags
 #define SK_PICT_BUFFER_SIZE_TAG     SkSetFourByteTag('a', 'r', 'a', 'y')
@@ -68,6 +69,15 @@ public:
 // Always write this guy last (with no length field afterwards)
 #define SK_PICT_EOF_TAG     SkSetFourByteTag('e', 'o', 'f', ' ')
 
+// When a picture recorded with a BBH is serialized, we index its op data by the ops of the
+// original recording: each entry covers the op data bytes [fBegin, fEnd) that one recorded op
+// turned into, and fBounds is where that op can draw, in the picture's coordinates.
+struct SkPictureOpIndexEntry {
+    uint32_t fBegin,
+             fEnd;
+    SkRect   fBounds;
+};
+
 template <typename T>
 T* read_index_base_1_or_null(SkReadBuffer* reader, const SkTArray<sk_sp<T>>& array) {
     int index = reader->readInt();
@@ -76,24 +86,30 @@ T* read_index_base_1_or_null(SkReadBuffer* reader, const SkTArray<sk_sp<T>>& arr
 
 class SkPictureData {
 public:
-    SkPictureData(const SkPictureRecord& record, const SkPictInfo&);
+    SkPictureData(const SkPictureRecord& record, const SkPictInfo&,
+                  SkTArray<SkPictureOpIndexEntry> opIndex = SkTArray<SkPictureOpIndexEntry>());
     // Does not affect ownership of SkStream.
+    // If backing is not null, the SkStream reads its bytes and the SkStream's position is an
+    // offset into backing.  We then share large payloads with backing instead of copying them.
     static SkPictureData* CreateFromStream(SkStream*,
                                            const SkPictInfo&,
                                            const SkDeserialProcs&,
-                                           SkTypefacePlayback*);
+                                           SkTypefacePlayback*,
+                                           const SkData* backing = nullptr);
     static SkPictureData* CreateFromBuffer(SkReadBuffer&, const SkPictInfo&);
 
     void serialize(SkWStream*, const SkSerialProcs&, SkRefCntSet*, bool textBlobsOnly=false) const;
     void flatten(SkWriteBuffer&) const;
 
     const sk_sp<SkData>& opData() const { return fOpData; }
+    // Empty unless the picture was recorded with a BBH.  Entries are in op data order.
+    const SkTArray<SkPictureOpIndexEntry>& opIndex() const { return fOpIndex; }
 
 protected:
     explicit SkPictureData(const SkPictInfo& info);
 
     // Does not affect ownership of SkStream.
-    bool parseStream(SkStream*, const SkDeserialProcs&, SkTypefacePlayback*);
+    bool parseStream(SkStream*, const SkDeserialProcs&, SkTypefacePlayback*, const SkData* backing);
     bool parseBuffer(SkReadBuffer& buffer);
 
 public:
@@ -138,7 +154,7 @@ private:
     // these help us with reading/writing
     // Does not affect ownership of SkStream.
     bool parseStreamTag(SkStream*, uint32_t tag, uint32_t size,
-                        const SkDeserialProcs&, SkTypefacePlayback*);
+                        const SkDeserialProcs&, SkTypefacePlayback*, const SkData* backing);
     void parseBufferTag(SkReadBuffer&, uint32_t tag, uint32_t size);
     void flattenToBuffer(SkWriteBuffer&, bool textBlobsOnly) const;
 
@@ -146,6 +162,7 @@ private:
     SkTArray<SkPath>   fPaths;
 
     sk_sp<SkData>   fOpData;    // opcodes and parameters
+    SkTArray<SkPictureOpIndexEntry> fOpIndex;
 
     const SkPath    fEmptyPath;
     const SkBitmap  fEmptyBitmap;
@@ -59,30 +59,84 @@ void SkPicturePlayback::draw(SkCanvas* canvas,
 
     SkAutoCanvasRestore acr(canvas, false);
 
-    while (!reader.eof()) {
+    this->drawOps(&reader, reader.size(), canvas, callback, initialMatrix);
+
+    // need to propagate invalid state to the parent reader
+    if (buffer) {
+        buffer->validate(reader.isValid());
+    }
+}
+
+void SkPicturePlayback::drawQuery(SkCanvas* canvas, const SkRect& query, SkReadBuffer* buffer) {
+    const SkTArray<SkPictureOpIndexEntry>& index = fPictureData->opIndex();
+    if (index.empty()) {
+        this->draw(canvas, nullptr, buffer);
+        return;
+    }
+
+    AutoResetOpID aroi(this);
+    SkASSERT(0 == fCurOffset);
+
+    SkReadBuffer reader(fPictureData->opData()->bytes(),
+                        fPictureData->opData()->size());
+
+    SkMatrix initialMatrix = canvas->getTotalMatrix();
+
+    SkAutoCanvasRestore acr(canvas, false);
+
+    // A linear scan over the bounds is cheaper than building a BBH to answer a single query.
+    size_t prevEnd = 0;
+    for (const SkPictureOpIndexEntry& entry : index) {
+        // Entries must be in order and each must cover whole ops, so we never seek backwards
+        // or into the middle of an op.
+        if (!reader.validate(prevEnd <= entry.fBegin && entry.fBegin < entry.fEnd &&
+                             entry.fEnd <= reader.size())) {
+            break;
+        }
+        prevEnd = entry.fEnd;
+
+        if (SkRect::Intersects(entry.fBounds, query)) {
+            // Ops that skip to their restore when clipped out may take us past entry.fEnd,
+            // but never past an op we need: the restore is in the index whenever its save is.
+            if (reader.offset() < entry.fBegin) {
+                reader.setOffset(entry.fBegin);
+            }
+            this->drawOps(&reader, entry.fEnd, canvas, nullptr, initialMatrix);
+            if (!reader.isValid()) {
+                break;
+            }
+        }
+    }
+
+    if (buffer) {
+        buffer->validate(reader.isValid());
+    }
+}
+
+void SkPicturePlayback::drawOps(SkReadBuffer* reader,
+                                size_t stop,
+                                SkCanvas* canvas,
+                                SkPicture::AbortCallback* callback,
+                                const SkMatrix& initialMatrix) {
+    while (reader->offset() < stop && !reader->eof()) {
         if (callback && callback->abort()) {
             return;
         }
 
-        fCurOffset = reader.offset();
+        fCurOffset = reader->offset();
 
-        uint32_t bits = reader.readInt();
+        uint32_t bits = reader->readInt();
         uint32_t op   = bits >> 24,
                  size = bits & 0xffffff;
         if (size == 0xffffff) {
-            size = reader.readInt();
+            size = reader->readInt();
         }
 
-        if (!reader.validate(size > 0 && op > UNUSED && op <= LAST_DRAWTYPE_ENUM)) {
+        if (!reader->validate(size > 0 && op > UNUSED && op <= LAST_DRAWTYPE_ENUM)) {
             return;
         }
 
-        this->handleOp(&reader, (DrawType)op, size, canvas, initialMatrix);
-    }
-
-    // need to propagate invalid state to the parent reader
-    if (buffer) {
-        buffer->validate(reader.isValid());
+        this->handleOp(reader, (DrawType)op, size, canvas, initialMatrix);
     }
 }
 
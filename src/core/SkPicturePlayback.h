@@ -25,6 +25,10 @@ public:
 
     void draw(SkCanvas* canvas, SkPicture::AbortCallback*, SkReadBuffer* buffer);
 
+    // Like draw(), but uses the picture data's op index to play back only the ops that may
+    // draw inside query.  Without an op index, this plays back everything.
+    void drawQuery(SkCanvas* canvas, const SkRect& query, SkReadBuffer* buffer);
+
     // TODO: remove the curOp calls after cleaning up GrGatherDevice
     // Return the ID of the operation currently being executed when playing
     // back. 0 indicates no call is active.
@@ -37,6 +41,13 @@ protected:
     // The offset of the current operation when within the draw method
     size_t fCurOffset;
 
+    // Plays back ops from reader until it reaches the op data offset stop.
+    void drawOps(SkReadBuffer* reader,
+                 size_t stop,
+                 SkCanvas* canvas,
+                 SkPicture::AbortCallback* callback,
+                 const SkMatrix& initialMatrix);
+
     void handleOp(SkReadBuffer* reader,
                   DrawType op,
                   uint32_t size,
@@ -74,6 +74,8 @@ public:
     // V71: Unify erode and dilate image filters
     // V72: SkColorFilter_Matrix domain (rgba vs. hsla)
     // V73: Use SkColor4f in per-edge AA quad API
+    // V74: Pad op data and buffer payloads in streams to 4-byte offsets so they can be shared
+    // V75: Index op data by op bounds in streams of pictures recorded with a BBH
 
     enum Version {
         kTileModeInBlurImageFilter_Version  = 56,
@@ -94,10 +96,12 @@ public:
         kUnifyErodeDilateImpls_Version      = 71,
         kMatrixColorFilterDomain_Version    = 72,
         kEdgeAAQuadColor4f_Version          = 73,
+        kAlignedPayloads_Version            = 74,
+        kOpIndex_Version                    = 75,
 
         // Only SKPs within the min/current picture version range (inclusive) can be read.
         kMin_Version     = kTileModeInBlurImageFilter_Version,
-        kCurrent_Version = kEdgeAAQuadColor4f_Version
+        kCurrent_Version = kOpIndex_Version
     };
 
     static_assert(kMin_Version <= 62, "Remove kFontAxes_bad from SkFontDescriptor.cpp");
@@ -7,8 +7,66 @@
 
 #include "src/core/SkRTree.h"
 
+#include "include/private/SkVx.h"
+#include "src/core/SkMathPriv.h"
+
 SkRTree::SkRTree() : fCount(0) {}
 
+void SkRTree::Node::setChild(int i, const Branch& branch) {
+    SkASSERT(0 <= i && i < kMaxChildren);
+    fLeft  [i] = branch.fBounds.fLeft;
+    fTop   [i] = branch.fBounds.fTop;
+    fRight [i] = branch.fBounds.fRight;
+    fBottom[i] = branch.fBounds.fBottom;
+    if (0 == fLevel) {
+        fChildren[i].fOpIndex = branch.fOpIndex;
+    } else {
+        fChildren[i].fSubtree = branch.fSubtree;
+    }
+}
+
+SkRect SkRTree::Node::bounds() const {
+    using F = skvx::Vec<4,float>;
+    auto min = [](const float v[]) {
+        return skvx::min(skvx::min(skvx::min(F::Load(v), F::Load(v+4)), F::Load(v+8)));
+    };
+    auto max = [](const float v[]) {
+        return skvx::max(skvx::max(skvx::max(F::Load(v), F::Load(v+4)), F::Load(v+8)));
+    };
+    return { min(fLeft), min(fTop), max(fRight), max(fBottom) };
+}
+
+// Returns a bit for each true lane of mask.
+static uint32_t bitmask(const skvx::Vec<4,int32_t>& mask) {
+#if defined(__SSE__)
+    return _mm_movemask_ps(skvx::bit_pun<__m128>(mask));
+#else
+    return (mask[0] & 1) | (mask[1] & 2) | (mask[2] & 4) | (mask[3] & 8);
+#endif
+}
+
+// Returns a bit for each of the 4 children starting at i whose bounds intersect q.
+static uint32_t intersects4(const float l[], const float t[], const float r[], const float b[],
+                            int i, const SkRect& q) {
+    using F = skvx::Vec<4,float>;
+    // For non-empty rects this matches SkRect::Intersects().  Children are never empty, and we
+    // reject empty queries before getting here.
+    return bitmask((F::Load(l+i) < q.fRight ) & (q.fLeft < F::Load(r+i))
+                 & (F::Load(t+i) < q.fBottom) & (q.fTop  < F::Load(b+i))) << i;
+}
+
+uint32_t SkRTree::Node::intersects(const SkRect& q) const {
+    return intersects4(fLeft, fTop, fRight, fBottom, 0, q)
+         | intersects4(fLeft, fTop, fRight, fBottom, 4, q)
+         | intersects4(fLeft, fTop, fRight, fBottom, 8, q);
+}
+
+// Returns the index of the lowest set bit in bits, which must not be 0.
+static int lowest_bit(uint32_t bits) {
+    SkASSERT(bits);
+    return 31 - SkCLZ(bits & (0 - bits));
+}
+
 void SkRTree::insert(const SkRect boundsArray[], int N) {
     SkASSERT(0 == fCount);
 
@@ -33,7 +91,7 @@ void SkRTree::insert(const SkRect boundsArray[], int N) {
             fNodes.reserve(1);
             Node* n = this->allocateNodeAtLevel(0);
             n->fNumChildren = 1;
-            n->fChildren[0] = branches[0];
+            n->setChild(0, branches[0]);
             fRoot.fSubtree = n;
             fRoot.fBounds  = branches[0].fBounds;
         } else {
@@ -44,11 +102,19 @@ void SkRTree::insert(const SkRect boundsArray[], int N) {
 }
 
 SkRTree::Node* SkRTree::allocateNodeAtLevel(uint16_t level) {
+    static const Node kEmpty = [] {
+        Node n = {};
+        for (int i = 0; i < kPaddedChildren; i++) {
+            n.fLeft [i] = n.fTop   [i] = +SK_FloatInfinity;
+            n.fRight[i] = n.fBottom[i] = -SK_FloatInfinity;
+        }
+        return n;
+    }();
+
     SkDEBUGCODE(Node* p = fNodes.data());
-    fNodes.push_back(Node{});
+    fNodes.push_back(kEmpty);
     Node& out = fNodes.back();
     SkASSERT(fNodes.data() == p);  // If this fails, we didn't reserve() enough.
-    out.fNumChildren = 0;
     out.fLevel = level;
     return &out;
 }
@@ -127,17 +193,16 @@ SkRTree::Branch SkRTree::bulkLoad(std::vector<Branch>* branches, int level) {
         }
         Node* n = allocateNodeAtLevel(level);
         n->fNumChildren = 1;
-        n->fChildren[0] = (*branches)[currentBranch];
-        Branch b;
-        b.fBounds = (*branches)[currentBranch].fBounds;
-        b.fSubtree = n;
+        n->setChild(0, (*branches)[currentBranch]);
         ++currentBranch;
         for (int k = 1; k < incrementBy && currentBranch < (int)branches->size(); ++k) {
-            b.fBounds.join((*branches)[currentBranch].fBounds);
-            n->fChildren[k] = (*branches)[currentBranch];
+            n->setChild(k, (*branches)[currentBranch]);
             ++n->fNumChildren;
             ++currentBranch;
         }
+        Branch b;
+        b.fBounds = n->bounds();
+        b.fSubtree = n;
         (*branches)[newBranches] = b;
         ++newBranches;
     }
@@ -151,15 +216,67 @@ void SkRTree::search(const SkRect& query, std::vector<int>* results) const {
     }
 }
 
-void SkRTree::search(Node* node, const SkRect& query, std::vector<int>* results) const {
-    for (int i = 0; i < node->fNumChildren; ++i) {
-        if (SkRect::Intersects(node->fChildren[i].fBounds, query)) {
-            if (0 == node->fLevel) {
-                results->push_back(node->fChildren[i].fOpIndex);
-            } else {
-                this->search(node->fChildren[i].fSubtree, query, results);
+void SkRTree::search(const Node* node, const SkRect& query, std::vector<int>* results) const {
+    for (uint32_t hits = node->intersects(query); hits; hits &= hits - 1) {
+        int i = lowest_bit(hits);
+        if (0 == node->fLevel) {
+            results->push_back(node->fChildren[i].fOpIndex);
+        } else {
+            this->search(node->fChildren[i].fSubtree, query, results);
+        }
+    }
+}
+
+void SkRTree::search(const SkRect queries[], int N, std::vector<int> results[]) const {
+    if (fCount == 0) {
+        return;
+    }
+
+    // Each level of the tree uses at most 2N ints of scratch: its live queries and their hits.
+    std::vector<int> scratch(2 * N * (this->getDepth() + 1));
+
+    int count = 0;
+    for (int i = 0; i < N; i++) {
+        if (SkRect::Intersects(fRoot.fBounds, queries[i])) {
+            scratch[count++] = i;
+        }
+    }
+    if (count > 0) {
+        this->search(fRoot.fSubtree, queries, scratch.data(), count, results);
+    }
+}
+
+void SkRTree::search(const Node* node, const SkRect queries[], int live[], int count,
+                     std::vector<int> results[]) const {
+    if (0 == node->fLevel) {
+        for (int j = 0; j < count; j++) {
+            std::vector<int>* r = &results[live[j]];
+            for (uint32_t hits = node->intersects(queries[live[j]]); hits; hits &= hits - 1) {
+                r->push_back(node->fChildren[lowest_bit(hits)].fOpIndex);
+            }
+        }
+        return;
+    }
+
+    // Test every live query against this node's children once, then walk the children in order,
+    // each with just the queries that hit it.  This keeps each query's results in op order.
+    int* hits = live + count;
+    uint32_t anyHits = 0;
+    for (int j = 0; j < count; j++) {
+        hits[j] = node->intersects(queries[live[j]]);
+        anyHits |= hits[j];
+    }
+
+    int* next = hits + count;
+    for (; anyHits; anyHits &= anyHits - 1) {
+        int i = lowest_bit(anyHits);
+        int nextCount = 0;
+        for (int j = 0; j < count; j++) {
+            if (hits[j] & (1 << i)) {
+                next[nextCount++] = live[j];
             }
         }
+        this->search(node->fChildren[i].fSubtree, queries, next, nextCount, results);
     }
 }
 
@@ -18,6 +18,9 @@
  * It only supports bulk-loading, i.e. creation from a batch of bounding rectangles.
  * This performs a bottom-up bulk load using the STR (sort-tile-recursive) algorithm.
  *
+ * Each node stores its children's bounds as structure-of-arrays, so searches test a query against
+ * all of a node's children at once, 4 at a time with SIMD.
+ *
  * TODO: Experiment with other bulk-load algorithms (in particular the Hilbert pack variant,
  * which groups rects by position on the Hilbert curve, is probably worth a look). There also
  * exist top-down bulk load variants (VAMSplit, TopDownGreedy, etc).
@@ -33,6 +36,7 @@ public:
 
     void insert(const SkRect[], int N) override;
     void search(const SkRect& query, std::vector<int>* results) const override;
+    void search(const SkRect queries[], int N, std::vector<int> results[]) const override;
     size_t bytesUsed() const override;
 
     // Methods and constants below here are only public for tests.
@@ -57,13 +61,35 @@ private:
         SkRect fBounds;
     };
 
+    // We test children 4 at a time, so we pad kMaxChildren up to a multiple of 4.
+    static constexpr int kPaddedChildren = (kMaxChildren + 3) & ~3;
+    static_assert(kPaddedChildren == 12, "Node::intersects() and bounds() assume 3 groups of 4.");
+
     struct Node {
         uint16_t fNumChildren;
         uint16_t fLevel;
-        Branch fChildren[kMaxChildren];
+        // Children's bounds as structure-of-arrays.  Unused slots hold inverted
+        // (+inf, +inf, -inf, -inf) bounds, which never intersect anything and never grow a join.
+        float fLeft  [kPaddedChildren],
+              fTop   [kPaddedChildren],
+              fRight [kPaddedChildren],
+              fBottom[kPaddedChildren];
+        union {
+            Node* fSubtree;
+            int fOpIndex;
+        } fChildren[kMaxChildren];
+
+        void setChild(int i, const Branch&);
+        // The join of all the children's bounds.
+        SkRect bounds() const;
+        // Bit i is set if child i's bounds intersect query, which must not be empty.
+        uint32_t intersects(const SkRect& query) const;
     };
 
-    void search(Node* root, const SkRect& query, std::vector<int>* results) const;
+    void search(const Node*, const SkRect& query, std::vector<int>* results) const;
+    // Searches node for the count queries listed in live, using live[count...] as scratch.
+    void search(const Node*, const SkRect queries[], int live[], int count,
+                std::vector<int> results[]) const;
 
     // Consumes the input array.
     Branch bulkLoad(std::vector<Branch>* branches, int level = 0);
@@ -143,6 +143,19 @@ bool SkReadBuffer::readPad32(void* buffer, size_t bytes) {
     return false;
 }
 
+sk_sp<SkData> SkReadBuffer::readPad32AsData(size_t bytes) {
+    const void* src = this->skip(bytes);
+    if (!src) {
+        return nullptr;
+    }
+    if (fBackingData) {
+        size_t offset = (const char*)src - (const char*)fBackingData->data();
+        SkASSERT(offset <= fBackingData->size() && bytes <= fBackingData->size() - offset);
+        return SkData::MakeSubset(fBackingData, offset, bytes);
+    }
+    return SkData::MakeWithCopy(src, bytes);
+}
+
 const char* SkReadBuffer::readString(size_t* len) {
     *len = this->readUInt();
 
@@ -267,11 +280,8 @@ sk_sp<SkData> SkReadBuffer::readByteArrayAsData() {
         return nullptr;
     }
 
-    SkAutoMalloc buffer(numBytes);
-    if (!this->readByteArray(buffer.get(), numBytes)) {
-        return nullptr;
-    }
-    return SkData::MakeFromMalloc(buffer.release(), numBytes);
+    (void)this->readUInt();  // numBytes again, which we peeked at above.
+    return this->readPad32AsData(numBytes);
 }
 
 uint32_t SkReadBuffer::getArrayCount() {
@@ -328,8 +338,8 @@ sk_sp<SkImage> SkReadBuffer::readImage() {
         return nullptr;
     }
 
-    sk_sp<SkData> data = SkData::MakeUninitialized(size);
-    if (!this->readPad32(data->writable_data(), size)) {
+    sk_sp<SkData> data = this->readPad32AsData(size);
+    if (!data) {
         this->validate(false);
         return nullptr;
     }
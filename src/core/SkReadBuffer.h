@@ -52,6 +52,12 @@ public:
 
     size_t size() const { return fReader.size(); }
     size_t offset() const { return fReader.offset(); }
+    // Moves to offset, which must be 4-byte aligned and no more than size().
+    void setOffset(size_t offset) {
+        if (this->validate(SkIsAlign4(offset) && offset <= fReader.size())) {
+            fReader.setOffset(offset);
+        }
+    }
     bool eof() { return fReader.eof(); }
     const void* skip(size_t size);
     const void* skip(size_t count, size_t size);    // does safe multiply
@@ -152,6 +158,12 @@ public:
     void setDeserialProcs(const SkDeserialProcs& procs);
     const SkDeserialProcs& getDeserialProcs() const { return fProcs; }
 
+    /**
+     *  If the memory this buffer reads lives inside data, byte arrays and encoded images are
+     *  returned as subsets of data rather than copies. data must outlive this buffer.
+     */
+    void setBackingData(const SkData* data) { fBackingData = data; }
+
     /**
      *  If isValid is false, sets the buffer to be "invalid". Returns true if the buffer
      *  is still valid.
@@ -197,8 +209,11 @@ private:
     void setInvalid();
     bool readArray(void* value, size_t size, size_t elementSize);
     void setMemory(const void*, size_t);
+    // Like readPad32(), but returns the bytes as SkData, sharing fBackingData if we can.
+    sk_sp<SkData> readPad32AsData(size_t bytes);
 
     SkReader32 fReader;
+    const SkData* fBackingData = nullptr;
 
     // Only used if we do not have an fFactoryArray.
     SkTHashMap<uint32_t, SkFlattenable::Factory> fFlattenableDict;
@@ -233,6 +248,7 @@ public:
 
     size_t size() const { return 0; }
     size_t offset() const { return 0; }
+    void setOffset(size_t) {}
     bool eof() { return true; }
     size_t available() const { return 0; }
 
@@ -309,6 +325,7 @@ public:
     void setTypefaceArray(sk_sp<SkTypeface>[], int)        {}
     void setFactoryPlayback(SkFlattenable::Factory[], int) {}
     void setDeserialProcs(const SkDeserialProcs&)          {}
+    void setBackingData(const SkData*)                     {}
 
     const SkDeserialProcs& getDeserialProcs() const {
         static const SkDeserialProcs procs;
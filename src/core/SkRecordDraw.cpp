@@ -18,8 +18,6 @@ void SkRecordDraw(const SkRecord& record,
                   int drawableCount,
                   const SkBBoxHierarchy* bbh,
                   SkPicture::AbortCallback* callback) {
-    SkAutoCanvasRestore saveRestore(canvas, true /*save now, restore at exit*/);
-
     if (bbh) {
         // Draw only ops that affect pixels in the canvas's current clip.
         // The SkRecord and BBH were recorded in identity space.  This canvas
@@ -31,28 +29,40 @@ void SkRecordDraw(const SkRecord& record,
         std::vector<int> ops;
         bbh->search(query, &ops);
 
-        SkRecords::Draw draw(canvas, drawablePicts, drawables, drawableCount);
-        for (int i = 0; i < (int)ops.size(); i++) {
-            if (callback && callback->abort()) {
-                return;
-            }
-            // This visit call uses the SkRecords::Draw::operator() to call
-            // methods on the |canvas|, wrapped by methods defined with the
-            // DRAW() macro.
-            record.visit(ops[i], draw);
+        SkRecordDrawOps(record, canvas, drawablePicts, drawables, drawableCount, ops, callback);
+        return;
+    }
+
+    SkAutoCanvasRestore saveRestore(canvas, true /*save now, restore at exit*/);
+
+    // Draw all ops.
+    SkRecords::Draw draw(canvas, drawablePicts, drawables, drawableCount);
+    for (int i = 0; i < record.count(); i++) {
+        if (callback && callback->abort()) {
+            return;
         }
-    } else {
-        // Draw all ops.
-        SkRecords::Draw draw(canvas, drawablePicts, drawables, drawableCount);
-        for (int i = 0; i < record.count(); i++) {
-            if (callback && callback->abort()) {
-                return;
-            }
-            // This visit call uses the SkRecords::Draw::operator() to call
-            // methods on the |canvas|, wrapped by methods defined with the
-            // DRAW() macro.
-            record.visit(i, draw);
+        // This visit call uses the SkRecords::Draw::operator() to call
+        // methods on the |canvas|, wrapped by methods defined with the
+        // DRAW() macro.
+        record.visit(i, draw);
+    }
+}
+
+void SkRecordDrawOps(const SkRecord& record,
+                     SkCanvas* canvas,
+                     SkPicture const* const drawablePicts[],
+                     SkDrawable* const drawables[],
+                     int drawableCount,
+                     const std::vector<int>& ops,
+                     SkPicture::AbortCallback* callback) {
+    SkAutoCanvasRestore saveRestore(canvas, true /*save now, restore at exit*/);
+
+    SkRecords::Draw draw(canvas, drawablePicts, drawables, drawableCount);
+    for (int i = 0; i < (int)ops.size(); i++) {
+        if (callback && callback->abort()) {
+            return;
         }
+        record.visit(ops[i], draw);
     }
 }
 
@@ -32,6 +32,12 @@ void SkRecordDraw(const SkRecord&, SkCanvas*, SkPicture const* const drawablePic
                   SkDrawable* const drawables[], int drawableCount,
                   const SkBBoxHierarchy*, SkPicture::AbortCallback*);
 
+// Draw only the given ops of an SkRecord (in the order given, typically the result of a BBH
+// search) into an SkCanvas.  SkRecordDraw() uses this when it has a BBH.
+void SkRecordDrawOps(const SkRecord&, SkCanvas*, SkPicture const* const drawablePicts[],
+                     SkDrawable* const drawables[], int drawableCount,
+                     const std::vector<int>& ops, SkPicture::AbortCallback*);
+
 // Draw a portion of an SkRecord into an SkCanvas.
 // When drawing a portion of an SkRecord the CTM on the passed in canvas must be
 // the composition of the replay matrix with the record-time CTM (for the portion
@@ -8,7 +8,7 @@
 #include "src/core/SkResourceCache.h"
 
 #include "include/core/SkTraceMemoryDump.h"
-#include "include/private/SkMutex.h"
+#include "include/private/SkChecksum.h"
 #include "include/private/SkTo.h"
 #include "src/core/SkDiscardableMemory.h"
 #include "src/core/SkImageFilter_Base.h"
@@ -39,6 +39,14 @@ static inline bool SkShouldPostMessageToBus(
     #define SK_DEFAULT_IMAGE_CACHE_LIMIT     (32 * 1024 * 1024)
 #endif
 
+#ifndef SK_RESOURCE_CACHE_SHARD_COUNT
+    #define SK_RESOURCE_CACHE_SHARD_COUNT    1
+#endif
+
+// Counts calls to PostPurgeSharedID(), so that a cache can tell whether it has messages to handle
+// without taking its inbox's lock.
+static std::atomic<uint32_t> gPurgeSharedIDPostCount{0};
+
 void SkResourceCache::Key::init(void* nameSpace, uint64_t sharedID, size_t dataSize) {
     SkASSERT(SkAlign4(dataSize) == dataSize);
 
@@ -85,6 +93,8 @@ void SkResourceCache::init() {
     fTotalBytesUsed = 0;
     fCount = 0;
     fSingleAllocationByteLimit = 0;
+    fDiscardableCountLimit = SK_DISCARDABLEMEMORY_SCALEDIMAGECACHE_COUNT_LIMIT;
+    fPurgeMessagesSeen = gPurgeSharedIDPostCount.load(std::memory_order_acquire);
 
     // One of these should be explicit set by the caller after we return.
     fTotalByteLimit = 0;
@@ -129,6 +139,35 @@ bool SkResourceCache::find(const Key& key, FindVisitor visitor, void* context) {
     return false;
 }
 
+bool SkResourceCache::findShared(const Key& key, FindVisitor visitor, void* context,
+                                 ID* stale) const {
+    *stale = nullptr;
+    if (auto found = fHash->find(key)) {
+        Rec* rec = *found;
+        if (visitor(*rec, context)) {
+            rec->fRecentlyUsed.store(true, std::memory_order_relaxed);  // for our LRU
+            return true;
+        } else {
+            *stale = rec;
+            return false;
+        }
+    }
+    return false;
+}
+
+void SkResourceCache::purgeStale(const Key& key, ID stale) {
+    // Another thread may have purged it since it was found stale.
+    if (auto found = fHash->find(key)) {
+        if (*found == stale) {
+            this->remove(*found);
+        }
+    }
+}
+
+bool SkResourceCache::hasPendingMessages() const {
+    return gPurgeSharedIDPostCount.load(std::memory_order_acquire) != fPurgeMessagesSeen;
+}
+
 static void make_size_str(size_t size, SkString* str) {
     const char suffix[] = { 'b', 'k', 'm', 'g', 't', 0 };
     int i = 0;
@@ -204,7 +243,7 @@ void SkResourceCache::purgeAsNeeded(bool forcePurge) {
     int    countLimit;
 
     if (fDiscardableFactory) {
-        countLimit = SK_DISCARDABLEMEMORY_SCALEDIMAGECACHE_COUNT_LIMIT;
+        countLimit = fDiscardableCountLimit;
         byteLimit = UINT32_MAX;  // no limit based on bytes
     } else {
         countLimit = SK_MaxS32; // no limit based on count
@@ -218,7 +257,10 @@ void SkResourceCache::purgeAsNeeded(bool forcePurge) {
         }
 
         Rec* prev = rec->fPrev;
-        if (rec->canBePurged()) {
+        if (!forcePurge && rec->fRecentlyUsed.exchange(false, std::memory_order_relaxed)) {
+            // Found by findShared() since it was last moved, so it isn't really the LRU.
+            this->moveToHead(rec);
+        } else if (rec->canBePurged()) {
             this->remove(rec);
         }
         rec = prev;
@@ -441,8 +483,11 @@ size_t SkResourceCache::getEffectiveSingleAllocationByteLimit() const {
 }
 
 void SkResourceCache::checkMessages() {
+    // Read the count first, so any message it counts is already in our inbox.
+    uint32_t posted = gPurgeSharedIDPostCount.load(std::memory_order_acquire);
     SkTArray<PurgeSharedIDMessage> msgs;
     fPurgeSharedIDInbox.poll(&msgs);
+    fPurgeMessagesSeen = posted;
     for (int i = 0; i < msgs.count(); ++i) {
         this->purgeSharedID(msgs[i].fSharedID);
     }
@@ -450,94 +495,214 @@ void SkResourceCache::checkMessages() {
 
 ///////////////////////////////////////////////////////////////////////////////
 
-static SkResourceCache* gResourceCache = nullptr;
-static SkMutex& resource_cache_mutex() {
-    static SkMutex& mutex = *(new SkMutex);
-    return mutex;
+SkShardedResourceCache::SkShardedResourceCache(int shardCount, size_t byteLimit)
+    : fShardCount(std::max(1, shardCount))
+    , fShards(new Shard[fShardCount])
+    , fTotalByteLimit(byteLimit) {
+    for (int i = 0; i < fShardCount; i++) {
+        fShards[i].fCache = new SkResourceCache(byteLimit / fShardCount);
+    }
+}
+
+SkShardedResourceCache::SkShardedResourceCache(int shardCount,
+                                               SkResourceCache::DiscardableFactory factory)
+    : fShardCount(std::max(1, shardCount))
+    , fShards(new Shard[fShardCount])
+    , fDiscardableFactory(factory) {
+    for (int i = 0; i < fShardCount; i++) {
+        fShards[i].fCache = new SkResourceCache(factory);
+        fShards[i].fCache->fDiscardableCountLimit =
+                std::max(1, SK_DISCARDABLEMEMORY_SCALEDIMAGECACHE_COUNT_LIMIT / fShardCount);
+    }
+}
+
+SkShardedResourceCache::~SkShardedResourceCache() {
+    for (int i = 0; i < fShardCount; i++) {
+        delete fShards[i].fCache;
+    }
+}
+
+SkShardedResourceCache::Shard& SkShardedResourceCache::shardFor(const SkResourceCache::Key& key) {
+    // Each shard's hash table indexes by the low bits of the hash, so pick shards with a mix of
+    // all of them.
+    return fShards[SkChecksum::Mix(key.hash()) % fShardCount];
+}
+
+bool SkShardedResourceCache::find(const SkResourceCache::Key& key,
+                                  SkResourceCache::FindVisitor visitor, void* context) {
+    Shard& shard = this->shardFor(key);
+    SkResourceCache::ID stale = nullptr;
+    {
+        SkAutoSharedMutexShared lock(shard.fMutex);
+        if (!shard.fCache->hasPendingMessages()) {
+            bool found = shard.fCache->findShared(key, visitor, context, &stale);
+            if (found || !stale) {
+                return found;
+            }
+        }
+    }
+
+    // We have messages to handle, or a stale Rec to purge, so we need exclusive access.
+    SkAutoSharedMutexExclusive lock(shard.fMutex);
+    if (stale) {
+        shard.fCache->purgeStale(key, stale);
+        return false;
+    }
+    return shard.fCache->find(key, visitor, context);
+}
+
+void SkShardedResourceCache::add(SkResourceCache::Rec* rec, void* payload) {
+    Shard& shard = this->shardFor(rec->getKey());
+    SkAutoSharedMutexExclusive lock(shard.fMutex);
+    shard.fCache->add(rec, payload);
 }
 
-/** Must hold resource_cache_mutex() when calling. */
-static SkResourceCache* get_cache() {
-    // resource_cache_mutex() is always held when this is called, so we don't need to be fancy in here.
-    resource_cache_mutex().assertHeld();
-    if (nullptr == gResourceCache) {
+void SkShardedResourceCache::visitAll(SkResourceCache::Visitor visitor, void* context) {
+    for (int i = 0; i < fShardCount; i++) {
+        SkAutoSharedMutexExclusive lock(fShards[i].fMutex);
+        fShards[i].fCache->visitAll(visitor, context);
+    }
+}
+
+size_t SkShardedResourceCache::getTotalBytesUsed() {
+    size_t used = 0;
+    for (int i = 0; i < fShardCount; i++) {
+        SkAutoSharedMutexShared lock(fShards[i].fMutex);
+        used += fShards[i].fCache->getTotalBytesUsed();
+    }
+    return used;
+}
+
+size_t SkShardedResourceCache::getTotalByteLimit() {
+    SkAutoSharedMutexShared lock(fShards[0].fMutex);
+    return fTotalByteLimit;
+}
+
+size_t SkShardedResourceCache::setTotalByteLimit(size_t newLimit) {
+    size_t prevLimit;
+    {
+        SkAutoSharedMutexExclusive lock(fShards[0].fMutex);
+        prevLimit = fTotalByteLimit;
+        fTotalByteLimit = newLimit;
+    }
+    for (int i = 0; i < fShardCount; i++) {
+        SkAutoSharedMutexExclusive lock(fShards[i].fMutex);
+        fShards[i].fCache->setTotalByteLimit(newLimit / fShardCount);
+    }
+    return prevLimit;
+}
+
+size_t SkShardedResourceCache::setSingleAllocationByteLimit(size_t newLimit) {
+    size_t prevLimit = 0;
+    for (int i = 0; i < fShardCount; i++) {
+        SkAutoSharedMutexExclusive lock(fShards[i].fMutex);
+        prevLimit = fShards[i].fCache->setSingleAllocationByteLimit(newLimit);
+    }
+    return prevLimit;
+}
+
+size_t SkShardedResourceCache::getSingleAllocationByteLimit() {
+    SkAutoSharedMutexShared lock(fShards[0].fMutex);
+    return fShards[0].fCache->getSingleAllocationByteLimit();
+}
+
+size_t SkShardedResourceCache::getEffectiveSingleAllocationByteLimit() {
+    SkAutoSharedMutexShared lock(fShards[0].fMutex);
+    return fShards[0].fCache->getEffectiveSingleAllocationByteLimit();
+}
+
+void SkShardedResourceCache::purgeAll() {
+    for (int i = 0; i < fShardCount; i++) {
+        SkAutoSharedMutexExclusive lock(fShards[i].fMutex);
+        fShards[i].fCache->purgeAll();
+    }
+}
+
+SkCachedData* SkShardedResourceCache::newCachedData(size_t bytes) {
+    // This needs no shard's state, so it takes no lock.  Messages are handled by find() and add().
+    if (fDiscardableFactory) {
+        SkDiscardableMemory* dm = fDiscardableFactory(bytes);
+        return dm ? new SkCachedData(bytes, dm) : nullptr;
+    } else {
+        return new SkCachedData(sk_malloc_throw(bytes), bytes);
+    }
+}
+
+void SkShardedResourceCache::dump() {
+    for (int i = 0; i < fShardCount; i++) {
+        SkAutoSharedMutexExclusive lock(fShards[i].fMutex);
+        fShards[i].fCache->dump();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static SkShardedResourceCache* get_cache() {
+    static SkShardedResourceCache* gResourceCache =
 #ifdef SK_USE_DISCARDABLE_SCALEDIMAGECACHE
-        gResourceCache = new SkResourceCache(SkDiscardableMemory::Create);
+            new SkShardedResourceCache(SK_RESOURCE_CACHE_SHARD_COUNT, SkDiscardableMemory::Create);
 #else
-        gResourceCache = new SkResourceCache(SK_DEFAULT_IMAGE_CACHE_LIMIT);
+            new SkShardedResourceCache(SK_RESOURCE_CACHE_SHARD_COUNT, SK_DEFAULT_IMAGE_CACHE_LIMIT);
 #endif
-    }
     return gResourceCache;
 }
 
 size_t SkResourceCache::GetTotalBytesUsed() {
-    SkAutoMutexExclusive am(resource_cache_mutex());
     return get_cache()->getTotalBytesUsed();
 }
 
 size_t SkResourceCache::GetTotalByteLimit() {
-    SkAutoMutexExclusive am(resource_cache_mutex());
     return get_cache()->getTotalByteLimit();
 }
 
 size_t SkResourceCache::SetTotalByteLimit(size_t newLimit) {
-    SkAutoMutexExclusive am(resource_cache_mutex());
     return get_cache()->setTotalByteLimit(newLimit);
 }
 
 SkResourceCache::DiscardableFactory SkResourceCache::GetDiscardableFactory() {
-    SkAutoMutexExclusive am(resource_cache_mutex());
     return get_cache()->discardableFactory();
 }
 
 SkCachedData* SkResourceCache::NewCachedData(size_t bytes) {
-    SkAutoMutexExclusive am(resource_cache_mutex());
     return get_cache()->newCachedData(bytes);
 }
 
 void SkResourceCache::Dump() {
-    SkAutoMutexExclusive am(resource_cache_mutex());
     get_cache()->dump();
 }
 
 size_t SkResourceCache::SetSingleAllocationByteLimit(size_t size) {
-    SkAutoMutexExclusive am(resource_cache_mutex());
     return get_cache()->setSingleAllocationByteLimit(size);
 }
 
 size_t SkResourceCache::GetSingleAllocationByteLimit() {
-    SkAutoMutexExclusive am(resource_cache_mutex());
     return get_cache()->getSingleAllocationByteLimit();
 }
 
 size_t SkResourceCache::GetEffectiveSingleAllocationByteLimit() {
-    SkAutoMutexExclusive am(resource_cache_mutex());
     return get_cache()->getEffectiveSingleAllocationByteLimit();
 }
 
 void SkResourceCache::PurgeAll() {
-    SkAutoMutexExclusive am(resource_cache_mutex());
-    return get_cache()->purgeAll();
+    get_cache()->purgeAll();
 }
 
 bool SkResourceCache::Find(const Key& key, FindVisitor visitor, void* context) {
-    SkAutoMutexExclusive am(resource_cache_mutex());
     return get_cache()->find(key, visitor, context);
 }
 
 void SkResourceCache::Add(Rec* rec, void* payload) {
-    SkAutoMutexExclusive am(resource_cache_mutex());
     get_cache()->add(rec, payload);
 }
 
 void SkResourceCache::VisitAll(Visitor visitor, void* context) {
-    SkAutoMutexExclusive am(resource_cache_mutex());
     get_cache()->visitAll(visitor, context);
 }
 
 void SkResourceCache::PostPurgeSharedID(uint64_t sharedID) {
     if (sharedID) {
         SkMessageBus<PurgeSharedIDMessage>::Post(PurgeSharedIDMessage(sharedID));
+        gPurgeSharedIDPostCount.fetch_add(1, std::memory_order_release);
     }
 }
 
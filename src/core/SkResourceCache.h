@@ -11,6 +11,9 @@
 #include "include/core/SkBitmap.h"
 #include "include/private/SkTDArray.h"
 #include "src/core/SkMessageBus.h"
+#include "src/core/SkSharedMutex.h"
+
+#include <atomic>
 
 class SkCachedData;
 class SkDiscardableMemory;
@@ -106,6 +109,10 @@ public:
         Rec*    fNext;
         Rec*    fPrev;
 
+        // Set by findShared() hits, which can't move the Rec in the LRU.  purgeAsNeeded() gives
+        // such a Rec a second chance, moving it to the head instead of purging it.
+        std::atomic<bool> fRecentlyUsed{false};
+
         friend class SkResourceCache;
     };
 
@@ -220,6 +227,19 @@ public:
     void add(Rec*, void* payload = nullptr);
     void visitAll(Visitor, void* context);
 
+    /**
+     *  Like find(), but safe to call from many threads at once, so long as no other method is
+     *  running (e.g. under a shared lock, with the other methods under an exclusive lock).
+     *  The LRU is not reordered, so a hit only marks its Rec as recently used.
+     *
+     *  This does not purge a Rec the visitor finds stale.  Instead it returns false with
+     *  *stale set to that Rec, to be passed to purgeStale() under an exclusive lock.
+     *  Callers should use find() instead if hasPendingMessages().
+     */
+    bool findShared(const Key&, FindVisitor, void* context, ID* stale) const;
+    void purgeStale(const Key&, ID stale);
+    bool hasPendingMessages() const;
+
     size_t getTotalBytesUsed() const { return fTotalBytesUsed; }
     size_t getTotalByteLimit() const { return fTotalByteLimit; }
 
@@ -269,6 +289,8 @@ private:
     size_t  fTotalByteLimit;
     size_t  fSingleAllocationByteLimit;
     int     fCount;
+    int     fDiscardableCountLimit;
+    uint32_t fPurgeMessagesSeen;
 
     SkMessageBus<PurgeSharedIDMessage>::Inbox fPurgeSharedIDInbox;
 
@@ -283,10 +305,66 @@ private:
 
     void init();    // called by constructors
 
+    friend class SkShardedResourceCache;
+
 #ifdef SK_DEBUG
     void validate() const;
 #else
     void validate() const {}
 #endif
 };
+
+/**
+ *  A thread-safe cache made of independent SkResourceCaches, called shards, each with its own
+ *  lock, LRU, and even share of the budget.  Keys are spread across the shards by hash, so
+ *  threads looking up different keys rarely contend for the same lock.  Hits take only a shared
+ *  lock on their shard, so threads looking up the same keys don't block each other either.
+ *
+ *  The global cache behind SkResourceCache's static methods is one of these, with
+ *  SK_RESOURCE_CACHE_SHARD_COUNT shards.
+ */
+class SkShardedResourceCache {
+public:
+    // The shards allocate with malloc, sharing byteLimit between them.
+    SkShardedResourceCache(int shardCount, size_t byteLimit);
+    // The shards allocate discardable memory, sharing the count limit between them.
+    SkShardedResourceCache(int shardCount, SkResourceCache::DiscardableFactory);
+    ~SkShardedResourceCache();
+
+    int shardCount() const { return fShardCount; }
+
+    bool find(const SkResourceCache::Key&, SkResourceCache::FindVisitor, void* context);
+    void add(SkResourceCache::Rec*, void* payload = nullptr);
+    void visitAll(SkResourceCache::Visitor, void* context);
+
+    size_t getTotalBytesUsed();
+    size_t getTotalByteLimit();
+    size_t setTotalByteLimit(size_t newLimit);
+
+    size_t setSingleAllocationByteLimit(size_t);
+    size_t getSingleAllocationByteLimit();
+    // Pinned against one shard's budget, as that's the most one allocation could ever use.
+    size_t getEffectiveSingleAllocationByteLimit();
+
+    void purgeAll();
+
+    SkResourceCache::DiscardableFactory discardableFactory() const { return fDiscardableFactory; }
+    SkCachedData* newCachedData(size_t bytes);
+
+    void dump();
+
+private:
+    struct Shard {
+        SkSharedMutex    fMutex;
+        SkResourceCache* fCache = nullptr;
+    };
+
+    Shard& shardFor(const SkResourceCache::Key&);
+
+    const int                           fShardCount;
+    std::unique_ptr<Shard[]>            fShards;
+    SkResourceCache::DiscardableFactory fDiscardableFactory = nullptr;
+    size_t                              fTotalByteLimit = 0;  // Guarded by fShards[0].fMutex.
+};
+
 #endif
@@ -10,12 +10,17 @@
 #include "include/effects/SkRuntimeEffect.h"
 #include "include/private/SkChecksum.h"
 #include "include/private/SkMutex.h"
+#include "src/core/SkLRUCache.h"
 #include "src/core/SkRasterPipeline.h"
 #include "src/core/SkReadBuffer.h"
+#include "src/core/SkVM.h"
 #include "src/core/SkWriteBuffer.h"
+#include "src/shaders/SkShaderBase.h"
 #include "src/sksl/SkSLByteCode.h"
 #include "src/sksl/SkSLCompiler.h"
 #include "src/sksl/SkSLInterpreter.h"
+#include "src/sksl/SkSLVMGenerator.h"
+#include "src/sksl/ir/SkSLFunctionDefinition.h"
 #include "src/sksl/ir/SkSLVarDeclarations.h"
 
 #if SK_SUPPORT_GPU
@@ -49,7 +54,49 @@ private:
 SkSL::Compiler* SharedCompiler::gCompiler = nullptr;
 }
 
+// Effects are immutable, so Make() hands out the same effect to every caller with identical SkSL
+// rather than compiling the program again (for example, each time a picture using it is
+// deserialized). Only successfully compiled effects are cached.
+class SkRuntimeEffectCache {
+public:
+    static sk_sp<SkRuntimeEffect> Find(const SkString& sksl) {
+        SkAutoMutexExclusive lock(Mutex());
+        sk_sp<SkRuntimeEffect>* effect = Cache()->find(sksl);
+        return effect ? *effect : nullptr;
+    }
+
+    // Returns the effect that ends up cached for effect's SkSL, which is a different one if
+    // another thread compiled the same SkSL first.
+    static sk_sp<SkRuntimeEffect> Add(sk_sp<SkRuntimeEffect> effect) {
+        SkAutoMutexExclusive lock(Mutex());
+        const SkString& sksl = effect->source();
+        if (sk_sp<SkRuntimeEffect>* existing = Cache()->find(sksl)) {
+            return *existing;
+        }
+        return *Cache()->insert(sksl, effect);
+    }
+
+private:
+    static constexpr int kMaxEffects = 128;
+
+    using LRU = SkLRUCache<SkString, sk_sp<SkRuntimeEffect>>;
+
+    static SkMutex& Mutex() {
+        static SkMutex& mutex = *(new SkMutex);
+        return mutex;
+    }
+
+    static LRU* Cache() {
+        static LRU* cache = new LRU(kMaxEffects);
+        return cache;
+    }
+};
+
 SkRuntimeEffect::EffectResult SkRuntimeEffect::Make(SkString sksl) {
+    if (sk_sp<SkRuntimeEffect> effect = SkRuntimeEffectCache::Find(sksl)) {
+        return std::make_pair(std::move(effect), SkString());
+    }
+
     SkSL::SharedCompiler compiler;
     auto program = compiler->convertProgram(SkSL::Program::kPipelineStage_Kind,
                                             SkSL::String(sksl.c_str(), sksl.size()),
@@ -201,7 +248,7 @@ SkRuntimeEffect::EffectResult SkRuntimeEffect::Make(SkString sksl) {
                                                       std::move(inAndUniformVars),
                                                       std::move(children),
                                                       uniformSize));
-    return std::make_pair(std::move(effect), SkString());
+    return std::make_pair(SkRuntimeEffectCache::Add(std::move(effect)), SkString());
 }
 
 size_t SkRuntimeEffect::Variable::sizeInBytes() const {
@@ -333,10 +380,43 @@ SkRuntimeEffect::ByteCodeResult SkRuntimeEffect::toByteCode(const void* inputs)
     return ByteCodeResult(std::move(byteCode), SkString(compiler->errorText().c_str()));
 }
 
+SkRuntimeEffect::ProgramResult SkRuntimeEffect::toProgram(const void* inputs) {
+    SkSL::SharedCompiler compiler;
+
+    return this->specialize(*fBaseProgram, inputs, compiler);
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 
 static constexpr int kVectorWidth = SkRasterPipeline_InterpreterCtx::VECTOR_WIDTH;
 
+// Lowers main() of a specialized runtime effect program into p, pushing the effect's uniforms
+// (the leading uniformSize bytes of inputs) into uniforms. 'arguments' are main's parameters.
+static bool program_to_skvm(const SkSL::Program& program, const SkData& inputs,
+                            size_t uniformSize, skvm::Builder* p, skvm::Uniforms* uniforms,
+                            SkSpan<skvm::Val> arguments, SkSL::SampleChildFn sampleChild) {
+    const SkSL::FunctionDefinition* main = nullptr;
+    for (const auto& e : program) {
+        if (e.fKind == SkSL::ProgramElement::kFunction_Kind) {
+            const auto& f = (const SkSL::FunctionDefinition&) e;
+            if (f.fDeclaration.fName == "main") {
+                main = &f;
+            }
+        }
+    }
+    if (!main) {
+        return false;
+    }
+
+    std::vector<skvm::Val> uniformVals;
+    const float* uniformData = static_cast<const float*>(inputs.data());
+    for (size_t i = 0; i < uniformSize / sizeof(float); ++i) {
+        uniformVals.push_back(p->uniformF(uniforms->pushF(uniformData[i])).id);
+    }
+    return SkSL::ProgramToSkVM(program, *main, p, SkMakeSpan(uniformVals), arguments,
+                               std::move(sampleChild));
+}
+
 class SkRuntimeColorFilter : public SkColorFilter {
 public:
     SkRuntimeColorFilter(sk_sp<SkRuntimeEffect> effect, sk_sp<SkData> inputs,
@@ -384,6 +464,31 @@ public:
         return true;
     }
 
+    bool onProgram(skvm::Builder* p,
+                   SkColorSpace* dstCS,
+                   skvm::Uniforms* uniforms, SkArenaAlloc*,
+                   skvm::F32* r, skvm::F32* g, skvm::F32* b, skvm::F32* a) const override {
+        // Child color filters have no coordinates to be sampled at.
+        if (!fChildren.empty()) {
+            return false;
+        }
+        const SkSL::Program* program = this->specializedProgram();
+        if (!program) {
+            return false;
+        }
+
+        skvm::Val color[] = { r->id, g->id, b->id, a->id };
+        if (!program_to_skvm(*program, *fInputs, fEffect->uniformSize(), p, uniforms,
+                             SkMakeSpan(color), nullptr)) {
+            return false;
+        }
+        *r = {color[0]};
+        *g = {color[1]};
+        *b = {color[2]};
+        *a = {color[3]};
+        return true;
+    }
+
     void flatten(SkWriteBuffer& buffer) const override {
         buffer.writeString(fEffect->source().c_str());
         if (fInputs) {
@@ -400,6 +505,19 @@ public:
     SK_FLATTENABLE_HOOKS(SkRuntimeColorFilter)
 
 private:
+    const SkSL::Program* specializedProgram() const {
+        SkAutoMutexExclusive ama(fProgramMutex);
+        if (!fProgram) {
+            auto [program, errorText] = fEffect->toProgram(fInputs->data());
+            if (!program) {
+                SkDebugf("%s\n", errorText.c_str());
+                return nullptr;
+            }
+            fProgram = std::move(program);
+        }
+        return fProgram.get();
+    }
+
     sk_sp<SkRuntimeEffect> fEffect;
     sk_sp<SkData> fInputs;
     std::vector<sk_sp<SkColorFilter>> fChildren;
@@ -407,6 +525,9 @@ private:
     mutable SkMutex fInterpreterMutex;
     mutable std::unique_ptr<SkSL::Interpreter<kVectorWidth>> fInterpreter;
     mutable const SkSL::ByteCodeFunction* fMain;
+
+    mutable SkMutex fProgramMutex;
+    mutable std::unique_ptr<SkSL::Program> fProgram;
 };
 
 sk_sp<SkFlattenable> SkRuntimeColorFilter::CreateProc(SkReadBuffer& buffer) {
@@ -503,6 +624,56 @@ public:
         return true;
     }
 
+    bool onProgram(skvm::Builder* p,
+                   const SkMatrix& ctm, const SkMatrix* localM,
+                   SkFilterQuality quality, SkColorSpace* dstCS,
+                   skvm::Uniforms* uniforms, SkArenaAlloc* alloc,
+                   skvm::F32 x, skvm::F32 y,
+                   skvm::F32* r, skvm::F32* g, skvm::F32* b, skvm::F32* a) const override {
+        SkMatrix inverse;
+        if (!this->computeTotalInverse(ctm, localM, &inverse)) {
+            return false;
+        }
+        const SkSL::Program* program = this->specializedProgram();
+        if (!program) {
+            return false;
+        }
+        SkShaderBase::ApplyMatrix(p, inverse, &x, &y, uniforms);
+
+        // Children are sampled in their own local space, at the coordinates main() asks for.
+        bool childrenOK = true;
+        auto sampleChild = [&](int index, skvm::F32 childX, skvm::F32 childY) {
+            skvm::Color color = { p->splat(0.0f), p->splat(0.0f), p->splat(0.0f),
+                                  p->splat(0.0f) };
+            const SkShader* child = fChildren[index].get();
+            if (!child || !as_SB(child)->program(p, SkMatrix::I(), nullptr, quality, dstCS,
+                                                 uniforms, alloc, childX, childY,
+                                                 &color.r, &color.g, &color.b, &color.a)) {
+                childrenOK = false;
+            }
+            return color;
+        };
+
+        // main() starts with the paint color, which we don't know here. Marking it unknown
+        // makes programs that read it fall back to the interpreter.
+        skvm::Val arguments[] = { x.id, y.id, skvm::NA, skvm::NA, skvm::NA, skvm::NA };
+        if (!program_to_skvm(*program, *fInputs, fEffect->uniformSize(), p, uniforms,
+                             SkMakeSpan(arguments), sampleChild) || !childrenOK) {
+            return false;
+        }
+        // If main() didn't write every channel in every lane, part of the color is still unknown.
+        for (int i = 2; i < 6; ++i) {
+            if (arguments[i] == skvm::NA) {
+                return false;
+            }
+        }
+        *r = {arguments[2]};
+        *g = {arguments[3]};
+        *b = {arguments[4]};
+        *a = {arguments[5]};
+        return true;
+    }
+
     void flatten(SkWriteBuffer& buffer) const override {
         uint32_t flags = 0;
         if (fIsOpaque) {
@@ -531,6 +702,19 @@ public:
     SK_FLATTENABLE_HOOKS(SkRTShader)
 
 private:
+    const SkSL::Program* specializedProgram() const {
+        SkAutoMutexExclusive ama(fProgramMutex);
+        if (!fProgram) {
+            auto [program, errorText] = fEffect->toProgram(fInputs->data());
+            if (!program) {
+                SkDebugf("%s\n", errorText.c_str());
+                return nullptr;
+            }
+            fProgram = std::move(program);
+        }
+        return fProgram.get();
+    }
+
     enum Flags {
         kIsOpaque_Flag          = 1 << 0,
         kHasLocalMatrix_Flag    = 1 << 1,
@@ -545,6 +729,9 @@ private:
     mutable SkMutex fInterpreterMutex;
     mutable std::unique_ptr<SkSL::Interpreter<kVectorWidth>> fInterpreter;
     mutable const SkSL::ByteCodeFunction* fMain;
+
+    mutable SkMutex fProgramMutex;
+    mutable std::unique_ptr<SkSL::Program> fProgram;
 };
 
 sk_sp<SkFlattenable> SkRTShader::CreateProc(SkReadBuffer& buffer) {
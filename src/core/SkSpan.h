@@ -9,6 +9,7 @@
 #define SkSpan_DEFINED
 
 #include <cstddef>
+#include <iterator>
 #include "include/private/SkTo.h"
 
 template <typename T>
@@ -0,0 +1,306 @@
+/*
+ * Copyright 2020 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "src/core/SkStrikeBundle.h"
+
+#include "include/core/SkData.h"
+#include "include/core/SkFontMgr.h"
+#include "include/core/SkStream.h"
+#include "include/core/SkTypeface.h"
+#include "include/private/SkTemplates.h"
+#include "src/core/SkDescriptor.h"
+#include "src/core/SkGlyph.h"
+#include "src/core/SkMask.h"
+#include "src/core/SkOpts.h"
+#include "src/core/SkReadBuffer.h"
+#include "src/core/SkScalerContext.h"
+#include "src/core/SkStrikeSpec.h"
+
+static constexpr uint32_t kMagic = SkSetFourByteTag('s', 'k', 'S', 'B');
+
+// Builds the local descriptor for a bundled one: same rec, but pointing at our typeface.
+static bool make_local_descriptor(const void* data, size_t length, SkFontID fontID,
+                                  SkAutoDescriptor* ad) {
+    if (length < sizeof(SkDescriptor) || length != SkAlign4(length)) {
+        return false;
+    }
+    SkAutoDescriptor source(length);
+    memcpy(source.getDesc(), data, length);
+    const SkDescriptor* sourceDesc = source.getDesc();
+    if (sourceDesc->getLength() != length || !sourceDesc->isValid()) {
+        return false;
+    }
+
+    uint32_t recSize = 0;
+    const void* recData = sourceDesc->findEntry(kRec_SkDescriptorTag, &recSize);
+    if (recData == nullptr || recSize != sizeof(SkScalerContextRec) ||
+        sourceDesc->getCount() != 1) {
+        return false;
+    }
+    SkScalerContextRec rec;
+    memcpy((void*)&rec, recData, sizeof(rec));
+    rec.fFontID = fontID;
+
+    ad->reset(SkDescriptor::ComputeOverhead(1) + sizeof(rec));
+    SkDescriptor* desc = ad->getDesc();
+    desc->addEntry(kRec_SkDescriptorTag, sizeof(rec), &rec);
+    desc->computeChecksum();
+    return true;
+}
+
+// -- TypefaceIdentity -----------------------------------------------------------------------------
+auto SkStrikeBundle::TypefaceIdentity::Make(const SkTypeface& typeface) -> TypefaceIdentity {
+    TypefaceIdentity identity;
+    typeface.getFamilyName(&identity.fFamilyName);
+    identity.fStyle = typeface.fontStyle();
+    identity.fGlyphCount = SkToU32(typeface.countGlyphs());
+    identity.fUnitsPerEm = SkToU32(typeface.getUnitsPerEm());
+    // The head table carries the font revision, checksum adjustment and modification date, which
+    // tells apart two builds of the same family far more cheaply than hashing the whole file.
+    if (sk_sp<SkData> head = typeface.copyTableData(SkSetFourByteTag('h', 'e', 'a', 'd'))) {
+        identity.fHeadHash = SkOpts::hash(head->data(), head->size());
+    }
+    return identity;
+}
+
+void SkStrikeBundle::TypefaceIdentity::write(SkWriteBuffer* buffer) const {
+    buffer->writeString(fFamilyName.c_str());
+    buffer->writeUInt(fStyle.weight());
+    buffer->writeUInt(fStyle.width());
+    buffer->writeUInt(fStyle.slant());
+    buffer->writeUInt(fGlyphCount);
+    buffer->writeUInt(fUnitsPerEm);
+    buffer->writeUInt(fHeadHash);
+}
+
+bool SkStrikeBundle::TypefaceIdentity::read(SkReadBuffer* buffer) {
+    buffer->readString(&fFamilyName);
+    int weight = buffer->readInt();
+    int width = buffer->readInt();
+    auto slant = buffer->read32LE(SkFontStyle::kOblique_Slant);
+    fStyle = SkFontStyle(weight, width, slant);
+    fGlyphCount = buffer->readUInt();
+    fUnitsPerEm = buffer->readUInt();
+    fHeadHash = buffer->readUInt();
+    return buffer->isValid();
+}
+
+bool SkStrikeBundle::TypefaceIdentity::operator==(const TypefaceIdentity& that) const {
+    return fFamilyName == that.fFamilyName
+        && fStyle == that.fStyle
+        && fGlyphCount == that.fGlyphCount
+        && fUnitsPerEm == that.fUnitsPerEm
+        && fHeadHash == that.fHeadHash;
+}
+
+// -- Writer ---------------------------------------------------------------------------------------
+SkStrikeBundle::Writer::Writer() = default;
+SkStrikeBundle::Writer::~Writer() = default;
+
+int SkStrikeBundle::Writer::typefaceIndex(const SkTypeface& typeface) {
+    if (int* index = fTypefaceIndices.find(typeface.uniqueID())) {
+        return *index;
+    }
+    TypefaceIdentity::Make(typeface).write(&fTypefaces);
+    fTypefaceIndices.set(typeface.uniqueID(), fTypefaceCount);
+    return fTypefaceCount++;
+}
+
+bool SkStrikeBundle::Writer::addStrike(const SkStrikeSpec& spec,
+                                       SkSpan<const SkGlyphID> glyphIDs,
+                                       bool includePaths) {
+    const SkDescriptor& desc = spec.descriptor();
+    if (desc.findEntry(kEffects_SkDescriptorTag, nullptr) != nullptr) {
+        return false;
+    }
+
+    sk_sp<SkStrike> strike = spec.findOrCreateStrike(&fCache);
+    int typefaceIndex = this->typefaceIndex(*strike->getScalerContext()->getTypeface());
+
+    SkAutoSTArray<64, const SkGlyph*> results(glyphIDs.size());
+    if (includePaths) {
+        strike->preparePaths(glyphIDs, results.get());
+    }
+    SkAutoSTArray<64, SkPackedGlyphID> packedIDs(glyphIDs.size());
+    for (size_t i = 0; i < glyphIDs.size(); ++i) {
+        packedIDs[i] = SkPackedGlyphID{glyphIDs[i]};
+    }
+    SkSpan<const SkGlyph*> glyphs = strike->prepareImages(
+            SkSpan<const SkPackedGlyphID>{packedIDs.get(), glyphIDs.size()}, results.get());
+
+    fStrikes.writeUInt(typefaceIndex);
+    fStrikes.writeByteArray(&desc, desc.getLength());
+    const SkFontMetrics& metrics = strike->getFontMetrics();
+    fStrikes.writeByteArray(&metrics, sizeof(metrics));
+
+    fStrikes.writeUInt(SkToU32(glyphs.size()));
+    for (const SkGlyph* glyph : glyphs) {
+        uint32_t flags = 0;
+        if (glyph->image() != nullptr) {
+            flags |= kImage_Flag;
+        }
+        if (glyph->setPathHasBeenCalled()) {
+            flags |= kPath_Flag;
+            if (glyph->path() != nullptr) {
+                flags |= kPathNonEmpty_Flag;
+            }
+        }
+
+        fStrikes.writeUInt(glyph->getPackedID().value());
+        fStrikes.writeScalar(glyph->advanceX());
+        fStrikes.writeScalar(glyph->advanceY());
+        fStrikes.writeUInt((uint32_t)glyph->width() << 16 | glyph->height());
+        fStrikes.writeInt(glyph->top());
+        fStrikes.writeInt(glyph->left());
+        fStrikes.writeUInt(glyph->maskFormat() | flags << 8);
+        if (flags & kImage_Flag) {
+            fStrikes.writeByteArray(glyph->image(), glyph->imageSize());
+        }
+        if (flags & kPathNonEmpty_Flag) {
+            fStrikes.writePath(*glyph->path());
+        }
+    }
+    fStrikeCount++;
+    return true;
+}
+
+bool SkStrikeBundle::Writer::writeToStream(SkWStream* stream) const {
+    SkBinaryWriteBuffer header;
+    header.writeUInt(kMagic);
+    header.writeUInt(kVersion);
+    header.writeUInt(SkToU32(fTypefaceCount));
+    SkBinaryWriteBuffer strikeCount;
+    strikeCount.writeUInt(SkToU32(fStrikeCount));
+
+    return header.writeToStream(stream)
+        && fTypefaces.writeToStream(stream)
+        && strikeCount.writeToStream(stream)
+        && fStrikes.writeToStream(stream);
+}
+
+// -- Load -----------------------------------------------------------------------------------------
+int SkStrikeBundle::Load(const void* data, size_t size, SkStrikeCache* cache, SkFontMgr* fontMgr) {
+    SkASSERT(cache != nullptr);
+    SkReadBuffer buffer(data, size);
+    if (buffer.readUInt() != kMagic || buffer.readUInt() != kVersion) {
+        return -1;
+    }
+
+    uint32_t typefaceCount = buffer.readUInt();
+    if (!buffer.validateCanReadN<uint32_t>(typefaceCount)) {
+        return -1;
+    }
+    std::vector<sk_sp<SkTypeface>> typefaces;
+    typefaces.reserve(typefaceCount);
+    for (uint32_t i = 0; i < typefaceCount; ++i) {
+        TypefaceIdentity identity;
+        if (!identity.read(&buffer)) {
+            return -1;
+        }
+        sk_sp<SkTypeface> typeface;
+        if (fontMgr != nullptr) {
+            typeface.reset(fontMgr->matchFamilyStyle(identity.fFamilyName.c_str(),
+                                                     identity.fStyle));
+        }
+        if (typeface && !(TypefaceIdentity::Make(*typeface) == identity)) {
+            typeface = nullptr;
+        }
+        typefaces.push_back(std::move(typeface));
+    }
+
+    uint32_t strikeCount = buffer.readUInt();
+    if (!buffer.validateCanReadN<uint32_t>(strikeCount)) {
+        return -1;
+    }
+    int loaded = 0;
+    for (uint32_t i = 0; i < strikeCount; ++i) {
+        uint32_t typefaceIndex = buffer.readUInt();
+        uint32_t descLength = buffer.readUInt();
+        const void* descData = buffer.skip(descLength);
+        SkFontMetrics metrics;
+        buffer.readByteArray(&metrics, sizeof(metrics));
+        if (!buffer.validate(typefaceIndex < typefaces.size())) {
+            return -1;
+        }
+
+        sk_sp<SkStrike> strike;
+        if (const SkTypeface* typeface = typefaces[typefaceIndex].get()) {
+            SkAutoDescriptor ad;
+            if (!make_local_descriptor(descData, descLength, typeface->uniqueID(), &ad)) {
+                return -1;
+            }
+            strike = cache->findStrike(*ad.getDesc());
+            if (strike == nullptr) {
+                SkScalerContextEffects effects;
+                strike = cache->createStrike(*ad.getDesc(),
+                                             typeface->createScalerContext(effects, ad.getDesc()),
+                                             &metrics);
+            }
+        }
+
+        uint32_t glyphCount = buffer.readUInt();
+        if (!buffer.validateCanReadN<uint32_t>(glyphCount)) {
+            return -1;
+        }
+        for (uint32_t j = 0; j < glyphCount; ++j) {
+            SkGlyph glyph{SkPackedGlyphID{buffer.readUInt()}};
+            glyph.fAdvanceX = buffer.readScalar();
+            glyph.fAdvanceY = buffer.readScalar();
+            uint32_t size = buffer.readUInt();
+            glyph.fWidth = SkToU16(size >> 16);
+            glyph.fHeight = SkToU16(size & 0xFFFF);
+            int32_t top = buffer.readInt();
+            int32_t left = buffer.readInt();
+            glyph.fTop = (int16_t)top;
+            glyph.fLeft = (int16_t)left;
+            uint32_t formatAndFlags = buffer.readUInt();
+            glyph.fMaskFormat = formatAndFlags & 0xFF;
+            uint32_t flags = formatAndFlags >> 8;
+            if (!buffer.validate(glyph.fTop == top && glyph.fLeft == left &&
+                                 SkMask::IsValidFormat(glyph.fMaskFormat) &&
+                                 (flags & ~(kImage_Flag | kPath_Flag | kPathNonEmpty_Flag)) == 0)) {
+                return -1;
+            }
+
+            if (flags & kImage_Flag) {
+                if (!buffer.validate(!glyph.isEmpty() && !glyph.imageTooLarge())) {
+                    return -1;
+                }
+                uint32_t imageSize = buffer.readUInt();
+                if (!buffer.validate(imageSize == glyph.imageSize())) {
+                    return -1;
+                }
+                glyph.fImage = const_cast<void*>(buffer.skip(imageSize));
+            }
+            SkPath path;
+            if (flags & (kPath_Flag | kPathNonEmpty_Flag)) {
+                // Empty glyphs like space get their paths prepared too, so they may carry one.
+                if (!buffer.validate(flags & kPath_Flag)) {
+                    return -1;
+                }
+                if (flags & kPathNonEmpty_Flag) {
+                    buffer.readPath(&path);
+                }
+            }
+            if (!buffer.isValid()) {
+                return -1;
+            }
+
+            if (strike != nullptr) {
+                // Copies the image; nothing keeps pointing into the bundle.
+                SkGlyph* merged = strike->mergeGlyphAndImage(glyph.getPackedID(), glyph);
+                if (flags & kPath_Flag) {
+                    strike->mergePath(merged, (flags & kPathNonEmpty_Flag) ? &path : nullptr);
+                }
+            }
+        }
+        if (strike != nullptr) {
+            loaded++;
+        }
+    }
+    return loaded;
+}
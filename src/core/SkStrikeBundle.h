@@ -0,0 +1,115 @@
+/*
+ * Copyright 2020 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkStrikeBundle_DEFINED
+#define SkStrikeBundle_DEFINED
+
+#include "include/core/SkFontStyle.h"
+#include "include/core/SkString.h"
+#include "include/core/SkTypes.h"
+#include "include/private/SkTHash.h"
+#include "src/core/SkSpan.h"
+#include "src/core/SkStrikeCache.h"
+#include "src/core/SkWriteBuffer.h"
+
+#include <vector>
+
+class SkFontMgr;
+class SkReadBuffer;
+class SkStrikeSpec;
+class SkTypeface;
+class SkWStream;
+
+/**
+ *  A strike bundle is a file of already rasterized strikes, written ahead of time and loaded into
+ *  an SkStrikeCache at startup so the first frames of text do not have to go through the scaler.
+ *
+ *  Everything is written with SkBinaryWriteBuffer, so values are 32-bit words in host byte order
+ *  and byte arrays are a length word followed by the bytes padded to 4.
+ *
+ *    uint32        magic ('skSB')
+ *    uint32        version
+ *    uint32        typeface count, then for each typeface:
+ *      string        family name
+ *      uint32        weight, width, slant
+ *      uint32        glyph count
+ *      uint32        units per em
+ *      uint32        hash of the 'head' table, or 0 if the typeface has none
+ *    uint32        strike count, then for each strike:
+ *      uint32        typeface index
+ *      byte array    SkDescriptor; only the rec entry, effects are not supported
+ *      byte array    SkFontMetrics
+ *      uint32        glyph count, then for each glyph:
+ *        uint32        SkPackedGlyphID
+ *        float         advance x, advance y
+ *        uint32        width << 16 | height
+ *        int32         top, left
+ *        uint32        mask format | flags << 8
+ *        byte array    image, if kImage_Flag
+ *        path          outline, if kPathNonEmpty_Flag
+ *
+ *  The font ID inside each descriptor is replaced with that of the matching typeface when loading.
+ *  A typeface is resolved through an SkFontMgr by family name and style and is only used if every
+ *  identity field matches; strikes for typefaces that do not match are skipped.
+ */
+class SkStrikeBundle {
+public:
+    static constexpr uint32_t kVersion = 1;
+
+    class Writer {
+    public:
+        Writer();
+        ~Writer();
+
+        // Rasterizes the glyphs through the strike described by spec and adds it to the bundle.
+        // Paths are included when includePaths is true. Returns false if spec has effects.
+        bool addStrike(const SkStrikeSpec& spec, SkSpan<const SkGlyphID> glyphIDs,
+                       bool includePaths);
+
+        int strikeCount() const { return fStrikeCount; }
+
+        bool writeToStream(SkWStream* stream) const;
+
+    private:
+        int typefaceIndex(const SkTypeface& typeface);
+
+        // A private cache so writing a bundle does not disturb the process-wide one.
+        SkStrikeCache fCache;
+        SkBinaryWriteBuffer fTypefaces;
+        SkTHashMap<SkFontID, int> fTypefaceIndices;
+        int fTypefaceCount = 0;
+        SkBinaryWriteBuffer fStrikes;
+        int fStrikeCount = 0;
+    };
+
+    // Loads the strikes of a bundle into cache. data must be 4-byte aligned and is not referenced
+    // after the call. Returns the number of strikes loaded, or -1 if the data is not a valid
+    // bundle; strikes read before an error is found stay in the cache.
+    static int Load(const void* data, size_t size, SkStrikeCache* cache, SkFontMgr* fontMgr);
+
+private:
+    enum GlyphFlags : uint32_t {
+        kImage_Flag        = 1 << 0,
+        kPath_Flag         = 1 << 1,  // A path was requested...
+        kPathNonEmpty_Flag = 1 << 2,  // ... and the glyph has one.
+    };
+
+    struct TypefaceIdentity {
+        SkString    fFamilyName;
+        SkFontStyle fStyle;
+        uint32_t    fGlyphCount = 0;
+        uint32_t    fUnitsPerEm = 0;
+        uint32_t    fHeadHash = 0;
+
+        static TypefaceIdentity Make(const SkTypeface& typeface);
+        void write(SkWriteBuffer* buffer) const;
+        bool read(SkReadBuffer* buffer);
+        bool operator==(const TypefaceIdentity& that) const;
+    };
+};
+
+#endif  // SkStrikeBundle_DEFINED
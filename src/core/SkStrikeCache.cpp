@@ -7,6 +7,7 @@
 
 #include "src/core/SkStrikeCache.h"
 
+#include <algorithm>
 #include <cctype>
 
 #include "include/core/SkGraphics.h"
@@ -20,6 +21,89 @@
 
 bool gSkUseThreadLocalStrikeCaches_IAcknowledgeThisIsIncrediblyExperimental = false;
 
+#if !defined(SK_BUILD_FOR_IOS) && SK_STRIKE_CACHE_THREAD_MRU_COUNT > 0
+    #define SK_STRIKE_CACHE_USE_THREAD_MRU
+#endif
+
+#if defined(SK_STRIKE_CACHE_USE_THREAD_MRU)
+namespace {
+// Entries don't own their strikes, so that idle threads can't keep purged strikes alive; the
+// generation tells us whether the strike is still in its cache, and so still alive.
+struct ThreadStrikeEntry {
+    uint32_t  fCacheID{0};    // 0 marks an empty entry.
+    uint32_t  fGeneration{0};
+    uint32_t  fChecksum{0};   // The descriptor's, so that misses don't touch the strike.
+    SkStrike* fStrike{nullptr};
+};
+
+// A hazard slot says which strike, if any, its thread is about to read through an entry. A
+// cache that removes that strike holds on to it until the slot moves on, rather than making
+// the reader wait or waiting for it; see internalRemoveStrike(). Each thread has its own slot,
+// so lookups never write to memory shared with other threads. Slots are never freed; the slot
+// of a thread that exits is reused by the next new thread.
+struct HazardSlot {
+    std::atomic<const SkStrike*> fStrike{nullptr};
+    std::atomic<bool>            fInUse{true};
+    HazardSlot*                  fNext{nullptr};
+};
+
+std::atomic<HazardSlot*> gHazardSlots{nullptr};
+
+HazardSlot* acquire_hazard_slot() {
+    for (HazardSlot* slot = gHazardSlots.load(std::memory_order_acquire); slot;
+         slot = slot->fNext) {
+        bool inUse = false;
+        if (!slot->fInUse.load(std::memory_order_relaxed) &&
+             slot->fInUse.compare_exchange_strong(inUse, true, std::memory_order_acquire)) {
+            return slot;
+        }
+    }
+    HazardSlot* slot = new HazardSlot;
+    slot->fNext = gHazardSlots.load(std::memory_order_relaxed);
+    while (!gHazardSlots.compare_exchange_weak(slot->fNext, slot, std::memory_order_release,
+                                                                  std::memory_order_relaxed)) {}
+    return slot;
+}
+
+struct ThreadHazardSlot {
+    HazardSlot* const fSlot = acquire_hazard_slot();
+    ~ThreadHazardSlot() { fSlot->fInUse.store(false, std::memory_order_release); }
+};
+
+bool is_hazard(const SkStrike* strike) {
+    for (HazardSlot* slot = gHazardSlots.load(std::memory_order_acquire); slot;
+         slot = slot->fNext) {
+        if (slot->fStrike.load() == strike) {
+            return true;
+        }
+    }
+    return false;
+}
+}  // namespace
+
+static HazardSlot* thread_hazard_slot() {
+    static thread_local ThreadHazardSlot slot;
+    return slot.fSlot;
+}
+
+// Most recently used first.
+static ThreadStrikeEntry* thread_strike_entries() {
+    static thread_local ThreadStrikeEntry entries[SK_STRIKE_CACHE_THREAD_MRU_COUNT];
+    return entries;
+}
+#endif
+
+static uint32_t next_strike_cache_id() {
+    static std::atomic<uint32_t> nextID{1};
+    uint32_t id;
+    do {
+        id = nextID.fetch_add(1, std::memory_order_relaxed);
+    } while (id == 0);
+    return id;
+}
+
+SkStrikeCache::SkStrikeCache() : fUniqueID{next_strike_cache_id()} {}
+
 SkStrikeCache* SkStrikeCache::GlobalStrikeCache() {
 #if !defined(SK_BUILD_FOR_IOS)
     if (gSkUseThreadLocalStrikeCaches_IAcknowledgeThisIsIncrediblyExperimental) {
@@ -34,15 +118,81 @@ SkStrikeCache* SkStrikeCache::GlobalStrikeCache() {
 auto SkStrikeCache::findOrCreateStrike(const SkDescriptor& desc,
                                        const SkScalerContextEffects& effects,
                                        const SkTypeface& typeface) -> sk_sp<Strike> {
+    if (sk_sp<Strike> strike = this->findInThreadCache(desc)) {
+        return strike;
+    }
+
     SkAutoSpinlock ac(fLock);
     sk_sp<Strike> strike = this->internalFindStrikeOrNull(desc);
     if (strike == nullptr) {
         auto scaler = typeface.createScalerContext(effects, &desc);
         strike = this->internalCreateStrike(desc, std::move(scaler));
     }
+    this->addToThreadCache(strike, fPurgeGeneration.load(std::memory_order_relaxed));
     return strike;
 }
 
+auto SkStrikeCache::findInThreadCache(const SkDescriptor& desc) const -> sk_sp<Strike> {
+#if defined(SK_STRIKE_CACHE_USE_THREAD_MRU)
+    const uint32_t generation = fPurgeGeneration.load();
+    ThreadStrikeEntry* entries = thread_strike_entries();
+    for (int i = 0; i < SK_STRIKE_CACHE_THREAD_MRU_COUNT; ++i) {
+        ThreadStrikeEntry& entry = entries[i];
+        if (entry.fCacheID != fUniqueID) {
+            continue;
+        }
+        if (entry.fGeneration != generation) {
+            // Something was purged since this entry was made, so its strike may be gone; let the
+            // shared cache decide.
+            entry = ThreadStrikeEntry{};
+            continue;
+        }
+        if (entry.fChecksum != desc.getChecksum()) {
+            continue;
+        }
+
+        // Claim the strike, then check that it was not removed before the claim could be seen.
+        // Either internalRemoveStrike() sees the claim, or we see its new generation.
+        HazardSlot* hazard = thread_hazard_slot();
+        hazard->fStrike.store(entry.fStrike);
+        if (fPurgeGeneration.load() != generation) {
+            hazard->fStrike.store(nullptr, std::memory_order_release);
+            return nullptr;
+        }
+        sk_sp<Strike> strike;
+        if (entry.fStrike->getDescriptor() == desc) {
+            strike = sk_ref_sp(entry.fStrike);
+        }
+        hazard->fStrike.store(nullptr, std::memory_order_release);
+        if (strike == nullptr) {
+            continue;
+        }
+
+        if (!strike->fRecentlyUsed.load(std::memory_order_relaxed)) {
+            strike->fRecentlyUsed.store(true, std::memory_order_relaxed);
+        }
+        for (int j = i; j > 0; --j) {
+            entries[j] = entries[j - 1];
+        }
+        entries[0] = {fUniqueID, generation, desc.getChecksum(), strike.get()};
+        return strike;
+    }
+#endif
+    return nullptr;
+}
+
+void SkStrikeCache::addToThreadCache(const sk_sp<Strike>& strike, uint32_t generation) const {
+#if defined(SK_STRIKE_CACHE_USE_THREAD_MRU)
+    // The generation must be read under fLock, together with the lookup, so that a strike
+    // removed right after we unlock can never be remembered as current.
+    ThreadStrikeEntry* entries = thread_strike_entries();
+    for (int j = SK_STRIKE_CACHE_THREAD_MRU_COUNT - 1; j > 0; --j) {
+        entries[j] = entries[j - 1];
+    }
+    entries[0] = {fUniqueID, generation, strike->getDescriptor().getChecksum(), strike.get()};
+#endif
+}
+
 SkScopedStrikeForGPU SkStrikeCache::findOrCreateScopedStrike(const SkDescriptor& desc,
                                                              const SkScalerContextEffects& effects,
                                                              const SkTypeface& typeface) {
@@ -119,8 +269,16 @@ void SkStrikeCache::DumpMemoryStatistics(SkTraceMemoryDump* dump) {
 }
 
 sk_sp<SkStrike> SkStrikeCache::findStrike(const SkDescriptor& desc) {
+    if (sk_sp<Strike> strike = this->findInThreadCache(desc)) {
+        return strike;
+    }
+
     SkAutoSpinlock ac(fLock);
-    return this->internalFindStrikeOrNull(desc);
+    sk_sp<Strike> strike = this->internalFindStrikeOrNull(desc);
+    if (strike != nullptr) {
+        this->addToThreadCache(strike, fPurgeGeneration.load(std::memory_order_relaxed));
+    }
+    return strike;
 }
 
 auto SkStrikeCache::internalFindStrikeOrNull(const SkDescriptor& desc) -> sk_sp<Strike> {
@@ -133,6 +291,11 @@ auto SkStrikeCache::internalFindStrikeOrNull(const SkDescriptor& desc) -> sk_sp<
     if (strikeHandle == nullptr) { return nullptr; }
     Strike* strikePtr = strikeHandle->get();
     SkASSERT(strikePtr != nullptr);
+    this->internalMoveToHead(strikePtr);
+    return sk_ref_sp(strikePtr);
+}
+
+void SkStrikeCache::internalMoveToHead(Strike* strikePtr) {
     if (fHead != strikePtr) {
         // Make most recently used
         strikePtr->fPrev->fNext = strikePtr->fNext;
@@ -146,7 +309,6 @@ auto SkStrikeCache::internalFindStrikeOrNull(const SkDescriptor& desc) -> sk_sp<
         strikePtr->fPrev = nullptr;
         fHead = strikePtr;
     }
-    return sk_ref_sp(strikePtr);
 }
 
 sk_sp<SkStrike> SkStrikeCache::createStrike(
@@ -171,7 +333,11 @@ auto SkStrikeCache::internalCreateStrike(
 
 void SkStrikeCache::purgeAll() {
     SkAutoSpinlock ac(fLock);
+    for (Strike* strike = fHead; strike != nullptr; strike = strike->fNext) {
+        strike->fRecentlyUsed.store(false, std::memory_order_relaxed);
+    }
     this->internalPurge(fTotalMemoryUsed);
+    this->internalReleaseRetired();
 }
 
 size_t SkStrikeCache::getTotalMemoryUsed() const {
@@ -278,12 +444,17 @@ size_t SkStrikeCache::internalPurge(size_t minBytesNeeded) {
 
     // Start at the tail and proceed backwards deleting; the list is in LRU
     // order, with unimportant entries at the tail.
+    // Strikes used through a per-thread cache since the last purge are moved back to the
+    // head instead; stop at the old head so they are not visited twice.
     Strike* strike = fTail;
+    Strike* const oldHead = fHead;
     while (strike != nullptr && (bytesFreed < bytesNeeded || countFreed < countNeeded)) {
-        Strike* prev = strike->fPrev;
+        Strike* prev = strike == oldHead ? nullptr : strike->fPrev;
 
-        // Only delete if the strike is not pinned.
-        if (strike->fPinner == nullptr || strike->fPinner->canDelete()) {
+        if (strike->fRecentlyUsed.exchange(false, std::memory_order_relaxed)) {
+            this->internalMoveToHead(strike);
+        } else if (strike->fPinner == nullptr || strike->fPinner->canDelete()) {
+            // Only delete if the strike is not pinned.
             bytesFreed += strike->fMemoryUsed;
             countFreed += 1;
             this->internalRemoveStrike(strike);
@@ -342,7 +513,28 @@ void SkStrikeCache::internalRemoveStrike(Strike* strike) {
 
     strike->fPrev = strike->fNext = nullptr;
     strike->fRemoved = true;
+
+    // Invalidate every thread's entries. Dropping the cache's ref may free the strike, so if a
+    // thread claimed it before seeing the new generation, keep the ref until a later removal.
+    fPurgeGeneration.fetch_add(1);
+    sk_sp<Strike> ref = *fStrikeLookup.find(strike->getDescriptor());
     fStrikeLookup.remove(strike->getDescriptor());
+    this->internalReleaseRetired();
+#if defined(SK_STRIKE_CACHE_USE_THREAD_MRU)
+    if (is_hazard(strike)) {
+        fRetired.push_back(std::move(ref));
+    }
+#endif
+}
+
+void SkStrikeCache::internalReleaseRetired() {
+#if defined(SK_STRIKE_CACHE_USE_THREAD_MRU)
+    fRetired.erase(std::remove_if(fRetired.begin(), fRetired.end(),
+                                  [](const sk_sp<Strike>& strike) {
+                                      return !is_hazard(strike.get());
+                                  }),
+                   fRetired.end());
+#endif
 }
 
 void SkStrikeCache::validate() const {
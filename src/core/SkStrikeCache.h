@@ -8,8 +8,10 @@
 #ifndef SkStrikeCache_DEFINED
 #define SkStrikeCache_DEFINED
 
+#include <atomic>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "include/private/SkSpinlock.h"
 #include "include/private/SkTemplates.h"
@@ -30,6 +32,11 @@ class SkTraceMemoryDump;
     #define SK_DEFAULT_FONT_CACHE_POINT_SIZE_LIMIT  256
 #endif
 
+// Number of strikes each thread remembers in front of the shared cache. Set to 0 to disable.
+#ifndef SK_STRIKE_CACHE_THREAD_MRU_COUNT
+    #define SK_STRIKE_CACHE_THREAD_MRU_COUNT    4
+#endif
+
 ///////////////////////////////////////////////////////////////////////////////
 
 class SkStrikePinner {
@@ -40,7 +47,7 @@ public:
 
 class SkStrikeCache final : public SkStrikeForGPUCacheInterface {
 public:
-    SkStrikeCache() = default;
+    SkStrikeCache();
 
     class Strike final : public SkRefCnt, public SkStrikeForGPU {
     public:
@@ -143,6 +150,9 @@ public:
         std::unique_ptr<SkStrikePinner> fPinner;
         size_t                          fMemoryUsed{sizeof(SkScalerCache)};
         bool                            fRemoved{false};
+        // Set by per-thread cache hits, which do not touch the LRU list; gives the strike a
+        // second chance when it reaches the tail during a purge.
+        std::atomic<bool>               fRecentlyUsed{false};
     };  // Strike
 
     static SkStrikeCache* GlobalStrikeCache();
@@ -186,6 +196,13 @@ public:
     int  setCachePointSizeLimit(int limit) SK_EXCLUDES(fLock);
 
 private:
+    // Each thread keeps a few recently used strikes so that repeated lookups of the same
+    // descriptor skip fLock. Entries hold no refs, and are only trusted while fPurgeGeneration
+    // is unchanged; a thread marks the strike it reads in its hazard slot while it refs it.
+    // Hits mark Strike::fRecentlyUsed instead of moving the strike to the head of the list.
+    sk_sp<Strike> findInThreadCache(const SkDescriptor& desc) const SK_EXCLUDES(fLock);
+    void addToThreadCache(const sk_sp<Strike>& strike, uint32_t generation) const;
+
     sk_sp<Strike> internalFindStrikeOrNull(const SkDescriptor& desc) SK_REQUIRES(fLock);
     sk_sp<Strike> internalCreateStrike(
             const SkDescriptor& desc,
@@ -196,6 +213,9 @@ private:
     // The following methods can only be called when mutex is already held.
     void internalRemoveStrike(Strike* strike) SK_REQUIRES(fLock);
     void internalAttachToHead(sk_sp<Strike> strike) SK_REQUIRES(fLock);
+    void internalMoveToHead(Strike* strike) SK_REQUIRES(fLock);
+    // Drops the refs in fRetired that no thread is reading anymore.
+    void internalReleaseRetired() SK_REQUIRES(fLock);
 
     // Checkout budgets, modulated by the specified min-bytes-needed-to-purge,
     // and attempt to purge caches to match.
@@ -225,6 +245,12 @@ private:
     int32_t fCacheCountLimit{SK_DEFAULT_FONT_CACHE_COUNT_LIMIT};
     int32_t fCacheCount SK_GUARDED_BY(fLock) {0};
     int32_t fPointSizeLimit{SK_DEFAULT_FONT_CACHE_POINT_SIZE_LIMIT};
+
+    // Bumped every time a strike leaves the cache; invalidates the per-thread entries.
+    std::atomic<uint32_t> fPurgeGeneration{0};
+    // Removed strikes that a thread was reading through its entries at the time.
+    std::vector<sk_sp<Strike>> fRetired SK_GUARDED_BY(fLock);
+    const uint32_t fUniqueID;
 };
 
 using SkStrike = SkStrikeCache::Strike;
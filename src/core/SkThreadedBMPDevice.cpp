@@ -0,0 +1,387 @@
+/*
+ * Copyright 2020 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "src/core/SkThreadedBMPDevice.h"
+
+#include "include/core/SkPath.h"
+#include "include/core/SkRRect.h"
+#include "include/core/SkVertices.h"
+#include "include/private/SkTo.h"
+#include "src/core/SkDraw.h"
+#include "src/core/SkRecords.h"
+#include "src/core/SkSpecialImage.h"
+#include "src/core/SkTLazy.h"
+#include "src/core/SkTaskGroup.h"
+
+#include <algorithm>
+#include <atomic>
+
+// Must match SkDrawTiler's kMaxDim in SkBitmapDevice.cpp.
+static constexpr int kMaxDim = 8192 - 1;
+
+// Mirrors Bounder in SkBitmapDevice.cpp: the local bounds of drawing r with paint, if known.
+static const SkRect* paint_bounds(const SkRect& r, const SkPaint& paint, SkRect* storage) {
+    if (!paint.canComputeFastBounds()) {
+        return nullptr;
+    }
+    *storage = paint.computeFastBounds(r, storage);
+    return storage;
+}
+
+// Recorded bitmaps must not change under us before we flush, so we snap mutable ones.
+static SkBitmap snap_bitmap(const SkBitmap& bitmap) {
+    if (bitmap.isImmutable() || !bitmap.getPixels()) {
+        return bitmap;
+    }
+    SkBitmap copy;
+    if (!copy.tryAllocPixels(bitmap.info()) || !bitmap.readPixels(copy.pixmap())) {
+        return SkBitmap();
+    }
+    copy.setImmutable();
+    return copy;
+}
+
+SkThreadedBMPDevice::SkThreadedBMPDevice(const SkBitmap& bitmap, int tiles, int threads,
+                                         SkExecutor* executor)
+        : SkThreadedBMPDevice(bitmap, SkSurfaceProps(SkSurfaceProps::kLegacyFontHost_InitType),
+                              tiles, threads, executor) {}
+
+SkThreadedBMPDevice::SkThreadedBMPDevice(const SkBitmap& bitmap,
+                                         const SkSurfaceProps& surfaceProps, int tiles,
+                                         int threads, SkExecutor* executor)
+        : INHERITED(bitmap, surfaceProps, nullptr, nullptr)
+        , fTileCnt(SkTPin(tiles, 1, std::max(bitmap.height(), 1))) {
+    if (executor) {
+        fExecutor = executor;
+    } else {
+        fInternalExecutor = SkExecutor::MakeFIFOThreadPool(threads > 0 ? threads : fTileCnt);
+        fExecutor = fInternalExecutor.get();
+    }
+
+    // Full width horizontal strips, so each draw touches a contiguous run of them.
+    fTileBounds.reserve(fTileCnt);
+    for (int i = 0; i < fTileCnt; ++i) {
+        int top    = SkToInt((int64_t)bitmap.height() *  i      / fTileCnt),
+            bottom = SkToInt((int64_t)bitmap.height() * (i + 1) / fTileCnt);
+        fTileBounds.push_back(SkIRect::MakeLTRB(0, top, bitmap.width(), bottom));
+    }
+}
+
+SkThreadedBMPDevice::~SkThreadedBMPDevice() {
+    // Our pixels may well outlive us, so make sure they hold everything that was drawn.
+    this->flush();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void SkThreadedBMPDevice::recordTiledDraw(const SkRect* tilerBounds, const SkRect* binBounds,
+                                          DrawFn&& drawFn) {
+    const SkRasterClip& rc = fRCStack.rc();
+    if (rc.isEmpty()) {
+        return;
+    }
+    const SkMatrix& ctm = this->localToDevice();
+    const SkIRect clipR = rc.getBounds();
+
+    DrawElement element(rc);
+    // This replicates SkDrawTiler's decisions, so that we can later replay its exact SkDraws.
+    element.fNeedsTiling = clipR.right() > kMaxDim || clipR.bottom() > kMaxDim;
+    if (element.fNeedsTiling) {
+        element.fTilerBounds = tilerBounds ? ctm.mapRect(*tilerBounds).roundOut() : clipR;
+        if (!element.fTilerBounds.intersect(clipR)) {
+            return;
+        }
+        element.fNeedsTiling = element.fTilerBounds.right() > kMaxDim ||
+                               element.fTilerBounds.bottom() > kMaxDim;
+    }
+
+    element.fDevBounds = clipR;
+    if (binBounds) {
+        SkIRect devBounds = ctm.mapRect(*binBounds).roundOut();
+        devBounds.outset(1, 1);
+        if (!element.fDevBounds.intersect(devBounds)) {
+            return;
+        }
+    }
+
+    element.fMatrix = ctm;
+    (void)element.fMatrix.getType();  // Precache the type, as tiles read it concurrently.
+    element.fDrawFn = std::move(drawFn);
+    fQueue.push_back(std::move(element));
+}
+
+void SkThreadedBMPDevice::recordDirectDraw(const SkIRect* devBounds, DrawFn&& drawFn) {
+    const SkRasterClip& rc = fRCStack.rc();
+    if (rc.isEmpty()) {
+        return;
+    }
+
+    DrawElement element(rc);
+    element.fNeedsTiling = false;
+    element.fDevBounds = rc.getBounds();
+    if (devBounds && !element.fDevBounds.intersect(*devBounds)) {
+        return;
+    }
+
+    element.fMatrix = this->localToDevice();
+    (void)element.fMatrix.getType();
+    element.fDrawFn = std::move(drawFn);
+    fQueue.push_back(std::move(element));
+}
+
+void SkThreadedBMPDevice::drawElement(const DrawElement& element, const SkPixmap& root) const {
+    SkDraw draw;
+    if (!element.fNeedsTiling) {
+        draw.fDst = root;
+        draw.fMatrix = &element.fMatrix;
+        draw.fRC = &element.fRC;
+        element.fDrawFn(draw);
+        return;
+    }
+
+    // Walk the same kMaxDim tiles that SkDrawTiler would.
+    SkMatrix matrix;
+    SkRasterClip rc;
+    draw.fMatrix = &matrix;
+    draw.fRC = &rc;
+    const SkIRect& src = element.fTilerBounds;
+    for (int y = src.fTop; y < src.fBottom; y += kMaxDim) {
+        for (int x = src.fLeft; x < src.fRight; x += kMaxDim) {
+            if (!root.extractSubset(&draw.fDst, SkIRect::MakeXYWH(x, y, kMaxDim, kMaxDim))) {
+                continue;
+            }
+            matrix = element.fMatrix;
+            matrix.postTranslate(SkIntToScalar(-x), SkIntToScalar(-y));
+            element.fRC.translate(-x, -y, &rc);
+            if (rc.op(SkIRect::MakeWH(draw.fDst.width(), draw.fDst.height()),
+                      SkRegion::kIntersect_Op)) {
+                element.fDrawFn(draw);
+            }
+        }
+    }
+}
+
+void SkThreadedBMPDevice::flush() {
+    if (fQueue.empty()) {
+        return;
+    }
+    // Take the queue first: accessing our pixels below re-enters flush() through onPeekPixels().
+    std::vector<DrawElement> queue;
+    queue.swap(fQueue);
+
+    SkPixmap root;
+    if (!this->INHERITED::onAccessPixels(&root)) {
+        return;
+    }
+
+    // Each tile plays the draws that touch it in order. A draw that touches several tiles is
+    // played once, by the last of them to reach it, which then resumes the others after it.
+    const int drawCount = SkToInt(queue.size());
+    std::vector<std::vector<int>> tileDraws(fTileCnt);
+    std::unique_ptr<std::atomic<int>[]> tilesToArrive(new std::atomic<int>[drawCount]);
+    for (int i = 0; i < drawCount; ++i) {
+        int tiles = 0;
+        for (int t = 0; t < fTileCnt; ++t) {
+            if (SkIRect::Intersects(queue[i].fDevBounds, fTileBounds[t])) {
+                tileDraws[t].push_back(i);
+                tiles++;
+            }
+        }
+        tilesToArrive[i].store(tiles, std::memory_order_relaxed);
+    }
+
+    SkTaskGroup tg(*fExecutor);
+    std::function<void(int, size_t)> playTile = [&](int t, size_t next) {
+        const std::vector<int>& draws = tileDraws[t];
+        for (; next < draws.size(); ++next) {
+            const int i = draws[next];
+            if (tilesToArrive[i].fetch_sub(1, std::memory_order_acq_rel) != 1) {
+                return;
+            }
+            this->drawElement(queue[i], root);
+            for (int u = 0; u < fTileCnt; ++u) {
+                if (u != t && SkIRect::Intersects(queue[i].fDevBounds, fTileBounds[u])) {
+                    const std::vector<int>& other = tileDraws[u];
+                    size_t resume = std::lower_bound(other.begin(), other.end(), i) - other.begin();
+                    tg.add([&playTile, u, resume] { playTile(u, resume + 1); });
+                }
+            }
+        }
+    };
+    tg.batch(fTileCnt, [&](int t) { playTile(t, 0); });
+    tg.wait();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void SkThreadedBMPDevice::drawPaint(const SkPaint& paint) {
+    this->recordDirectDraw(nullptr, [paint](const SkDraw& draw) {
+        draw.drawPaint(paint);
+    });
+}
+
+void SkThreadedBMPDevice::drawPoints(SkCanvas::PointMode mode, size_t count,
+                                     const SkPoint pts[], const SkPaint& paint) {
+    std::vector<SkPoint> points(pts, pts + count);
+    this->recordTiledDraw(nullptr, nullptr, [mode, points = std::move(points), paint]
+                                            (const SkDraw& draw) {
+        draw.drawPoints(mode, points.size(), points.data(), paint, nullptr);
+    });
+}
+
+void SkThreadedBMPDevice::drawRect(const SkRect& r, const SkPaint& paint) {
+    SkRect storage;
+    const SkRect* bounds = paint_bounds(r, paint, &storage);
+    this->recordTiledDraw(bounds, bounds, [r, paint](const SkDraw& draw) {
+        draw.drawRect(r, paint);
+    });
+}
+
+void SkThreadedBMPDevice::drawRRect(const SkRRect& rrect, const SkPaint& paint) {
+#ifdef SK_IGNORE_BLURRED_RRECT_OPT
+    // SkBitmapDevice turns this into a (virtual) drawPath(), which we record.
+    this->INHERITED::drawRRect(rrect, paint);
+#else
+    SkRect storage;
+    const SkRect* bounds = paint_bounds(rrect.getBounds(), paint, &storage);
+    this->recordTiledDraw(bounds, bounds, [rrect, paint](const SkDraw& draw) {
+        draw.drawRRect(rrect, paint);
+    });
+#endif
+}
+
+void SkThreadedBMPDevice::drawPath(const SkPath& path, const SkPaint& paint, bool) {
+    // Precache the path's bounds and gen ID, as tiles read them concurrently.
+    SkRecords::PreCachedPath cachedPath(path);
+
+    SkRect storage;
+    const SkRect* bounds = path.isInverseFillType()
+                         ? nullptr : paint_bounds(cachedPath.getBounds(), paint, &storage);
+    const bool tilerUsesBounds = this->width() > kMaxDim || this->height() > kMaxDim;
+    this->recordTiledDraw(tilerUsesBounds ? bounds : nullptr, bounds,
+                          [cachedPath, paint](const SkDraw& draw) {
+        // Every tile draws the same path, so it is never mutable.
+        draw.drawPath(cachedPath, paint, nullptr, false);
+    });
+}
+
+void SkThreadedBMPDevice::drawBitmap(const SkBitmap& bitmap, const SkMatrix& matrix,
+                                     const SkRect* dstOrNull, const SkPaint& paint) {
+    SkBitmap snap = snap_bitmap(bitmap);
+    if (snap.drawsNothing()) {
+        return;
+    }
+
+    SkRect mapped, storage;
+    matrix.mapRect(&mapped, SkRect::MakeIWH(bitmap.width(), bitmap.height()));
+    const SkRect* bounds = paint_bounds(dstOrNull ? *dstOrNull : mapped, paint, &storage);
+
+    // SkBitmapDevice hands the tiler dstOrNull as is, or the paint bounds of the mapped bitmap.
+    SkRect tilerStorage;
+    const SkRect* tilerBounds = dstOrNull;
+    if (!tilerBounds && (this->width() > kMaxDim || this->height() > kMaxDim)) {
+        tilerBounds = paint_bounds(mapped, paint, &tilerStorage);
+    }
+
+    SkTLazy<SkRect> dst;
+    if (dstOrNull) {
+        dst.init(*dstOrNull);
+    }
+    this->recordTiledDraw(tilerBounds, bounds, [snap, matrix, dst, paint](const SkDraw& draw) {
+        draw.drawBitmap(snap, matrix, dst.getMaybeNull(), paint);
+    });
+}
+
+void SkThreadedBMPDevice::drawSprite(const SkBitmap& bitmap, int x, int y, const SkPaint& paint) {
+    SkBitmap snap = snap_bitmap(bitmap);
+    if (snap.drawsNothing()) {
+        return;
+    }
+    const SkIRect devBounds = SkIRect::MakeXYWH(x, y, snap.width(), snap.height());
+    this->recordDirectDraw(&devBounds, [snap, x, y, paint](const SkDraw& draw) {
+        draw.drawSprite(snap, x, y, paint);
+    });
+}
+
+void SkThreadedBMPDevice::drawVertices(const SkVertices* vertices, SkBlendMode bmode,
+                                       const SkPaint& paint) {
+    SkIRect devBounds = this->localToDevice().mapRect(vertices->bounds()).roundOut();
+    devBounds.outset(1, 1);
+    this->recordDirectDraw(&devBounds, [vertices = sk_ref_sp(vertices), bmode, paint]
+                                       (const SkDraw& draw) {
+        draw.drawVertices(vertices->mode(), vertices->vertexCount(), vertices->positions(),
+                          vertices->texCoords(), vertices->colors(),
+                          bmode, vertices->indices(), vertices->indexCount(), paint);
+    });
+}
+
+void SkThreadedBMPDevice::drawDevice(SkBaseDevice* device, int x, int y, const SkPaint& paint) {
+    SkASSERT(!paint.getImageFilter());
+    SkASSERT(!paint.getMaskFilter());
+
+    SkPixmap pm;
+    if (static_cast<SkBitmapDevice*>(device)->accessCoverage() || !device->peekPixels(&pm)) {
+        this->flush();
+        this->INHERITED::drawDevice(device, x, y, paint);
+        return;
+    }
+
+    // A layer is never drawn to again once it has been drawn into its parent, so rather than
+    // snapping its pixels we just keep the layer device alive until we've flushed.
+    SkBitmap layer;
+    layer.installPixels(pm);
+    const SkIRect devBounds = SkIRect::MakeXYWH(x, y, layer.width(), layer.height());
+    this->recordDirectDraw(&devBounds, [layer, owner = sk_ref_sp(device), x, y, paint]
+                                       (const SkDraw& draw) {
+        draw.drawSprite(layer, x, y, paint);
+    });
+}
+
+void SkThreadedBMPDevice::drawGlyphRunList(const SkGlyphRunList& glyphRunList) {
+    // Glyph runs reference transient storage and share our (single-threaded) glyph painter.
+    this->flush();
+    this->INHERITED::drawGlyphRunList(glyphRunList);
+}
+
+void SkThreadedBMPDevice::drawAtlas(const SkImage* atlas, const SkRSXform xform[],
+                                    const SkRect tex[], const SkColor colors[], int count,
+                                    SkBlendMode mode, const SkPaint& paint) {
+    this->flush();
+    this->INHERITED::drawAtlas(atlas, xform, tex, colors, count, mode, paint);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+sk_sp<SkSpecialImage> SkThreadedBMPDevice::snapSpecial(const SkIRect& bounds, bool forceCopy) {
+    this->flush();
+    return this->INHERITED::snapSpecial(bounds, forceCopy);
+}
+
+void SkThreadedBMPDevice::setImmutable() {
+    this->flush();
+    this->INHERITED::setImmutable();
+}
+
+bool SkThreadedBMPDevice::onReadPixels(const SkPixmap& pm, int x, int y) {
+    this->flush();
+    return this->INHERITED::onReadPixels(pm, x, y);
+}
+
+bool SkThreadedBMPDevice::onWritePixels(const SkPixmap& pm, int x, int y) {
+    this->flush();
+    return this->INHERITED::onWritePixels(pm, x, y);
+}
+
+bool SkThreadedBMPDevice::onPeekPixels(SkPixmap* pmap) {
+    this->flush();
+    return this->INHERITED::onPeekPixels(pmap);
+}
+
+bool SkThreadedBMPDevice::onAccessPixels(SkPixmap* pmap) {
+    this->flush();
+    return this->INHERITED::onAccessPixels(pmap);
+}
@@ -0,0 +1,112 @@
+/*
+ * Copyright 2020 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkThreadedBMPDevice_DEFINED
+#define SkThreadedBMPDevice_DEFINED
+
+#include "include/core/SkExecutor.h"
+#include "src/core/SkBitmapDevice.h"
+#include "src/core/SkRasterClip.h"
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+class SkDraw;
+
+/**
+ *  A raster device that records draws instead of executing them, and plays them back on
+ *  flush(), binned into horizontal tiles that are played concurrently on an SkExecutor.
+ *
+ *  Each recorded draw snapshots the matrix and the raster clip it was issued with, and is played
+ *  with exactly the SkDraw setup SkBitmapDevice would have used. Draws are never split: clipping
+ *  one to a tile would change how its edges are rasterized. A draw that touches a single tile is
+ *  played by that tile's task; one that touches several is played once, after all of those tiles
+ *  have caught up to it, and holds them until it's done. So the output matches the
+ *  single-threaded SkBitmapDevice pixel for pixel.
+ *
+ *  Draws that cannot be deferred safely (glyph runs, atlases, coverage-tracking layers) flush the
+ *  pending work and then draw immediately on the calling thread. All pixel access through the
+ *  device (readPixels, peekPixels, snapSpecial, ...) flushes first; callers that reach the pixels
+ *  some other way (e.g. through the SkBitmap they handed us) must call SkCanvas::flush() first.
+ */
+class SkThreadedBMPDevice : public SkBitmapDevice {
+public:
+    // When threads = 0, we use one thread per tile. Otherwise we use that many threads.
+    // When executor is nullptr, we own a thread pool. Otherwise the caller owns it, and it must
+    // outlive this device.
+    SkThreadedBMPDevice(const SkBitmap& bitmap, int tiles, int threads = 0,
+                        SkExecutor* executor = nullptr);
+    SkThreadedBMPDevice(const SkBitmap& bitmap, const SkSurfaceProps& surfaceProps, int tiles,
+                        int threads = 0, SkExecutor* executor = nullptr);
+    ~SkThreadedBMPDevice() override;
+
+    // Rasterizes all pending draws and waits for them to finish.
+    void flush() override;
+
+protected:
+    void drawPaint(const SkPaint& paint) override;
+    void drawPoints(SkCanvas::PointMode mode, size_t count,
+                    const SkPoint[], const SkPaint& paint) override;
+    void drawRect(const SkRect& r, const SkPaint& paint) override;
+    void drawRRect(const SkRRect& rr, const SkPaint& paint) override;
+    void drawPath(const SkPath&, const SkPaint&, bool pathIsMutable) override;
+    void drawSprite(const SkBitmap&, int x, int y, const SkPaint&) override;
+    void drawBitmap(const SkBitmap&, const SkMatrix&, const SkRect* dstOrNull,
+                    const SkPaint&) override;
+    void drawVertices(const SkVertices*, SkBlendMode, const SkPaint&) override;
+    void drawDevice(SkBaseDevice*, int x, int y, const SkPaint&) override;
+
+    void drawGlyphRunList(const SkGlyphRunList& glyphRunList) override;
+    void drawAtlas(const SkImage*, const SkRSXform[], const SkRect[], const SkColor[], int count,
+                   SkBlendMode, const SkPaint&) override;
+
+    sk_sp<SkSpecialImage> snapSpecial(const SkIRect&, bool forceCopy = false) override;
+    void setImmutable() override;
+
+    bool onReadPixels(const SkPixmap&, int x, int y) override;
+    bool onWritePixels(const SkPixmap&, int, int) override;
+    bool onPeekPixels(SkPixmap*) override;
+    bool onAccessPixels(SkPixmap*) override;
+
+private:
+    using DrawFn = std::function<void(const SkDraw&)>;
+
+    struct DrawElement {
+        explicit DrawElement(const SkRasterClip& rc) : fRC(rc) {}
+
+        SkMatrix     fMatrix;
+        SkRasterClip fRC;
+        // Whether SkBitmapDevice would have split this draw with SkDrawTiler (only possible on
+        // devices larger than 8K), and if so, the source bounds the tiler would have walked.
+        bool         fNeedsTiling;
+        SkIRect      fTilerBounds;
+        // Conservative device space bounds of the draw, used to bin it into our tiles. The draw
+        // must not touch pixels outside them, as tiles it doesn't touch keep playing meanwhile.
+        SkIRect      fDevBounds;
+        DrawFn       fDrawFn;
+    };
+
+    // Queues a draw that SkBitmapDevice issues through SkDrawTiler. tilerBounds are the local
+    // bounds SkBitmapDevice passes to the tiler, binBounds our best (paint-adjusted) local bounds.
+    void recordTiledDraw(const SkRect* tilerBounds, const SkRect* binBounds, DrawFn&&);
+    // Queues a draw that SkBitmapDevice issues directly on the whole device, with the given
+    // device space bounds (or the clip bounds, if devBounds is null).
+    void recordDirectDraw(const SkIRect* devBounds, DrawFn&&);
+
+    void drawElement(const DrawElement&, const SkPixmap& root) const;
+
+    const int                    fTileCnt;
+    std::unique_ptr<SkExecutor>  fInternalExecutor;
+    SkExecutor*                  fExecutor;
+    std::vector<SkIRect>         fTileBounds;
+    std::vector<DrawElement>     fQueue;
+
+    typedef SkBitmapDevice INHERITED;
+};
+
+#endif // SkThreadedBMPDevice_DEFINED
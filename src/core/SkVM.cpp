@@ -5,6 +5,7 @@
  * found in the LICENSE file.
  */
 
+#include "include/core/SkData.h"
 #include "include/core/SkStream.h"
 #include "include/core/SkString.h"
 #include "include/private/SkChecksum.h"
@@ -14,6 +15,7 @@
 #include "include/private/SkVx.h"
 #include "src/core/SkCpu.h"
 #include "src/core/SkOpts.h"
+#include "src/core/SkSharedMutex.h"
 #include "src/core/SkVM.h"
 #include <atomic>
 
@@ -47,6 +49,20 @@ bool gSkVMJITViaDylib{false};
 
 namespace skvm {
 
+    static std::atomic<JITCache*> gJITCache{nullptr};
+
+    // Held shared while a Program uses gJITCache, and exclusively to change it, so that a cache
+    // is no longer in use once SetJITCache() has replaced it.
+    static SkSharedMutex& jit_cache_lock() {
+        static SkSharedMutex* lock = new SkSharedMutex;
+        return *lock;
+    }
+
+    void SetJITCache(JITCache* cache) {
+        SkAutoSharedMutexExclusive lock(jit_cache_lock());
+        gJITCache.store(cache);
+    }
+
     struct Program::Impl {
         std::vector<Instruction> instructions;
         int                      regs = 0;
@@ -838,6 +854,9 @@ namespace skvm {
     I32 Builder::select(I32 x, I32 y, I32 z) {
         int X,Y,Z;
         if (this->allImm(x.id,&X, y.id,&Y, z.id,&Z)) { return this->splat(X?Y:Z); }
+        if (this->isImm(x.id,~0)) { return y; }   // (true  ? y : z) == y
+        if (this->isImm(x.id, 0)) { return z; }   // (false ? y : z) == z
+        if (y.id == z.id) { return y; }            // (x ? y : y) == y
         // TODO: some cases to reduce to bit_and when y == 0 or z == 0?
         return {this->push(Op::select, x.id, y.id, z.id)};
     }
@@ -988,6 +1007,27 @@ namespace skvm {
     }
 
 
+    // Pack x86 opcode map selector to 5-bit VEX (or 2-bit EVEX) encoding.
+    static int vex_map(int map) {
+        switch (map) {
+            case   0x0f: return 0b00001;
+            case 0x380f: return 0b00010;
+            case 0x3a0f: return 0b00011;
+            // Several more cases only used by XOP / TBM.
+        }
+        SkUNREACHABLE;
+    }
+
+    // Pack mandatory SSE opcode prefix byte to 2-bit VEX (and EVEX) encoding.
+    static int vex_pp(int pp) {
+        switch (pp) {
+            case 0x66: return 0b01;
+            case 0xf3: return 0b10;
+            case 0xf2: return 0b11;
+        }
+        return 0b00;
+    }
+
     // The VEX prefix extends SSE operations to AVX.  Used generally, even with XMM.
     struct VEX {
         int     len;
@@ -1003,26 +1043,8 @@ namespace skvm {
                    bool   L,   // Set for 256-bit ymm operations, off for 128-bit xmm.
                    int   pp) { // SSE mandatory prefix: 0x66, 0xf3, 0xf2, else none.
 
-        // Pack x86 opcode map selector to 5-bit VEX encoding.
-        map = [map]{
-            switch (map) {
-                case   0x0f: return 0b00001;
-                case 0x380f: return 0b00010;
-                case 0x3a0f: return 0b00011;
-                // Several more cases only used by XOP / TBM.
-            }
-            SkUNREACHABLE;
-        }();
-
-        // Pack  mandatory SSE opcode prefix byte to 2-bit VEX encoding.
-        pp = [pp]{
-            switch (pp) {
-                case 0x66: return 0b01;
-                case 0xf3: return 0b10;
-                case 0xf2: return 0b11;
-            }
-            return 0b00;
-        }();
+        map = vex_map(map);
+        pp  = vex_pp (pp);
 
         VEX vex = {0, {0,0,0}};
         if (X == 0 && B == 0 && WE == 0 && map == 0b00001) {
@@ -1049,6 +1071,38 @@ namespace skvm {
         return vex;
     }
 
+    // The EVEX prefix extends AVX to AVX-512: 512-bit zmm registers and opmask registers.
+    // We only use zmm0-zmm15, so the high register bits R' and V' are always left off, and
+    // we don't use embedded broadcast, embedded rounding, or zeroing-masking.
+    struct EVEX {
+        uint8_t bytes[4];
+    };
+
+    static EVEX evex(bool    W,   // Like VEX WE.
+                     bool    R,   // Same as VEX R.
+                     bool    X,   // Same as VEX X.
+                     bool    B,   // Same as VEX B.
+                     int   map,   // Same as VEX.
+                     int  vvvv,   // Same as VEX.
+                     int    pp,   // Same as VEX.
+                     int   aaa) { // Opmask register, k1-k7, or 0 for no masking.
+        EVEX evex;
+        evex.bytes[0] = 0x62;
+        evex.bytes[1] = (vex_map(map) &  3) << 0
+                      | 1                   << 4   // ~R', off.
+                      | (~(int)B      &  1) << 5
+                      | (~(int)X      &  1) << 6
+                      | (~(int)R      &  1) << 7;
+        evex.bytes[2] = (vex_pp(pp)   &  3) << 0
+                      | 1                   << 2   // Fixed 1.
+                      | (~vvvv        & 15) << 3
+                      | (W            &  1) << 7;
+        evex.bytes[3] = (aaa          &  7) << 0
+                      | 1                   << 3   // ~V', off.
+                      | 0b10                << 5;  // L'L, 512-bit zmm operations.
+        return evex;
+    }
+
     Assembler::Assembler(void* buf) : fCode((uint8_t*)buf), fCurr(fCode), fSize(0) {}
 
     size_t Assembler::size() const { return fSize; }
@@ -1109,6 +1163,34 @@ namespace skvm {
         this->bytes(&off, imm_bytes(mod(off)));
     }
 
+    void Assembler::movl(GP64 dst, GP64 src, int off) {
+        if ((dst>>3) || (src>>3)) {
+            this->byte(rex(0,dst>>3,0,src>>3));
+        }
+        this->byte(0x8b);
+        this->byte(mod_rm(mod(off), dst&7, src&7));
+        this->bytes(&off, imm_bytes(mod(off)));
+    }
+
+    void Assembler::movq(GP64 dst, GP64 src) {
+        this->byte(rex(1,src>>3,0,dst>>3));
+        this->byte(0x89);
+        this->byte(mod_rm(Mod::Direct, src&7, dst&7));
+    }
+
+    void Assembler::push(GP64 reg) {
+        if (reg>>3) {
+            this->byte(rex(0,0,0,1));
+        }
+        this->byte(0x50 | (reg&7));
+    }
+    void Assembler::pop(GP64 reg) {
+        if (reg>>3) {
+            this->byte(rex(0,0,0,1));
+        }
+        this->byte(0x58 | (reg&7));
+    }
+
     void Assembler::op(int prefix, int map, int opcode, Ymm dst, Ymm x, Ymm y, bool W/*=false*/) {
         VEX v = vex(W, dst>>3, 0, y>>3,
                     map, x, 1/*ymm, not xmm*/, prefix);
@@ -1451,6 +1533,161 @@ namespace skvm {
         this->byte(sib(scale, ix&7, base&7));
     }
 
+    void Assembler::op(int prefix, int map, int opcode, Zmm dst, Zmm x, Zmm y, bool W/*=false*/) {
+        EVEX e = evex(W, dst>>3, 0, y>>3,
+                      map, x, prefix, 0);
+        this->bytes(e.bytes, sizeof(e.bytes));
+        this->byte(opcode);
+        this->byte(mod_rm(Mod::Direct, dst&7, y&7));
+    }
+
+    void Assembler::op(int prefix, int map, int opcode, Zmm dst, Zmm x, Label* l) {
+        // IP-relative addressing works just like it does for VEX above.  EVEX compresses 8-bit
+        // displacements (disp8*N) but never 32-bit ones, so disp32() needs no adjustment.
+        const int rip = rbp;
+
+        EVEX e = evex(0, dst>>3, 0, rip>>3,
+                      map, x, prefix, 0);
+        this->bytes(e.bytes, sizeof(e.bytes));
+        this->byte(opcode);
+        this->byte(mod_rm(Mod::Indirect, dst&7, rip&7));
+        this->word(this->disp32(l));
+    }
+
+    void Assembler::op(int prefix, int map, int opcode, Zmm dst, Zmm x, ZmmOrLabel y) {
+        y.label ? this->op(prefix,map,opcode,dst,x, y.label)
+                : this->op(prefix,map,opcode,dst,x, y.zmm  );
+    }
+
+    // dst = x op /opcode_ext imm
+    void Assembler::op(int prefix, int map, int opcode, int opcode_ext, Zmm dst, Zmm x, int imm) {
+        // Same trick as the VEX version above.
+        this->op(prefix, map, opcode, (Zmm)opcode_ext,dst,x);
+        this->byte(imm);
+    }
+
+    void Assembler::load_store(int prefix, int map, int opcode, Zmm zmm, GP64 ptr) {
+        EVEX e = evex(0, zmm>>3, 0, ptr>>3,
+                      map, 0, prefix, 0);
+        this->bytes(e.bytes, sizeof(e.bytes));
+        this->byte(opcode);
+        this->byte(mod_rm(Mod::Indirect, zmm&7, ptr&7));
+    }
+
+    void Assembler::vpaddd (Zmm dst, Zmm x, ZmmOrLabel y) { this->op(0x66,  0x0f,0xfe, dst,x,y); }
+    void Assembler::vpsubd (Zmm dst, Zmm x, ZmmOrLabel y) { this->op(0x66,  0x0f,0xfa, dst,x,y); }
+    void Assembler::vpmulld(Zmm dst, Zmm x, Zmm        y) { this->op(0x66,0x380f,0x40, dst,x,y); }
+
+    void Assembler::vpsubw (Zmm dst, Zmm x, Zmm y) { this->op(0x66,0x0f,0xf9, dst,x,y); }
+    void Assembler::vpmullw(Zmm dst, Zmm x, Zmm y) { this->op(0x66,0x0f,0xd5, dst,x,y); }
+
+    void Assembler::vpandd (Zmm dst, Zmm x, ZmmOrLabel y) { this->op(0x66,0x0f,0xdb, dst,x,y); }
+    void Assembler::vpord  (Zmm dst, Zmm x, ZmmOrLabel y) { this->op(0x66,0x0f,0xeb, dst,x,y); }
+    void Assembler::vpxord (Zmm dst, Zmm x, ZmmOrLabel y) { this->op(0x66,0x0f,0xef, dst,x,y); }
+    void Assembler::vpandnd(Zmm dst, Zmm x, Zmm        y) { this->op(0x66,0x0f,0xdf, dst,x,y); }
+
+    void Assembler::vaddps(Zmm dst, Zmm x, ZmmOrLabel y) { this->op(0,0x0f,0x58, dst,x,y); }
+    void Assembler::vsubps(Zmm dst, Zmm x, ZmmOrLabel y) { this->op(0,0x0f,0x5c, dst,x,y); }
+    void Assembler::vmulps(Zmm dst, Zmm x, ZmmOrLabel y) { this->op(0,0x0f,0x59, dst,x,y); }
+    void Assembler::vdivps(Zmm dst, Zmm x, Zmm        y) { this->op(0,0x0f,0x5e, dst,x,y); }
+    void Assembler::vminps(Zmm dst, Zmm x, ZmmOrLabel y) { this->op(0,0x0f,0x5d, dst,x,y); }
+    void Assembler::vmaxps(Zmm dst, Zmm x, ZmmOrLabel y) { this->op(0,0x0f,0x5f, dst,x,y); }
+
+    void Assembler::vfmadd132ps(Zmm dst, Zmm x, Zmm y) { this->op(0x66,0x380f,0x98, dst,x,y); }
+    void Assembler::vfmadd213ps(Zmm dst, Zmm x, Zmm y) { this->op(0x66,0x380f,0xa8, dst,x,y); }
+    void Assembler::vfmadd231ps(Zmm dst, Zmm x, Zmm y) { this->op(0x66,0x380f,0xb8, dst,x,y); }
+
+    void Assembler::vpcmpeqd(Mask dst, Zmm x, ZmmOrLabel y) {
+        this->op(0x66,0x0f,0x76, (Zmm)dst,x,y);
+    }
+    void Assembler::vpcmpgtd(Mask dst, Zmm x, Zmm y) { this->op(0x66,0x0f,0x66, (Zmm)dst,x,y); }
+
+    void Assembler::vcmpps(Mask dst, Zmm x, Zmm y, int imm) {
+        this->op(0,0x0f,0xc2, (Zmm)dst,x,y);
+        this->byte(imm);
+    }
+
+    void Assembler::vpmovm2d(Zmm dst, Mask src) {
+        this->op(0xf3,0x380f,0x38, dst,(Zmm)0,(Zmm)src);
+    }
+
+    // The opmask instructions are plain VEX, and always work on whole mask registers.
+    void Assembler::kxnorw(Mask dst, Mask x, Mask y) {
+        VEX v = vex(0, 0, 0, 0,
+                    0x0f, x, /*L*/1, 0);
+        this->bytes(v.bytes, v.len);
+        this->byte(0x46);
+        this->byte(mod_rm(Mod::Direct, dst, y));
+    }
+    void Assembler::kortestw(Mask x, Mask y) {
+        VEX v = vex(0, 0, 0, 0,
+                    0x0f, 0, /*L*/0, 0);
+        this->bytes(v.bytes, v.len);
+        this->byte(0x98);
+        this->byte(mod_rm(Mod::Direct, x, y));
+    }
+
+    void Assembler::vpternlogd(Zmm dst, Zmm x, Zmm y, int imm) {
+        this->op(0x66,0x3a0f,0x25, dst,x,y);
+        this->byte(imm);
+    }
+
+    void Assembler::vpslld(Zmm dst, Zmm x, int imm) { this->op(0x66,0x0f,0x72,6, dst,x,imm); }
+    void Assembler::vpsrld(Zmm dst, Zmm x, int imm) { this->op(0x66,0x0f,0x72,2, dst,x,imm); }
+    void Assembler::vpsrad(Zmm dst, Zmm x, int imm) { this->op(0x66,0x0f,0x72,4, dst,x,imm); }
+
+    void Assembler::vpsrlw(Zmm dst, Zmm x, int imm) { this->op(0x66,0x0f,0x71,2, dst,x,imm); }
+
+    void Assembler::vrndscaleps(Zmm dst, Zmm x, int imm) {
+        this->op(0x66,0x3a0f,0x08, dst,(Zmm)0,x);
+        this->byte(imm);
+    }
+
+    void Assembler::vmovdqa32 (Zmm dst, Zmm x) { this->op(0x66,0x0f,0x6f, dst,(Zmm)0,x); }
+    void Assembler::vcvtdq2ps (Zmm dst, Zmm x) { this->op(   0,0x0f,0x5b, dst,(Zmm)0,x); }
+    void Assembler::vcvttps2dq(Zmm dst, Zmm x) { this->op(0xf3,0x0f,0x5b, dst,(Zmm)0,x); }
+    void Assembler::vsqrtps   (Zmm dst, Zmm x) { this->op(   0,0x0f,0x51, dst,(Zmm)0,x); }
+
+    void Assembler::vpshufb(Zmm dst, Zmm x, Label* l) { this->op(0x66,0x380f,0x00, dst,x,l); }
+
+    void Assembler::vbroadcastss(Zmm dst, Label* l) { this->op(0x66,0x380f,0x18, dst,(Zmm)0,l); }
+    void Assembler::vbroadcastss(Zmm dst, Xmm src) {
+        this->op(0x66,0x380f,0x18, dst,(Zmm)0,(Zmm)src);
+    }
+    void Assembler::vbroadcastss(Zmm dst, GP64 ptr, int off) {
+        EVEX e = evex(0, dst>>3, 0, ptr>>3,
+                      0x380f, 0, 0x66, 0);
+        this->bytes(e.bytes, sizeof(e.bytes));
+        this->byte(0x18);
+
+        // An 8-bit displacement would be scaled by the 4-byte element size (disp8*N),
+        // so we keep things simple and use a 32-bit displacement for any non-zero offset.
+        Mod m = off ? Mod::FourByteImm : Mod::Indirect;
+        this->byte(mod_rm(m, dst&7, ptr&7));
+        this->bytes(&off, imm_bytes(m));
+    }
+
+    void Assembler::vmovups  (Zmm dst, GP64 src) { this->load_store(0   ,  0x0f,0x10, dst,src); }
+    void Assembler::vpmovzxwd(Zmm dst, GP64 src) { this->load_store(0x66,0x380f,0x33, dst,src); }
+    void Assembler::vpmovzxbd(Zmm dst, GP64 src) { this->load_store(0x66,0x380f,0x31, dst,src); }
+
+    void Assembler::vmovups(GP64 dst, Zmm src) { this->load_store(0   ,  0x0f,0x11, src,dst); }
+    void Assembler::vpmovdw(GP64 dst, Zmm src) { this->load_store(0xf3,0x380f,0x33, src,dst); }
+    void Assembler::vpmovdb(GP64 dst, Zmm src) { this->load_store(0xf3,0x380f,0x31, src,dst); }
+
+    void Assembler::vgatherdps(Zmm dst, Scale scale, Zmm ix, GP64 base, Mask mask) {
+        // As with the VEX version, dst may not alias ix.  The mask must not be k0 (no mask).
+        SkASSERT(dst != ix);
+        SkASSERT(mask != k0);
+
+        EVEX e = evex(0, dst>>3, ix>>3, base>>3,
+                      0x380f, 0, 0x66, mask);
+        this->bytes(e.bytes, sizeof(e.bytes));
+        this->byte(0x92);
+        this->byte(mod_rm(Mod::Indirect, dst&7, rsp));
+        this->byte(sib(scale, ix&7, base&7));
+    }
+
     // https://static.docs.arm.com/ddi0596/a/DDI_0596_ARM_a64_instruction_set_architecture.pdf
 
     static int operator"" _mask(unsigned long long bits) { return (1<<(int)bits)-1; }
@@ -1593,6 +1830,21 @@ namespace skvm {
                   | (dst & 5_mask)                  << 0);
     }
 
+    void Assembler::ldrd(X dst, X src, int off) {
+        SkASSERT(off % 8 == 0);
+        this->word( 0b11'111'0'01'01        << 22
+                  | ((off/8) & 12_mask) << 10
+                  | (src     &  5_mask) <<  5
+                  | (dst     &  5_mask) <<  0);
+    }
+    void Assembler::ldrs(X dst, X src, int off) {
+        SkASSERT(off % 4 == 0);
+        this->word( 0b10'111'0'01'01        << 22
+                  | ((off/4) & 12_mask) << 10
+                  | (src     &  5_mask) <<  5
+                  | (dst     &  5_mask) <<  0);
+    }
+
     void Assembler::ldrq(V dst, Label* l) {
         const int imm19 = this->disp19(l);
         this->word( 0b10'011'1'00     << 24
@@ -1664,6 +1916,7 @@ namespace skvm {
             jits++;
             fast += n;
     #endif
+        #if defined(SKVM_LLVM)
             void** a = args;
             switch (fImpl->strides.size()) {
                 case 0: return ((void(*)(int                        ))b)(n                    );
@@ -1673,14 +1926,32 @@ namespace skvm {
                 case 4: return ((void(*)(int,void*,void*,void*,void*))b)(n,a[0],a[1],a[2],a[3]);
                 case 5: return ((void(*)(int,void*,void*,void*,void*,void*))b)
                                 (n,a[0],a[1],a[2],a[3],a[4]);
+                case 6: return ((void(*)(int,void*,void*,void*,void*,void*,void*))b)
+                                (n,a[0],a[1],a[2],a[3],a[4],a[5]);
                 default: SkUNREACHABLE;  // TODO
             }
+        #else
+            // Our own JIT'd code always takes a list of spans; this is just a list of one.
+            const Span span = {n, args};
+            return ((void(*)(int, const Span*))b)(1, &span);
+        #endif
         }
 
         // So we'll sometimes use the interpreter here even if later calls will use the JIT.
         this->interpret(n, args);
     }
 
+    void Program::evalSpans(const Span spans[], int nspans) const {
+    #if !defined(SKVM_LLVM)
+        if (const void* b = fImpl->jit_entry.load()) {
+            return ((void(*)(int, const Span*))b)(nspans, spans);
+        }
+    #endif
+        for (int i = 0; i < nspans; i++) {
+            this->eval(spans[i].n, spans[i].args);
+        }
+    }
+
     void Program::interpret(int n, void* args[]) const {
         // We'll operate in SIMT style, knocking off K-size chunks from n while possible.
         constexpr int K = 16;
@@ -2595,16 +2866,28 @@ namespace skvm {
         A::GP64 N        = A::rdi,
                 scratch  = A::rax,
                 scratch2 = A::r11,
-                arg[]    = { A::rsi, A::rdx, A::rcx, A::r8, A::r9 };
+                arg[]    = { A::rsi, A::rdx, A::rcx, A::r8, A::r9, A::r10 };
+
+        // We're called as void(int nspans, const Program::Span spans[]), and walk the spans
+        // with these two callee-saved registers, preserved on the stack.
+        A::GP64 span  = A::rbx,
+                spans = A::rbp;
 
         // All 16 ymm registers are available to use.
         using Reg = A::Ymm;
         uint32_t avail = 0xffff;
 
+        // With AVX-512 we run the main loop 16 lanes at a time in zmm registers.  zmm0-zmm15
+        // alias ymm0-ymm15, so we allocate them just the same, and the scalar tail loop is
+        // unchanged.  Opmask k1 holds comparison results and gather masks between instructions.
+        const bool zmm = SkCpu::Supports(SkCpu::SKX);
+
     #elif defined(__aarch64__)
         A::X N       = A::x0,
              scratch = A::x8,
-             arg[]   = { A::x1, A::x2, A::x3, A::x4, A::x5, A::x6, A::x7 };
+             arg[]   = { A::x1, A::x2, A::x3, A::x4, A::x5, A::x6, A::x7 },
+             span    = A::x9,    // As on x86, we're called with nspans in x0, spans in x1.
+             spans   = A::x10;
 
         // We can use v0-v7 and v16-v31 freely; we'd need to preserve v8-v15.
         using Reg = A::V;
@@ -2617,6 +2900,19 @@ namespace skvm {
 
         auto hoisted = [&](Val id) { return try_hoisting && instructions[id].can_hoist; };
 
+        // Hoisted values that depend on uniforms are recomputed for each span, as each span
+        // may have its own uniforms.  Constants and the math on them are computed only once.
+        std::vector<bool> per_span(instructions.size());
+        for (Val id = 0; id < (Val)instructions.size(); id++) {
+            const OptimizedInstruction& inst = instructions[id];
+            per_span[id] = inst.op == Op::uniform8
+                        || inst.op == Op::uniform16
+                        || inst.op == Op::uniform32
+                        || (inst.x != NA && per_span[inst.x])
+                        || (inst.y != NA && per_span[inst.y])
+                        || (inst.z != NA && per_span[inst.z]);
+        }
+
         std::vector<Reg> r(instructions.size());
 
         struct LabelAndReg {
@@ -2708,7 +3004,8 @@ namespace skvm {
             auto maybe_recycle_register = [&](Val input) {
                 if (input != NA
                         && instructions[input].death == id
-                        && !(hoisted(input) && instructions[input].used_in_loop)) {
+                        && !(hoisted(input) && instructions[input].used_in_loop)
+                        && !(hoisted(input) && !per_span[input] && per_span[id])) {
                     avail |= 1 << r[input];
                 }
             };
@@ -2754,6 +3051,165 @@ namespace skvm {
             // just laid out hooks for how to do so if we need them, depending on the instruction.
             //
             // Now let's actually assemble the instruction!
+        #if defined(__x86_64__)
+            if (zmm && !scalar) {
+                auto zr   = [&](Val v) { return (A::Zmm)r[v]; };
+                auto zdst = [&]        { return (A::Zmm)dst(); };
+                auto ztmp = [&]        { return (A::Zmm)tmp(); };
+
+                switch (op) {
+                    default:
+                        if (debug_dump()) {
+                            SkDEBUGFAILF("\nOp::%s (%d) not yet implemented\n", name(op), op);
+                        }
+                        return false;
+
+                    case Op::assert_true: {
+                        a->vpcmpeqd(A::k1, zr(x), &constants[0xffffffff].label);
+                        a->kortestw(A::k1, A::k1);
+                        A::Label all_true;
+                        a->jc(&all_true);
+                        a->int3();
+                        a->label(&all_true);
+                    } break;
+
+                    case Op::store8 : a->vpmovdb(arg[immy], zr(x)); break;
+                    case Op::store16: a->vpmovdw(arg[immy], zr(x)); break;
+                    case Op::store32: a->vmovups(arg[immy], zr(x)); break;
+
+                    case Op::load8 : a->vpmovzxbd(zdst(), arg[immy]); break;
+                    case Op::load16: a->vpmovzxwd(zdst(), arg[immy]); break;
+                    case Op::load32: a->vmovups  (zdst(), arg[immy]); break;
+
+                    case Op::gather32: {
+                        // As with ymm, dst() may not overlap index, but the mask now lives in k1.
+                        A::Ymm index = r[x];
+                        if (int found = __builtin_ffs(avail & ~(1<<index))) {
+                            set_dst((A::Ymm)(found-1));
+                        } else {
+                            ok = false;
+                            break;
+                        }
+                        auto base = scratch;
+                        a->movq(base, arg[immy], immz);
+                        a->kxnorw(A::k1, A::k1, A::k1);   // (All lanes enabled.)
+                        a->vgatherdps(zdst(), A::FOUR, zr(x), base, A::k1);
+                    } break;
+
+                    case Op::uniform8: a->movzbl(scratch, arg[immy], immz);
+                                       a->vmovd_direct((A::Xmm)dst(), scratch);
+                                       a->vbroadcastss(zdst(), (A::Xmm)dst());
+                                       break;
+
+                    case Op::uniform32: a->vbroadcastss(zdst(), arg[immy], immz);
+                                        break;
+
+                    case Op::index: a->vmovd_direct((A::Xmm)tmp(), N);
+                                    a->vbroadcastss(ztmp(), (A::Xmm)tmp());
+                                    a->vpsubd(zdst(), ztmp(), &iota.label);
+                                    break;
+
+                    case Op::splat: if (immy) { a->vbroadcastss(zdst(), &constants[immy].label); }
+                                    else      { a->vpxord(zdst(), zdst(), zdst()); }
+                                    break;
+
+                    case Op::add_f32: a->vaddps(zdst(), zr(x), zr(y)); break;
+                    case Op::sub_f32: a->vsubps(zdst(), zr(x), zr(y)); break;
+                    case Op::mul_f32: a->vmulps(zdst(), zr(x), zr(y)); break;
+                    case Op::div_f32: a->vdivps(zdst(), zr(x), zr(y)); break;
+                    case Op::min_f32: a->vminps(zdst(), zr(x), zr(y)); break;
+                    case Op::max_f32: a->vmaxps(zdst(), zr(x), zr(y)); break;
+
+                    case Op::fma_f32:
+                        if      (avail & (1<<r[x])) { set_dst(r[x]);
+                                                      a->vfmadd132ps(zr(x), zr(z), zr(y)); }
+                        else if (avail & (1<<r[y])) { set_dst(r[y]);
+                                                      a->vfmadd213ps(zr(y), zr(x), zr(z)); }
+                        else if (avail & (1<<r[z])) { set_dst(r[z]);
+                                                      a->vfmadd231ps(zr(z), zr(x), zr(y)); }
+                        else                        { SkASSERT(dst() == tmp());
+                                                      a->vmovdqa32  (zdst(), zr(x));
+                                                      a->vfmadd132ps(zdst(), zr(z), zr(y)); }
+                                                      break;
+
+                    case Op::sqrt_f32: a->vsqrtps(zdst(), zr(x)); break;
+
+                    case Op::add_f32_imm: a->vaddps(zdst(), zr(x), &constants[immy].label); break;
+                    case Op::sub_f32_imm: a->vsubps(zdst(), zr(x), &constants[immy].label); break;
+                    case Op::mul_f32_imm: a->vmulps(zdst(), zr(x), &constants[immy].label); break;
+                    case Op::min_f32_imm: a->vminps(zdst(), zr(x), &constants[immy].label); break;
+                    case Op::max_f32_imm: a->vmaxps(zdst(), zr(x), &constants[immy].label); break;
+
+                    case Op::add_i32: a->vpaddd (zdst(), zr(x), zr(y)); break;
+                    case Op::sub_i32: a->vpsubd (zdst(), zr(x), zr(y)); break;
+                    case Op::mul_i32: a->vpmulld(zdst(), zr(x), zr(y)); break;
+
+                    case Op::sub_i16x2: a->vpsubw (zdst(), zr(x), zr(y)); break;
+                    case Op::mul_i16x2: a->vpmullw(zdst(), zr(x), zr(y)); break;
+                    case Op::shr_i16x2: a->vpsrlw (zdst(), zr(x), immy); break;
+
+                    case Op::bit_and  : a->vpandd (zdst(), zr(x), zr(y)); break;
+                    case Op::bit_or   : a->vpord  (zdst(), zr(x), zr(y)); break;
+                    case Op::bit_xor  : a->vpxord (zdst(), zr(x), zr(y)); break;
+                    case Op::bit_clear: a->vpandnd(zdst(), zr(y), zr(x)); break;  // N.B. Y then X.
+
+                    // vpternlogd overwrites one of its inputs, so like fma_f32 we'd like to
+                    // reuse whichever input dies here, picking the truth table to match.
+                    case Op::select:
+                        if      (avail & (1<<r[x])) { set_dst(r[x]);
+                                                      a->vpternlogd(zr(x), zr(y), zr(z), 0xca); }
+                        else if (avail & (1<<r[y])) { set_dst(r[y]);
+                                                      a->vpternlogd(zr(y), zr(x), zr(z), 0xe2); }
+                        else if (avail & (1<<r[z])) { set_dst(r[z]);
+                                                      a->vpternlogd(zr(z), zr(x), zr(y), 0xb8); }
+                        else                        { SkASSERT(dst() == tmp());
+                                                      a->vmovdqa32 (zdst(), zr(x));
+                                                      a->vpternlogd(zdst(), zr(y), zr(z), 0xca); }
+                                                      break;
+
+                    case Op::bit_and_imm: a->vpandd(zdst(), zr(x), &constants[immy].label); break;
+                    case Op::bit_or_imm : a->vpord (zdst(), zr(x), &constants[immy].label); break;
+                    case Op::bit_xor_imm: a->vpxord(zdst(), zr(x), &constants[immy].label); break;
+
+                    case Op::shl_i32: a->vpslld(zdst(), zr(x), immy); break;
+                    case Op::shr_i32: a->vpsrld(zdst(), zr(x), immy); break;
+                    case Op::sra_i32: a->vpsrad(zdst(), zr(x), immy); break;
+
+                    case Op::eq_i32: a->vpcmpeqd(A::k1, zr(x), zr(y));
+                                     a->vpmovm2d(zdst(), A::k1);
+                                     break;
+                    case Op::gt_i32: a->vpcmpgtd(A::k1, zr(x), zr(y));
+                                     a->vpmovm2d(zdst(), A::k1);
+                                     break;
+
+                    case Op:: eq_f32: a->vcmpeqps (A::k1, zr(x), zr(y));
+                                      a->vpmovm2d (zdst(), A::k1);
+                                      break;
+                    case Op::neq_f32: a->vcmpneqps(A::k1, zr(x), zr(y));
+                                      a->vpmovm2d (zdst(), A::k1);
+                                      break;
+                    case Op:: gt_f32: a->vcmpltps (A::k1, zr(y), zr(x));
+                                      a->vpmovm2d (zdst(), A::k1);
+                                      break;
+                    case Op::gte_f32: a->vcmpleps (A::k1, zr(y), zr(x));
+                                      a->vpmovm2d (zdst(), A::k1);
+                                      break;
+
+                    case Op::pack: a->vpslld(ztmp(),  zr(y), immz);
+                                   a->vpord (zdst(), ztmp(), zr(x));
+                                   break;
+
+                    case Op::floor : a->vrndscaleps(zdst(), zr(x), Assembler::FLOOR); break;
+                    case Op::to_f32: a->vcvtdq2ps  (zdst(), zr(x)); break;
+                    case Op::trunc : a->vcvttps2dq (zdst(), zr(x)); break;
+
+                    case Op::bytes: a->vpshufb(zdst(), zr(x), &bytes_masks.find(immy)->label);
+                                    break;
+                }
+                return ok;
+            }
+        #endif
+
             switch (op) {
                 default:
                     if (debug_dump()) {
@@ -3053,14 +3509,32 @@ namespace skvm {
 
 
         #if defined(__x86_64__)
-            const int K = 8;
+            const int K = zmm ? 16 : 8;
             auto jump_if_less = [&](A::Label* l) { a->jl (l); };
             auto jump         = [&](A::Label* l) { a->jmp(l); };
 
             auto add = [&](A::GP64 gp, int imm) { a->add(gp, imm); };
             auto sub = [&](A::GP64 gp, int imm) { a->sub(gp, imm); };
 
-            auto exit = [&]{ a->vzeroupper(); a->ret(); };
+            auto enter = [&]{
+                a->push(span);
+                a->push(spans);
+                a->movq(span,  arg[0]);
+                a->movq(spans, N);
+            };
+            auto load_span = [&]{
+                a->movl(N,       span, (int)offsetof(Span, n));
+                a->movq(scratch, span, (int)offsetof(Span, args));
+                for (int i = 0; i < (int)fImpl->strides.size(); i++) {
+                    a->movq(arg[i], scratch, i*(int)sizeof(void*));
+                }
+            };
+            auto exit = [&]{
+                a->pop(spans);
+                a->pop(span);
+                a->vzeroupper();
+                a->ret();
+            };
         #elif defined(__aarch64__)
             const int K = 4;
             auto jump_if_less = [&](A::Label* l) { a->blt(l); };
@@ -3069,22 +3543,48 @@ namespace skvm {
             auto add = [&](A::X gp, int imm) { a->add(gp, gp, imm); };
             auto sub = [&](A::X gp, int imm) { a->sub(gp, gp, imm); };
 
+            auto enter = [&]{
+                a->add(span,  arg[0], 0);
+                a->add(spans, N,      0);
+            };
+            auto load_span = [&]{
+                a->ldrs(N,       span, (int)offsetof(Span, n));
+                a->ldrd(scratch, span, (int)offsetof(Span, args));
+                for (int i = 0; i < (int)fImpl->strides.size(); i++) {
+                    a->ldrd(arg[i], scratch, i*(int)sizeof(void*));
+                }
+            };
             auto exit = [&]{ a->ret(A::x30); };
         #endif
 
-        A::Label body,
+        A::Label next_span,
+                 body,
                  tail,
+                 span_done,
                  done;
 
+        enter();
         for (Val id = 0; id < (Val)instructions.size(); id++) {
             if (!warmup(id)) {
                 return false;
             }
-            if (hoisted(id) && !emit(id, /*scalar=*/false)) {
+            if (hoisted(id) && !per_span[id] && !emit(id, /*scalar=*/false)) {
                 return false;
             }
         }
 
+        a->label(&next_span);
+        {
+            a->cmp(spans, 1);
+            jump_if_less(&done);
+            load_span();
+            for (Val id = 0; id < (Val)instructions.size(); id++) {
+                if (hoisted(id) && per_span[id] && !emit(id, /*scalar=*/false)) {
+                    return false;
+                }
+            }
+        }
+
         a->label(&body);
         {
             a->cmp(N, K);
@@ -3106,7 +3606,7 @@ namespace skvm {
         a->label(&tail);
         {
             a->cmp(N, 1);
-            jump_if_less(&done);
+            jump_if_less(&span_done);
             for (Val id = 0; id < (Val)instructions.size(); id++) {
                 if (!hoisted(id) && !emit(id, /*scalar=*/true)) {
                     return false;
@@ -3121,6 +3621,13 @@ namespace skvm {
             jump(&tail);
         }
 
+        a->label(&span_done);
+        {
+            add(span, (int)sizeof(Span));
+            sub(spans, 1);
+            jump(&next_span);
+        }
+
         a->label(&done);
         {
             exit();
@@ -3140,15 +3647,15 @@ namespace skvm {
         });
 
         bytes_masks.foreach([&](int imm, LabelAndReg* entry) {
-            // One 16-byte pattern for ARM tbl, that same pattern twice for x86-64 vpshufb.
+            // One 16-byte pattern for ARM tbl, that same pattern repeated for each 128-bit lane
+            // of x86-64 vpshufb, twice for ymm or four times for zmm.
             a->align(4);
             a->label(&entry->label);
             int mask[4];
             bytes_control(imm, mask);
-            a->bytes(mask, sizeof(mask));
-        #if defined(__x86_64__)
-            a->bytes(mask, sizeof(mask));
-        #endif
+            for (int i = 0; i < K/4; i++) {
+                a->bytes(mask, sizeof(mask));
+            }
         });
 
         if (!iota.label.references.empty()) {
@@ -3162,35 +3669,96 @@ namespace skvm {
         return true;
     }
 
+    // Bump this whenever jit() changes the code it generates for the same instructions.
+    static constexpr int kJITCacheVersion = 2;
+
+    static sk_sp<SkData> jit_cache_key(const std::vector<OptimizedInstruction>& instructions,
+                                       const std::vector<int>& strides) {
+        // The JIT'd code depends on the instruction set we targeted,
+        // and on every field of every instruction, including their liveness.
+        int cpu = 0;
+    #if defined(__x86_64__)
+        cpu = 0x100 | (SkCpu::Supports(SkCpu::HSW) ? 1 : 0)
+                    | (SkCpu::Supports(SkCpu::SKX) ? 2 : 0);
+    #elif defined(__aarch64__)
+        cpu = 0x200;
+    #endif
+
+        std::vector<int> key;
+        key.reserve(4 + strides.size() + 9*instructions.size());
+        key.push_back(kJITCacheVersion);
+        key.push_back(cpu);
+        key.push_back((int)strides.size());
+        key.insert(key.end(), strides.begin(), strides.end());
+        key.push_back((int)instructions.size());
+        for (const OptimizedInstruction& inst : instructions) {
+            key.push_back((int)inst.op);
+            key.push_back(inst.x);
+            key.push_back(inst.y);
+            key.push_back(inst.z);
+            key.push_back(inst.immy);
+            key.push_back(inst.immz);
+            key.push_back(inst.death);
+            key.push_back(inst.can_hoist);
+            key.push_back(inst.used_in_loop);
+        }
+        return SkData::MakeWithCopy(key.data(), key.size() * sizeof(int));
+    }
+
     void Program::setupJIT(const std::vector<OptimizedInstruction>& instructions,
                            const char* debug_name) {
+        // If we've JIT'd this exact program before, we can just copy that code.
+        SkAutoSharedMutexShared lock(jit_cache_lock());
+        JITCache* cache = gJITCache.load();
+        sk_sp<SkData> key, cached;
+        if (cache) {
+            key    = jit_cache_key(instructions, fImpl->strides);
+            cached = cache->load(*key);
+        }
+
         // Assemble with no buffer to determine a.size(), the number of bytes we'll assemble.
         Assembler a{nullptr};
+        size_t code_size = 0;
 
         // First try allowing code hoisting (faster code)
         // then again without if that fails (lower register pressure).
         bool try_hoisting = true;
-        if (!this->jit(instructions, try_hoisting, &a)) {
-            try_hoisting = false;
+        if (cached && cached->size() > 0) {
+            code_size = cached->size();
+        } else {
+            cached = nullptr;
             if (!this->jit(instructions, try_hoisting, &a)) {
-                return;
+                try_hoisting = false;
+                if (!this->jit(instructions, try_hoisting, &a)) {
+                    return;
+                }
             }
+            code_size = a.size();
         }
 
         // Allocate space that we can remap as executable.
         const size_t page = sysconf(_SC_PAGESIZE);
 
         // mprotect works at page granularity.
-        fImpl->jit_size = ((a.size() + page - 1) / page) * page;
+        fImpl->jit_size = ((code_size + page - 1) / page) * page;
 
         void* jit_entry
              = mmap(nullptr,fImpl->jit_size, PROT_READ|PROT_WRITE, MAP_ANONYMOUS|MAP_PRIVATE, -1,0);
         fImpl->jit_entry.store(jit_entry);
 
-        // Assemble the program for real.
-        a = Assembler{jit_entry};
-        SkAssertResult(this->jit(instructions, try_hoisting, &a));
-        SkASSERT(a.size() <= fImpl->jit_size);
+        if (cached) {
+            // Our code is position independent, so it can run from anywhere we copy it.
+            memcpy(jit_entry, cached->data(), code_size);
+        } else {
+            // Assemble the program for real.
+            a = Assembler{jit_entry};
+            SkAssertResult(this->jit(instructions, try_hoisting, &a));
+            SkASSERT(a.size() <= fImpl->jit_size);
+
+            if (cache) {
+                cache->store(*key, *SkData::MakeWithoutCopy(jit_entry, code_size));
+            }
+        }
 
         // Remap as executable, and flush caches on platforms that need that.
         mprotect(jit_entry, fImpl->jit_size, PROT_READ|PROT_EXEC);
@@ -3203,7 +3771,7 @@ namespace skvm {
             // Dump the raw program binary.
             SkString path = SkStringPrintf("/tmp/%s.XXXXXX", debug_name);
             int fd = mkstemp(path.writable_str());
-            ::write(fd, jit_entry, a.size());
+            ::write(fd, jit_entry, code_size);
             close(fd);
 
             this->dropJIT();  // (unmap and null out fImpl->jit_entry.)
@@ -8,12 +8,15 @@
 #ifndef SkVM_DEFINED
 #define SkVM_DEFINED
 
+#include "include/core/SkRefCnt.h"
 #include "include/core/SkTypes.h"
 #include "include/private/SkMacros.h"
 #include "include/private/SkTHash.h"
 #include "src/core/SkVM_fwd.h"
+#include <memory>      // std::unique_ptr
 #include <vector>      // std::vector
 
+class SkData;
 class SkWStream;
 
 namespace skvm {
@@ -68,6 +71,11 @@ namespace skvm {
         void sub(GP64, int imm);
 
         void movq(GP64 dst, GP64 src, int off);  // dst = *(src+off)
+        void movl(GP64 dst, GP64 src, int off);  // dst = *(src+off), 32-bit, zero extended
+        void movq(GP64 dst, GP64 src);           // dst = src
+
+        void push(GP64);
+        void pop (GP64);
 
         struct Label {
             int                                      offset = 0;
@@ -166,6 +174,81 @@ namespace skvm {
         // mask = 0;
         void vgatherdps(Ymm dst, Scale scale, Ymm ix, GP64 base, Ymm mask);
 
+        // x86-64 AVX-512 (SKX)
+        //
+        // These are EVEX encoded to work with all 512 bits of zmm0-zmm15, which alias ymm0-ymm15.
+        // Comparisons write to opmask registers k0-k7 instead of to a vector register.
+
+        enum Zmm {
+            zmm0, zmm1, zmm2 , zmm3 , zmm4 , zmm5 , zmm6 , zmm7 ,
+            zmm8, zmm9, zmm10, zmm11, zmm12, zmm13, zmm14, zmm15,
+        };
+        enum Mask { k0, k1, k2, k3, k4, k5, k6, k7 };
+
+        struct ZmmOrLabel {
+            Zmm    zmm   = zmm0;
+            Label* label = nullptr;
+
+            /*implicit*/ ZmmOrLabel(Zmm    z) : zmm  (z) { SkASSERT(!label); }
+            /*implicit*/ ZmmOrLabel(Label* l) : label(l) { SkASSERT( label); }
+        };
+
+        using ZmmEqXOpY = void(Zmm dst, Zmm x, Zmm y);
+        ZmmEqXOpY vpandnd,
+                  vpmulld,
+                  vpsubw, vpmullw,
+                  vdivps,
+                  vfmadd132ps, vfmadd213ps, vfmadd231ps;
+
+        using ZmmEqXOpYOrLabel = void(Zmm dst, Zmm x, ZmmOrLabel y);
+        ZmmEqXOpYOrLabel vpandd, vpord, vpxord,
+                         vpaddd, vpsubd,
+                         vaddps, vsubps, vmulps, vminps, vmaxps;
+
+        void vpcmpeqd(Mask dst, Zmm x, ZmmOrLabel y);
+        void vpcmpgtd(Mask dst, Zmm x, Zmm y);
+
+        void vcmpps(Mask dst, Zmm x, Zmm y, int imm);
+        void vcmpeqps (Mask dst, Zmm x, Zmm y) { this->vcmpps(dst,x,y,0); }
+        void vcmpltps (Mask dst, Zmm x, Zmm y) { this->vcmpps(dst,x,y,1); }
+        void vcmpleps (Mask dst, Zmm x, Zmm y) { this->vcmpps(dst,x,y,2); }
+        void vcmpneqps(Mask dst, Zmm x, Zmm y) { this->vcmpps(dst,x,y,4); }
+
+        void vpmovm2d(Zmm dst, Mask src);        // dst = src ? ~0 : 0, per lane
+        void kxnorw  (Mask dst, Mask x, Mask y);
+        void kortestw(Mask x, Mask y);           // CF = (x|y) all ones, ZF = (x|y) all zeros
+
+        // Bitwise dst = f(dst,x,y), where imm is f's truth table indexed by dst<<2 | x<<1 | y.
+        void vpternlogd(Zmm dst, Zmm x, Zmm y, int imm);
+
+        using ZmmEqXOpImm = void(Zmm dst, Zmm x, int imm);
+        ZmmEqXOpImm vpslld, vpsrld, vpsrad,
+                    vpsrlw,
+                    vrndscaleps;  // Takes the same rounding mode immediates as vroundps.
+
+        using ZmmEqOpX = void(Zmm dst, Zmm x);
+        ZmmEqOpX vmovdqa32, vcvtdq2ps, vcvttps2dq, vsqrtps;
+
+        void vpshufb(Zmm dst, Zmm x, Label*);
+
+        void vbroadcastss(Zmm dst, Label*);
+        void vbroadcastss(Zmm dst, Xmm src);
+        void vbroadcastss(Zmm dst, GP64 ptr, int off);  // dst = *(ptr+off)
+
+        void vmovups  (Zmm dst, GP64 ptr);   // dst = *ptr, 512-bit
+        void vpmovzxwd(Zmm dst, GP64 ptr);   // dst = *ptr, 256-bit, each uint16_t expanded to int
+        void vpmovzxbd(Zmm dst, GP64 ptr);   // dst = *ptr, 128-bit, each uint8_t  expanded to int
+
+        void vmovups(GP64 ptr, Zmm src);     // *ptr = src, 512-bit
+        void vpmovdw(GP64 ptr, Zmm src);     // *ptr = src, 256-bit, each int truncated to uint16_t
+        void vpmovdb(GP64 ptr, Zmm src);     // *ptr = src, 128-bit, each int truncated to uint8_t
+
+        // if (mask & (1<<lane)) {
+        //     dst = base[scale*ix];
+        // }
+        // mask = 0;
+        void vgatherdps(Zmm dst, Scale scale, Zmm ix, GP64 base, Mask mask);
+
         // aarch64
 
         // d = op(n,m)
@@ -239,6 +322,9 @@ namespace skvm {
 
         void fmovs(X dst, V src); // dst = 32-bit src[0]
 
+        void ldrd(X dst, X src, int off);  // 64-bit dst = *(src+off), off a multiple of 8
+        void ldrs(X dst, X src, int off);  // 32-bit dst = *(src+off), off a multiple of 4
+
     private:
         // dst = op(dst, imm)
         void op(int opcode, int opcode_ext, GP64 dst, int imm);
@@ -261,6 +347,13 @@ namespace skvm {
         // *ptr = ymm or ymm = *ptr, depending on opcode.
         void load_store(int prefix, int map, int opcode, Ymm ymm, GP64 ptr);
 
+        // EVEX-encoded zmm equivalents of the ymm op()s and load_store() above.
+        void op(int prefix, int map, int opcode, Zmm dst, Zmm x, Zmm y, bool W=false);
+        void op(int prefix, int map, int opcode, Zmm dst, Zmm x, Label* l);
+        void op(int prefix, int map, int opcode, Zmm dst, Zmm x, ZmmOrLabel);
+        void op(int prefix, int map, int opcode, int opcode_ext, Zmm dst, Zmm x, int imm);
+        void load_store(int prefix, int map, int opcode, Zmm zmm, GP64 ptr);
+
         // Opcode for 3-arguments ops is split between hi and lo:
         //    [11 bits hi] [5 bits m] [6 bits lo] [5 bits n] [5 bits d]
         void op(uint32_t hi, V m, uint32_t lo, V n, V d);
@@ -611,6 +704,31 @@ namespace skvm {
 
     using Reg = int;
 
+    // JIT'ing a Program costs real time, and every process pays it again for the same Programs.
+    // A JITCache lets Programs reuse previously JIT'd machine code instead.  Keys are a versioned
+    // serialization of the optimized instructions, strides, and the CPU features the code was
+    // generated for; values are the raw (position independent) code.  Like
+    // GrContextOptions::PersistentCache, implementations must be thread safe.
+    class JITCache {
+    public:
+        virtual ~JITCache() = default;
+
+        // Returns the code previously stored for this key, or null.
+        virtual sk_sp<SkData> load(const SkData& key) = 0;
+        virtual void store(const SkData& key, const SkData& code) = 0;
+    };
+
+    // Sets the JITCache consulted when JIT'ing new Programs.  Does not take ownership.  Once this
+    // returns, Programs being created no longer use the previous cache, so it may be destroyed.
+    // Pass nullptr to disable caching.
+    void SetJITCache(JITCache*);
+
+    // A JITCache persisted in the file at path, so that JIT'd code survives process restarts and
+    // can be shared by many processes.  The file is mmap'd, and cached code is returned without
+    // copying.  Newly JIT'd code is added to the file as it is stored, by writing a new file and
+    // renaming it over the old one.
+    std::unique_ptr<JITCache> MakeFileJITCache(const char* path);
+
     class Program {
     public:
         struct Instruction {   // d = op(x, y/imm, z/imm)
@@ -639,6 +757,18 @@ namespace skvm {
 
         void eval(int n, void* args[]) const;
 
+        // One run of the program over n lanes, with the same args[] eval() would take.
+        struct Span {
+            int    n;
+            void** args;
+        };
+
+        // Run the program over each of these spans in order, as if by eval(span.n, span.args),
+        // but in a single call into JIT'd code that loads constants only once for all spans.
+        // Uniforms are reloaded for each span, so each span may point to different uniforms.
+        // Like eval(), this may clobber each span's args[].
+        void evalSpans(const Span spans[], int nspans) const;
+
         template <typename... T>
         void eval(int n, T*... arg) const {
             SkASSERT(sizeof...(arg) == this->nargs());
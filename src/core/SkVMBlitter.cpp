@@ -20,14 +20,12 @@
 
 namespace {
 
-    // Uniforms set by the Blitter itself,
-    // rather than by the Shader, which follow this struct in the skvm::Uniforms buffer.
+    // Uniforms set by the Blitter itself for each span it blits, passed as their own argument
+    // rather than with the Shader's uniforms in the skvm::Uniforms buffer.
     struct BlitterUniforms {
         int right;  // First device x + blit run length n, used to get device x coordiate.
         int y;      // Device y coordiate.
     };
-    static_assert(SkIsAlign4(sizeof(BlitterUniforms)), "");
-    static constexpr int kBlitterUniformsCount = sizeof(BlitterUniforms) / 4;
 
     enum class Coverage { Full, UniformA8, MaskA8, MaskLCD16, Mask3D };
 
@@ -120,9 +118,11 @@ namespace {
                 const SkShaderBase* shader = as_SB(params.shader);
                 skvm::Builder p;
 
-                skvm::I32 dx = p.sub(p.uniform32(uniforms->base, offsetof(BlitterUniforms, right)),
+                skvm::Arg blitter = p.uniform();
+                uniforms->base    = p.uniform();
+                skvm::I32 dx = p.sub(p.uniform32(blitter, offsetof(BlitterUniforms, right)),
                                      p.index()),
-                          dy = p.uniform32(uniforms->base, offsetof(BlitterUniforms, y));
+                          dy = p.uniform32(blitter, offsetof(BlitterUniforms, y));
                 skvm::F32 x = p.add(p.to_f32(dx), p.splat(0.5f)),
                           y = p.add(p.to_f32(dy), p.splat(0.5f));
 
@@ -173,9 +173,11 @@ namespace {
         }
 
         Builder(const Params& params, skvm::Uniforms* uniforms, SkArenaAlloc* alloc) {
-            // First two arguments are always uniforms and the destination buffer.
-            uniforms->base    = uniform();
-            skvm::Arg dst_ptr = arg(SkColorTypeBytesPerPixel(params.colorType));
+            // First three arguments are always the blitter's uniforms, the shader's uniforms,
+            // and the destination buffer.
+            skvm::Arg blitter_uniforms = uniform();
+            uniforms->base             = uniform();
+            skvm::Arg dst_ptr          = arg(SkColorTypeBytesPerPixel(params.colorType));
             // Other arguments depend on params.coverage:
             //    - Full:      (no more arguments)
             //    - Mask3D:    mul varying, add varying, 8-bit coverage varying
@@ -183,9 +185,9 @@ namespace {
             //    - MaskLCD16: 565 coverage varying
             //    - UniformA8: 8-bit coverage uniform
 
-            skvm::I32 dx = sub(uniform32(uniforms->base, offsetof(BlitterUniforms, right)),
+            skvm::I32 dx = sub(uniform32(blitter_uniforms, offsetof(BlitterUniforms, right)),
                                index()),
-                      dy = uniform32(uniforms->base, offsetof(BlitterUniforms, y));
+                      dy = uniform32(blitter_uniforms, offsetof(BlitterUniforms, y));
             skvm::F32 x = add(to_f32(dx), splat(0.5f)),
                       y = add(to_f32(dy), splat(0.5f));
 
@@ -498,12 +500,14 @@ namespace {
     public:
         Blitter(const SkPixmap& device, const SkPaint& paint, const SkMatrix& ctm, bool* ok)
             : fDevice(device)
-            , fUniforms(kBlitterUniformsCount)
+            , fUniforms(0)
             , fParams(effective_params(device, paint, ctm))
             , fKey(Builder::CacheKey(fParams, &fUniforms, &fAlloc, ok))
         {}
 
         ~Blitter() override {
+            this->flush();
+
             if (SkLRUCache<Key, skvm::Program>* cache = try_acquire_program_cache()) {
                 auto cache_program = [&](skvm::Program&& program, Coverage coverage) {
                     if (!program.empty()) {
@@ -537,6 +541,19 @@ namespace {
                        fBlitMask3D,
                        fBlitMaskLCD16;
 
+        // Spans queued up to run all at once with a single Program::evalSpans().
+        // blitH() leaves its spans queued across calls; the others flush before returning,
+        // as their coverage is only ours to read until then.
+        static constexpr int kMaxPendingSpans = 32;
+        struct PendingSpan {
+            BlitterUniforms uniforms;
+            void*           args[6];  // Blitter uniforms, shader uniforms, dst, coverage...
+        };
+        const skvm::Program* fPendingProgram = nullptr;
+        PendingSpan          fPending     [kMaxPendingSpans];
+        skvm::Program::Span  fPendingSpans[kMaxPendingSpans];
+        int                  fPendingCount = 0;
+
         skvm::Program buildProgram(Coverage coverage) {
             Key key = fKey.withCoverage(coverage);
             {
@@ -556,7 +573,7 @@ namespace {
             // and more natural to rebuild fUniforms than to emit them into a dummy buffer.
             // fUniforms should reuse the exact same memory, so this is very cheap.
             SkDEBUGCODE(size_t prev = fUniforms.buf.size();)
-            fUniforms.buf.resize(kBlitterUniformsCount);
+            fUniforms.buf.clear();
             Builder builder{fParams.withCoverage(coverage), &fUniforms, &fAlloc};
             SkASSERT(fUniforms.buf.size() == prev);
 
@@ -578,17 +595,39 @@ namespace {
             return program;
         }
 
-        void updateUniforms(int right, int y) {
-            BlitterUniforms uniforms{right, y};
-            memcpy(fUniforms.buf.data(), &uniforms, sizeof(BlitterUniforms));
+        void flush() {
+            if (fPendingCount > 0) {
+                fPendingProgram->evalSpans(fPendingSpans, fPendingCount);
+                fPendingCount = 0;
+            }
+        }
+
+        // Queue program to run over [x,x+w) on row y, with any coverage arguments it takes.
+        void queueSpan(const skvm::Program& program, int x, int y, int w,
+                       std::initializer_list<const void*> coverage = {}) {
+            if (&program != fPendingProgram || fPendingCount == kMaxPendingSpans) {
+                this->flush();
+                fPendingProgram = &program;
+            }
+            PendingSpan& span = fPending[fPendingCount];
+            span.uniforms = {x+w, y};
+            span.args[0]  = &span.uniforms;
+            span.args[1]  = fUniforms.buf.data();
+            span.args[2]  = fDevice.writable_addr(x,y);
+
+            SkASSERT(coverage.size() <= SK_ARRAY_COUNT(span.args) - 3);
+            void** arg = span.args + 3;
+            for (const void* ptr : coverage) {
+                *arg++ = const_cast<void*>(ptr);
+            }
+            fPendingSpans[fPendingCount++] = {w, span.args};
         }
 
         void blitH(int x, int y, int w) override {
             if (fBlitH.empty()) {
                 fBlitH = this->buildProgram(Coverage::Full);
             }
-            this->updateUniforms(x+w, y);
-            fBlitH.eval(w, fUniforms.buf.data(), fDevice.addr(x,y));
+            this->queueSpan(fBlitH, x,y,w);
         }
 
         void blitAntiH(int x, int y, const SkAlpha cov[], const int16_t runs[]) override {
@@ -596,13 +635,13 @@ namespace {
                 fBlitAntiH = this->buildProgram(Coverage::UniformA8);
             }
             for (int16_t run = *runs; run > 0; run = *runs) {
-                this->updateUniforms(x+run, y);
-                fBlitAntiH.eval(run, fUniforms.buf.data(), fDevice.addr(x,y), cov);
+                this->queueSpan(fBlitAntiH, x,y,run, {cov});
 
                 x    += run;
                 runs += run;
                 cov  += run;
             }
+            this->flush();
         }
 
         void blitMask(const SkMask& mask, const SkIRect& clip) override {
@@ -641,19 +680,18 @@ namespace {
                 for (int y = clip.top(); y < clip.bottom(); y++) {
                     int x = clip.left(),
                         w = clip.width();
-                    void* dptr =        fDevice.writable_addr(x,y);
-                    auto  mptr = (const uint8_t*)mask.getAddr(x,y);
-                    this->updateUniforms(x+w,y);
+                    auto mptr = (const uint8_t*)mask.getAddr(x,y);
 
                     if (program == &fBlitMask3D) {
                         size_t plane = mask.computeImageSize();
-                        program->eval(w, fUniforms.buf.data(), dptr, mptr + 1*plane
-                                                                   , mptr + 2*plane
-                                                                   , mptr + 0*plane);
+                        this->queueSpan(*program, x,y,w, {mptr + 1*plane
+                                                        , mptr + 2*plane
+                                                        , mptr + 0*plane});
                     } else {
-                        program->eval(w, fUniforms.buf.data(), dptr, mptr);
+                        this->queueSpan(*program, x,y,w, {mptr});
                     }
                 }
+                this->flush();
             }
         }
     };
@@ -0,0 +1,196 @@
+/*
+ * Copyright 2020 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/core/SkData.h"
+#include "include/core/SkStream.h"
+#include "include/core/SkString.h"
+#include "include/core/SkTime.h"
+#include "include/private/SkMutex.h"
+#include "include/private/SkTHash.h"
+#include "src/core/SkOSFile.h"
+#include "src/core/SkOpts.h"
+#include "src/core/SkVM.h"
+
+#include <cstdio>
+
+// The file format is a header followed by entries, all fields native endian uint32_ts:
+//
+//    header:   kMagic, kFormatVersion
+//    entry:    key size, code size, code hash, key bytes, code bytes
+//
+// with the key and code bytes each zero-padded to a multiple of 4 bytes.
+//
+// Other processes may have the file mmap'd, so we never modify it in place.  To add an entry we
+// re-read the file, write its valid prefix and the new entry to a temporary file, and rename that
+// over the original; readers keep their old mapping, and two racing writers can at worst drop
+// each other's newest entry, costing a cache miss.  When reading we stop at the first entry that
+// doesn't fit, and we verify each entry's code hash before handing its code out, so a damaged file
+// only ever costs us cache misses.  A file with the wrong magic or version is discarded and
+// started fresh.
+//
+// Keys carry their own version and CPU features (see jit_cache_key() in SkVM.cpp), so this format
+// version only needs to change when this file layout does.
+
+namespace {
+
+    static constexpr uint32_t kMagic         = 0x6d766b73;  // 'skvm'
+    static constexpr uint32_t kFormatVersion = 1;
+
+    static uint32_t hash(const SkData& data) {
+        return SkOpts::hash(data.data(), data.size());
+    }
+
+    class FileJITCache final : public skvm::JITCache {
+    public:
+        explicit FileJITCache(const char* path) : fPath(path) {
+            fFile = SkData::MakeFromFileName(path);  // mmap'd when possible.
+            const size_t valid = fFile ? Parse(fFile, &fEntries) : 0;
+            if (valid == 0 || valid < fFile->size()) {
+                this->publish(nullptr);
+            }
+        }
+
+        sk_sp<SkData> load(const SkData& key) override {
+            const uint32_t keyHash = hash(key);
+
+            SkAutoMutexExclusive lock(fMutex);
+            Entry* entry = fEntries.find(keyHash);
+            if (!entry || !entry->key->equals(&key)) {
+                return nullptr;
+            }
+            if (!entry->verified) {
+                if (hash(*entry->code) != entry->codeHash) {
+                    fEntries.remove(keyHash);
+                    return nullptr;
+                }
+                entry->verified = true;
+            }
+            return entry->code;
+        }
+
+        void store(const SkData& key, const SkData& code) override {
+            const uint32_t keyHash = hash(key);
+
+            SkAutoMutexExclusive lock(fMutex);
+            if (Entry* entry = fEntries.find(keyHash); entry && entry->key->equals(&key)) {
+                return;
+            }
+
+            const uint32_t codeHash = hash(code);
+            SkDynamicMemoryWStream buf;
+            buf.write32(SkToU32(key.size()));
+            buf.write32(SkToU32(code.size()));
+            buf.write32(codeHash);
+            buf.write(key.data(), key.size());
+            buf.padToAlign4();
+            buf.write(code.data(), code.size());
+            buf.padToAlign4();
+            sk_sp<SkData> bytes = buf.detachAsData();
+            this->publish(bytes.get());
+
+            fEntries.set(keyHash, {SkData::MakeWithCopy(key.data(), key.size()),
+                                   SkData::MakeWithCopy(code.data(), code.size()),
+                                   codeHash,
+                                   /*verified=*/true});
+        }
+
+    private:
+        struct Entry {
+            sk_sp<SkData> key,
+                          code;
+            uint32_t      codeHash;
+            bool          verified;
+        };
+
+        // Index the entries of file into entries (if not null), referencing their keys and code in
+        // place.  Returns the size of its valid prefix, or 0 if the header is not one we understand.
+        static size_t Parse(const sk_sp<SkData>& file, SkTHashMap<uint32_t, Entry>* entries) {
+            const uint8_t* bytes = file->bytes();
+            const size_t   size  = file->size();
+
+            uint32_t header[2];
+            if (size < sizeof(header)) {
+                return 0;
+            }
+            memcpy(header, bytes, sizeof(header));
+            if (header[0] != kMagic || header[1] != kFormatVersion) {
+                return 0;
+            }
+
+            size_t offset = sizeof(header);
+            uint32_t fields[3];
+            while (offset + sizeof(fields) <= size) {
+                memcpy(fields, bytes + offset, sizeof(fields));
+                const size_t keySize  = fields[0],
+                             codeSize = fields[1],
+                             keyOff   = offset + sizeof(fields),
+                             codeOff  = keyOff  + SkAlign4(keySize),
+                             end      = codeOff + SkAlign4(codeSize);
+                if (keySize == 0 || codeSize == 0 || end > size) {
+                    break;
+                }
+
+                if (entries) {
+                    sk_sp<SkData> key = SkData::MakeSubset(file.get(), keyOff, keySize);
+                    const uint32_t keyHash = hash(*key);
+                    entries->set(keyHash, {std::move(key),
+                                           SkData::MakeSubset(file.get(), codeOff, codeSize),
+                                           fields[2],
+                                           /*verified=*/false});
+                }
+                offset = end;
+            }
+            return offset;
+        }
+
+        // Replace the file with the valid prefix of what's on disk now (or just a header) followed
+        // by entry, if not null.  This goes through a temporary file renamed over the original,
+        // so that processes with the old file mapped never see it change underneath them.
+        void publish(const SkData* entry) {
+            sk_sp<SkData> current = SkData::MakeFromFileName(fPath.c_str());
+            const size_t valid = current ? Parse(current, nullptr) : 0;
+
+            SkString tmp = SkStringPrintf("%s.%p.%llx.tmp", fPath.c_str(), (const void*)this,
+                                          (unsigned long long)SkTime::GetNSecs());
+            FILE* f = sk_fopen(tmp.c_str(), kWrite_SkFILE_Flag);
+            if (!f) {
+                return;
+            }
+            if (valid) {
+                sk_fwrite(current->data(), valid, f);
+            } else {
+                const uint32_t header[] = { kMagic, kFormatVersion };
+                sk_fwrite(header, sizeof(header), f);
+            }
+            if (entry) {
+                sk_fwrite(entry->data(), entry->size(), f);
+            }
+            sk_fclose(f);
+            current = nullptr;
+
+            // rename() can fail where it won't replace an existing file (Windows); we just lose
+            // this update, which the cache can afford.
+            if (rename(tmp.c_str(), fPath.c_str()) != 0) {
+                remove(tmp.c_str());
+            }
+        }
+
+        const SkString                 fPath;
+        SkMutex                        fMutex;
+        sk_sp<SkData>                  fFile;     // Keeps the entries we parsed from it alive.
+        SkTHashMap<uint32_t, Entry>    fEntries;  // Keyed by hash of the key.
+    };
+
+}  // namespace
+
+namespace skvm {
+
+    std::unique_ptr<JITCache> MakeFileJITCache(const char* path) {
+        return path ? std::make_unique<FileJITCache>(path) : nullptr;
+    }
+
+}  // namespace skvm
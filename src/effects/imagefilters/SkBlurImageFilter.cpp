@@ -13,8 +13,8 @@
 #include "include/core/SkTileMode.h"
 #include "include/private/SkColorData.h"
 #include "include/private/SkNx.h"
+#include "include/private/SkTemplates.h"
 #include "include/private/SkTFitsIn.h"
-#include "src/core/SkArenaAlloc.h"
 #include "src/core/SkAutoPixmapStorage.h"
 #include "src/core/SkGpuBlurUtils.h"
 #include "src/core/SkImageFilter_Base.h"
@@ -244,22 +244,27 @@ static int calculate_buffer(int window) {
 //
 //   This is all encapsulated in the processValue function below.
 //
-using Pass0And1 = Sk4u[2];
+//  blur_lines runs kLines neighboring lines in lockstep. When the lines are columns, each step
+// then reads and writes kLines adjacent pixels of a row instead of a single pixel, which keeps
+// the vertical pass from touching a new cache line for every pixel. The circular buffers of the
+// lines are interleaved so that a step touches kLines adjacent entries of each buffer.
+//
 // The would be dLeft parameter is assumed to be 0.
-static void blur_one_direction(Sk4u* buffer, int window,
-                               int srcLeft, int srcRight, int dstRight,
-                               const uint32_t* src, int srcXStride, int srcYStride, int srcH,
-                                     uint32_t* dst, int dstXStride, int dstYStride) {
+template <int kLines>
+static void blur_lines(Sk4u* buffer, int window,
+                       int srcLeft, int srcRight, int dstRight,
+                       const uint32_t* src, int srcXStride, int srcYStride,
+                             uint32_t* dst, int dstXStride, int dstYStride) {
 
     // The circular buffers are one less than the window.
     auto pass0Count = window - 1,
          pass1Count = window - 1,
          pass2Count = (window & 1) == 1 ? window - 1 : window;
 
-    Pass0And1* buffer01Start = (Pass0And1*)buffer;
-    Sk4u*      buffer2Start  = buffer + pass0Count + pass1Count;
-    Pass0And1* buffer01End   = (Pass0And1*)buffer2Start;
-    Sk4u*      buffer2End    = buffer2Start + pass2Count;
+    Sk4u* buffer0 = buffer;
+    Sk4u* buffer1 = buffer0 + pass0Count * kLines;
+    Sk4u* buffer2 = buffer1 + pass1Count * kLines;
+    sk_bzero(buffer, (pass0Count + pass1Count + pass2Count) * kLines * sizeof(Sk4u));
 
     // If the window is odd then the divisor is just window ^ 3 otherwise,
     // it is window * window * (window + 1) = window ^ 3 + window ^ 2;
@@ -288,86 +293,148 @@ static void blur_one_direction(Sk4u* buffer, int window,
          srcEnd   = srcRight - border,
          dstEnd   = dstRight;
 
-    for (auto y = 0; y < srcH; y++) {
-        auto buffer01Cursor = buffer01Start;
-        auto buffer2Cursor  = buffer2Start;
-
-        Sk4u sum0{0u};
-        Sk4u sum1{0u};
-        Sk4u sum2{half};
-
-        sk_bzero(buffer01Start, (buffer2End - (Sk4u *) (buffer01Start)) * sizeof(*buffer2Start));
-
-        // Given an expanded input pixel, move the window ahead using the leadingEdge value.
-        auto processValue = [&](const Sk4u& leadingEdge) -> Sk4u {
-            sum0 += leadingEdge;
-            sum1 += sum0;
-            sum2 += sum1;
-
-            Sk4u value = sum2.mulHi(weight);
-
-            sum2 -= *buffer2Cursor;
-            *buffer2Cursor = sum1;
-            buffer2Cursor = (buffer2Cursor + 1) < buffer2End ? buffer2Cursor + 1 : buffer2Start;
-
-            sum1 -= (*buffer01Cursor)[1];
-            (*buffer01Cursor)[1] = sum0;
-            sum0 -= (*buffer01Cursor)[0];
-            (*buffer01Cursor)[0] = leadingEdge;
-            buffer01Cursor =
-                    (buffer01Cursor + 1) < buffer01End ? buffer01Cursor + 1 : buffer01Start;
-
-            return value;
-        };
-
-        auto srcIdx = srcStart;
-        auto dstIdx = 0;
-        const uint32_t* srcCursor = src;
-              uint32_t* dstCursor = dst;
-
-        // The destination pixels are not effected by the src pixels,
-        // change to zero as per the spec.
-        // https://drafts.fxtf.org/filter-effects/#FilterPrimitivesOverviewIntro
-        while (dstIdx < srcIdx) {
-            *dstCursor = 0;
-            dstCursor += dstXStride;
-            SK_PREFETCH(dstCursor);
-            dstIdx++;
+    Sk4u sum0[kLines], sum1[kLines], sum2[kLines];
+    for (int k = 0; k < kLines; k++) {
+        sum0[k] = 0u;
+        sum1[k] = 0u;
+        sum2[k] = half;
+    }
+    int buffer01Cursor = 0,
+        buffer2Cursor  = 0;
+
+    // Given an expanded input pixel of line k, move the window ahead using the leadingEdge value.
+    auto processValue = [&](int k, const Sk4u& leadingEdge) -> Sk4u {
+        sum0[k] += leadingEdge;
+        sum1[k] += sum0[k];
+        sum2[k] += sum1[k];
+
+        Sk4u value = sum2[k].mulHi(weight);
+
+        Sk4u* trailing2 = &buffer2[buffer2Cursor * kLines + k];
+        sum2[k] -= *trailing2;
+        *trailing2 = sum1[k];
+
+        Sk4u* trailing1 = &buffer1[buffer01Cursor * kLines + k];
+        sum1[k] -= *trailing1;
+        *trailing1 = sum0[k];
+
+        Sk4u* trailing0 = &buffer0[buffer01Cursor * kLines + k];
+        sum0[k] -= *trailing0;
+        *trailing0 = leadingEdge;
+
+        return value;
+    };
+    auto advance = [&]() {
+        buffer2Cursor  = (buffer2Cursor + 1)  < pass2Count ? buffer2Cursor + 1  : 0;
+        buffer01Cursor = (buffer01Cursor + 1) < pass0Count ? buffer01Cursor + 1 : 0;
+    };
+
+    auto srcIdx = srcStart;
+    auto dstIdx = 0;
+    const uint32_t* srcCursor = src;
+          uint32_t* dstCursor = dst;
+
+    // The destination pixels are not effected by the src pixels,
+    // change to zero as per the spec.
+    // https://drafts.fxtf.org/filter-effects/#FilterPrimitivesOverviewIntro
+    while (dstIdx < srcIdx) {
+        for (int k = 0; k < kLines; k++) {
+            dstCursor[k * dstYStride] = 0;
         }
+        dstCursor += dstXStride;
+        SK_PREFETCH(dstCursor);
+        dstIdx++;
+    }
 
-        // The edge of the source is before the edge of the destination. Calculate the sums for
-        // the pixels before the start of the destination.
-        while (dstIdx > srcIdx) {
-            Sk4u leadingEdge = srcIdx < srcEnd ? SkNx_cast<uint32_t>(Sk4b::Load(srcCursor)) : 0;
-            (void) processValue(leadingEdge);
-            srcCursor += srcXStride;
-            srcIdx++;
+    // The edge of the source is before the edge of the destination. Calculate the sums for
+    // the pixels before the start of the destination.
+    while (dstIdx > srcIdx) {
+        for (int k = 0; k < kLines; k++) {
+            Sk4u leadingEdge = srcIdx < srcEnd
+                    ? SkNx_cast<uint32_t>(Sk4b::Load(srcCursor + k * srcYStride)) : 0;
+            (void) processValue(k, leadingEdge);
         }
+        advance();
+        srcCursor += srcXStride;
+        srcIdx++;
+    }
 
-        // The dstIdx and srcIdx are in sync now; the code just uses the dstIdx for both now.
-        // Consume the source generating pixels to dst.
-        auto loopEnd = std::min(dstEnd, srcEnd);
-        while (dstIdx < loopEnd) {
-            Sk4u leadingEdge = SkNx_cast<uint32_t>(Sk4b::Load(srcCursor));
-            SkNx_cast<uint8_t>(processValue(leadingEdge)).store(dstCursor);
-            srcCursor += srcXStride;
-            dstCursor += dstXStride;
-            SK_PREFETCH(dstCursor);
-            dstIdx++;
+    // The dstIdx and srcIdx are in sync now; the code just uses the dstIdx for both now.
+    // Consume the source generating pixels to dst.
+    auto loopEnd = std::min(dstEnd, srcEnd);
+    while (dstIdx < loopEnd) {
+        for (int k = 0; k < kLines; k++) {
+            Sk4u leadingEdge = SkNx_cast<uint32_t>(Sk4b::Load(srcCursor + k * srcYStride));
+            SkNx_cast<uint8_t>(processValue(k, leadingEdge)).store(dstCursor + k * dstYStride);
         }
+        advance();
+        srcCursor += srcXStride;
+        dstCursor += dstXStride;
+        SK_PREFETCH(dstCursor);
+        dstIdx++;
+    }
 
-        // The leading edge is beyond the end of the source. Assume that the pixels
-        // are now 0x0000 until the end of the destination.
-        loopEnd = dstEnd;
-        while (dstIdx < loopEnd) {
-            SkNx_cast<uint8_t>(processValue(0u)).store(dstCursor);
-            dstCursor += dstXStride;
-            SK_PREFETCH(dstCursor);
-            dstIdx++;
+    // The leading edge is beyond the end of the source. Assume that the pixels
+    // are now 0x0000 until the end of the destination.
+    loopEnd = dstEnd;
+    while (dstIdx < loopEnd) {
+        for (int k = 0; k < kLines; k++) {
+            SkNx_cast<uint8_t>(processValue(k, 0u)).store(dstCursor + k * dstYStride);
         }
+        advance();
+        dstCursor += dstXStride;
+        SK_PREFETCH(dstCursor);
+        dstIdx++;
+    }
+}
 
-        src += srcYStride;
-        dst += dstYStride;
+// Columns are blurred eight at a time; 32 bytes of each row.
+static constexpr int kColumnsPerGroup = 8;
+// Below this many destination pixels a pass is not worth splitting up.
+static constexpr int kMinPixelsPerTask = 1 << 16;
+static constexpr int kMaxTasks = 32;
+
+// Blurs srcH lines, each srcYStride apart. Lines are independent, so they are spread over
+// ForEachConcurrently(); each task has its own circular buffers.
+static void blur_one_direction(int window,
+                               int srcLeft, int srcRight, int dstRight,
+                               const uint32_t* src, int srcXStride, int srcYStride, int srcH,
+                                     uint32_t* dst, int dstXStride, int dstYStride) {
+    // Only lines that are next to each other in memory benefit from going in lockstep.
+    const int linesPerGroup = (srcYStride == 1 && dstYStride == 1) ? kColumnsPerGroup : 1;
+    const int groupCount = (srcH + linesPerGroup - 1) / linesPerGroup;
+
+    int64_t pixels = (int64_t)srcH * dstRight;
+    int taskCount = (int)std::min<int64_t>(pixels / kMinPixelsPerTask, kMaxTasks);
+    taskCount = SkTPin(taskCount, 1, std::max(groupCount, 1));
+
+    auto blurGroups = [&](int task) {
+        int groupStart = groupCount *  task      / taskCount,
+            groupEnd   = groupCount * (task + 1) / taskCount;
+        SkAutoTMalloc<Sk4u> buffer(calculate_buffer(window) * linesPerGroup);
+        for (int group = groupStart; group < groupEnd; group++) {
+            int line  = group * linesPerGroup,
+                lines = std::min(linesPerGroup, srcH - line);
+            const uint32_t* lineSrc = src + (int64_t)line * srcYStride;
+                  uint32_t* lineDst = dst + (int64_t)line * dstYStride;
+            if (lines == kColumnsPerGroup) {
+                blur_lines<kColumnsPerGroup>(buffer.get(), window, srcLeft, srcRight, dstRight,
+                                             lineSrc, srcXStride, srcYStride,
+                                             lineDst, dstXStride, dstYStride);
+                continue;
+            }
+            for (int k = 0; k < lines; k++) {
+                blur_lines<1>(buffer.get(), window, srcLeft, srcRight, dstRight,
+                              lineSrc + k * srcYStride, srcXStride, srcYStride,
+                              lineDst + k * dstYStride, dstXStride, dstYStride);
+            }
+        }
+    };
+
+    if (taskCount == 1) {
+        blurGroups(0);
+    } else {
+        SkImageFilter_Base::ForEachConcurrently(taskCount, blurGroups);
     }
 }
 
@@ -477,14 +544,6 @@ static sk_sp<SkSpecialImage> cpu_blur(
         return nullptr;
     }
 
-    auto bufferSizeW = calculate_buffer(windowW),
-         bufferSizeH = calculate_buffer(windowH);
-
-    // The amount 1024 is enough for buffers up to 10 sigma. The tmp bitmap will be
-    // allocated on the heap.
-    SkSTArenaAlloc<1024> alloc;
-    Sk4u* buffer = alloc.makeArrayDefault<Sk4u>(std::max(bufferSizeW, bufferSizeH));
-
     // Basic Plan: The three cases to handle
     // * Horizontal and Vertical - blur horizontally while copying values from the source to
     //     the destination. Then, do an in-place vertical blur.
@@ -526,7 +585,7 @@ static sk_sp<SkSpecialImage> cpu_blur(
         intermediateDst = static_cast<uint32_t *>(dst.getPixels());
 
         blur_one_direction(
-                buffer, windowW,
+                windowW,
                 srcBounds.left(), srcBounds.right(), dstBounds.right(),
                 static_cast<uint32_t *>(src.getPixels()), 1, src.rowBytesAsPixels(), srcH,
                 intermediateSrc, 1, intermediateRowBytesAsPixels);
@@ -534,7 +593,7 @@ static sk_sp<SkSpecialImage> cpu_blur(
 
     if (windowH > 1) {
         blur_one_direction(
-                buffer, windowH,
+                windowH,
                 srcBounds.top(), srcBounds.bottom(), dstBounds.bottom(),
                 intermediateSrc, intermediateRowBytesAsPixels, 1, intermediateWidth,
                 intermediateDst, dst.rowBytesAsPixels(), 1);
@@ -424,6 +424,13 @@ protected:
 
     bool affectsTransparentBlack() const override { return true; }
 
+    bool onCanBeTiled() const override {
+        // Normals come from each pixel's neighbors, and pixels at the edge of the input bounds
+        // get edge normals instead, so a tile's edges would differ from the whole layer's. A flat
+        // surface has the same normal everywhere.
+        return 0 == fSurfaceScale;
+    }
+
     const SkImageFilterLight* light() const { return fLight.get(); }
     inline sk_sp<const SkImageFilterLight> refLight() const { return fLight; }
     SkScalar surfaceScale() const { return fSurfaceScale; }
@@ -58,6 +58,7 @@ protected:
     SkIRect onFilterNodeBounds(const SkIRect&, const SkMatrix& ctm,
                                MapDirection, const SkIRect* inputRect) const override;
     bool affectsTransparentBlack() const override;
+    bool onCanBeTiled() const override;
 
 private:
     friend void SkMatrixConvolutionImageFilter::RegisterFlattenables();
@@ -552,3 +553,8 @@ bool SkMatrixConvolutionImageFilterImpl::affectsTransparentBlack() const {
     // pixels it will affect in object-space.
     return SkTileMode::kRepeat != fTileMode && SkTileMode::kMirror != fTileMode;
 }
+
+bool SkMatrixConvolutionImageFilterImpl::onCanBeTiled() const {
+    // Repeat and mirror wrap around bounds that are computed from the clip.
+    return SkTileMode::kRepeat != fTileMode && SkTileMode::kMirror != fTileMode;
+}
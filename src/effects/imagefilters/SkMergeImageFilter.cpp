@@ -73,6 +73,7 @@ sk_sp<SkSpecialImage> SkMergeImageFilterImpl::onFilterImage(const Context& ctx,
     std::unique_ptr<SkIPoint[]> offsets(new SkIPoint[inputCount]);
 
     // Filter all of the inputs.
+    this->prefilterInputs(ctx);
     for (int i = 0; i < inputCount; ++i) {
         offsets[i] = { 0, 0 };
         inputs[i] = this->filterInput(i, ctx, &offsets[i]);
@@ -110,6 +110,8 @@ void SkXfermodeImageFilterImpl::flatten(SkWriteBuffer& buffer) const {
 
 sk_sp<SkSpecialImage> SkXfermodeImageFilterImpl::onFilterImage(const Context& ctx,
                                                                SkIPoint* offset) const {
+    this->prefilterInputs(ctx);
+
     SkIPoint backgroundOffset = SkIPoint::Make(0, 0);
     sk_sp<SkSpecialImage> background(this->filterInput(0, ctx, &backgroundOffset));
 
@@ -34,7 +34,9 @@
 #include "src/gpu/text/GrTextContext.h"
 #include "src/image/SkImage_GpuBase.h"
 #include "src/image/SkSurface_Gpu.h"
+#include "src/sksl/SkSLCompiler.h"
 #include <atomic>
+#include <thread>
 
 #define ASSERT_OWNED_PROXY(P) \
     SkASSERT(!(P) || !((P)->peekTexture()) || (P)->peekTexture()->getContext() == this)
@@ -643,6 +645,50 @@ bool GrContext::precompileShader(const SkData& key, const SkData& data) {
     return fGpu->precompileShader(key, data);
 }
 
+int GrContext::precompileShaders(const sk_sp<SkData> keys[], const sk_sp<SkData> data[],
+                                 int count) {
+    TRACE_EVENT0("skia.gpu", TRACE_FUNC);
+    GrContextOptions::PersistentCache* cache = this->priv().getPersistentCache();
+    if (this->abandoned() || !cache) {
+        return 0;
+    }
+
+    // We run one task per core, each claiming entries until none are left, so every worker
+    // converts the built-in modules into its compiler once rather than once per entry. A task that
+    // finds nothing left to claim doesn't build a compiler at all. The translations are stored
+    // afterwards, from this thread, since the PersistentCache isn't required to be thread safe.
+    std::vector<sk_sp<SkData>> translated(count);
+    std::atomic<int> next{0};
+    auto translate = [&](int) {
+        int i = next++;
+        if (i >= count) {
+            return;
+        }
+        SkSL::Compiler compiler;
+        for (; i < count; i = next++) {
+            translated[i] = fGpu->translateCachedShaders(&compiler, *data[i]);
+        }
+    };
+    if (SkExecutor* executor = this->options().fExecutor) {
+        // Our own group, so that we wait only on these tasks and not on others using fTaskGroup.
+        SkTaskGroup taskGroup(*executor);
+        int cores = (int)std::thread::hardware_concurrency();
+        taskGroup.batch(std::min(count, std::max(cores, 1)), translate);
+        taskGroup.wait();
+    } else {
+        translate(0);
+    }
+
+    int stored = 0;
+    for (int i = 0; i < count; ++i) {
+        if (translated[i]) {
+            cache->store(*keys[i], *translated[i]);
+            ++stored;
+        }
+    }
+    return stored;
+}
+
 #ifdef SK_ENABLE_DUMP_GPU
 #include "src/utils/SkJSONWriter.h"
 SkString GrContext::dump() const {
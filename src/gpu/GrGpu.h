@@ -42,6 +42,10 @@ class GrSurface;
 class GrTexture;
 class SkJSONWriter;
 
+namespace SkSL {
+class Compiler;
+}
+
 class GrGpu : public SkRefCnt {
 public:
     GrGpu(GrContext* context);
@@ -616,6 +620,16 @@ public:
 
     virtual bool precompileShader(const SkData& key, const SkData& data) { return false; }
 
+    /**
+     * Translates an SkSL cache entry (see GrContext::precompileShader) into the entry this backend
+     * would have stored for the same program, or returns null if that isn't possible. This is
+     * called from several threads at once, so it may only read state that doesn't change after
+     * creation (caps, options), and it compiles with the supplied compiler rather than its own.
+     */
+    virtual sk_sp<SkData> translateCachedShaders(SkSL::Compiler*, const SkData& data) const {
+        return nullptr;
+    }
+
 #if GR_TEST_UTILS
     /** Check a handle represents an actual texture in the backend API that has not been freed. */
     virtual bool isTestingOnlyBackendTexture(const GrBackendTexture&) const = 0;
@@ -37,6 +37,7 @@
 #include "src/gpu/gl/GrGLSemaphore.h"
 #include "src/gpu/gl/GrGLStencilAttachment.h"
 #include "src/gpu/gl/GrGLTextureRenderTarget.h"
+#include "src/gpu/gl/builders/GrGLProgramBuilder.h"
 #include "src/gpu/gl/builders/GrGLShaderStringBuilder.h"
 #include "src/sksl/SkSLCompiler.h"
 
@@ -3711,6 +3712,11 @@ void GrGLGpu::deleteBackendTexture(const GrBackendTexture& tex) {
     }
 }
 
+sk_sp<SkData> GrGLGpu::translateCachedShaders(SkSL::Compiler* compiler,
+                                              const SkData& data) const {
+    return GrGLProgramBuilder::TranslateCachedProgram(this, compiler, data);
+}
+
 #if GR_TEST_UTILS
 
 bool GrGLGpu::isTestingOnlyBackendTexture(const GrBackendTexture& tex) const {
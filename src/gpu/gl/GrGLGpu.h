@@ -162,6 +162,8 @@ public:
         return fProgramCache->precompileShader(key, data);
     }
 
+    sk_sp<SkData> translateCachedShaders(SkSL::Compiler*, const SkData& data) const override;
+
 #if GR_TEST_UTILS
     bool isTestingOnlyBackendTexture(const GrBackendTexture&) const override;
 
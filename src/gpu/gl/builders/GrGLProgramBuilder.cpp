@@ -29,6 +29,7 @@
 #include "src/gpu/glsl/GrGLSLGeometryProcessor.h"
 #include "src/gpu/glsl/GrGLSLProgramDataManager.h"
 #include "src/gpu/glsl/GrGLSLXferProcessor.h"
+#include "src/sksl/SkSLCompiler.h"
 
 #define GL_CALL(X) GR_GL_CALL(this->gpu()->glInterface(), X)
 #define GL_CALL_RET(R, X) GR_GL_CALL_RET(this->gpu()->glInterface(), R, X)
@@ -647,3 +648,47 @@ bool GrGLProgramBuilder::PrecompileProgram(GrGLPrecompiledProgram* precompiledPr
     precompiledProgram->fInputs = inputs;
     return true;
 }
+
+sk_sp<SkData> GrGLProgramBuilder::TranslateCachedProgram(const GrGLGpu* gpu,
+                                                         SkSL::Compiler* compiler,
+                                                         const SkData& cachedData) {
+    SkReader32 reader(cachedData.data(), cachedData.size());
+    SkFourByteTag shaderType = reader.readU32();
+    if (shaderType != kSKSL_Tag) {
+        return nullptr;
+    }
+
+    // These must match the settings finalize() would use for the same program.
+    SkSL::Program::Settings settings;
+    settings.fCaps = gpu->glCaps().shaderCaps();
+    settings.fSharpenTextures = gpu->getContext()->priv().options().fSharpenMipmappedTextures;
+    GrPersistentCacheUtils::ShaderMetadata meta;
+    meta.fSettings = &settings;
+
+    SkSL::String shaders[kGrShaderTypeCount];
+    SkSL::Program::Inputs inputs;
+    GrPersistentCacheUtils::UnpackCachedShaders(&reader, shaders, &inputs, 1, &meta);
+
+    static constexpr SkSL::Program::Kind kKinds[kGrShaderTypeCount] = {
+        SkSL::Program::kVertex_Kind,
+        SkSL::Program::kGeometry_Kind,
+        SkSL::Program::kFragment_Kind,
+    };
+    SkSL::String glsl[kGrShaderTypeCount];
+    for (int i = 0; i < kGrShaderTypeCount; ++i) {
+        if (shaders[i].empty()) {
+            SkASSERT(i == kGeometry_GrShaderType);
+            continue;
+        }
+        std::unique_ptr<SkSL::Program> program = compiler->convertProgram(kKinds[i], shaders[i],
+                                                                          settings);
+        if (!program || !compiler->toGLSL(*program, &glsl[i])) {
+            return nullptr;
+        }
+        if (i == kFragment_GrShaderType) {
+            // Like finalize(), GL only keeps the fragment shader's inputs.
+            inputs = program->fInputs;
+        }
+    }
+    return GrPersistentCacheUtils::PackCachedShaders(kGLSL_Tag, glsl, &inputs, 1, &meta);
+}
@@ -23,6 +23,10 @@ class GrProgramDesc;
 class GrGLSLShaderBuilder;
 class GrShaderCaps;
 
+namespace SkSL {
+class Compiler;
+}
+
 struct GrGLPrecompiledProgram {
     GrGLPrecompiledProgram(GrGLuint programID = 0,
                            SkSL::Program::Inputs inputs = SkSL::Program::Inputs())
@@ -52,6 +56,12 @@ public:
 
     static bool PrecompileProgram(GrGLPrecompiledProgram*, GrGLGpu*, const SkData&);
 
+    /**
+     * Translates the SkSL of a cached program to the GLSL finalize() would have generated for it,
+     * and returns the cache entry to store in its place. Safe to call from any thread.
+     */
+    static sk_sp<SkData> TranslateCachedProgram(const GrGLGpu*, SkSL::Compiler*, const SkData&);
+
     const GrCaps* caps() const override;
 
     GrGLGpu* gpu() const { return fGpu; }
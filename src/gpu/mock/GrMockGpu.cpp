@@ -5,12 +5,15 @@
  * found in the LICENSE file.
  */
 
+#include "src/core/SkReader32.h"
+#include "src/gpu/GrPersistentCacheUtils.h"
 #include "src/gpu/mock/GrMockBuffer.h"
 #include "src/gpu/mock/GrMockCaps.h"
 #include "src/gpu/mock/GrMockGpu.h"
 #include "src/gpu/mock/GrMockOpsRenderPass.h"
 #include "src/gpu/mock/GrMockStencilAttachment.h"
 #include "src/gpu/mock/GrMockTexture.h"
+#include "src/sksl/SkSLCompiler.h"
 #include <atomic>
 
 int GrMockGpu::NextInternalTextureID() {
@@ -333,6 +336,40 @@ void GrMockGpu::deleteBackendTexture(const GrBackendTexture& tex) {
     }
 }
 
+sk_sp<SkData> GrMockGpu::translateCachedShaders(SkSL::Compiler* compiler,
+                                                const SkData& data) const {
+    static constexpr SkFourByteTag kSKSL_Tag = SkSetFourByteTag('S', 'K', 'S', 'L');
+
+    SkReader32 reader(data.data(), data.size());
+    if (reader.readU32() != kSKSL_Tag) {
+        return nullptr;
+    }
+    SkSL::Program::Settings settings;
+    settings.fCaps = this->caps()->shaderCaps();
+    GrPersistentCacheUtils::ShaderMetadata meta;
+    meta.fSettings = &settings;
+    SkSL::String shaders[kGrShaderTypeCount];
+    SkSL::Program::Inputs inputs;
+    GrPersistentCacheUtils::UnpackCachedShaders(&reader, shaders, &inputs, 1, &meta);
+
+    static constexpr SkSL::Program::Kind kKinds[kGrShaderTypeCount] = {
+        SkSL::Program::kVertex_Kind,
+        SkSL::Program::kGeometry_Kind,
+        SkSL::Program::kFragment_Kind,
+    };
+    for (int i = 0; i < kGrShaderTypeCount; ++i) {
+        if (shaders[i].empty()) {
+            continue;
+        }
+        std::unique_ptr<SkSL::Program> program = compiler->convertProgram(kKinds[i], shaders[i],
+                                                                          settings);
+        if (!program || !compiler->optimize(*program)) {
+            return nullptr;
+        }
+    }
+    return SkData::MakeWithCopy(data.data(), data.size());
+}
+
 #if GR_TEST_UTILS
 bool GrMockGpu::isTestingOnlyBackendTexture(const GrBackendTexture& tex) const {
     SkASSERT(GrBackendApi::kMock == tex.backend());
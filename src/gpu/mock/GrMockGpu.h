@@ -155,6 +155,10 @@ private:
 
     bool compile(const GrProgramDesc&, const GrProgramInfo&) override { return false; }
 
+    // There is no shading language to translate to, so this only runs the SkSL front end over
+    // the entry, and returns it unchanged if it compiles.
+    sk_sp<SkData> translateCachedShaders(SkSL::Compiler*, const SkData& data) const override;
+
 #if GR_TEST_UTILS
     bool isTestingOnlyBackendTexture(const GrBackendTexture&) const override;
 
@@ -15,6 +15,9 @@ bool SkJpegEncoder::Encode(SkWStream*, const SkPixmap&, const Options&) { return
 std::unique_ptr<SkEncoder> SkJpegEncoder::Make(SkWStream*, const SkPixmap&, const Options&) {
     return nullptr;
 }
+std::unique_ptr<SkEncoder> SkJpegEncoder::Make(SkWStream*, const SkImageInfo&, const Options&) {
+    return nullptr;
+}
 #endif
 
 #ifndef SK_HAS_PNG_LIBRARY
@@ -22,6 +25,9 @@ bool SkPngEncoder::Encode(SkWStream*, const SkPixmap&, const Options&) { return
 std::unique_ptr<SkEncoder> SkPngEncoder::Make(SkWStream*, const SkPixmap&, const Options&) {
     return nullptr;
 }
+std::unique_ptr<SkEncoder> SkPngEncoder::Make(SkWStream*, const SkImageInfo&, const Options&) {
+    return nullptr;
+}
 #endif
 
 #ifndef SK_HAS_WEBP_LIBRARY
@@ -81,6 +87,10 @@ bool SkEncoder::encodeRows(int numRows) {
         return false;
     }
 
+    if (!fSrc.addr() && !fRows.addr()) {
+        return false;  // Made from an SkImageInfo, so we need rows passed in.
+    }
+
     if (fCurrRow + numRows > fSrc.height()) {
         numRows = fSrc.height() - fCurrRow;
     }
@@ -94,6 +104,22 @@ bool SkEncoder::encodeRows(int numRows) {
     return true;
 }
 
+bool SkEncoder::encodeRows(const SkPixmap& rows) {
+    if (!rows.addr() || rows.height() <= 0 || rows.rowBytes() < rows.info().minRowBytes() ||
+        rows.width()     != fSrc.width()     ||
+        rows.colorType() != fSrc.colorType() ||
+        rows.alphaType() != fSrc.alphaType() ||
+        !SkColorSpace::Equals(rows.colorSpace(), fSrc.colorSpace())) {
+        return false;
+    }
+
+    fRows    = rows;
+    fRowsTop = fCurrRow;
+    const bool success = this->encodeRows(rows.height());
+    fRows.reset();
+    return success;
+}
+
 sk_sp<SkData> SkEncodePixmap(const SkPixmap& src, SkEncodedImageFormat format, int quality) {
     SkDynamicMemoryWStream stream;
     return SkEncodeImage(&stream, src, format, quality) ? stream.detachAsData() : nullptr;
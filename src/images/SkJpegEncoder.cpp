@@ -169,7 +169,19 @@ std::unique_ptr<SkEncoder> SkJpegEncoder::Make(SkWStream* dst, const SkPixmap& s
     if (!SkPixmapIsValid(src)) {
         return nullptr;
     }
+    return MakeEncoder(dst, src, options);
+}
 
+std::unique_ptr<SkEncoder> SkJpegEncoder::Make(SkWStream* dst, const SkImageInfo& info,
+                                               const Options& options) {
+    if (!SkImageInfoIsValid(info)) {
+        return nullptr;
+    }
+    return MakeEncoder(dst, SkPixmap(info, nullptr, info.minRowBytes()), options);
+}
+
+std::unique_ptr<SkEncoder> SkJpegEncoder::MakeEncoder(SkWStream* dst, const SkPixmap& src,
+                                                      const Options& options) {
     std::unique_ptr<SkJpegEncoderMgr> encoderMgr = SkJpegEncoderMgr::Make(dst);
 
     skjpeg_error_mgr::AutoPushJmpBuf jmp(encoderMgr->errorMgr());
@@ -181,7 +193,16 @@ std::unique_ptr<SkEncoder> SkJpegEncoder::Make(SkWStream* dst, const SkPixmap& s
         return nullptr;
     }
 
+    if (!src.addr()) {
+        // Optimal Huffman tables need statistics from the whole image, so libjpeg-turbo would
+        // buffer every coefficient until the last row.  When streaming, use standard tables.
+        encoderMgr->cinfo()->optimize_coding = FALSE;
+    }
+
     jpeg_set_quality(encoderMgr->cinfo(), options.fQuality, TRUE);
+    if (options.fRestartRows > 0) {
+        encoderMgr->cinfo()->restart_in_rows = options.fRestartRows;
+    }
     jpeg_start_compress(encoderMgr->cinfo(), TRUE);
 
     sk_sp<SkData> icc = icc_from_color_space(src.info());
@@ -218,8 +239,8 @@ bool SkJpegEncoder::onEncodeRows(int numRows) {
     const size_t srcBytes = SkColorTypeBytesPerPixel(fSrc.colorType()) * fSrc.width();
     const size_t jpegSrcBytes = fEncoderMgr->cinfo()->input_components * fSrc.width();
 
-    const void* srcRow = fSrc.addr(0, fCurrRow);
     for (int i = 0; i < numRows; i++) {
+        const void* srcRow = this->srcRow(fCurrRow + i);
         JSAMPLE* jpegSrcRow = (JSAMPLE*) srcRow;
         if (fEncoderMgr->proc()) {
             sk_msan_assert_initialized(srcRow, SkTAddOffset<const void>(srcRow, srcBytes));
@@ -238,7 +259,6 @@ bool SkJpegEncoder::onEncodeRows(int numRows) {
         }
 
         jpeg_write_scanlines(fEncoderMgr->cinfo(), &jpegSrcRow, 1);
-        srcRow = SkTAddOffset<const void>(srcRow, fSrc.rowBytes());
     }
 
     fCurrRow += numRows;
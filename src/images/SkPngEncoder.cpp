@@ -15,11 +15,14 @@
 #include "include/private/SkImageInfoPriv.h"
 #include "src/codec/SkColorTable.h"
 #include "src/codec/SkPngPriv.h"
+#include "src/core/SkEndian.h"
 #include "src/core/SkMSAN.h"
 #include "src/images/SkImageEncoderFns.h"
+#include "src/utils/SkDeflate.h"
 #include <vector>
 
 #include "png.h"
+#include "zlib.h"
 
 static_assert(PNG_FILTER_NONE  == (int)SkPngEncoder::FilterFlag::kNone,  "Skia libpng filter err.");
 static_assert(PNG_FILTER_SUB   == (int)SkPngEncoder::FilterFlag::kSub,   "Skia libpng filter err.");
@@ -45,6 +48,65 @@ static void sk_write_fn(png_structp png_ptr, png_bytep data, png_size_t len) {
     }
 }
 
+// When we deflate the image data ourselves, this writes it out as IDAT chunks.  It writes
+// straight to the destination stream rather than through libpng, so that a failed write is
+// reported with a return value instead of a longjmp out of the middle of SkDeflateWStream.
+class SkPngIDATWStream final : public SkWStream {
+public:
+    explicit SkPngIDATWStream(SkWStream* stream) : fStream(stream) {}
+
+    bool write(const void* data, size_t len) override {
+        const uint8_t* bytes = (const uint8_t*)data;
+        fBytesWritten += len;
+        while (len > 0) {
+            size_t tocopy = std::min(len, sizeof(fBuffer) - fBufferIndex);
+            memcpy(fBuffer + fBufferIndex, bytes, tocopy);
+            len -= tocopy;
+            bytes += tocopy;
+            fBufferIndex += tocopy;
+            if (sizeof(fBuffer) == fBufferIndex) {
+                this->flush();
+            }
+        }
+        return !fFailed;
+    }
+
+    void flush() override {
+        if (fBufferIndex > 0) {
+            this->writeChunk("IDAT", fBuffer, fBufferIndex);
+            fBufferIndex = 0;
+        }
+    }
+
+    size_t bytesWritten() const override { return fBytesWritten; }
+
+    // Writes a chunk: its length, type and data, then the CRC of its type and data.
+    void writeChunk(const char type[4], const uint8_t* data, size_t len) {
+        if (fFailed || !fStream) {
+            fFailed = true;
+            return;
+        }
+        uLong crc = crc32(crc32(0, nullptr, 0), (const Bytef*)type, 4);
+        crc = crc32(crc, data, SkToUInt(len));
+        fFailed = !fStream->write32(SkEndian_SwapBE32(SkToU32(len))) ||
+                  !fStream->write(type, 4) ||
+                  !fStream->write(data, len) ||
+                  !fStream->write32(SkEndian_SwapBE32(SkToU32(crc)));
+    }
+
+    bool failed() const { return fFailed; }
+
+    // Drop anything written from now on, e.g. when the encoder is destroyed before the last row.
+    void abandon() { fStream = nullptr; }
+
+private:
+    SkWStream* fStream;
+    uint8_t    fBuffer[8192];
+    size_t     fBufferIndex = 0;
+    size_t     fBytesWritten = 0;
+    bool       fFailed = false;
+};
+
 class SkPngEncoderMgr final : SkNoncopyable {
 public:
 
@@ -59,26 +121,51 @@ public:
     bool writeInfo(const SkImageInfo& srcInfo);
     void chooseProc(const SkImageInfo& srcInfo);
 
+    // Must follow writeInfo(), as the image data follows the info chunks.
+    void setParallelDeflate(const SkImageInfo& srcInfo, const SkPngEncoder::Options& options);
+
     png_structp pngPtr() { return fPngPtr; }
     png_infop infoPtr() { return fInfoPtr; }
     int pngBytesPerPixel() const { return fPngBytesPerPixel; }
     transform_scanline_proc proc() const { return fProc; }
 
+    // With parallel deflate, rows are written with these instead of png_write_rows() and
+    // png_write_end().  Rows are as passed to libpng, after proc().
+    bool parallelDeflate() const { return fDeflate != nullptr; }
+    bool writeRow(uint8_t* row);
+    bool writeEnd();
+
     ~SkPngEncoderMgr() {
+        if (fIDAT) {
+            fIDAT->abandon();
+        }
+        fDeflate.reset();
         png_destroy_write_struct(&fPngPtr, &fInfoPtr);
     }
 
 private:
 
-    SkPngEncoderMgr(png_structp pngPtr, png_infop infoPtr)
+    SkPngEncoderMgr(png_structp pngPtr, png_infop infoPtr, SkWStream* stream)
         : fPngPtr(pngPtr)
         , fInfoPtr(infoPtr)
+        , fStream(stream)
     {}
 
     png_structp             fPngPtr;
     png_infop               fInfoPtr;
+    SkWStream*              fStream;
     int                     fPngBytesPerPixel;
     transform_scanline_proc fProc;
+
+    // State for parallel deflate.
+    std::unique_ptr<SkPngIDATWStream> fIDAT;
+    std::unique_ptr<SkDeflateWStream> fDeflate;
+    int                               fFilters = 0;
+    bool                              fStripFiller = false;
+    size_t                            fRowBytes = 0;  // As written, without the filter byte.
+    int                               fFilterBpp = 0;
+    SkAutoTMalloc<uint8_t>            fPrevRow;
+    SkAutoTMalloc<uint8_t>            fFilteredRows;  // Best and candidate, each with its type.
 };
 
 std::unique_ptr<SkPngEncoderMgr> SkPngEncoderMgr::Make(SkWStream* stream) {
@@ -95,7 +182,7 @@ std::unique_ptr<SkPngEncoderMgr> SkPngEncoderMgr::Make(SkWStream* stream) {
     }
 
     png_set_write_fn(pngPtr, (void*)stream, sk_write_fn, nullptr);
-    return std::unique_ptr<SkPngEncoderMgr>(new SkPngEncoderMgr(pngPtr, infoPtr));
+    return std::unique_ptr<SkPngEncoderMgr>(new SkPngEncoderMgr(pngPtr, infoPtr, stream));
 }
 
 bool SkPngEncoderMgr::setHeader(const SkImageInfo& srcInfo, const SkPngEncoder::Options& options) {
@@ -392,12 +479,112 @@ void SkPngEncoderMgr::chooseProc(const SkImageInfo& srcInfo) {
     fProc = choose_proc(srcInfo);
 }
 
+void SkPngEncoderMgr::setParallelDeflate(const SkImageInfo& srcInfo,
+                                         const SkPngEncoder::Options& options) {
+    fFilters = (int)options.fFilterFlags & (int)SkPngEncoder::FilterFlag::kAll;
+    if (!fFilters) {
+        fFilters = (int)SkPngEncoder::FilterFlag::kNone;
+    }
+    // Match the png_set_filler() in writeInfo().
+    fStripFiller = kRGBA_F16_SkColorType == srcInfo.colorType() &&
+                   kOpaque_SkAlphaType == srcInfo.alphaType();
+    fRowBytes = png_get_rowbytes(fPngPtr, fInfoPtr);
+    fFilterBpp = SkToInt(fRowBytes / srcInfo.width());
+    fPrevRow.reset(fRowBytes);
+    sk_bzero(fPrevRow.get(), fRowBytes);
+    fFilteredRows.reset(2 * (fRowBytes + 1));
+
+    fIDAT = std::make_unique<SkPngIDATWStream>(fStream);
+    fDeflate = std::make_unique<SkDeflateWStream>(fIDAT.get(),
+                                                  std::min(std::max(0, options.fZLibLevel), 9),
+                                                  false, options.fExecutor);
+}
+
+static uint8_t paeth_predictor(int a, int b, int c) {
+    int p = a + b - c;
+    int pa = SkTAbs(p - a),
+        pb = SkTAbs(p - b),
+        pc = SkTAbs(p - c);
+    return pa <= pb && pa <= pc ? a
+         : pb <= pc             ? b
+         :                        c;
+}
+
+// Writes the filter type, then the row filtered with it, to dst.  Returns the sum of the filtered
+// bytes taken as signed, which libpng minimizes to guess which filter will compress best.
+static uint32_t filter_row(int type, const uint8_t* row, const uint8_t* prev, size_t rowBytes,
+                           int bpp, uint8_t* dst) {
+    *dst++ = SkToU8(type);
+    uint32_t sum = 0;
+    for (size_t i = 0; i < rowBytes; i++) {
+        int a = i >= (size_t)bpp ? row [i - bpp] : 0,
+            b =                    prev[i],
+            c = i >= (size_t)bpp ? prev[i - bpp] : 0;
+        int prediction = 0;
+        switch (type) {
+            case PNG_FILTER_VALUE_SUB:   prediction = a;                        break;
+            case PNG_FILTER_VALUE_UP:    prediction = b;                        break;
+            case PNG_FILTER_VALUE_AVG:   prediction = (a + b) >> 1;             break;
+            case PNG_FILTER_VALUE_PAETH: prediction = paeth_predictor(a, b, c); break;
+        }
+        uint8_t filtered = row[i] - prediction;
+        dst[i] = filtered;
+        sum += filtered < 128 ? filtered : 256 - filtered;
+    }
+    return sum;
+}
+
+bool SkPngEncoderMgr::writeRow(uint8_t* row) {
+    if (fStripFiller) {
+        // RGBA 16-bit to RGB 16-bit, in place.
+        for (size_t src = 0, dst = 0; dst < fRowBytes; src += 8, dst += 6) {
+            memmove(row + dst, row + src, 6);
+        }
+    }
+
+    uint8_t* best      = fFilteredRows.get();
+    uint8_t* candidate = best + fRowBytes + 1;
+    uint32_t bestSum   = UINT32_MAX;
+    for (int type = PNG_FILTER_VALUE_NONE; type < PNG_FILTER_VALUE_LAST; type++) {
+        if (!(fFilters & ((int)SkPngEncoder::FilterFlag::kNone << type))) {
+            continue;
+        }
+        uint32_t sum = filter_row(type, row, fPrevRow.get(), fRowBytes, fFilterBpp, candidate);
+        if (sum < bestSum) {
+            bestSum = sum;
+            std::swap(best, candidate);
+        }
+    }
+
+    memcpy(fPrevRow.get(), row, fRowBytes);
+    return fDeflate->write(best, fRowBytes + 1) && !fIDAT->failed();
+}
+
+bool SkPngEncoderMgr::writeEnd() {
+    fDeflate->finalize();
+    fIDAT->flush();
+    fIDAT->writeChunk("IEND", nullptr, 0);
+    return !fIDAT->failed();
+}
+
 std::unique_ptr<SkEncoder> SkPngEncoder::Make(SkWStream* dst, const SkPixmap& src,
                                               const Options& options) {
     if (!SkPixmapIsValid(src)) {
         return nullptr;
     }
+    return MakeEncoder(dst, src, options);
+}
 
+std::unique_ptr<SkEncoder> SkPngEncoder::Make(SkWStream* dst, const SkImageInfo& info,
+                                              const Options& options) {
+    if (!SkImageInfoIsValid(info)) {
+        return nullptr;
+    }
+    return MakeEncoder(dst, SkPixmap(info, nullptr, info.minRowBytes()), options);
+}
+
+std::unique_ptr<SkEncoder> SkPngEncoder::MakeEncoder(SkWStream* dst, const SkPixmap& src,
+                                                     const Options& options) {
     std::unique_ptr<SkPngEncoderMgr> encoderMgr = SkPngEncoderMgr::Make(dst);
     if (!encoderMgr) {
         return nullptr;
@@ -416,6 +603,9 @@ std::unique_ptr<SkEncoder> SkPngEncoder::Make(SkWStream* dst, const SkPixmap& sr
     }
 
     encoderMgr->chooseProc(src.info());
+    if (options.fExecutor) {
+        encoderMgr->setParallelDeflate(src.info(), options);
+    }
 
     return std::unique_ptr<SkPngEncoder>(new SkPngEncoder(std::move(encoderMgr), src));
 }
@@ -432,8 +622,8 @@ bool SkPngEncoder::onEncodeRows(int numRows) {
         return false;
     }
 
-    const void* srcRow = fSrc.addr(0, fCurrRow);
     for (int y = 0; y < numRows; y++) {
+        const void* srcRow = this->srcRow(fCurrRow + y);
         sk_msan_assert_initialized(srcRow,
                                    (const uint8_t*)srcRow + (fSrc.width() << fSrc.shiftPerPixel()));
         fEncoderMgr->proc()((char*)fStorage.get(),
@@ -442,12 +632,20 @@ bool SkPngEncoder::onEncodeRows(int numRows) {
                             SkColorTypeBytesPerPixel(fSrc.colorType()));
 
         png_bytep rowPtr = (png_bytep) fStorage.get();
-        png_write_rows(fEncoderMgr->pngPtr(), &rowPtr, 1);
-        srcRow = SkTAddOffset<const void>(srcRow, fSrc.rowBytes());
+        if (fEncoderMgr->parallelDeflate()) {
+            if (!fEncoderMgr->writeRow(rowPtr)) {
+                return false;
+            }
+        } else {
+            png_write_rows(fEncoderMgr->pngPtr(), &rowPtr, 1);
+        }
     }
 
     fCurrRow += numRows;
     if (fCurrRow == fSrc.height()) {
+        if (fEncoderMgr->parallelDeflate()) {
+            return fEncoderMgr->writeEnd();
+        }
         png_write_end(fEncoderMgr->pngPtr(), fEncoderMgr->infoPtr());
     }
 
@@ -72,8 +72,8 @@ struct Ctx {
     #define JUMPER_IS_SCALAR
 #elif defined(SK_ARM_HAS_NEON)
     #define JUMPER_IS_NEON
-#elif SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_AVX512
-    #define JUMPER_IS_AVX512
+#elif SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SKX
+    #define JUMPER_IS_SKX
 #elif SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_AVX2
     #define JUMPER_IS_HSW
 #elif SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_AVX
@@ -336,7 +336,197 @@ namespace SK_OPTS_NS {
         }
     }
 
-#elif defined(JUMPER_IS_AVX) || defined(JUMPER_IS_HSW) || defined(JUMPER_IS_AVX512)
+#elif defined(JUMPER_IS_SKX)
+    // These are __m512 and __m512i, but friendlier and strongly-typed.
+    template <typename T> using V = T __attribute__((ext_vector_type(16)));
+    using F   = V<float   >;
+    using I32 = V< int32_t>;
+    using U64 = V<uint64_t>;
+    using U32 = V<uint32_t>;
+    using U16 = V<uint16_t>;
+    using U8  = V<uint8_t >;
+
+    SI F   mad(F f, F m, F a)   { return _mm512_fmadd_ps(f,m,a); }
+    SI F   min(F a, F b)        { return _mm512_min_ps(a,b);    }
+    SI F   max(F a, F b)        { return _mm512_max_ps(a,b);    }
+    SI F   abs_  (F v)          { return _mm512_and_ps(v, 0-v); }
+    SI F   floor_(F v)          { return _mm512_roundscale_ps(v, _MM_FROUND_TO_NEG_INF); }
+    SI F   rcp   (F v)          { return _mm512_rcp14_ps  (v);  }
+    SI F   rsqrt (F v)          { return _mm512_rsqrt14_ps(v);  }
+    SI F    sqrt_(F v)          { return _mm512_sqrt_ps   (v);  }
+    SI U32 round (F v, F scale) { return _mm512_cvtps_epi32(v*scale); }
+
+    SI U16 pack(U32 v) {
+        // Saturate the same way _mm_packus_epi32() does: negative to 0, too large to 0xffff.
+        return _mm512_cvtusepi32_epi16(_mm512_max_epi32(v, _mm512_setzero_si512()));
+    }
+    SI U8 pack(U16 v) {
+        return _mm256_cvtusepi16_epi8(v);
+    }
+
+    SI F if_then_else(I32 c, F t, F e) {
+        return _mm512_mask_blend_ps(_mm512_movepi32_mask(c), e,t);
+    }
+
+    template <typename T>
+    SI V<T> gather(const T* p, U32 ix) {
+        return { p[ix[ 0]], p[ix[ 1]], p[ix[ 2]], p[ix[ 3]],
+                 p[ix[ 4]], p[ix[ 5]], p[ix[ 6]], p[ix[ 7]],
+                 p[ix[ 8]], p[ix[ 9]], p[ix[10]], p[ix[11]],
+                 p[ix[12]], p[ix[13]], p[ix[14]], p[ix[15]], };
+    }
+    SI F   gather(const float*    p, U32 ix) { return _mm512_i32gather_ps   (ix, p, 4); }
+    SI U32 gather(const uint32_t* p, U32 ix) { return _mm512_i32gather_epi32(ix, p, 4); }
+    SI U64 gather(const uint64_t* p, U32 ix) {
+        __m512i parts[] = {
+            _mm512_i32gather_epi64(_mm512_castsi512_si256   (ix   ), p, 8),
+            _mm512_i32gather_epi64(_mm512_extracti64x4_epi64(ix, 1), p, 8),
+        };
+        return bit_cast<U64>(parts);
+    }
+
+    // Rather than working lane by lane, we handle tails with mask registers:
+    // masked-off lanes are never loaded (so can't fault) and never stored.
+    SI __mmask16 tail_mask(size_t tail) {
+        return tail ? (__mmask16)((1u << tail) - 1) : (__mmask16)0xffff;
+    }
+    // Masks selecting the first n lanes of a register, for any n, even n <= 0.
+    SI __mmask16 first16(int n) {
+        return n <= 0 ? 0 : n >= 16 ? (__mmask16)0xffff     : (__mmask16)((1u << n) - 1);
+    }
+    SI __mmask32 first32(int n) {
+        return n <= 0 ? 0 : n >= 32 ? (__mmask32)0xffffffff : (__mmask32)((1u << n) - 1);
+    }
+
+    SI void load2(const uint16_t* ptr, size_t tail, U16* r, U16* g) {
+        // Each pixel is one 32-bit lane, r in the low half and g in the high half.
+        __m512i rg = _mm512_maskz_loadu_epi32(tail_mask(tail), ptr);
+        *r = _mm512_cvtepi32_epi16(rg);
+        *g = _mm512_cvtepi32_epi16(_mm512_srli_epi32(rg, 16));
+    }
+    SI void store2(uint16_t* ptr, size_t tail, U16 r, U16 g) {
+        __m512i rg = _mm512_or_si512(                  _mm512_cvtepu16_epi32(r)     ,
+                                     _mm512_slli_epi32(_mm512_cvtepu16_epi32(g), 16));
+        _mm512_mask_storeu_epi32(ptr, tail_mask(tail), rg);
+    }
+
+    SI void load3(const uint16_t* ptr, size_t tail, U16* r, U16* g, U16* b) {
+        // 16 pixels are 48 values, which we load as two registers of up to 32 values.
+        // A single two-register permute then picks out every third value for each channel.
+        static const uint16_t kIx[3][32] = {
+            { 0,3,6, 9,12,15,18,21,24,27,30,33,36,39,42,45 },
+            { 1,4,7,10,13,16,19,22,25,28,31,34,37,40,43,46 },
+            { 2,5,8,11,14,17,20,23,26,29,32,35,38,41,44,47 },
+        };
+        const int n = 3 * (tail ? (int)tail : 16);
+        __m512i lo = _mm512_maskz_loadu_epi16(first32(n   ), ptr     ),
+                hi = _mm512_maskz_loadu_epi16(first32(n-32), ptr + 32);
+
+        auto channel = [&](int c) -> U16 {
+            return _mm512_castsi512_si256(
+                    _mm512_permutex2var_epi16(lo, _mm512_loadu_si512(kIx[c]), hi));
+        };
+        *r = channel(0);
+        *g = channel(1);
+        *b = channel(2);
+    }
+    SI void load4(const uint16_t* ptr, size_t tail, U16* r, U16* g, U16* b, U16* a) {
+        // Each pixel is one 64-bit lane, and _mm512_cvtepi64_epi16() keeps the low 16 bits of each.
+        const __mmask16 mask = tail_mask(tail);
+        __m512i lo = _mm512_maskz_loadu_epi64((__mmask8)(mask     ), ptr     ),
+                hi = _mm512_maskz_loadu_epi64((__mmask8)(mask >> 8), ptr + 32);
+
+        auto channel = [](__m512i lo, __m512i hi) -> U16 {
+            return _mm256_inserti128_si256(_mm256_castsi128_si256(_mm512_cvtepi64_epi16(lo)),
+                                                                  _mm512_cvtepi64_epi16(hi), 1);
+        };
+        *r = channel(                  lo     ,                   hi     );
+        *g = channel(_mm512_srli_epi64(lo, 16), _mm512_srli_epi64(hi, 16));
+        *b = channel(_mm512_srli_epi64(lo, 32), _mm512_srli_epi64(hi, 32));
+        *a = channel(_mm512_srli_epi64(lo, 48), _mm512_srli_epi64(hi, 48));
+    }
+    SI void store4(uint16_t* ptr, size_t tail, U16 r, U16 g, U16 b, U16 a) {
+        auto pixels = [](__m128i r, __m128i g, __m128i b, __m128i a) {
+            return _mm512_or_si512(
+                    _mm512_or_si512(                  _mm512_cvtepu16_epi64(r)     ,
+                                    _mm512_slli_epi64(_mm512_cvtepu16_epi64(g), 16)),
+                    _mm512_or_si512(_mm512_slli_epi64(_mm512_cvtepu16_epi64(b), 32),
+                                    _mm512_slli_epi64(_mm512_cvtepu16_epi64(a), 48)));
+        };
+        auto lo = [](U16 v) { return _mm256_castsi256_si128   (v   ); };
+        auto hi = [](U16 v) { return _mm256_extracti128_si256(v, 1); };
+
+        const __mmask16 mask = tail_mask(tail);
+        _mm512_mask_storeu_epi64(ptr     , (__mmask8)(mask     ), pixels(lo(r),lo(g),lo(b),lo(a)));
+        _mm512_mask_storeu_epi64(ptr + 32, (__mmask8)(mask >> 8), pixels(hi(r),hi(g),hi(b),hi(a)));
+    }
+
+    SI void load2(const float* ptr, size_t tail, F* r, F* g) {
+        // Each pixel is one 64-bit lane, 8 pixels to a register.
+        const __mmask16 mask = tail_mask(tail);
+        __m512 lo = _mm512_castpd_ps(_mm512_maskz_loadu_pd((__mmask8)(mask     ), ptr     )),
+               hi = _mm512_castpd_ps(_mm512_maskz_loadu_pd((__mmask8)(mask >> 8), ptr + 16));
+
+        *r = _mm512_permutex2var_ps(lo, _mm512_setr_epi32( 0, 2, 4, 6, 8,10,12,14,
+                                                          16,18,20,22,24,26,28,30), hi);
+        *g = _mm512_permutex2var_ps(lo, _mm512_setr_epi32( 1, 3, 5, 7, 9,11,13,15,
+                                                          17,19,21,23,25,27,29,31), hi);
+    }
+    SI void store2(float* ptr, size_t tail, F r, F g) {
+        __m512 lo = _mm512_permutex2var_ps(r, _mm512_setr_epi32(0,16, 1,17, 2,18, 3,19,
+                                                                 4,20, 5,21, 6,22, 7,23), g),
+               hi = _mm512_permutex2var_ps(r, _mm512_setr_epi32(8,24, 9,25,10,26,11,27,
+                                                                12,28,13,29,14,30,15,31), g);
+
+        const __mmask16 mask = tail_mask(tail);
+        _mm512_mask_storeu_pd(ptr     , (__mmask8)(mask     ), _mm512_castps_pd(lo));
+        _mm512_mask_storeu_pd(ptr + 16, (__mmask8)(mask >> 8), _mm512_castps_pd(hi));
+    }
+
+    SI void load4(const float* ptr, size_t tail, F* r, F* g, F* b, F* a) {
+        const int n = 4 * (tail ? (int)tail : 16);
+        __m512 _0123 = _mm512_maskz_loadu_ps(first16(n- 0), ptr+ 0),
+               _4567 = _mm512_maskz_loadu_ps(first16(n-16), ptr+16),
+               _89ab = _mm512_maskz_loadu_ps(first16(n-32), ptr+32),
+               _cdef = _mm512_maskz_loadu_ps(first16(n-48), ptr+48);
+
+        // Pick out each channel of pixels 0-7 and 8-15 from pairs of registers into the
+        // bottom halves of two registers, then splice those halves together.
+        auto channel = [&](int c) -> F {
+            __m512i ix = _mm512_add_epi32(_mm512_setr_epi32(0,4,8,12,16,20,24,28,
+                                                            0,4,8,12,16,20,24,28),
+                                          _mm512_set1_epi32(c));
+            return _mm512_shuffle_f32x4(_mm512_permutex2var_ps(_0123, ix, _4567),
+                                        _mm512_permutex2var_ps(_89ab, ix, _cdef), 0x44);
+        };
+        *r = channel(0);
+        *g = channel(1);
+        *b = channel(2);
+        *a = channel(3);
+    }
+    SI void store4(float* ptr, size_t tail, F r, F g, F b, F a) {
+        const __m512i lo = _mm512_setr_epi32(0,16, 1,17, 2,18, 3,19, 4,20, 5,21, 6,22, 7,23),
+                      hi = _mm512_setr_epi32(8,24, 9,25,10,26,11,27,12,28,13,29,14,30,15,31);
+        __m512 rg01234567 = _mm512_permutex2var_ps(r, lo, g),  // r0 g0 r1 g1 ... r7 g7
+               rg89abcdef = _mm512_permutex2var_ps(r, hi, g),
+               ba01234567 = _mm512_permutex2var_ps(b, lo, a),
+               ba89abcdef = _mm512_permutex2var_ps(b, hi, a);
+
+        const __m512i ix0 = _mm512_setr_epi32(0, 1,16,17, 2, 3,18,19, 4, 5,20,21, 6, 7,22,23),
+                      ix1 = _mm512_setr_epi32(8, 9,24,25,10,11,26,27,12,13,28,29,14,15,30,31);
+        __m512 _0123 = _mm512_permutex2var_ps(rg01234567, ix0, ba01234567),  // r0 g0 b0 a0 r1 ...
+               _4567 = _mm512_permutex2var_ps(rg01234567, ix1, ba01234567),
+               _89ab = _mm512_permutex2var_ps(rg89abcdef, ix0, ba89abcdef),
+               _cdef = _mm512_permutex2var_ps(rg89abcdef, ix1, ba89abcdef);
+
+        const int n = 4 * (tail ? (int)tail : 16);
+        _mm512_mask_storeu_ps(ptr+ 0, first16(n- 0), _0123);
+        _mm512_mask_storeu_ps(ptr+16, first16(n-16), _4567);
+        _mm512_mask_storeu_ps(ptr+32, first16(n-32), _89ab);
+        _mm512_mask_storeu_ps(ptr+48, first16(n-48), _cdef);
+    }
+
+#elif defined(JUMPER_IS_AVX) || defined(JUMPER_IS_HSW)
     // These are __m256 and __m256i, but friendlier and strongly-typed.
     template <typename T> using V = T __attribute__((ext_vector_type(8)));
     using F   = V<float   >;
@@ -347,7 +537,7 @@ namespace SK_OPTS_NS {
     using U8  = V<uint8_t >;
 
     SI F mad(F f, F m, F a)  {
-    #if defined(JUMPER_IS_HSW) || defined(JUMPER_IS_AVX512)
+    #if defined(JUMPER_IS_HSW)
         return _mm256_fmadd_ps(f,m,a);
     #else
         return f*m+a;
@@ -379,7 +569,7 @@ namespace SK_OPTS_NS {
         return { p[ix[0]], p[ix[1]], p[ix[2]], p[ix[3]],
                  p[ix[4]], p[ix[5]], p[ix[6]], p[ix[7]], };
     }
-    #if defined(JUMPER_IS_HSW) || defined(JUMPER_IS_AVX512)
+    #if defined(JUMPER_IS_HSW)
         SI F   gather(const float*    p, U32 ix) { return _mm256_i32gather_ps   (p, ix, 4); }
         SI U32 gather(const uint32_t* p, U32 ix) { return _mm256_i32gather_epi32(p, ix, 4); }
         SI U64 gather(const uint64_t* p, U32 ix) {
@@ -990,7 +1180,10 @@ SI F from_half(U16 h) {
     && !defined(SK_BUILD_FOR_GOOGLE3)  // Temporary workaround for some Google3 builds.
     return vcvt_f32_f16(h);
 
-#elif defined(JUMPER_IS_HSW) || defined(JUMPER_IS_AVX512)
+#elif defined(JUMPER_IS_SKX)
+    return _mm512_cvtph_ps(h);
+
+#elif defined(JUMPER_IS_HSW)
     return _mm256_cvtph_ps(h);
 
 #else
@@ -1011,7 +1204,10 @@ SI U16 to_half(F f) {
     && !defined(SK_BUILD_FOR_GOOGLE3)  // Temporary workaround for some Google3 builds.
     return vcvt_f16_f32(f);
 
-#elif defined(JUMPER_IS_HSW) || defined(JUMPER_IS_AVX512)
+#elif defined(JUMPER_IS_SKX)
+    return _mm512_cvtps_ph(f, _MM_FROUND_CUR_DIRECTION);
+
+#elif defined(JUMPER_IS_HSW)
     return _mm256_cvtps_ph(f, _MM_FROUND_CUR_DIRECTION);
 
 #else
@@ -1146,7 +1342,22 @@ static void start_pipeline(size_t dx, size_t dy, size_t xlimit, size_t ylimit, v
 
 template <typename V, typename T>
 SI V load(const T* src, size_t tail) {
-#if !defined(JUMPER_IS_SCALAR)
+#if defined(JUMPER_IS_SKX)
+    __builtin_assume(tail < N);
+    if (__builtin_expect(tail, 0)) {
+        const __mmask16 mask = tail_mask(tail);  // Any inactive lanes are zeroed.
+        if constexpr (sizeof(T) == 1) { return bit_cast<V>(_mm_maskz_loadu_epi8    (mask, src)); }
+        if constexpr (sizeof(T) == 2) { return bit_cast<V>(_mm256_maskz_loadu_epi16(mask, src)); }
+        if constexpr (sizeof(T) == 4) { return bit_cast<V>(_mm512_maskz_loadu_epi32(mask, src)); }
+        if constexpr (sizeof(T) == 8) {
+            __m512i parts[] = {
+                _mm512_maskz_loadu_epi64((__mmask8)(mask     ), src    ),
+                _mm512_maskz_loadu_epi64((__mmask8)(mask >> 8), src + 8),
+            };
+            return bit_cast<V>(parts);
+        }
+    }
+#elif !defined(JUMPER_IS_SCALAR)
     __builtin_assume(tail < N);
     if (__builtin_expect(tail, 0)) {
         V v{};  // Any inactive lanes are zeroed.
@@ -1167,7 +1378,28 @@ SI V load(const T* src, size_t tail) {
 
 template <typename V, typename T>
 SI void store(T* dst, V v, size_t tail) {
-#if !defined(JUMPER_IS_SCALAR)
+#if defined(JUMPER_IS_SKX)
+    __builtin_assume(tail < N);
+    if (__builtin_expect(tail, 0)) {
+        const __mmask16 mask = tail_mask(tail);
+        if constexpr (sizeof(T) == 1) {
+            _mm_mask_storeu_epi8    (dst, mask, bit_cast<__m128i>(v));
+        }
+        if constexpr (sizeof(T) == 2) {
+            _mm256_mask_storeu_epi16(dst, mask, bit_cast<__m256i>(v));
+        }
+        if constexpr (sizeof(T) == 4) {
+            _mm512_mask_storeu_epi32(dst, mask, bit_cast<__m512i>(v));
+        }
+        if constexpr (sizeof(T) == 8) {
+            __m512i parts[2];
+            memcpy(parts, &v, sizeof(parts));
+            _mm512_mask_storeu_epi64(dst    , (__mmask8)(mask     ), parts[0]);
+            _mm512_mask_storeu_epi64(dst + 8, (__mmask8)(mask >> 8), parts[1]);
+        }
+        return;
+    }
+#elif !defined(JUMPER_IS_SCALAR)
     __builtin_assume(tail < N);
     if (__builtin_expect(tail, 0)) {
         switch (tail) {
@@ -1288,7 +1520,7 @@ STAGE(seed_shader, Ctx::None) {
 
 STAGE(dither, const float* rate) {
     // Get [(dx,dy), (dx+1,dy), (dx+2,dy), ...] loaded up in integer vectors.
-    uint32_t iota[] = {0,1,2,3,4,5,6,7};
+    uint32_t iota[] = {0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15};
     U32 X = dx + sk_unaligned_load<U32>(iota),
         Y = dy;
 
@@ -1922,7 +2154,7 @@ STAGE(to_srgb, Ctx::None) {
         U32 sign;
         l = strip_sign(l, &sign);
         // We tweak c and d for each instruction set to make sure fn(1) is exactly 1.
-    #if defined(JUMPER_IS_AVX512)
+    #if defined(JUMPER_IS_SKX)
         const float c = 1.130026340485f,
                     d = 0.141387879848f;
     #elif defined(JUMPER_IS_SSE2) || defined(JUMPER_IS_SSE41) || \
@@ -2436,7 +2668,20 @@ STAGE(matrix_perspective, const float* m) {
 SI void gradient_lookup(const SkRasterPipeline_GradientCtx* c, U32 idx, F t,
                         F* r, F* g, F* b, F* a) {
     F fr, br, fg, bg, fb, bb, fa, ba;
-#if defined(JUMPER_IS_HSW) || defined(JUMPER_IS_AVX512)
+#if defined(JUMPER_IS_SKX)
+    if (c->stopCount <= 16) {
+        // The stop arrays may be shorter than 16, so only load the first stopCount of each.
+        const __mmask16 m = (__mmask16)((1u << c->stopCount) - 1);
+        fr = _mm512_permutexvar_ps(idx, _mm512_maskz_loadu_ps(m, c->fs[0]));
+        br = _mm512_permutexvar_ps(idx, _mm512_maskz_loadu_ps(m, c->bs[0]));
+        fg = _mm512_permutexvar_ps(idx, _mm512_maskz_loadu_ps(m, c->fs[1]));
+        bg = _mm512_permutexvar_ps(idx, _mm512_maskz_loadu_ps(m, c->bs[1]));
+        fb = _mm512_permutexvar_ps(idx, _mm512_maskz_loadu_ps(m, c->fs[2]));
+        bb = _mm512_permutexvar_ps(idx, _mm512_maskz_loadu_ps(m, c->bs[2]));
+        fa = _mm512_permutexvar_ps(idx, _mm512_maskz_loadu_ps(m, c->fs[3]));
+        ba = _mm512_permutexvar_ps(idx, _mm512_maskz_loadu_ps(m, c->bs[3]));
+    } else
+#elif defined(JUMPER_IS_HSW)
     if (c->stopCount <=8) {
         fr = _mm256_permutevar8x32_ps(_mm256_loadu_ps(c->fs[0]), idx);
         br = _mm256_permutevar8x32_ps(_mm256_loadu_ps(c->bs[0]), idx);
@@ -2951,7 +3196,7 @@ namespace lowp {
 
 #else  // We are compiling vector code with Clang... let's make some lowp stages!
 
-#if defined(JUMPER_IS_HSW) || defined(JUMPER_IS_AVX512)
+#if defined(JUMPER_IS_HSW) || defined(JUMPER_IS_SKX)
     using U8  = uint8_t  __attribute__((ext_vector_type(16)));
     using U16 = uint16_t __attribute__((ext_vector_type(16)));
     using I16 =  int16_t __attribute__((ext_vector_type(16)));
@@ -3175,7 +3420,7 @@ SI F mad(F f, F m, F a) { return f*m+a; }
 SI U32 trunc_(F x) { return (U32)cast<I32>(x); }
 
 SI F rcp(F x) {
-#if defined(JUMPER_IS_HSW) || defined(JUMPER_IS_AVX512)
+#if defined(JUMPER_IS_HSW) || defined(JUMPER_IS_SKX)
     __m256 lo,hi;
     split(x, &lo,&hi);
     return join<F>(_mm256_rcp_ps(lo), _mm256_rcp_ps(hi));
@@ -3196,7 +3441,7 @@ SI F rcp(F x) {
 #endif
 }
 SI F sqrt_(F x) {
-#if defined(JUMPER_IS_HSW) || defined(JUMPER_IS_AVX512)
+#if defined(JUMPER_IS_HSW) || defined(JUMPER_IS_SKX)
     __m256 lo,hi;
     split(x, &lo,&hi);
     return join<F>(_mm256_sqrt_ps(lo), _mm256_sqrt_ps(hi));
@@ -3231,7 +3476,7 @@ SI F floor_(F x) {
     float32x4_t lo,hi;
     split(x, &lo,&hi);
     return join<F>(vrndmq_f32(lo), vrndmq_f32(hi));
-#elif defined(JUMPER_IS_HSW) || defined(JUMPER_IS_AVX512)
+#elif defined(JUMPER_IS_HSW) || defined(JUMPER_IS_SKX)
     __m256 lo,hi;
     split(x, &lo,&hi);
     return join<F>(_mm256_floor_ps(lo), _mm256_floor_ps(hi));
@@ -3435,7 +3680,7 @@ SI V load(const T* ptr, size_t tail) {
     V v = 0;
     switch (tail & (N-1)) {
         case  0: memcpy(&v, ptr, sizeof(v)); break;
-    #if defined(JUMPER_IS_HSW) || defined(JUMPER_IS_AVX512)
+    #if defined(JUMPER_IS_HSW) || defined(JUMPER_IS_SKX)
         case 15: v[14] = ptr[14];
         case 14: v[13] = ptr[13];
         case 13: v[12] = ptr[12];
@@ -3459,7 +3704,7 @@ template <typename V, typename T>
 SI void store(T* ptr, size_t tail, V v) {
     switch (tail & (N-1)) {
         case  0: memcpy(ptr, &v, sizeof(v)); break;
-    #if defined(JUMPER_IS_HSW) || defined(JUMPER_IS_AVX512)
+    #if defined(JUMPER_IS_HSW) || defined(JUMPER_IS_SKX)
         case 15: ptr[14] = v[14];
         case 14: ptr[13] = v[13];
         case 13: ptr[12] = v[12];
@@ -3479,7 +3724,7 @@ SI void store(T* ptr, size_t tail, V v) {
     }
 }
 
-#if defined(JUMPER_IS_HSW) || defined(JUMPER_IS_AVX512)
+#if defined(JUMPER_IS_HSW) || defined(JUMPER_IS_SKX)
     template <typename V, typename T>
     SI V gather(const T* ptr, U32 ix) {
         return V{ ptr[ix[ 0]], ptr[ix[ 1]], ptr[ix[ 2]], ptr[ix[ 3]],
@@ -3517,7 +3762,7 @@ SI void store(T* ptr, size_t tail, V v) {
 // ~~~~~~ 32-bit memory loads and stores ~~~~~~ //
 
 SI void from_8888(U32 rgba, U16* r, U16* g, U16* b, U16* a) {
-#if 1 && defined(JUMPER_IS_HSW) || defined(JUMPER_IS_AVX512)
+#if 1 && defined(JUMPER_IS_HSW) || defined(JUMPER_IS_SKX)
     // Swap the middle 128-bit lanes to make _mm256_packus_epi32() in cast_U16() work out nicely.
     __m256i _01,_23;
     split(rgba, &_01, &_23);
@@ -3953,7 +4198,7 @@ SI void gradient_lookup(const SkRasterPipeline_GradientCtx* c, U32 idx, F t,
                         U16* r, U16* g, U16* b, U16* a) {
 
     F fr, fg, fb, fa, br, bg, bb, ba;
-#if defined(JUMPER_IS_HSW) || defined(JUMPER_IS_AVX512)
+#if defined(JUMPER_IS_HSW) || defined(JUMPER_IS_SKX)
     if (c->stopCount <=8) {
         __m256i lo, hi;
         split(idx, &lo, &hi);
@@ -10,8 +10,15 @@
 #include "src/pathops/SkIntersectionHelper.h"
 #include "src/pathops/SkIntersections.h"
 
+class SkExecutor;
 class SkOpCoincidence;
 
 bool AddIntersectTs(SkOpContour* test, SkOpContour* next, SkOpCoincidence* coincidence);
 
+// Adds the intersections between all contours in the sorted list, by calling AddIntersectTs()
+// on each pair in turn. Given an executor, the pairs' intersections are instead found
+// concurrently and then added in the same order, so the result doesn't change.
+void AddIntersections(SkOpContourHead* contourList, SkOpCoincidence* coincidence,
+                      SkExecutor* executor);
+
 #endif
@@ -125,7 +125,7 @@ public:
         }
     }
 
-    bool isCoincident(int index) {
+    bool isCoincident(int index) const {
         return (fIsCoincident[0] & 1 << index) != 0;
     }
 
@@ -9,6 +9,7 @@
 #include "include/pathops/SkPathOps.h"
 #include "src/core/SkArenaAlloc.h"
 #include "src/core/SkPathPriv.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/pathops/SkOpEdgeBuilder.h"
 #include "src/pathops/SkPathOpsCommon.h"
 
@@ -120,10 +121,14 @@ void SkOpBuilder::reset() {
     fOps.reset();
 }
 
+bool SkOpBuilder::resolve(SkPath* result) {
+    return this->resolve(result, nullptr);
+}
+
 /* OPTIMIZATION: Union doesn't need to be all-or-nothing. A run of three or more convex
    paths with union ops could be locally resolved and still improve over doing the
    ops one at a time. */
-bool SkOpBuilder::resolve(SkPath* result) {
+bool SkOpBuilder::resolve(SkPath* result, SkExecutor* executor) {
     SkPath original = *result;
     int count = fOps.count();
     bool allUnion = true;
@@ -161,7 +166,7 @@ bool SkOpBuilder::resolve(SkPath* result) {
     if (!allUnion) {
         *result = fPathRefs[0];
         for (int index = 1; index < count; ++index) {
-            if (!Op(*result, fPathRefs[index], fOps[index], result)) {
+            if (!OpWithExecutor(*result, fPathRefs[index], fOps[index], result, executor)) {
                 reset();
                 *result = original;
                 return false;
@@ -170,6 +175,41 @@ bool SkOpBuilder::resolve(SkPath* result) {
         reset();
         return true;
     }
+    if (executor) {
+        // Each path is simplified on its own, so they can all be done at once. Failures are
+        // handled as if the paths had been done in order.
+        enum Status { kOK, kSimplifyFailed, kFixWindingFailed };
+        SkAutoTArray<Status> status(count);
+        SkTaskGroup tasks(*executor);
+        tasks.batch(count, [&](int index) {
+            SkPath* path = &fPathRefs[index];
+            status[index] = !Simplify(*path, path) ? kSimplifyFailed
+                          : !path->isEmpty() && !FixWinding(path) ? kFixWindingFailed
+                          : kOK;
+        });
+        tasks.wait();
+        SkPath sum;
+        for (int index = 0; index < count; ++index) {
+            if (kSimplifyFailed == status[index]) {
+                reset();
+                *result = original;
+                return false;
+            }
+            if (kFixWindingFailed == status[index]) {
+                *result = original;
+                return false;
+            }
+            if (!fPathRefs[index].isEmpty()) {
+                sum.addPath(fPathRefs[index]);
+            }
+        }
+        reset();
+        bool success = SimplifyWithExecutor(sum, result, executor);
+        if (!success) {
+            *result = original;
+        }
+        return success;
+    }
     SkPath sum;
     for (int index = 0; index < count; ++index) {
         if (!Simplify(fPathRefs[index], &fPathRefs[index])) {
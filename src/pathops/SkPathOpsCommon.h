@@ -10,6 +10,7 @@
 #include "include/private/SkTDArray.h"
 #include "src/pathops/SkOpAngle.h"
 
+class SkExecutor;
 class SkOpCoincidence;
 class SkOpContour;
 class SkPathWriter;
@@ -27,4 +28,10 @@ bool OpDebug(const SkPath& one, const SkPath& two, SkPathOp op, SkPath* result
              SkDEBUGPARAMS(bool skipAssert)
              SkDEBUGPARAMS(const char* testName));
 
+// Op() and Simplify(), except that the intersections between the paths' contours are found on
+// the executor's threads. The results are identical.
+bool OpWithExecutor(const SkPath& one, const SkPath& two, SkPathOp op, SkPath* result,
+                    SkExecutor* executor);
+bool SimplifyWithExecutor(const SkPath& path, SkPath* result, SkExecutor* executor);
+
 #endif
@@ -236,8 +236,8 @@ extern void (*gVerboseFinalize)();
 
 #endif
 
-bool OpDebug(const SkPath& one, const SkPath& two, SkPathOp op, SkPath* result
-        SkDEBUGPARAMS(bool skipAssert) SkDEBUGPARAMS(const char* testName)) {
+static bool path_op(const SkPath& one, const SkPath& two, SkPathOp op, SkPath* result,
+        SkExecutor* executor SkDEBUGPARAMS(bool skipAssert) SkDEBUGPARAMS(const char* testName)) {
 #if DEBUG_DUMP_VERIFY
 #ifndef SK_DEBUG
     const char* testName = "release";
@@ -324,13 +324,7 @@ bool OpDebug(const SkPath& one, const SkPath& two, SkPathOp op, SkPath* result
         return true;
     }
     // find all intersections between segments
-    SkOpContour* current = contourList;
-    do {
-        SkOpContour* next = current;
-        while (AddIntersectTs(current, next, &coincidence)
-                && (next = next->next()))
-            ;
-    } while ((current = current->next()));
+    AddIntersections(contourList, &coincidence, executor);
 #if DEBUG_VALIDATE
     globalState.setPhase(SkOpPhase::kWalking);
 #endif
@@ -367,6 +361,17 @@ bool OpDebug(const SkPath& one, const SkPath& two, SkPathOp op, SkPath* result
     return true;
 }
 
+bool OpDebug(const SkPath& one, const SkPath& two, SkPathOp op, SkPath* result
+        SkDEBUGPARAMS(bool skipAssert) SkDEBUGPARAMS(const char* testName)) {
+    return path_op(one, two, op, result, nullptr  SkDEBUGPARAMS(skipAssert)
+            SkDEBUGPARAMS(testName));
+}
+
+bool OpWithExecutor(const SkPath& one, const SkPath& two, SkPathOp op, SkPath* result,
+        SkExecutor* executor) {
+    return path_op(one, two, op, result, executor  SkDEBUGPARAMS(true) SkDEBUGPARAMS(nullptr));
+}
+
 bool Op(const SkPath& one, const SkPath& two, SkPathOp op, SkPath* result) {
 #if DEBUG_DUMP_VERIFY
     if (SkPathOpsDebug::gVerifyOp) {
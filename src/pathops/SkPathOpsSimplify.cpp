@@ -136,8 +136,7 @@ static bool bridgeXor(SkOpContourHead* contourList, SkPathWriter* writer) {
     return true;
 }
 
-// FIXME : add this as a member of SkPath
-bool SimplifyDebug(const SkPath& path, SkPath* result
+static bool simplify_path(const SkPath& path, SkPath* result, SkExecutor* executor
         SkDEBUGPARAMS(bool skipAssert) SkDEBUGPARAMS(const char* testName)) {
     // returns 1 for evenodd, -1 for winding, regardless of inverse-ness
     SkPathFillType fillType = path.isInverseFillType() ? SkPathFillType::kInverseEvenOdd
@@ -180,12 +179,7 @@ bool SimplifyDebug(const SkPath& path, SkPath* result
         return true;
     }
     // find all intersections between segments
-    SkOpContour* current = contourList;
-    do {
-        SkOpContour* next = current;
-        while (AddIntersectTs(current, next, &coincidence)
-                && (next = next->next()));
-    } while ((current = current->next()));
+    AddIntersections(contourList, &coincidence, executor);
 #if DEBUG_VALIDATE
     globalState.setPhase(SkOpPhase::kWalking);
 #endif
@@ -211,6 +205,17 @@ bool SimplifyDebug(const SkPath& path, SkPath* result
     return true;
 }
 
+// FIXME : add this as a member of SkPath
+bool SimplifyDebug(const SkPath& path, SkPath* result
+        SkDEBUGPARAMS(bool skipAssert) SkDEBUGPARAMS(const char* testName)) {
+    return simplify_path(path, result, nullptr  SkDEBUGPARAMS(skipAssert)
+            SkDEBUGPARAMS(testName));
+}
+
+bool SimplifyWithExecutor(const SkPath& path, SkPath* result, SkExecutor* executor) {
+    return simplify_path(path, result, executor  SkDEBUGPARAMS(true) SkDEBUGPARAMS(nullptr));
+}
+
 bool Simplify(const SkPath& path, SkPath* result) {
 #if DEBUG_DUMP_VERIFY
     if (SkPathOpsDebug::gVerifyOp) {
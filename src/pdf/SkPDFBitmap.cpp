@@ -14,11 +14,11 @@
 #include "include/private/SkColorData.h"
 #include "include/private/SkImageInfoPriv.h"
 #include "include/private/SkTo.h"
-#include "src/pdf/SkDeflate.h"
 #include "src/pdf/SkJpegInfo.h"
 #include "src/pdf/SkPDFDocumentPriv.h"
 #include "src/pdf/SkPDFTypes.h"
 #include "src/pdf/SkPDFUtils.h"
+#include "src/utils/SkDeflate.h"
 
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -100,7 +100,7 @@ static void emit_image_stream(SkPDFDocument* doc,
 
 static void do_deflated_alpha(const SkPixmap& pm, SkPDFDocument* doc, SkPDFIndirectReference ref) {
     SkDynamicMemoryWStream buffer;
-    SkDeflateWStream deflateWStream(&buffer);
+    SkDeflateWStream deflateWStream(&buffer, doc->metadata().fCompressionLevel);
     if (kAlpha_8_SkColorType == pm.colorType()) {
         SkASSERT(pm.rowBytes() == (size_t)pm.width());
         buffer.write(pm.addr8(), pm.width() * pm.height());
@@ -134,16 +134,29 @@ static void do_deflated_alpha(const SkPixmap& pm, SkPDFDocument* doc, SkPDFIndir
                       length, false);
 }
 
+// An image's soft mask is reserved before we know whether the image really needs one,
+// so that reference numbers do not depend on the order jobs run in.  Unused, it is null.
+static void emit_unused_smask(SkPDFDocument* doc, SkPDFIndirectReference sMask) {
+    struct Null final : public SkPDFObject {
+        void emitObject(SkWStream* stream) const override { stream->writeText("null"); }
+    };
+    if (sMask) {
+        doc->emit(Null(), sMask);
+    }
+}
+
 static void do_deflated_image(const SkPixmap& pm,
                               SkPDFDocument* doc,
                               bool isOpaque,
-                              SkPDFIndirectReference ref) {
-    SkPDFIndirectReference sMask;
-    if (!isOpaque) {
-        sMask = doc->reserveRef();
+                              SkPDFIndirectReference ref,
+                              SkPDFIndirectReference sMask) {
+    SkASSERT(isOpaque || sMask);
+    if (isOpaque) {
+        emit_unused_smask(doc, sMask);
+        sMask = SkPDFIndirectReference();
     }
     SkDynamicMemoryWStream buffer;
-    SkDeflateWStream deflateWStream(&buffer);
+    SkDeflateWStream deflateWStream(&buffer, doc->metadata().fCompressionLevel);
     const char* colorSpace = "DeviceGray";
     switch (pm.colorType()) {
         case kAlpha_8_SkColorType:
@@ -245,16 +258,18 @@ static SkBitmap to_pixels(const SkImage* image) {
     return bm;
 }
 
-void serialize_image(const SkImage* img,
-                     int encodingQuality,
-                     SkPDFDocument* doc,
-                     SkPDFIndirectReference ref) {
+static void serialize_image(const SkImage* img,
+                            int encodingQuality,
+                            SkPDFDocument* doc,
+                            SkPDFIndirectReference ref,
+                            SkPDFIndirectReference sMask) {
     SkASSERT(img);
     SkASSERT(doc);
     SkASSERT(encodingQuality >= 0);
     SkISize dimensions = img->dimensions();
     sk_sp<SkData> data = img->refEncodedData();
     if (data && do_jpeg(std::move(data), doc, dimensions, ref)) {
+        emit_unused_smask(doc, sMask);
         return;
     }
     SkBitmap bm = to_pixels(img);
@@ -263,10 +278,11 @@ void serialize_image(const SkImage* img,
     if (encodingQuality <= 100 && isOpaque) {
         sk_sp<SkData> data = img->encodeToData(SkEncodedImageFormat::kJPEG, encodingQuality);
         if (data && do_jpeg(std::move(data), doc, dimensions, ref)) {
+            emit_unused_smask(doc, sMask);
             return;
         }
     }
-    do_deflated_image(pm, doc, isOpaque, ref);
+    do_deflated_image(pm, doc, isOpaque, ref, sMask);
 }
 
 SkPDFIndirectReference SkPDFSerializeImage(const SkImage* img,
@@ -275,16 +291,14 @@ SkPDFIndirectReference SkPDFSerializeImage(const SkImage* img,
     SkASSERT(img);
     SkASSERT(doc);
     SkPDFIndirectReference ref = doc->reserveRef();
-    if (SkExecutor* executor = doc->executor()) {
-        SkRef(img);
-        doc->incrementJobCount();
-        executor->add([img, encodingQuality, doc, ref]() {
-            serialize_image(img, encodingQuality, doc, ref);
-            SkSafeUnref(img);
-            doc->signalJobComplete();
-        });
-        return ref;
+    SkPDFIndirectReference sMask;
+    if (!img->isOpaque()) {
+        sMask = doc->reserveRef();
     }
-    serialize_image(img, encodingQuality, doc, ref);
+    SkRef(img);
+    doc->addJob([img, encodingQuality, doc, ref, sMask]() {
+        serialize_image(img, encodingQuality, doc, ref, sMask);
+        SkSafeUnref(img);
+    });
     return ref;
 }
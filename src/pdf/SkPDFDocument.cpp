@@ -8,6 +8,7 @@
 #include "include/docs/SkPDFDocument.h"
 #include "src/pdf/SkPDFDocumentPriv.h"
 
+#include "include/core/SkExecutor.h"
 #include "include/core/SkStream.h"
 #include "include/docs/SkPDFDocument.h"
 #include "include/private/SkTo.h"
@@ -36,12 +37,16 @@ static size_t difference(size_t minuend, size_t subtrahend) {
 }
 
 void SkPDFOffsetMap::markStartOfObject(int referenceNumber, const SkWStream* s) {
+    this->markStartOfObject(referenceNumber, s->bytesWritten());
+}
+
+void SkPDFOffsetMap::markStartOfObject(int referenceNumber, size_t bytesWritten) {
     SkASSERT(referenceNumber > 0);
     size_t index = SkToSizeT(referenceNumber - 1);
     if (index >= fOffsets.size()) {
         fOffsets.resize(index + 1);
     }
-    fOffsets[index] = SkToInt(difference(s->bytesWritten(), fBaseOffset));
+    fOffsets[index] = SkToInt(difference(bytesWritten, fBaseOffset));
 }
 
 int SkPDFOffsetMap::objectCount() const {
@@ -79,12 +84,21 @@ static void serializeHeader(SkPDFOffsetMap* offsetMap, SkWStream* wStream) {
 }
 #undef SKPDF_MAGIC
 
+static void write_object_header(SkPDFIndirectReference ref, SkWStream* s) {
+    s->writeDecAsText(ref.fValue);
+    s->writeText(" 0 obj\n");  // Generation number is always 0.
+}
+
 static void begin_indirect_object(SkPDFOffsetMap* offsetMap,
                                   SkPDFIndirectReference ref,
                                   SkWStream* s) {
     offsetMap->markStartOfObject(ref.fValue, s);
-    s->writeDecAsText(ref.fValue);
-    s->writeText(" 0 obj\n");  // Generation number is always 0.
+    write_object_header(ref, s);
+}
+
+static void begin_indirect_object(SkPDFOutputBlock* block, SkPDFIndirectReference ref) {
+    block->fObjectOffsets.emplace_back(ref.fValue, block->fData.bytesWritten());
+    write_object_header(ref, &block->fData);
 }
 
 static void end_indirect_object(SkWStream* s) { s->writeText("\nendobj\n"); }
@@ -196,6 +210,7 @@ SkPDFDocument::SkPDFDocument(SkWStream* stream,
     if (fMetadata.fStructureElementTreeRoot) {
         fTagTree.init(fMetadata.fStructureElementTreeRoot);
     }
+    fMetadata.fCompressionLevel = SkTPin(fMetadata.fCompressionLevel, -1, 9);
     fExecutor = metadata.fExecutor;
 }
 
@@ -204,22 +219,83 @@ SkPDFDocument::~SkPDFDocument() {
     this->close();
 }
 
+// The document and output block of the job running on this thread, if any.
+static thread_local const SkPDFDocument* gJobDocument = nullptr;
+static thread_local SkPDFOutputBlock* gJobOutputBlock = nullptr;
+
 SkPDFIndirectReference SkPDFDocument::emit(const SkPDFObject& object, SkPDFIndirectReference ref){
     SkAutoMutexExclusive lock(fMutex);
-    object.emitObject(this->beginObject(ref));
-    this->endObject();
+    SkWStream* stream = this->beginObject(ref);
+    object.emitObject(stream);
+    this->endObject(stream);
     return ref;
 }
 
 SkWStream* SkPDFDocument::beginObject(SkPDFIndirectReference ref) SK_REQUIRES(fMutex) {
-    begin_indirect_object(&fOffsetMap, ref, this->getStream());
-    return this->getStream();
+    if (gJobDocument == this) {
+        begin_indirect_object(gJobOutputBlock, ref);
+        return &gJobOutputBlock->fData;
+    }
+    if (fOutputBlocks.empty()) {
+        begin_indirect_object(&fOffsetMap, ref, this->getStream());
+        return this->getStream();
+    }
+    // Earlier jobs are still running, so this object has to wait its turn behind them.
+    // We hold fMutex until endObject(), so the block can be marked done already.
+    if (!fOutputBlocks.back()->fDone) {
+        fOutputBlocks.push_back(std::make_unique<SkPDFOutputBlock>());
+        fOutputBlocks.back()->fDone = true;
+    }
+    begin_indirect_object(fOutputBlocks.back().get(), ref);
+    return &fOutputBlocks.back()->fData;
 };
 
-void SkPDFDocument::endObject() SK_REQUIRES(fMutex) {
-    end_indirect_object(this->getStream());
+void SkPDFDocument::endObject(SkWStream* stream) SK_REQUIRES(fMutex) {
+    end_indirect_object(stream);
 };
 
+void SkPDFDocument::flushOutputBlocks() SK_REQUIRES(fMutex) {
+    SkWStream* stream = this->getStream();
+    while (!fOutputBlocks.empty() && fOutputBlocks.front()->fDone) {
+        SkPDFOutputBlock* block = fOutputBlocks.front().get();
+        size_t start = stream->bytesWritten();
+        for (const auto& [referenceNumber, offset] : block->fObjectOffsets) {
+            fOffsetMap.markStartOfObject(referenceNumber, start + offset);
+        }
+        block->fData.writeToAndReset(stream);
+        fOutputBlocks.pop_front();
+    }
+}
+
+void SkPDFDocument::addJob(std::function<void()> job) {
+    if (!fExecutor || gJobDocument == this) {
+        job();
+        return;
+    }
+    SkPDFOutputBlock* block;
+    {
+        SkAutoMutexExclusive lock(fMutex);
+        fOutputBlocks.push_back(std::make_unique<SkPDFOutputBlock>());
+        block = fOutputBlocks.back().get();
+    }
+    fJobCount++;
+    fExecutor->add([this, block, job = std::move(job)]() {
+        const SkPDFDocument* outerDocument = gJobDocument;
+        SkPDFOutputBlock* outerBlock = gJobOutputBlock;
+        gJobDocument = this;
+        gJobOutputBlock = block;
+        job();
+        gJobDocument = outerDocument;
+        gJobOutputBlock = outerBlock;
+        {
+            SkAutoMutexExclusive lock(fMutex);
+            block->fDone = true;
+            this->flushOutputBlocks();
+        }
+        fSemaphore.signal();
+    });
+}
+
 static SkSize operator*(SkISize u, SkScalar s) { return SkSize{u.width() * s, u.height() * s}; }
 static SkSize operator*(SkSize u, SkScalar s) { return SkSize{u.width() * s, u.height() * s}; }
 
@@ -331,10 +407,9 @@ void SkPDFDocument::onEndPage() {
     auto page = SkPDFMakeDict("Page");
 
     SkSize mediaSize = fPageDevice->imageInfo().dimensions() * fInverseRasterScale;
-    std::unique_ptr<SkStreamAsset> pageContent = fPageDevice->content();
     auto resourceDict = fPageDevice->makeResourceDict();
     SkASSERT(fPageRefs.size() > 0);
-    fPageDevice = nullptr;
+    sk_sp<SkPDFDevice> pageDevice = std::move(fPageDevice);
 
     page->insertObject("Resources", std::move(resourceDict));
     page->insertObject("MediaBox", SkPDFUtils::RectToArray(SkRect::MakeSize(mediaSize)));
@@ -346,7 +421,12 @@ void SkPDFDocument::onEndPage() {
         fCurrentPageLinkToDestinations.clear();
     }
 
-    page->insertRef("Contents", SkPDFStreamOut(nullptr, std::move(pageContent), this));
+    // Flattening, deflating and writing the content stream can all happen off this thread.
+    SkPDFIndirectReference contents = this->reserveRef();
+    this->addJob([this, pageDevice, contents]() {
+        SkPDFStreamOut(nullptr, pageDevice->content(), this, contents);
+    });
+    page->insertRef("Contents", contents);
     // The StructParents unique identifier for each page is just its
     // 0-based page index.
     page->insertInt("StructParents", SkToInt(this->currentPageIndex()));
@@ -556,14 +636,11 @@ void SkPDFDocument::onClose(SkWStream* stream) {
     this->waitForJobs();
     {
         SkAutoMutexExclusive autoMutexAcquire(fMutex);
+        SkASSERT(fOutputBlocks.empty());
         serialize_footer(fOffsetMap, this->getStream(), fInfoDict, docCatalogRef, fUUID);
     }
 }
 
-void SkPDFDocument::incrementJobCount() { fJobCount++; }
-
-void SkPDFDocument::signalJobComplete() { fSemaphore.signal(); }
-
 void SkPDFDocument::waitForJobs() {
      // fJobCount can increase while we wait.
      while (fJobCount > 0) {
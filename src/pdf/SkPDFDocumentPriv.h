@@ -16,6 +16,8 @@
 #include "src/pdf/SkPDFTag.h"
 
 #include <atomic>
+#include <deque>
+#include <functional>
 #include <vector>
 #include <memory>
 
@@ -40,6 +42,7 @@ class SkPDFOffsetMap {
 public:
     void markStartOfDocument(const SkWStream*);
     void markStartOfObject(int referenceNumber, const SkWStream*);
+    void markStartOfObject(int referenceNumber, size_t bytesWritten);
     int objectCount() const;
     int emitCrossReferenceTable(SkWStream* s) const;
 private:
@@ -47,6 +50,14 @@ private:
     size_t fBaseOffset = SIZE_MAX;
 };
 
+// Also logically part of SkPDFDocument.  Objects written by a job (see SkPDFDocument::addJob)
+// are collected in one of these, and copied into the document in the order the jobs were
+// added, so the output does not depend on which job finishes first.
+struct SkPDFOutputBlock {
+    SkDynamicMemoryWStream fData;
+    std::vector<std::pair<int, size_t>> fObjectOffsets;  // Reference number, offset in fData.
+    bool fDone = false;
+};
 
 struct SkPDFNamedDestination {
     sk_sp<SkData> fName;
@@ -86,9 +97,17 @@ public:
         stream->writeText(" stream\n");
         writeStream(stream);
         stream->writeText("\nendstream");
-        this->endObject();
+        this->endObject(stream);
     }
 
+    /**
+       Run the job on the executor, or right away if there is none.  Anything the job emits
+       is written to the document where it would have been had the job run here and now,
+       so the output is the same either way.  Jobs must reserve their references before
+       they are added; a job added from within a job simply runs in place.
+     */
+    void addJob(std::function<void()> job);
+
     const SkPDF::Metadata& metadata() const { return fMetadata; }
 
     SkPDFIndirectReference getPage(size_t pageIndex) const;
@@ -101,8 +120,6 @@ public:
     SkPDFIndirectReference reserveRef() { return SkPDFIndirectReference{fNextObjectNumber++}; }
 
     SkExecutor* executor() const { return fExecutor; }
-    void incrementJobCount();
-    void signalJobComplete();
     size_t currentPageIndex() { return fPages.size(); }
     size_t pageCount() { return fPageRefs.size(); }
 
@@ -150,10 +167,12 @@ private:
 
     SkMutex fMutex;
     SkSemaphore fSemaphore;
+    std::deque<std::unique_ptr<SkPDFOutputBlock>> fOutputBlocks;  // Not yet in the stream.
 
     void waitForJobs();
     SkWStream* beginObject(SkPDFIndirectReference);
-    void endObject();
+    void endObject(SkWStream*);
+    void flushOutputBlocks();
 };
 
 #endif  // SkPDFDocumentPriv_DEFINED
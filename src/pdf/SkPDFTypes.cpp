@@ -12,10 +12,10 @@
 #include "include/core/SkStream.h"
 #include "include/private/SkTo.h"
 #include "src/core/SkStreamPriv.h"
-#include "src/pdf/SkDeflate.h"
 #include "src/pdf/SkPDFDocumentPriv.h"
 #include "src/pdf/SkPDFUnion.h"
 #include "src/pdf/SkPDFUtils.h"
+#include "src/utils/SkDeflate.h"
 
 #include <new>
 
@@ -431,7 +431,9 @@ static void serialize_stream(SkPDFDict* origDict,
     static const size_t kMinimumSavings = strlen("/Filter_/FlateDecode_");
     if (deflate && stream->getLength() > kMinimumSavings) {
         SkDynamicMemoryWStream compressedData;
-        SkDeflateWStream deflateWStream(&compressedData);
+        // Streams are already deflated in parallel with each other, and deflating one in blocks
+        // would make its output depend on whether there is an executor.
+        SkDeflateWStream deflateWStream(&compressedData, doc->metadata().fCompressionLevel);
         SkStreamCopy(&deflateWStream, stream);
         deflateWStream.finalize();
         #ifdef SK_PDF_BASE85_BINARY
@@ -461,25 +463,27 @@ static void serialize_stream(SkPDFDict* origDict,
                     ref);
 }
 
+void SkPDFStreamOut(std::unique_ptr<SkPDFDict> dict,
+                    std::unique_ptr<SkStreamAsset> content,
+                    SkPDFDocument* doc,
+                    SkPDFIndirectReference ref,
+                    bool deflate) {
+    serialize_stream(dict.get(), content.get(), deflate, doc, ref);
+}
+
 SkPDFIndirectReference SkPDFStreamOut(std::unique_ptr<SkPDFDict> dict,
                                       std::unique_ptr<SkStreamAsset> content,
                                       SkPDFDocument* doc,
                                       bool deflate) {
     SkPDFIndirectReference ref = doc->reserveRef();
-    if (SkExecutor* executor = doc->executor()) {
-        SkPDFDict* dictPtr = dict.release();
-        SkStreamAsset* contentPtr = content.release();
-        // Pass ownership of both pointers into a std::function, which should
-        // only be executed once.
-        doc->incrementJobCount();
-        executor->add([dictPtr, contentPtr, deflate, doc, ref]() {
-            serialize_stream(dictPtr, contentPtr, deflate, doc, ref);
-            delete dictPtr;
-            delete contentPtr;
-            doc->signalJobComplete();
-        });
-        return ref;
-    }
-    serialize_stream(dict.get(), content.get(), deflate, doc, ref);
+    SkPDFDict* dictPtr = dict.release();
+    SkStreamAsset* contentPtr = content.release();
+    // Pass ownership of both pointers into a std::function, which should
+    // only be executed once.
+    doc->addJob([dictPtr, contentPtr, deflate, doc, ref]() {
+        serialize_stream(dictPtr, contentPtr, deflate, doc, ref);
+        delete dictPtr;
+        delete contentPtr;
+    });
     return ref;
 }
@@ -200,4 +200,11 @@ SkPDFIndirectReference SkPDFStreamOut(std::unique_ptr<SkPDFDict> dict,
                                       std::unique_ptr<SkStreamAsset> stream,
                                       SkPDFDocument* doc,
                                       bool deflate = kSkPDFDefaultDoDeflate);
+
+// As above, but writes to a reference the caller reserved, on the calling thread.
+void SkPDFStreamOut(std::unique_ptr<SkPDFDict> dict,
+                    std::unique_ptr<SkStreamAsset> stream,
+                    SkPDFDocument* doc,
+                    SkPDFIndirectReference ref,
+                    bool deflate = kSkPDFDefaultDoDeflate);
 #endif
@@ -14,6 +14,7 @@
 #include "src/sksl/SkSLHCodeGenerator.h"
 #include "src/sksl/SkSLIRGenerator.h"
 #include "src/sksl/SkSLMetalCodeGenerator.h"
+#include "src/sksl/SkSLParser.h"
 #include "src/sksl/SkSLPipelineStageCodeGenerator.h"
 #include "src/sksl/SkSLSPIRVCodeGenerator.h"
 #include "src/sksl/SkSLSPIRVtoHLSL.h"
@@ -77,6 +78,19 @@ static const char* SKSL_PIPELINE_INCLUDE =
 
 namespace SkSL {
 
+// indexed by Compiler::Module
+static const char* const MODULE_SOURCES[] = {
+    SKSL_GPU_INCLUDE,
+    SKSL_BLEND_INCLUDE,
+    SKSL_VERT_INCLUDE,
+    SKSL_FRAG_INCLUDE,
+    SKSL_GEOM_INCLUDE,
+    SKSL_PIPELINE_INCLUDE,
+    SKSL_INTERP_INCLUDE,
+    SKSL_FP_INCLUDE,
+};
+static constexpr int MODULE_COUNT = sizeof(MODULE_SOURCES) / sizeof(MODULE_SOURCES[0]);
+
 static void grab_intrinsics(std::vector<std::unique_ptr<ProgramElement>>* src,
                std::map<String, std::pair<std::unique_ptr<ProgramElement>, bool>>* target) {
     for (auto iter = src->begin(); iter != src->end(); ) {
@@ -262,46 +276,117 @@ Compiler::Compiler(Flags flags)
     Variable* skArgs = new Variable(-1, Modifiers(), skArgsName,
                                     *fContext->fSkArgs_Type, Variable::kGlobal_Storage);
     fIRGenerator->fSymbolTable->add(skArgsName, std::unique_ptr<Symbol>(skArgs));
-
-    fIRGenerator->fIntrinsics = &fGPUIntrinsics;
-    std::vector<std::unique_ptr<ProgramElement>> gpuIntrinsics;
-    this->processIncludeFile(Program::kFragment_Kind, SKSL_GPU_INCLUDE, strlen(SKSL_GPU_INCLUDE),
-                             symbols, &gpuIntrinsics, &fGpuSymbolTable);
-    this->processIncludeFile(Program::kFragment_Kind, SKSL_BLEND_INCLUDE,
-                             strlen(SKSL_BLEND_INCLUDE), std::move(fGpuSymbolTable), &gpuIntrinsics,
-                             &fGpuSymbolTable);
-    grab_intrinsics(&gpuIntrinsics, &fGPUIntrinsics);
-    // need to hang on to the source so that FunctionDefinition.fSource pointers in this file
-    // remain valid
-    fGpuIncludeSource = std::move(fIRGenerator->fFile);
-    this->processIncludeFile(Program::kVertex_Kind, SKSL_VERT_INCLUDE, strlen(SKSL_VERT_INCLUDE),
-                             fGpuSymbolTable, &fVertexInclude, &fVertexSymbolTable);
-    this->processIncludeFile(Program::kFragment_Kind, SKSL_FRAG_INCLUDE, strlen(SKSL_FRAG_INCLUDE),
-                             fGpuSymbolTable, &fFragmentInclude, &fFragmentSymbolTable);
-    this->processIncludeFile(Program::kGeometry_Kind, SKSL_GEOM_INCLUDE, strlen(SKSL_GEOM_INCLUDE),
-                             fGpuSymbolTable, &fGeometryInclude, &fGeometrySymbolTable);
-    this->processIncludeFile(Program::kPipelineStage_Kind, SKSL_PIPELINE_INCLUDE,
-                             strlen(SKSL_PIPELINE_INCLUDE), fGpuSymbolTable, &fPipelineInclude,
-                             &fPipelineSymbolTable);
-    this->processIncludeFile(Program::kGeneric_Kind, SKSL_INTERP_INCLUDE,
-                             strlen(SKSL_INTERP_INCLUDE), symbols, &fInterpreterInclude,
-                             &fInterpreterSymbolTable);
-    grab_intrinsics(&fInterpreterInclude, &fInterpreterIntrinsics);
-    // need to hang on to the source so that FunctionDefinition.fSource pointers in this file
-    // remain valid
-    fInterpreterIncludeSource = std::move(fIRGenerator->fFile);
 }
 
 Compiler::~Compiler() {
     delete fIRGenerator;
 }
 
-void Compiler::processIncludeFile(Program::Kind kind, const char* src, size_t length,
+ASTFile* Compiler::moduleFile(Module module) {
+    // The ASTs only refer to the (static) module sources, never to a particular Compiler, and the
+    // IRGenerator doesn't modify them, so one copy can be shared by every Compiler on every
+    // thread. The parse uses this Compiler's type names and reports errors to it.
+    static ASTFile** files = [this] {
+        ASTFile** result = new ASTFile*[MODULE_COUNT];
+        // The parser declares enum types as it goes; keep them out of our own type table, where
+        // declareModuleTypes() will add them when (and if) each module is loaded.
+        SymbolTable types(fTypes, this);
+        for (int i = 0; i < MODULE_COUNT; ++i) {
+            const char* src = MODULE_SOURCES[i];
+#ifdef SK_DEBUG
+            String source(src);
+            fSource = &source;
+#endif
+            Parser parser(src, strlen(src), types, *this);
+            result[i] = parser.file().release();
+            if (this->fErrorCount) {
+                printf("Unexpected errors: %s\n", this->fErrorText.c_str());
+            }
+            SkASSERT(!fErrorCount);
+        }
+#ifdef SK_DEBUG
+        fSource = nullptr;
+#endif
+        return result;
+    }();
+    return files[(int) module];
+}
+
+void Compiler::declareModuleTypes(ASTFile* file) {
+    for (const auto& decl : file->root()) {
+        if (decl.fKind == ASTNode::Kind::kEnum && !(*fTypes)[decl.getString()]) {
+            fTypes->add(decl.getString(), std::unique_ptr<Symbol>(new Type(decl.getString(),
+                                                                           Type::kEnum_Kind)));
+        }
+    }
+}
+
+void Compiler::loadGPUModule() {
+    if (!fGpuSymbolTable) {
+        fIRGenerator->fIntrinsics = &fGPUIntrinsics;
+        std::vector<std::unique_ptr<ProgramElement>> gpuIntrinsics;
+        this->processIncludeFile(Program::kFragment_Kind, Module::kGPU,
+                                 fIRGenerator->fRootSymbolTable, &gpuIntrinsics, &fGpuSymbolTable);
+        this->processIncludeFile(Program::kFragment_Kind, Module::kBlend,
+                                 std::move(fGpuSymbolTable), &gpuIntrinsics, &fGpuSymbolTable);
+        grab_intrinsics(&gpuIntrinsics, &fGPUIntrinsics);
+    }
+}
+
+void Compiler::loadVertexModule() {
+    if (!fVertexSymbolTable) {
+        this->loadGPUModule();
+        fIRGenerator->fIntrinsics = &fGPUIntrinsics;
+        this->processIncludeFile(Program::kVertex_Kind, Module::kVertex, fGpuSymbolTable,
+                                 &fVertexInclude, &fVertexSymbolTable);
+    }
+}
+
+void Compiler::loadFragmentModule() {
+    if (!fFragmentSymbolTable) {
+        this->loadGPUModule();
+        fIRGenerator->fIntrinsics = &fGPUIntrinsics;
+        this->processIncludeFile(Program::kFragment_Kind, Module::kFragment, fGpuSymbolTable,
+                                 &fFragmentInclude, &fFragmentSymbolTable);
+    }
+}
+
+void Compiler::loadGeometryModule() {
+    if (!fGeometrySymbolTable) {
+        this->loadGPUModule();
+        fIRGenerator->fIntrinsics = &fGPUIntrinsics;
+        this->processIncludeFile(Program::kGeometry_Kind, Module::kGeometry, fGpuSymbolTable,
+                                 &fGeometryInclude, &fGeometrySymbolTable);
+    }
+}
+
+void Compiler::loadPipelineModule() {
+    if (!fPipelineSymbolTable) {
+        this->loadGPUModule();
+        fIRGenerator->fIntrinsics = &fGPUIntrinsics;
+        this->processIncludeFile(Program::kPipelineStage_Kind, Module::kPipeline, fGpuSymbolTable,
+                                 &fPipelineInclude, &fPipelineSymbolTable);
+    }
+}
+
+void Compiler::loadInterpreterModule() {
+    if (!fInterpreterSymbolTable) {
+        fIRGenerator->fIntrinsics = &fInterpreterIntrinsics;
+        this->processIncludeFile(Program::kGeneric_Kind, Module::kInterpreter,
+                                 fIRGenerator->fRootSymbolTable, &fInterpreterInclude,
+                                 &fInterpreterSymbolTable);
+        grab_intrinsics(&fInterpreterInclude, &fInterpreterIntrinsics);
+    }
+}
+
+void Compiler::processIncludeFile(Program::Kind kind, Module module,
                                   std::shared_ptr<SymbolTable> base,
                                   std::vector<std::unique_ptr<ProgramElement>>* outElements,
                                   std::shared_ptr<SymbolTable>* outSymbolTable) {
+    ASTFile* file = this->moduleFile(module);
+    this->declareModuleTypes(file);
 #ifdef SK_DEBUG
-    String source(src, length);
+    String source(MODULE_SOURCES[(int) module]);
     fSource = &source;
 #endif
     fIRGenerator->fSymbolTable = std::move(base);
@@ -312,7 +397,7 @@ void Compiler::processIncludeFile(Program::Kind kind, const char* src, size_t le
     settings.fCaps = &caps;
 #endif
     fIRGenerator->start(&settings, nullptr);
-    fIRGenerator->convertProgram(kind, src, length, *fTypes, outElements);
+    fIRGenerator->convertProgram(kind, file, outElements);
     if (this->fErrorCount) {
         printf("Unexpected errors: %s\n", this->fErrorText.c_str());
     }
@@ -1378,55 +1463,71 @@ std::unique_ptr<Program> Compiler::convertProgram(Program::Kind kind, String tex
     fErrorCount = 0;
     std::vector<std::unique_ptr<ProgramElement>>* inherited;
     std::vector<std::unique_ptr<ProgramElement>> elements;
+    ASTFile* fpInclude = nullptr;
     switch (kind) {
         case Program::kVertex_Kind:
+            this->loadVertexModule();
             inherited = &fVertexInclude;
             fIRGenerator->fSymbolTable = fVertexSymbolTable;
             fIRGenerator->fIntrinsics = &fGPUIntrinsics;
-            fIRGenerator->start(&settings, inherited);
             break;
         case Program::kFragment_Kind:
+            this->loadFragmentModule();
             inherited = &fFragmentInclude;
             fIRGenerator->fSymbolTable = fFragmentSymbolTable;
             fIRGenerator->fIntrinsics = &fGPUIntrinsics;
-            fIRGenerator->start(&settings, inherited);
             break;
         case Program::kGeometry_Kind:
+            this->loadGeometryModule();
             inherited = &fGeometryInclude;
             fIRGenerator->fSymbolTable = fGeometrySymbolTable;
             fIRGenerator->fIntrinsics = &fGPUIntrinsics;
-            fIRGenerator->start(&settings, inherited);
             break;
         case Program::kFragmentProcessor_Kind:
+            this->loadGPUModule();
             inherited = nullptr;
             fIRGenerator->fSymbolTable = fGpuSymbolTable;
-            fIRGenerator->start(&settings, nullptr);
             fIRGenerator->fIntrinsics = &fGPUIntrinsics;
-            fIRGenerator->convertProgram(kind, SKSL_FP_INCLUDE, strlen(SKSL_FP_INCLUDE), *fTypes,
-                                         &elements);
-            fIRGenerator->fSymbolTable->markAllFunctionsBuiltin();
+            fpInclude = this->moduleFile(Module::kFP);
+            this->declareModuleTypes(fpInclude);
             break;
         case Program::kPipelineStage_Kind:
+            this->loadPipelineModule();
             inherited = &fPipelineInclude;
             fIRGenerator->fSymbolTable = fPipelineSymbolTable;
             fIRGenerator->fIntrinsics = &fGPUIntrinsics;
-            fIRGenerator->start(&settings, inherited);
             break;
         case Program::kGeneric_Kind:
+            this->loadInterpreterModule();
             inherited = &fInterpreterInclude;
             fIRGenerator->fSymbolTable = fInterpreterSymbolTable;
             fIRGenerator->fIntrinsics = &fInterpreterIntrinsics;
-            fIRGenerator->start(&settings, inherited);
             break;
     }
-    for (auto& element : elements) {
-        if (element->fKind == ProgramElement::kEnum_Kind) {
-            ((Enum&) *element).fBuiltin = true;
-        }
-    }
     std::unique_ptr<String> textPtr(new String(std::move(text)));
     fSource = textPtr.get();
-    fIRGenerator->convertProgram(kind, textPtr->c_str(), textPtr->size(), *fTypes, &elements);
+    // The parser adds the program's struct and enum types to fTypes, which outlives the program,
+    // so parsing happens before the program's pool is attached.
+    Parser parser(textPtr->c_str(), textPtr->size(), *fTypes, *this);
+    fIRGenerator->fParsedFile = parser.file();
+    std::shared_ptr<Pool> pool = Pool::Create();
+    {
+        Pool::AutoAttach attach(pool.get());
+        fIRGenerator->start(&settings, inherited);
+        if (fpInclude) {
+            fIRGenerator->convertProgram(kind, fpInclude, &elements);
+            fIRGenerator->fSymbolTable->markAllFunctionsBuiltin();
+            for (auto& element : elements) {
+                if (element->fKind == ProgramElement::kEnum_Kind) {
+                    ((Enum&) *element).fBuiltin = true;
+                }
+            }
+        }
+        if (!fErrorCount) {
+            SkASSERT(fIRGenerator->fParsedFile);
+            fIRGenerator->convertProgram(kind, fIRGenerator->fParsedFile.get(), &elements);
+        }
+    }
     auto result = std::unique_ptr<Program>(new Program(kind,
                                                        std::move(textPtr),
                                                        settings,
@@ -1434,7 +1535,10 @@ std::unique_ptr<Program> Compiler::convertProgram(Program::Kind kind, String tex
                                                        inherited,
                                                        std::move(elements),
                                                        fIRGenerator->fSymbolTable,
-                                                       fIRGenerator->fInputs));
+                                                       fIRGenerator->fInputs,
+                                                       std::move(pool)));
+    // Don't let the generator hang on to the program's symbols, which may live in its pool.
+    fIRGenerator->finish();
     if (fErrorCount) {
         return nullptr;
     }
@@ -1444,6 +1548,7 @@ std::unique_ptr<Program> Compiler::convertProgram(Program::Kind kind, String tex
 bool Compiler::optimize(Program& program) {
     SkASSERT(!fErrorCount);
     if (!program.fIsOptimized) {
+        Pool::AutoAttach attach(program.fPool.get());
         program.fIsOptimized = true;
         fIRGenerator->fKind = program.fKind;
         fIRGenerator->fSettings = &program.fSettings;
@@ -1479,9 +1584,13 @@ bool Compiler::optimize(Program& program) {
 std::unique_ptr<Program> Compiler::specialize(
                    Program& program,
                    const std::unordered_map<SkSL::String, SkSL::Program::Settings::Value>& inputs) {
+    // The clone shares the original's symbols, so it shares its pool as well.
     std::vector<std::unique_ptr<ProgramElement>> elements;
-    for (const auto& e : program) {
-        elements.push_back(e.clone());
+    {
+        Pool::AutoAttach attach(program.fPool.get());
+        for (const auto& e : program) {
+            elements.push_back(e.clone());
+        }
     }
     Program::Settings settings;
     settings.fCaps = program.fSettings.fCaps;
@@ -1496,7 +1605,8 @@ std::unique_ptr<Program> Compiler::specialize(
                                                 program.fInheritedElements,
                                                 std::move(elements),
                                                 program.fSymbols,
-                                                program.fInputs));
+                                                program.fInputs,
+                                                program.fPool));
     return result;
 }
 
@@ -1506,6 +1616,7 @@ bool Compiler::toSPIRV(Program& program, OutputStream& out) {
     if (!this->optimize(program)) {
         return false;
     }
+    Pool::AutoAttach attach(program.fPool.get());
 #ifdef SK_ENABLE_SPIRV_VALIDATION
     StringStream buffer;
     fSource = program.fSource.get();
@@ -1547,6 +1658,7 @@ bool Compiler::toGLSL(Program& program, OutputStream& out) {
     if (!this->optimize(program)) {
         return false;
     }
+    Pool::AutoAttach attach(program.fPool.get());
     fSource = program.fSource.get();
     GLSLCodeGenerator cg(fContext.get(), &program, this, &out);
     bool result = cg.generateCode();
@@ -1576,6 +1688,7 @@ bool Compiler::toMetal(Program& program, OutputStream& out) {
     if (!this->optimize(program)) {
         return false;
     }
+    Pool::AutoAttach attach(program.fPool.get());
     MetalCodeGenerator cg(fContext.get(), &program, this, &out);
     bool result = cg.generateCode();
     return result;
@@ -1597,6 +1710,7 @@ bool Compiler::toCPP(Program& program, String name, OutputStream& out) {
     if (!this->optimize(program)) {
         return false;
     }
+    Pool::AutoAttach attach(program.fPool.get());
     fSource = program.fSource.get();
     CPPCodeGenerator cg(fContext.get(), &program, this, name, &out);
     bool result = cg.generateCode();
@@ -1608,6 +1722,7 @@ bool Compiler::toH(Program& program, String name, OutputStream& out) {
     if (!this->optimize(program)) {
         return false;
     }
+    Pool::AutoAttach attach(program.fPool.get());
     fSource = program.fSource.get();
     HCodeGenerator cg(fContext.get(), &program, this, name, &out);
     bool result = cg.generateCode();
@@ -1620,6 +1735,7 @@ bool Compiler::toH(Program& program, String name, OutputStream& out) {
 #if !defined(SKSL_STANDALONE) && SK_SUPPORT_GPU
 bool Compiler::toPipelineStage(const Program& program, PipelineStageArgs* outArgs) {
     SkASSERT(program.fIsOptimized);
+    Pool::AutoAttach attach(program.fPool.get());
     fSource = program.fSource.get();
     StringStream buffer;
     PipelineStageCodeGenerator cg(fContext.get(), &program, this, &buffer, outArgs);
@@ -1637,6 +1753,7 @@ std::unique_ptr<ByteCode> Compiler::toByteCode(Program& program) {
     if (!this->optimize(program)) {
         return nullptr;
     }
+    Pool::AutoAttach attach(program.fPool.get());
     fSource = program.fSource.get();
     std::unique_ptr<ByteCode> result(new ByteCode());
     ByteCodeGenerator cg(&program, this, result.get());
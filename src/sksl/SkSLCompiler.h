@@ -175,11 +175,44 @@ public:
     static bool IsAssignment(Token::Kind token);
 
 private:
-    void processIncludeFile(Program::Kind kind, const char* src, size_t length,
+    // The built-in include files.
+    enum class Module {
+        kGPU,
+        kBlend,
+        kVertex,
+        kFragment,
+        kGeometry,
+        kPipeline,
+        kInterpreter,
+        kFP,
+    };
+
+    /**
+     * Returns the AST of a built-in module. The modules are parsed once per process, and the
+     * resulting ASTs are shared, read-only, by every Compiler.
+     */
+    ASTFile* moduleFile(Module module);
+
+    /**
+     * Declares the enum types introduced by a built-in module. The parser would normally do this,
+     * but the modules are parsed just once, against a scratch type table.
+     */
+    void declareModuleTypes(ASTFile* file);
+
+    void processIncludeFile(Program::Kind kind, Module module,
                             std::shared_ptr<SymbolTable> base,
                             std::vector<std::unique_ptr<ProgramElement>>* outElements,
                             std::shared_ptr<SymbolTable>* outSymbolTable);
 
+    // The modules are converted to IR the first time a program needs them, so that constructing a
+    // Compiler is cheap and programs only pay for the modules they use.
+    void loadGPUModule();
+    void loadVertexModule();
+    void loadFragmentModule();
+    void loadGeometryModule();
+    void loadPipelineModule();
+    void loadInterpreterModule();
+
     void addDefinition(const Expression* lvalue, std::unique_ptr<Expression>* expr,
                        DefinitionMap* definitions);
 
@@ -217,7 +250,6 @@ private:
 
     std::map<String, std::pair<std::unique_ptr<ProgramElement>, bool>> fGPUIntrinsics;
     std::map<String, std::pair<std::unique_ptr<ProgramElement>, bool>> fInterpreterIntrinsics;
-    std::unique_ptr<ASTFile> fGpuIncludeSource;
     std::shared_ptr<SymbolTable> fGpuSymbolTable;
     std::vector<std::unique_ptr<ProgramElement>> fVertexInclude;
     std::shared_ptr<SymbolTable> fVertexSymbolTable;
@@ -227,7 +259,6 @@ private:
     std::shared_ptr<SymbolTable> fGeometrySymbolTable;
     std::vector<std::unique_ptr<ProgramElement>> fPipelineInclude;
     std::shared_ptr<SymbolTable> fPipelineSymbolTable;
-    std::unique_ptr<ASTFile> fInterpreterIncludeSource;
     std::vector<std::unique_ptr<ProgramElement>> fInterpreterInclude;
     std::shared_ptr<SymbolTable> fInterpreterSymbolTable;
 
@@ -2461,18 +2461,11 @@ void IRGenerator::setRefKind(const Expression& expr, VariableReference::RefKind
 }
 
 void IRGenerator::convertProgram(Program::Kind kind,
-                                 const char* text,
-                                 size_t length,
-                                 SymbolTable& types,
+                                 ASTFile* file,
                                  std::vector<std::unique_ptr<ProgramElement>>* out) {
     fKind = kind;
     fProgramElements = out;
-    Parser parser(text, length, types, fErrors);
-    fFile = parser.file();
-    if (fErrors.errorCount()) {
-        return;
-    }
-    SkASSERT(fFile);
+    fFile = file;
     for (const auto& decl : fFile->root()) {
         switch (decl.fKind) {
             case ASTNode::Kind::kVarDeclarations: {
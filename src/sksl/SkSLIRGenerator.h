@@ -42,10 +42,12 @@ public:
     IRGenerator(const Context* context, std::shared_ptr<SymbolTable> root,
                 ErrorReporter& errorReporter);
 
+    /**
+     * Converts a file which has already been parsed, either by the Compiler or as one of the
+     * built-in modules. The file is not modified, and must outlive any IR generated from it.
+     */
     void convertProgram(Program::Kind kind,
-                        const char* text,
-                        size_t length,
-                        SymbolTable& types,
+                        ASTFile* file,
                         std::vector<std::unique_ptr<ProgramElement>>* result);
 
     /**
@@ -151,7 +153,9 @@ private:
     void getConstantInt(const Expression& value, int64_t* out);
     bool checkSwizzleWrite(const Swizzle& swizzle);
 
-    std::unique_ptr<ASTFile> fFile;
+    // the file currently being converted; fParsedFile holds the last program the Compiler parsed
+    ASTFile* fFile = nullptr;
+    std::unique_ptr<ASTFile> fParsedFile;
     const FunctionDeclaration* fCurrentFunction;
     std::unordered_map<String, Program::Settings::Value> fCapsMap;
     std::shared_ptr<SymbolTable> fRootSymbolTable;
@@ -0,0 +1,116 @@
+/*
+ * Copyright 2020 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "src/sksl/SkSLPool.h"
+
+#include <new>
+
+namespace SkSL {
+
+namespace {
+
+// Precedes every IR node, so that FreeIRNode knows where the node came from.
+struct alignas(std::max_align_t) NodeHeader {
+    // null for nodes allocated on the heap
+    Pool* fPool;
+    int fSizeClass;
+};
+
+// Pool allocations are made in multiples of the header size, which keeps every node aligned.
+static constexpr size_t kGranularity = sizeof(NodeHeader);
+static constexpr size_t kBlockSize = 16 * 1024;
+
+}  // namespace
+
+static thread_local Pool* gAttachedPool = nullptr;
+
+Pool::~Pool() {
+    for (void* block : fBlocks) {
+        ::operator delete(block);
+    }
+}
+
+std::shared_ptr<Pool> Pool::Create() {
+    return std::shared_ptr<Pool>(new Pool());
+}
+
+Pool::AutoAttach::AutoAttach(Pool* pool)
+    : fPrevious(gAttachedPool) {
+    gAttachedPool = pool;
+}
+
+Pool::AutoAttach::~AutoAttach() {
+    gAttachedPool = fPrevious;
+}
+
+Pool* Pool::Attached() {
+    return gAttachedPool;
+}
+
+bool Pool::contains(const void* node) const {
+    for (void* block : fBlocks) {
+        if (node >= block && node < (char*) block + kBlockSize) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void* Pool::allocate(int sizeClass) {
+    if (void* recycled = fFreeLists[sizeClass]) {
+        fFreeLists[sizeClass] = *(void**) recycled;
+        return recycled;
+    }
+    size_t size = sizeClass * kGranularity;
+    if (size > fRemaining) {
+        fCurrent = (char*) ::operator new(kBlockSize);
+        fRemaining = kBlockSize;
+        fBlocks.push_back(fCurrent);
+    }
+    void* result = fCurrent;
+    fCurrent += size;
+    fRemaining -= size;
+    return result;
+}
+
+void Pool::recycle(void* header, int sizeClass) {
+    *(void**) header = fFreeLists[sizeClass];
+    fFreeLists[sizeClass] = header;
+}
+
+void* Pool::AllocIRNode(size_t size) {
+    size_t total = sizeof(NodeHeader) + size;
+    int sizeClass = (int) ((total + kGranularity - 1) / kGranularity);
+    NodeHeader* header;
+    Pool* pool = gAttachedPool;
+    if (pool && sizeClass <= kMaxSizeClass) {
+        header = (NodeHeader*) pool->allocate(sizeClass);
+        header->fPool = pool;
+        header->fSizeClass = sizeClass;
+    } else {
+        header = (NodeHeader*) ::operator new(total);
+        header->fPool = nullptr;
+    }
+    return header + 1;
+}
+
+void Pool::FreeIRNode(void* node) {
+    if (!node) {
+        return;
+    }
+    NodeHeader* header = (NodeHeader*) node - 1;
+    Pool* pool = header->fPool;
+    if (!pool) {
+        ::operator delete(header);
+    } else if (pool == gAttachedPool) {
+        // Only the thread that has the pool attached touches its free lists. Nodes freed anywhere
+        // else simply stay put until the pool goes away.
+        pool->recycle(header, header->fSizeClass);
+    }
+}
+
+} // namespace
@@ -0,0 +1,86 @@
+/*
+ * Copyright 2020 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SKSL_POOL
+#define SKSL_POOL
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace SkSL {
+
+/**
+ * Backing memory for the IR nodes of a Program. While a pool is attached to a thread, every IRNode
+ * created on that thread is carved out of the pool's blocks instead of being allocated on its own,
+ * and all of the blocks are released at once when the pool is destroyed. Nodes created with no
+ * pool attached (for instance the built-in modules, which live as long as their Compiler) come
+ * from the heap as before; each node remembers where it came from, so the two kinds can be mixed
+ * freely within a tree.
+ *
+ * A node freed while its pool is attached is recycled for the next node of the same size, which
+ * keeps the optimizer's constant rewriting from growing the pool. Otherwise freeing a pool node
+ * does nothing, and its memory is reclaimed with the pool.
+ *
+ * Nothing holding pool nodes may outlive the pool; Program keeps its pool alive for that reason.
+ * SymbolTables remember the pool attached when they were made, and assert that they are never
+ * handed nodes from another one.
+ */
+class Pool {
+public:
+    ~Pool();
+
+    static std::shared_ptr<Pool> Create();
+
+    /**
+     * Attaches a pool to the current thread for the lifetime of the AutoAttach, then restores
+     * whichever pool was attached before. Attaching null sends allocations back to the heap.
+     */
+    class AutoAttach {
+    public:
+        AutoAttach(Pool* pool);
+
+        ~AutoAttach();
+
+    private:
+        Pool* fPrevious;
+    };
+
+    /**
+     * Returns the pool attached to the current thread, or null if allocations go to the heap.
+     */
+    static Pool* Attached();
+
+    /**
+     * Returns true if node was carved out of this pool. This walks all of the pool's blocks, so it
+     * is meant for assertions.
+     */
+    bool contains(const void* node) const;
+
+    static void* AllocIRNode(size_t size);
+
+    static void FreeIRNode(void* node);
+
+private:
+    Pool() = default;
+
+    void* allocate(int sizeClass);
+
+    void recycle(void* header, int sizeClass);
+
+    static constexpr int kMaxSizeClass = 32;
+
+    std::vector<void*> fBlocks;
+    char* fCurrent = nullptr;
+    size_t fRemaining = 0;
+    // recycled nodes, indexed by size class and linked through their first word
+    void* fFreeLists[kMaxSizeClass + 1] = {};
+};
+
+} // namespace
+
+#endif
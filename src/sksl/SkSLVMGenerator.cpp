@@ -0,0 +1,1384 @@
+/*
+ * Copyright 2020 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "src/sksl/SkSLVMGenerator.h"
+
+#if !defined(SKSL_STANDALONE)
+
+#include "src/sksl/SkSLUtil.h"
+#include "src/sksl/ir/SkSLBinaryExpression.h"
+#include "src/sksl/ir/SkSLBlock.h"
+#include "src/sksl/ir/SkSLBoolLiteral.h"
+#include "src/sksl/ir/SkSLConstructor.h"
+#include "src/sksl/ir/SkSLExpressionStatement.h"
+#include "src/sksl/ir/SkSLFieldAccess.h"
+#include "src/sksl/ir/SkSLFloatLiteral.h"
+#include "src/sksl/ir/SkSLForStatement.h"
+#include "src/sksl/ir/SkSLFunctionCall.h"
+#include "src/sksl/ir/SkSLFunctionDeclaration.h"
+#include "src/sksl/ir/SkSLFunctionDefinition.h"
+#include "src/sksl/ir/SkSLIfStatement.h"
+#include "src/sksl/ir/SkSLIndexExpression.h"
+#include "src/sksl/ir/SkSLIntLiteral.h"
+#include "src/sksl/ir/SkSLPostfixExpression.h"
+#include "src/sksl/ir/SkSLPrefixExpression.h"
+#include "src/sksl/ir/SkSLProgram.h"
+#include "src/sksl/ir/SkSLReturnStatement.h"
+#include "src/sksl/ir/SkSLSwizzle.h"
+#include "src/sksl/ir/SkSLTernaryExpression.h"
+#include "src/sksl/ir/SkSLVarDeclarations.h"
+#include "src/sksl/ir/SkSLVarDeclarationsStatement.h"
+#include "src/sksl/ir/SkSLVariableReference.h"
+
+#include <unordered_map>
+#include <unordered_set>
+
+namespace SkSL {
+
+namespace {
+
+// Every SkSL value is lowered to a flat list of SkVM values, one per scalar slot (matrices are
+// column-major). Floats are F32, ints are I32, and bools are I32 masks (~0 for true, 0 for false).
+using Value = std::vector<skvm::Val>;
+
+enum class BaseKind {
+    kFloat,
+    kSigned,
+    kUnsigned,
+    kBool,
+};
+
+static const Type& base_type(const Type& type) {
+    return type.kind() == Type::kVector_Kind || type.kind() == Type::kMatrix_Kind
+            ? type.componentType()
+            : type;
+}
+
+static BaseKind base_kind(const Type& type) {
+    const Type& base = base_type(type);
+    if (base.isFloat()) {
+        return BaseKind::kFloat;
+    }
+    if (base.isSigned()) {
+        return BaseKind::kSigned;
+    }
+    if (base.isUnsigned()) {
+        return BaseKind::kUnsigned;
+    }
+    return BaseKind::kBool;
+}
+
+// Returns the number of slots needed to hold a value of 'type', or -1 if it can't be lowered.
+static int slot_count(const Type& type) {
+    switch (type.kind()) {
+        case Type::kScalar_Kind:
+            return 1;
+        case Type::kVector_Kind:
+            return type.columns();
+        case Type::kMatrix_Kind:
+            return type.columns() * type.rows();
+        case Type::kArray_Kind: {
+            int count = slot_count(type.componentType());
+            return type.columns() > 0 && count >= 0 ? type.columns() * count : -1;
+        }
+        case Type::kStruct_Kind: {
+            int count = 0;
+            for (const auto& f : type.fields()) {
+                int fieldCount = slot_count(*f.fType);
+                if (fieldCount < 0) {
+                    return -1;
+                }
+                count += fieldCount;
+            }
+            return count;
+        }
+        default:
+            return type.name() == "void" ? 0 : -1;
+    }
+}
+
+class SkVMGenerator {
+public:
+    SkVMGenerator(const Program& program,
+                  skvm::Builder* builder,
+                  SkSpan<skvm::Val> uniforms,
+                  SampleChildFn sampleChild);
+
+    bool generateCode(const FunctionDefinition& function, SkSpan<skvm::Val> arguments);
+
+private:
+    enum class Intrinsic {
+        kAbs,
+        kCeil,
+        kClamp,
+        kCross,
+        kDistance,
+        kDot,
+        kFloor,
+        kFract,
+        kInverseSqrt,
+        kLength,
+        kMax,
+        kMin,
+        kMix,
+        kMod,
+        kNormalize,
+        kSample,
+        kSaturate,
+        kSign,
+        kSmoothstep,
+        kSqrt,
+        kStep,
+    };
+
+    // A reference to some of the slots of a variable.
+    struct LValue {
+        const Variable* fVar = nullptr;
+        std::vector<int> fSlots;
+    };
+
+    skvm::F32 f32(skvm::Val v) { return skvm::F32{v}; }
+    skvm::I32 i32(skvm::Val v) { return skvm::I32{v}; }
+
+    // Marks generation as failed. Generation continues with zero-valued placeholders, so every
+    // handler can keep returning well-formed values, and the caller discards the result.
+    void fail();
+    Value zeros(int count);
+
+    // Lanes that should be affected by the code being generated right now.
+    skvm::I32 mask();
+    bool allLanesActive() const {
+        return fConditionDepth == 0 && !fMayHaveReturned && !fMayHaveBroken;
+    }
+
+    void writeStatement(const Statement& s);
+    void writeBlock(const Block& b);
+    void writeForStatement(const ForStatement& f);
+    void writeIfStatement(const IfStatement& i);
+    void writeReturnStatement(const ReturnStatement& r);
+    void writeVarDeclarations(const VarDeclarations& decls);
+
+    Value writeExpression(const Expression& e);
+    Value writeBinaryExpression(const BinaryExpression& b);
+    Value writeBinaryOperation(Token::Kind op, const Type& leftType, const Value& left,
+                               const Type& rightType, const Value& right, int offset);
+    Value writeConstructor(const Constructor& c);
+    Value writeFunctionCall(const FunctionCall& c);
+    Value writeIndexExpression(const IndexExpression& i);
+    Value writeIntrinsicCall(const FunctionCall& c, Intrinsic intrinsic);
+    Value writePrefixExpression(const PrefixExpression& p);
+    Value writePostfixExpression(const PostfixExpression& p);
+    Value writeTernaryExpression(const TernaryExpression& t);
+    Value writeVariableReference(const VariableReference& v);
+
+    // Indices are constant if they're literals or the induction variable of an unrolled loop.
+    bool constantIndex(const Expression& index, int64_t* value);
+
+    // Selects the slots of a swizzle, field access, or constant index from its base.
+    bool selectSlots(const Expression& e, int baseSlots, std::vector<int>* slots);
+
+    LValue getLValue(const Expression& e);
+    void store(const LValue& lvalue, const Value& value);
+
+    skvm::Val convert(skvm::Val v, BaseKind from, BaseKind to);
+    skvm::F32 dot(const Value& x, const Value& y, int n);
+
+    const Program& fProgram;
+    skvm::Builder* fBuilder;
+    SampleChildFn fSampleChild;
+    const std::unordered_map<String, Intrinsic> fIntrinsics;
+
+    std::unordered_map<const FunctionDeclaration*, const FunctionDefinition*> fFunctions;
+    std::unordered_map<const Variable*, int> fChildren;
+    std::unordered_map<const Variable*, Value> fVariables;
+    std::unordered_map<const Variable*, int64_t> fLoopIndices;
+    std::unordered_set<const FunctionDeclaration*> fCallStack;
+
+    // Lanes that are running are those in all four masks. The condition mask is narrowed by
+    // if/else, ternaries and short-circuiting operators; the loop mask loses lanes that break,
+    // the continue mask loses lanes that continue (until the next iteration), and the return
+    // mask loses lanes that return from the function currently being inlined.
+    skvm::I32 fConditionMask;
+    skvm::I32 fLoopMask;
+    skvm::I32 fContinueMask;
+    skvm::I32 fReturnMask;
+    Value fReturnValue;
+
+    // Tracks whether the masks above could be anything other than all-on, without relying on
+    // the builder to tell us which values are constants.
+    int  fConditionDepth = 0;
+    bool fMayHaveReturned = false;
+    bool fMayHaveBroken = false;
+
+    bool fFailed = false;
+};
+
+SkVMGenerator::SkVMGenerator(const Program& program,
+                             skvm::Builder* builder,
+                             SkSpan<skvm::Val> uniforms,
+                             SampleChildFn sampleChild)
+        : fProgram(program)
+        , fBuilder(builder)
+        , fSampleChild(std::move(sampleChild))
+        , fIntrinsics {
+            { "abs",         Intrinsic::kAbs },
+            { "ceil",        Intrinsic::kCeil },
+            { "clamp",       Intrinsic::kClamp },
+            { "cross",       Intrinsic::kCross },
+            { "distance",    Intrinsic::kDistance },
+            { "dot",         Intrinsic::kDot },
+            { "floor",       Intrinsic::kFloor },
+            { "fract",       Intrinsic::kFract },
+            { "inversesqrt", Intrinsic::kInverseSqrt },
+            { "length",      Intrinsic::kLength },
+            { "max",         Intrinsic::kMax },
+            { "min",         Intrinsic::kMin },
+            { "mix",         Intrinsic::kMix },
+            { "mod",         Intrinsic::kMod },
+            { "normalize",   Intrinsic::kNormalize },
+            { "sample",      Intrinsic::kSample },
+            { "saturate",    Intrinsic::kSaturate },
+            { "sign",        Intrinsic::kSign },
+            { "smoothstep",  Intrinsic::kSmoothstep },
+            { "sqrt",        Intrinsic::kSqrt },
+            { "step",        Intrinsic::kStep },
+          } {
+    fConditionMask = fLoopMask = fContinueMask = fReturnMask = fBuilder->splat(~0);
+
+    // Bind uniforms (in declaration order) to the caller's values, number the children, and
+    // collect function definitions for inlining. Other globals are initialized in generateCode.
+    size_t uniformSlot = 0;
+    int childIndex = 0;
+    for (const ProgramElement& e : fProgram) {
+        if (e.fKind == ProgramElement::kFunction_Kind) {
+            const FunctionDefinition& f = (const FunctionDefinition&) e;
+            fFunctions[&f.fDeclaration] = &f;
+        } else if (e.fKind == ProgramElement::kVar_Kind) {
+            const VarDeclarations& decls = (const VarDeclarations&) e;
+            for (const auto& raw : decls.fVars) {
+                const Variable* var = ((const VarDeclaration&) *raw).fVar;
+                if (var->fType == *fProgram.fContext->fFragmentProcessor_Type) {
+                    fChildren[var] = childIndex++;
+                } else if (var->fModifiers.fFlags & Modifiers::kUniform_Flag) {
+                    int count = slot_count(var->fType);
+                    if (count < 0 || base_kind(var->fType) != BaseKind::kFloat ||
+                        uniformSlot + count > uniforms.size()) {
+                        this->fail();  // unsupported uniform
+                        continue;
+                    }
+                    Value& value = fVariables[var];
+                    value.assign(uniforms.begin() + uniformSlot,
+                                 uniforms.begin() + uniformSlot + count);
+                    uniformSlot += count;
+                }
+            }
+        }
+    }
+}
+
+void SkVMGenerator::fail() {
+    fFailed = true;
+}
+
+Value SkVMGenerator::zeros(int count) {
+    return Value((size_t) std::max(count, 0), fBuilder->splat(0).id);
+}
+
+skvm::I32 SkVMGenerator::mask() {
+    return fBuilder->bit_and(fBuilder->bit_and(fConditionMask, fLoopMask),
+                             fBuilder->bit_and(fContinueMask, fReturnMask));
+}
+
+bool SkVMGenerator::generateCode(const FunctionDefinition& function,
+                                 SkSpan<skvm::Val> arguments) {
+    for (const ProgramElement& e : fProgram) {
+        if (e.fKind != ProgramElement::kVar_Kind) {
+            continue;
+        }
+        const VarDeclarations& decls = (const VarDeclarations&) e;
+        for (const auto& raw : decls.fVars) {
+            const VarDeclaration& decl = (const VarDeclaration&) *raw;
+            const Variable* var = decl.fVar;
+            if (fChildren.count(var) || (var->fModifiers.fFlags & Modifiers::kUniform_Flag)) {
+                continue;
+            }
+            // Any 'in' variables were specialized into constants, so these are plain globals.
+            fVariables[var] = decl.fValue ? this->writeExpression(*decl.fValue)
+                                          : this->zeros(slot_count(var->fType));
+        }
+    }
+
+    size_t argumentSlot = 0;
+    for (const Variable* param : function.fDeclaration.fParameters) {
+        int count = slot_count(param->fType);
+        if (count < 0 || argumentSlot + count > arguments.size()) {
+            this->fail();  // unsupported parameter
+            return false;
+        }
+        fVariables[param].assign(arguments.begin() + argumentSlot,
+                                 arguments.begin() + argumentSlot + count);
+        argumentSlot += count;
+    }
+
+    fCallStack.insert(&function.fDeclaration);
+    this->writeStatement(*function.fBody);
+    fCallStack.erase(&function.fDeclaration);
+
+    argumentSlot = 0;
+    for (const Variable* param : function.fDeclaration.fParameters) {
+        for (skvm::Val v : fVariables[param]) {
+            arguments[argumentSlot++] = v;
+        }
+    }
+    return !fFailed;
+}
+
+void SkVMGenerator::writeStatement(const Statement& s) {
+    if (fFailed) {
+        return;
+    }
+    switch (s.fKind) {
+        case Statement::kBlock_Kind:
+            this->writeBlock((const Block&) s);
+            break;
+        case Statement::kBreak_Kind:
+            fLoopMask = fBuilder->bit_clear(fLoopMask, this->mask());
+            fMayHaveBroken = true;
+            break;
+        case Statement::kContinue_Kind:
+            fContinueMask = fBuilder->bit_clear(fContinueMask, this->mask());
+            fMayHaveBroken = true;
+            break;
+        case Statement::kExpression_Kind:
+            this->writeExpression(*((const ExpressionStatement&) s).fExpression);
+            break;
+        case Statement::kFor_Kind:
+            this->writeForStatement((const ForStatement&) s);
+            break;
+        case Statement::kIf_Kind:
+            this->writeIfStatement((const IfStatement&) s);
+            break;
+        case Statement::kNop_Kind:
+            break;
+        case Statement::kReturn_Kind:
+            this->writeReturnStatement((const ReturnStatement&) s);
+            break;
+        case Statement::kVarDeclarations_Kind:
+            this->writeVarDeclarations(*((const VarDeclarationsStatement&) s).fDeclaration);
+            break;
+        case Statement::kDiscard_Kind:
+        case Statement::kDo_Kind:
+        case Statement::kSwitch_Kind:
+        case Statement::kWhile_Kind:
+        default:
+            this->fail();  // unsupported statement
+            break;
+    }
+}
+
+void SkVMGenerator::writeBlock(const Block& b) {
+    for (const auto& s : b.fStatements) {
+        this->writeStatement(*s);
+    }
+}
+
+void SkVMGenerator::writeVarDeclarations(const VarDeclarations& decls) {
+    for (const auto& raw : decls.fVars) {
+        const VarDeclaration& decl = (const VarDeclaration&) *raw;
+        int count = slot_count(decl.fVar->fType);
+        if (count < 0) {
+            this->fail();  // unsupported variable type
+            return;
+        }
+        // Each declaration makes a fresh variable, so there's nothing to merge with: lanes that
+        // aren't running will never read it.
+        fVariables[decl.fVar] = decl.fValue ? this->writeExpression(*decl.fValue)
+                                            : this->zeros(count);
+    }
+}
+
+void SkVMGenerator::writeIfStatement(const IfStatement& i) {
+    const Expression& test = *i.fTest;
+    if (test.fKind == Expression::kBoolLiteral_Kind) {
+        if (((const BoolLiteral&) test).fValue) {
+            this->writeStatement(*i.fIfTrue);
+        } else if (i.fIfFalse) {
+            this->writeStatement(*i.fIfFalse);
+        }
+        return;
+    }
+
+    skvm::I32 cond = this->i32(this->writeExpression(test)[0]);
+    skvm::I32 saved = fConditionMask;
+    ++fConditionDepth;
+    fConditionMask = fBuilder->bit_and(saved, cond);
+    this->writeStatement(*i.fIfTrue);
+    if (i.fIfFalse) {
+        fConditionMask = fBuilder->bit_clear(saved, cond);
+        this->writeStatement(*i.fIfFalse);
+    }
+    fConditionMask = saved;
+    --fConditionDepth;
+}
+
+void SkVMGenerator::writeForStatement(const ForStatement& f) {
+    // SkVM has no branches, so loops are fully unrolled. We only accept the canonical form with a
+    // single numeric induction variable, a literal start, bound and step, and no other writes to
+    // the induction variable, so the trip count is known now.
+    auto literal_value = [](const Expression* e, double* value) {
+        if (e && e->fKind == Expression::kIntLiteral_Kind) {
+            *value = (double) ((const IntLiteral*) e)->fValue;
+            return true;
+        }
+        if (e && e->fKind == Expression::kFloatLiteral_Kind) {
+            *value = ((const FloatLiteral*) e)->fValue;
+            return true;
+        }
+        return false;
+    };
+
+    const Variable* var = nullptr;
+    double start = 0, bound = 0, step = 0;
+    if (f.fInitializer && f.fInitializer->fKind == Statement::kVarDeclarations_Kind) {
+        const VarDeclarations& decls =
+                *((const VarDeclarationsStatement&) *f.fInitializer).fDeclaration;
+        if (decls.fVars.size() == 1) {
+            const VarDeclaration& decl = (const VarDeclaration&) *decls.fVars[0];
+            if (decl.fVar->fType.kind() == Type::kScalar_Kind &&
+                base_kind(decl.fVar->fType) != BaseKind::kBool &&
+                literal_value(decl.fValue.get(), &start)) {
+                var = decl.fVar;
+            }
+        }
+    }
+
+    Token::Kind cmp = Token::Kind::EQ;
+    if (var && f.fTest && f.fTest->fKind == Expression::kBinary_Kind) {
+        const BinaryExpression& test = (const BinaryExpression&) *f.fTest;
+        if (test.fLeft->fKind == Expression::kVariableReference_Kind &&
+            &((const VariableReference&) *test.fLeft).fVariable == var &&
+            literal_value(test.fRight.get(), &bound)) {
+            cmp = test.fOperator;
+        }
+    }
+
+    bool validStep = false;
+    if (f.fNext && f.fNext->fKind == Expression::kPrefix_Kind) {
+        const PrefixExpression& p = (const PrefixExpression&) *f.fNext;
+        step = p.fOperator == Token::Kind::PLUSPLUS ? 1 : -1;
+        validStep = (p.fOperator == Token::Kind::PLUSPLUS ||
+                     p.fOperator == Token::Kind::MINUSMINUS) &&
+                    p.fOperand->fKind == Expression::kVariableReference_Kind &&
+                    &((const VariableReference&) *p.fOperand).fVariable == var;
+    } else if (f.fNext && f.fNext->fKind == Expression::kPostfix_Kind) {
+        const PostfixExpression& p = (const PostfixExpression&) *f.fNext;
+        step = p.fOperator == Token::Kind::PLUSPLUS ? 1 : -1;
+        validStep = (p.fOperator == Token::Kind::PLUSPLUS ||
+                     p.fOperator == Token::Kind::MINUSMINUS) &&
+                    p.fOperand->fKind == Expression::kVariableReference_Kind &&
+                    &((const VariableReference&) *p.fOperand).fVariable == var;
+    } else if (f.fNext && f.fNext->fKind == Expression::kBinary_Kind) {
+        const BinaryExpression& b = (const BinaryExpression&) *f.fNext;
+        validStep = (b.fOperator == Token::Kind::PLUSEQ || b.fOperator == Token::Kind::MINUSEQ) &&
+                    b.fLeft->fKind == Expression::kVariableReference_Kind &&
+                    &((const VariableReference&) *b.fLeft).fVariable == var &&
+                    literal_value(b.fRight.get(), &step);
+        if (b.fOperator == Token::Kind::MINUSEQ) {
+            step = -step;
+        }
+    }
+
+    // The initializer and the step are the only writes we allow to the induction variable.
+    static constexpr int kMaxIterations = 256;
+    bool validTest = cmp == Token::Kind::LT || cmp == Token::Kind::LTEQ ||
+                     cmp == Token::Kind::GT || cmp == Token::Kind::GTEQ ||
+                     cmp == Token::Kind::NEQ;
+    if (!var || !validTest || !validStep || step == 0 || var->fWriteCount > 2) {
+        this->fail();  // unsupported loop
+        return;
+    }
+
+    std::vector<double> values;
+    for (double i = start; values.size() <= kMaxIterations; i += step) {
+        bool running;
+        switch (cmp) {
+            case Token::Kind::LT:   running = i <  bound; break;
+            case Token::Kind::LTEQ: running = i <= bound; break;
+            case Token::Kind::GT:   running = i >  bound; break;
+            case Token::Kind::GTEQ: running = i >= bound; break;
+            case Token::Kind::NEQ:  running = i != bound; break;
+            default:                SkUNREACHABLE;
+        }
+        if (!running) {
+            break;
+        }
+        values.push_back(i);
+    }
+    if (values.size() > kMaxIterations) {
+        this->fail();  // loop has too many iterations
+        return;
+    }
+
+    skvm::I32 savedLoopMask = fLoopMask,
+              savedContinueMask = fContinueMask;
+    bool savedMayHaveBroken = fMayHaveBroken;
+    bool isFloat = base_kind(var->fType) == BaseKind::kFloat;
+    for (double i : values) {
+        fVariables[var] = { isFloat ? fBuilder->splat((float) i).id
+                                    : fBuilder->splat((int) i).id };
+        if (!isFloat) {
+            fLoopIndices[var] = (int64_t) i;
+        }
+        fContinueMask = fBuilder->splat(~0);
+        this->writeStatement(*f.fStatement);
+        if (fFailed) {
+            break;
+        }
+    }
+    fLoopIndices.erase(var);
+    fLoopMask = savedLoopMask;
+    fContinueMask = savedContinueMask;
+    fMayHaveBroken = savedMayHaveBroken;
+}
+
+void SkVMGenerator::writeReturnStatement(const ReturnStatement& r) {
+    if (r.fExpression) {
+        Value value = this->writeExpression(*r.fExpression);
+        skvm::I32 mask = this->mask();
+        for (size_t i = 0; i < value.size() && i < fReturnValue.size(); ++i) {
+            fReturnValue[i] = fBuilder->select(mask, this->i32(value[i]),
+                                                     this->i32(fReturnValue[i])).id;
+        }
+    }
+    fReturnMask = fBuilder->bit_clear(fReturnMask, this->mask());
+    fMayHaveReturned = true;
+}
+
+Value SkVMGenerator::writeExpression(const Expression& e) {
+    int count = slot_count(e.fType);
+    if (count < 0) {
+        this->fail();  // unsupported type
+    }
+    if (fFailed) {
+        return this->zeros(count);
+    }
+
+    Value result;
+    switch (e.fKind) {
+        case Expression::kBinary_Kind:
+            result = this->writeBinaryExpression((const BinaryExpression&) e);
+            break;
+        case Expression::kBoolLiteral_Kind:
+            result = { fBuilder->splat(((const BoolLiteral&) e).fValue ? ~0 : 0).id };
+            break;
+        case Expression::kConstructor_Kind:
+            result = this->writeConstructor((const Constructor&) e);
+            break;
+        case Expression::kFloatLiteral_Kind:
+            result = { fBuilder->splat((float) ((const FloatLiteral&) e).fValue).id };
+            break;
+        case Expression::kIntLiteral_Kind:
+            result = { fBuilder->splat((int) ((const IntLiteral&) e).fValue).id };
+            break;
+        case Expression::kFunctionCall_Kind:
+            result = this->writeFunctionCall((const FunctionCall&) e);
+            break;
+        case Expression::kPrefix_Kind:
+            result = this->writePrefixExpression((const PrefixExpression&) e);
+            break;
+        case Expression::kPostfix_Kind:
+            result = this->writePostfixExpression((const PostfixExpression&) e);
+            break;
+        case Expression::kTernary_Kind:
+            result = this->writeTernaryExpression((const TernaryExpression&) e);
+            break;
+        case Expression::kVariableReference_Kind:
+            result = this->writeVariableReference((const VariableReference&) e);
+            break;
+        case Expression::kIndex_Kind:
+            result = this->writeIndexExpression((const IndexExpression&) e);
+            break;
+        case Expression::kFieldAccess_Kind:
+        case Expression::kSwizzle_Kind: {
+            const Expression& base = e.fKind == Expression::kFieldAccess_Kind
+                                             ? *((const FieldAccess&) e).fBase
+                                             : *((const Swizzle&) e).fBase;
+            Value baseValue = this->writeExpression(base);
+            std::vector<int> slots;
+            if (!this->selectSlots(e, baseValue.size(), &slots)) {
+                break;
+            }
+            for (int slot : slots) {
+                if (slot == SKSL_SWIZZLE_0 || slot == SKSL_SWIZZLE_1) {
+                    bool isFloat = base_kind(e.fType) == BaseKind::kFloat;
+                    result.push_back(isFloat ? fBuilder->splat(slot == SKSL_SWIZZLE_1 ? 1.0f : 0.0f).id
+                                             : fBuilder->splat(slot == SKSL_SWIZZLE_1 ? 1 : 0).id);
+                } else {
+                    result.push_back(baseValue[slot]);
+                }
+            }
+            break;
+        }
+        default:
+            this->fail();  // unsupported expression
+            break;
+    }
+
+    if (fFailed || (int) result.size() != count) {
+        this->fail();  // internal error: wrong number of slots
+        return this->zeros(count);
+    }
+    return result;
+}
+
+bool SkVMGenerator::constantIndex(const Expression& index, int64_t* value) {
+    if (index.fKind == Expression::kIntLiteral_Kind) {
+        *value = ((const IntLiteral&) index).fValue;
+        return true;
+    }
+    if (index.fKind == Expression::kVariableReference_Kind) {
+        auto found = fLoopIndices.find(&((const VariableReference&) index).fVariable);
+        if (found != fLoopIndices.end()) {
+            *value = found->second;
+            return true;
+        }
+    }
+    return false;
+}
+
+Value SkVMGenerator::writeIndexExpression(const IndexExpression& i) {
+    Value base = this->writeExpression(*i.fBase);
+    if (fFailed) {
+        return {};
+    }
+    std::vector<int> slots;
+    int64_t index;
+    if (this->constantIndex(*i.fIndex, &index)) {
+        if (!this->selectSlots(i, base.size(), &slots)) {
+            return {};
+        }
+        Value result;
+        for (int slot : slots) {
+            result.push_back(base[slot]);
+        }
+        return result;
+    }
+
+    // Any other index picks its element with a chain of selects. Out of range indices read the
+    // first element.
+    skvm::I32 dynamicIndex = this->i32(this->writeExpression(*i.fIndex)[0]);
+    size_t count = slot_count(i.fType);
+    Value result(base.begin(), base.begin() + count);
+    for (size_t element = 1; (element + 1) * count <= base.size(); ++element) {
+        skvm::I32 match = fBuilder->eq(dynamicIndex, fBuilder->splat((int) element));
+        for (size_t slot = 0; slot < count; ++slot) {
+            result[slot] = fBuilder->select(match, this->i32(base[element * count + slot]),
+                                                   this->i32(result[slot])).id;
+        }
+    }
+    return result;
+}
+
+bool SkVMGenerator::selectSlots(const Expression& e, int baseSlots, std::vector<int>* slots) {
+    switch (e.fKind) {
+        case Expression::kSwizzle_Kind:
+            *slots = ((const Swizzle&) e).fComponents;
+            for (int slot : *slots) {
+                if (slot >= baseSlots) {
+                    this->fail();  // swizzle out of range
+                    return false;
+                }
+            }
+            return true;
+        case Expression::kFieldAccess_Kind: {
+            const FieldAccess& f = (const FieldAccess&) e;
+            const auto& fields = f.fBase->fType.fields();
+            int first = 0;
+            for (int i = 0; i < f.fFieldIndex; ++i) {
+                first += slot_count(*fields[i].fType);
+            }
+            for (int i = 0; i < slot_count(e.fType); ++i) {
+                slots->push_back(first + i);
+            }
+            return true;
+        }
+        case Expression::kIndex_Kind: {
+            const IndexExpression& i = (const IndexExpression&) e;
+            int64_t index;
+            if (!this->constantIndex(*i.fIndex, &index)) {
+                this->fail();  // assigning through a dynamic index is not supported
+                return false;
+            }
+            int count = slot_count(e.fType);
+            if (index < 0 || (index + 1) * count > baseSlots) {
+                this->fail();  // index out of range
+                return false;
+            }
+            for (int slot = 0; slot < count; ++slot) {
+                slots->push_back(index * count + slot);
+            }
+            return true;
+        }
+        default:
+            SkUNREACHABLE;
+    }
+}
+
+SkVMGenerator::LValue SkVMGenerator::getLValue(const Expression& e) {
+    LValue result;
+    switch (e.fKind) {
+        case Expression::kVariableReference_Kind: {
+            const Variable* var = &((const VariableReference&) e).fVariable;
+            auto found = fVariables.find(var);
+            if (found == fVariables.end() || fChildren.count(var) ||
+                (var->fModifiers.fFlags & Modifiers::kUniform_Flag)) {
+                this->fail();  // unsupported assignment
+                break;
+            }
+            result.fVar = var;
+            for (size_t i = 0; i < found->second.size(); ++i) {
+                result.fSlots.push_back(i);
+            }
+            break;
+        }
+        case Expression::kFieldAccess_Kind:
+        case Expression::kIndex_Kind:
+        case Expression::kSwizzle_Kind: {
+            const Expression& base = e.fKind == Expression::kFieldAccess_Kind
+                                             ? *((const FieldAccess&) e).fBase
+                                     : e.fKind == Expression::kIndex_Kind
+                                             ? *((const IndexExpression&) e).fBase
+                                             : *((const Swizzle&) e).fBase;
+            LValue baseLValue = this->getLValue(base);
+            std::vector<int> slots;
+            if (!baseLValue.fVar || !this->selectSlots(e, baseLValue.fSlots.size(), &slots)) {
+                break;
+            }
+            result.fVar = baseLValue.fVar;
+            for (int slot : slots) {
+                if (slot < 0) {
+                    this->fail();  // cannot assign to a constant swizzle component
+                    return LValue();
+                }
+                result.fSlots.push_back(baseLValue.fSlots[slot]);
+            }
+            break;
+        }
+        default:
+            this->fail();  // unsupported assignment
+            break;
+    }
+    return result;
+}
+
+void SkVMGenerator::store(const LValue& lvalue, const Value& value) {
+    if (fFailed || !lvalue.fVar) {
+        return;
+    }
+    SkASSERT(lvalue.fSlots.size() == value.size());
+    Value& slots = fVariables[lvalue.fVar];
+    skvm::I32 mask = this->mask();
+    bool allLanesActive = this->allLanesActive();
+    for (size_t i = 0; i < value.size(); ++i) {
+        skvm::Val& slot = slots[lvalue.fSlots[i]];
+        if (slot == skvm::NA) {
+            // An unknown argument stays unknown unless it's overwritten in every lane.
+            slot = allLanesActive ? value[i] : skvm::NA;
+        } else {
+            slot = fBuilder->select(mask, this->i32(value[i]), this->i32(slot)).id;
+        }
+    }
+}
+
+skvm::Val SkVMGenerator::convert(skvm::Val v, BaseKind from, BaseKind to) {
+    if (from == to) {
+        return v;
+    }
+    switch (to) {
+        case BaseKind::kFloat:
+            return from == BaseKind::kBool
+                    ? fBuilder->select(this->i32(v), fBuilder->splat(1.0f),
+                                                     fBuilder->splat(0.0f)).id
+                    : fBuilder->to_f32(this->i32(v)).id;
+        case BaseKind::kSigned:
+        case BaseKind::kUnsigned:
+            switch (from) {
+                case BaseKind::kFloat: return fBuilder->trunc(this->f32(v)).id;
+                case BaseKind::kBool:  return fBuilder->bit_and(this->i32(v),
+                                                                fBuilder->splat(1)).id;
+                default:               return v;
+            }
+        case BaseKind::kBool:
+            return from == BaseKind::kFloat
+                    ? fBuilder->neq(this->f32(v), fBuilder->splat(0.0f)).id
+                    : fBuilder->neq(this->i32(v), fBuilder->splat(0)).id;
+    }
+    SkUNREACHABLE;
+}
+
+skvm::F32 SkVMGenerator::dot(const Value& x, const Value& y, int n) {
+    skvm::F32 result = fBuilder->mul(this->f32(x[0]), this->f32(y[0]));
+    for (int i = 1; i < n; ++i) {
+        result = fBuilder->mad(this->f32(x[i]), this->f32(y[i]), result);
+    }
+    return result;
+}
+
+Value SkVMGenerator::writeVariableReference(const VariableReference& v) {
+    auto found = fVariables.find(&v.fVariable);
+    if (found == fVariables.end()) {
+        this->fail();  // unsupported variable
+        return {};
+    }
+    for (skvm::Val slot : found->second) {
+        if (slot == skvm::NA) {
+            this->fail();  // reads a value that is not available
+            return {};
+        }
+    }
+    return found->second;
+}
+
+Value SkVMGenerator::writeBinaryExpression(const BinaryExpression& b) {
+    Token::Kind op = b.fOperator;
+    const Type& leftType = b.fLeft->fType;
+    const Type& rightType = b.fRight->fType;
+
+    if (op == Token::Kind::EQ) {
+        Value right = this->writeExpression(*b.fRight);
+        this->store(this->getLValue(*b.fLeft), right);
+        return right;
+    }
+
+    bool assignment = is_assignment(op);
+    if (assignment) {
+        op = remove_assignment(op);
+    }
+
+    Value left = this->writeExpression(*b.fLeft);
+    Value right;
+    if (op == Token::Kind::LOGICALAND || op == Token::Kind::LOGICALOR) {
+        // Only evaluate the right side (and its side effects) in lanes that need it.
+        skvm::I32 saved = fConditionMask;
+        ++fConditionDepth;
+        fConditionMask = op == Token::Kind::LOGICALAND
+                ? fBuilder->bit_and(saved, this->i32(left[0]))
+                : fBuilder->bit_clear(saved, this->i32(left[0]));
+        right = this->writeExpression(*b.fRight);
+        fConditionMask = saved;
+        --fConditionDepth;
+    } else if (op == Token::Kind::SHL || op == Token::Kind::SHR) {
+        if (b.fRight->fKind != Expression::kIntLiteral_Kind) {
+            this->fail();  // shifts must be by a constant
+            return {};
+        }
+        int bits = (int) ((const IntLiteral&) *b.fRight).fValue;
+        Value result;
+        for (skvm::Val v : left) {
+            result.push_back(op == Token::Kind::SHL
+                                     ? fBuilder->shl(this->i32(v), bits).id
+                             : base_kind(leftType) == BaseKind::kUnsigned
+                                     ? fBuilder->shr(this->i32(v), bits).id
+                                     : fBuilder->sra(this->i32(v), bits).id);
+        }
+        if (assignment) {
+            this->store(this->getLValue(*b.fLeft), result);
+        }
+        return result;
+    } else {
+        right = this->writeExpression(*b.fRight);
+    }
+    if (fFailed) {
+        return {};
+    }
+
+    Value result = this->writeBinaryOperation(op, leftType, left, rightType, right, b.fOffset);
+    if (assignment) {
+        this->store(this->getLValue(*b.fLeft), result);
+    }
+    return result;
+}
+
+Value SkVMGenerator::writeBinaryOperation(Token::Kind op,
+                                          const Type& leftType, const Value& left,
+                                          const Type& rightType, const Value& right,
+                                          int offset) {
+    skvm::Builder* b = fBuilder;
+    bool leftMatrix = leftType.kind() == Type::kMatrix_Kind,
+         rightMatrix = rightType.kind() == Type::kMatrix_Kind;
+
+    // Linear algebra.
+    if (op == Token::Kind::STAR && (leftMatrix || rightMatrix) &&
+        leftType.kind() != Type::kScalar_Kind && rightType.kind() != Type::kScalar_Kind) {
+        // A vector on the left is a row vector, and on the right a column vector.
+        int leftColumns  = leftType.columns(),
+            leftRows     = leftMatrix ? leftType.rows() : 1,
+            rightColumns = rightMatrix ? rightType.columns() : 1,
+            rightRows    = rightMatrix ? rightType.rows() : rightType.columns();
+        if (leftColumns != rightRows) {
+            this->fail();  // mismatched matrix dimensions
+            return {};
+        }
+        Value result;
+        for (int c = 0; c < rightColumns; ++c) {
+            for (int r = 0; r < leftRows; ++r) {
+                skvm::F32 sum = b->splat(0.0f);
+                for (int k = 0; k < leftColumns; ++k) {
+                    sum = b->mad(this->f32(left[k * leftRows + r]),
+                                 this->f32(right[c * rightRows + k]), sum);
+                }
+                result.push_back(sum.id);
+            }
+        }
+        return result;
+    }
+
+    BaseKind kind = base_kind(leftType);
+    size_t n = std::max(left.size(), right.size());
+    auto L = [&](size_t i) { return left .size() == 1 ? left [0] : left [i]; };
+    auto R = [&](size_t i) { return right.size() == 1 ? right[0] : right[i]; };
+
+    if (op == Token::Kind::EQEQ || op == Token::Kind::NEQ) {
+        bool eq = op == Token::Kind::EQEQ;
+        skvm::I32 result = b->splat(eq ? ~0 : 0);
+        for (size_t i = 0; i < n; ++i) {
+            skvm::I32 cmp = kind == BaseKind::kFloat
+                    ? (eq ? b->eq (this->f32(L(i)), this->f32(R(i)))
+                          : b->neq(this->f32(L(i)), this->f32(R(i))))
+                    : (eq ? b->eq (this->i32(L(i)), this->i32(R(i)))
+                          : b->neq(this->i32(L(i)), this->i32(R(i))));
+            result = eq ? b->bit_and(result, cmp) : b->bit_or(result, cmp);
+        }
+        return { result.id };
+    }
+
+    Value result;
+    for (size_t i = 0; i < n; ++i) {
+        skvm::Val x = L(i), y = R(i);
+        if (kind == BaseKind::kFloat) {
+            skvm::F32 fx = this->f32(x), fy = this->f32(y);
+            switch (op) {
+                case Token::Kind::PLUS:  result.push_back(b->add(fx, fy).id); continue;
+                case Token::Kind::MINUS: result.push_back(b->sub(fx, fy).id); continue;
+                case Token::Kind::STAR:  result.push_back(b->mul(fx, fy).id); continue;
+                case Token::Kind::SLASH: result.push_back(b->div(fx, fy).id); continue;
+                case Token::Kind::LT:    result.push_back(b->lt (fx, fy).id); continue;
+                case Token::Kind::LTEQ:  result.push_back(b->lte(fx, fy).id); continue;
+                case Token::Kind::GT:    result.push_back(b->gt (fx, fy).id); continue;
+                case Token::Kind::GTEQ:  result.push_back(b->gte(fx, fy).id); continue;
+                default: break;
+            }
+        } else {
+            skvm::I32 ix = this->i32(x), iy = this->i32(y);
+            switch (op) {
+                case Token::Kind::BITWISEAND:
+                case Token::Kind::LOGICALAND: result.push_back(b->bit_and(ix, iy).id); continue;
+                case Token::Kind::BITWISEOR:
+                case Token::Kind::LOGICALOR:  result.push_back(b->bit_or (ix, iy).id); continue;
+                case Token::Kind::BITWISEXOR:
+                case Token::Kind::LOGICALXOR: result.push_back(b->bit_xor(ix, iy).id); continue;
+                default: break;
+            }
+            if (kind != BaseKind::kBool) {
+                switch (op) {
+                    case Token::Kind::PLUS:  result.push_back(b->add(ix, iy).id); continue;
+                    case Token::Kind::MINUS: result.push_back(b->sub(ix, iy).id); continue;
+                    case Token::Kind::STAR:  result.push_back(b->mul(ix, iy).id); continue;
+                    default: break;
+                }
+            }
+            if (kind == BaseKind::kSigned) {
+                switch (op) {
+                    case Token::Kind::LT:   result.push_back(b->lt (ix, iy).id); continue;
+                    case Token::Kind::LTEQ: result.push_back(b->lte(ix, iy).id); continue;
+                    case Token::Kind::GT:   result.push_back(b->gt (ix, iy).id); continue;
+                    case Token::Kind::GTEQ: result.push_back(b->gte(ix, iy).id); continue;
+                    default: break;
+                }
+            }
+        }
+        this->fail();  // unsupported operator
+        return {};
+    }
+    return result;
+}
+
+Value SkVMGenerator::writePrefixExpression(const PrefixExpression& p) {
+    Value operand = this->writeExpression(*p.fOperand);
+    if (fFailed) {
+        return {};
+    }
+    BaseKind kind = base_kind(p.fOperand->fType);
+    Value result;
+    switch (p.fOperator) {
+        case Token::Kind::MINUS:
+            for (skvm::Val v : operand) {
+                result.push_back(kind == BaseKind::kFloat
+                                 ? fBuilder->negate(this->f32(v)).id
+                                 : fBuilder->sub(fBuilder->splat(0), this->i32(v)).id);
+            }
+            return result;
+        case Token::Kind::LOGICALNOT:
+        case Token::Kind::BITWISENOT:
+            for (skvm::Val v : operand) {
+                result.push_back(fBuilder->bit_xor(this->i32(v), fBuilder->splat(~0)).id);
+            }
+            return result;
+        case Token::Kind::PLUSPLUS:
+        case Token::Kind::MINUSMINUS: {
+            Value one = { kind == BaseKind::kFloat ? fBuilder->splat(1.0f).id
+                                                   : fBuilder->splat(1).id };
+            result = this->writeBinaryOperation(p.fOperator == Token::Kind::PLUSPLUS
+                                                        ? Token::Kind::PLUS
+                                                        : Token::Kind::MINUS,
+                                                p.fOperand->fType, operand,
+                                                p.fOperand->fType, one, p.fOffset);
+            this->store(this->getLValue(*p.fOperand), result);
+            return result;
+        }
+        default:
+            this->fail();  // unsupported prefix operator
+            return {};
+    }
+}
+
+Value SkVMGenerator::writePostfixExpression(const PostfixExpression& p) {
+    Value operand = this->writeExpression(*p.fOperand);
+    if (fFailed) {
+        return {};
+    }
+    BaseKind kind = base_kind(p.fOperand->fType);
+    Value one = { kind == BaseKind::kFloat ? fBuilder->splat(1.0f).id : fBuilder->splat(1).id };
+    Value result = this->writeBinaryOperation(p.fOperator == Token::Kind::PLUSPLUS
+                                                      ? Token::Kind::PLUS
+                                                      : Token::Kind::MINUS,
+                                              p.fOperand->fType, operand,
+                                              p.fOperand->fType, one, p.fOffset);
+    this->store(this->getLValue(*p.fOperand), result);
+    return operand;
+}
+
+Value SkVMGenerator::writeTernaryExpression(const TernaryExpression& t) {
+    skvm::I32 test = this->i32(this->writeExpression(*t.fTest)[0]);
+
+    skvm::I32 saved = fConditionMask;
+    ++fConditionDepth;
+    fConditionMask = fBuilder->bit_and(saved, test);
+    Value ifTrue = this->writeExpression(*t.fIfTrue);
+    fConditionMask = fBuilder->bit_clear(saved, test);
+    Value ifFalse = this->writeExpression(*t.fIfFalse);
+    fConditionMask = saved;
+    --fConditionDepth;
+
+    Value result;
+    for (size_t i = 0; i < ifTrue.size() && i < ifFalse.size(); ++i) {
+        result.push_back(fBuilder->select(test, this->i32(ifTrue[i]),
+                                                this->i32(ifFalse[i])).id);
+    }
+    return result;
+}
+
+Value SkVMGenerator::writeConstructor(const Constructor& c) {
+    const Type& dstType = c.fType;
+    BaseKind dstKind = base_kind(dstType);
+    int dstSlots = slot_count(dstType);
+
+    if (c.fArguments.size() == 1) {
+        const Type& srcType = c.fArguments[0]->fType;
+        BaseKind srcKind = base_kind(srcType);
+        Value src = this->writeExpression(*c.fArguments[0]);
+        if (fFailed) {
+            return {};
+        }
+
+        if (srcType.kind() == Type::kScalar_Kind && dstType.kind() == Type::kMatrix_Kind) {
+            // A scalar fills the diagonal.
+            skvm::Val diagonal = this->convert(src[0], srcKind, dstKind),
+                      zero = fBuilder->splat(0.0f).id;
+            Value result;
+            for (int col = 0; col < dstType.columns(); ++col) {
+                for (int row = 0; row < dstType.rows(); ++row) {
+                    result.push_back(col == row ? diagonal : zero);
+                }
+            }
+            return result;
+        }
+        if (srcType.kind() == Type::kMatrix_Kind && dstType.kind() == Type::kMatrix_Kind) {
+            // Resize, keeping the top-left corner and filling the rest with the identity.
+            Value result;
+            for (int col = 0; col < dstType.columns(); ++col) {
+                for (int row = 0; row < dstType.rows(); ++row) {
+                    if (col < srcType.columns() && row < srcType.rows()) {
+                        result.push_back(src[col * srcType.rows() + row]);
+                    } else {
+                        result.push_back(fBuilder->splat(col == row ? 1.0f : 0.0f).id);
+                    }
+                }
+            }
+            return result;
+        }
+        if (src.size() == 1 && dstSlots > 1) {
+            return Value((size_t) dstSlots, this->convert(src[0], srcKind, dstKind));
+        }
+    }
+
+    Value result;
+    for (const auto& arg : c.fArguments) {
+        BaseKind srcKind = base_kind(arg->fType);
+        for (skvm::Val v : this->writeExpression(*arg)) {
+            result.push_back(this->convert(v, srcKind, dstKind));
+        }
+    }
+    return result;
+}
+
+Value SkVMGenerator::writeFunctionCall(const FunctionCall& c) {
+    auto definition = fFunctions.find(&c.fFunction);
+    if (definition == fFunctions.end()) {
+        auto found = fIntrinsics.find(c.fFunction.fName);
+        if (!c.fFunction.fBuiltin || found == fIntrinsics.end()) {
+            this->fail();  // unsupported function call
+            return {};
+        }
+        return this->writeIntrinsicCall(c, found->second);
+    }
+    if (fCallStack.count(&c.fFunction)) {
+        this->fail();  // recursion is not supported
+        return {};
+    }
+
+    // Calls are inlined: arguments become fresh variables, and the body runs with its own return
+    // and loop state, under the caller's current mask.
+    const FunctionDeclaration& decl = c.fFunction;
+    std::vector<Value> arguments;
+    for (size_t i = 0; i < c.fArguments.size(); ++i) {
+        const Variable* param = decl.fParameters[i];
+        bool in = (param->fModifiers.fFlags & Modifiers::kIn_Flag) ||
+                  !(param->fModifiers.fFlags & Modifiers::kOut_Flag);
+        arguments.push_back(in ? this->writeExpression(*c.fArguments[i])
+                               : this->zeros(slot_count(param->fType)));
+    }
+    if (fFailed) {
+        return {};
+    }
+    for (size_t i = 0; i < arguments.size(); ++i) {
+        fVariables[decl.fParameters[i]] = arguments[i];
+    }
+
+    // The callee's loop and return state starts fresh, so the lanes the caller has broken out of
+    // or returned from are folded into the condition mask first.
+    skvm::I32 savedConditionMask = fConditionMask,
+              savedLoopMask = fLoopMask,
+              savedContinueMask = fContinueMask,
+              savedReturnMask = fReturnMask;
+    bool savedMayHaveReturned = fMayHaveReturned,
+         savedMayHaveBroken = fMayHaveBroken;
+    int savedConditionDepth = fConditionDepth;
+    Value savedReturnValue = std::move(fReturnValue);
+
+    if (!this->allLanesActive()) {
+        fConditionMask = this->mask();
+        ++fConditionDepth;
+    }
+    fLoopMask = fContinueMask = fReturnMask = fBuilder->splat(~0);
+    fMayHaveReturned = fMayHaveBroken = false;
+    fReturnValue = this->zeros(slot_count(decl.fReturnType));
+
+    fCallStack.insert(&decl);
+    this->writeStatement(*definition->second->fBody);
+    fCallStack.erase(&decl);
+
+    Value result = std::move(fReturnValue);
+    fConditionMask = savedConditionMask;
+    fConditionDepth = savedConditionDepth;
+    fLoopMask = savedLoopMask;
+    fContinueMask = savedContinueMask;
+    fReturnMask = savedReturnMask;
+    fMayHaveReturned = savedMayHaveReturned;
+    fMayHaveBroken = savedMayHaveBroken;
+    fReturnValue = std::move(savedReturnValue);
+
+    for (size_t i = 0; i < c.fArguments.size(); ++i) {
+        if (decl.fParameters[i]->fModifiers.fFlags & Modifiers::kOut_Flag) {
+            this->store(this->getLValue(*c.fArguments[i]), fVariables[decl.fParameters[i]]);
+        }
+    }
+    return result;
+}
+
+Value SkVMGenerator::writeIntrinsicCall(const FunctionCall& c, Intrinsic intrinsic) {
+    skvm::Builder* b = fBuilder;
+
+    if (intrinsic == Intrinsic::kSample) {
+        const Expression& child = *c.fArguments[0];
+        auto found = child.fKind == Expression::kVariableReference_Kind
+                ? fChildren.find(&((const VariableReference&) child).fVariable)
+                : fChildren.end();
+        if (!fSampleChild || found == fChildren.end() || c.fArguments.size() != 2 ||
+            c.fArguments[1]->fType.kind() != Type::kVector_Kind) {
+            this->fail();  // unsupported sample() call
+            return {};
+        }
+        Value coords = this->writeExpression(*c.fArguments[1]);
+        if (fFailed) {
+            return {};
+        }
+        skvm::Color color = fSampleChild(found->second, this->f32(coords[0]),
+                                                        this->f32(coords[1]));
+        return { color.r.id, color.g.id, color.b.id, color.a.id };
+    }
+
+    std::vector<Value> args;
+    for (const auto& arg : c.fArguments) {
+        args.push_back(this->writeExpression(*arg));
+    }
+    if (fFailed) {
+        return {};
+    }
+
+    // Scalar arguments are broadcast against vector ones.
+    auto arg = [&](size_t a, size_t i) {
+        return this->f32(args[a].size() == 1 ? args[a][0] : args[a][i]);
+    };
+    const Type& argType = c.fArguments[0]->fType;
+    BaseKind kind = base_kind(argType);
+    size_t n = slot_count(c.fType);
+
+    if (kind != BaseKind::kFloat) {
+        // Only the comparisons have obvious integer forms.
+        if (kind != BaseKind::kSigned || (intrinsic != Intrinsic::kAbs &&
+                                          intrinsic != Intrinsic::kMin &&
+                                          intrinsic != Intrinsic::kMax &&
+                                          intrinsic != Intrinsic::kClamp)) {
+            this->fail();  // unsupported intrinsic argument type
+            return {};
+        }
+        auto iarg = [&](size_t a, size_t i) {
+            return this->i32(args[a].size() == 1 ? args[a][0] : args[a][i]);
+        };
+        Value result;
+        for (size_t i = 0; i < n; ++i) {
+            skvm::I32 x = iarg(0, i);
+            switch (intrinsic) {
+                case Intrinsic::kAbs:
+                    x = b->select(b->lt(x, b->splat(0)), b->sub(b->splat(0), x), x);
+                    break;
+                case Intrinsic::kMin:
+                    x = b->select(b->lt(iarg(1, i), x), iarg(1, i), x);
+                    break;
+                case Intrinsic::kMax:
+                    x = b->select(b->gt(iarg(1, i), x), iarg(1, i), x);
+                    break;
+                case Intrinsic::kClamp:
+                    x = b->select(b->lt(x, iarg(1, i)), iarg(1, i), x);
+                    x = b->select(b->gt(x, iarg(2, i)), iarg(2, i), x);
+                    break;
+                default:
+                    SkUNREACHABLE;
+            }
+            result.push_back(x.id);
+        }
+        return result;
+    }
+
+    switch (intrinsic) {
+        case Intrinsic::kDot:
+            return { this->dot(args[0], args[1], args[0].size()).id };
+        case Intrinsic::kLength:
+            return { b->sqrt(this->dot(args[0], args[0], args[0].size())).id };
+        case Intrinsic::kDistance: {
+            Value delta;
+            for (size_t i = 0; i < args[0].size(); ++i) {
+                delta.push_back(b->sub(arg(0, i), arg(1, i)).id);
+            }
+            return { b->sqrt(this->dot(delta, delta, delta.size())).id };
+        }
+        case Intrinsic::kNormalize: {
+            skvm::F32 invLength = b->div(b->splat(1.0f),
+                                         b->sqrt(this->dot(args[0], args[0], args[0].size())));
+            Value result;
+            for (size_t i = 0; i < n; ++i) {
+                result.push_back(b->mul(arg(0, i), invLength).id);
+            }
+            return result;
+        }
+        case Intrinsic::kCross: {
+            auto cross = [&](int i, int j) {
+                return b->sub(b->mul(arg(0, i), arg(1, j)), b->mul(arg(0, j), arg(1, i)));
+            };
+            return { cross(1, 2).id, cross(2, 0).id, cross(0, 1).id };
+        }
+        default:
+            break;
+    }
+
+    Value result;
+    for (size_t i = 0; i < n; ++i) {
+        skvm::F32 x = arg(0, i);
+        switch (intrinsic) {
+            case Intrinsic::kAbs:         x = b->abs(x);                                break;
+            case Intrinsic::kCeil:        x = b->negate(b->floor(b->negate(x)));        break;
+            case Intrinsic::kFloor:       x = b->floor(x);                              break;
+            case Intrinsic::kFract:       x = b->fract(x);                              break;
+            case Intrinsic::kInverseSqrt: x = b->div(b->splat(1.0f), b->sqrt(x));       break;
+            case Intrinsic::kSaturate:    x = b->clamp(x, b->splat(0.0f), b->splat(1.0f)); break;
+            case Intrinsic::kSqrt:        x = b->sqrt(x);                               break;
+            case Intrinsic::kMin:         x = b->min(x, arg(1, i));                     break;
+            case Intrinsic::kMax:         x = b->max(x, arg(1, i));                     break;
+            case Intrinsic::kClamp:       x = b->clamp(x, arg(1, i), arg(2, i));        break;
+            case Intrinsic::kSign:
+                x = b->select(b->gt(x, b->splat(0.0f)), b->splat( 1.0f),
+                    b->select(b->lt(x, b->splat(0.0f)), b->splat(-1.0f), b->splat(0.0f)));
+                break;
+            case Intrinsic::kMod: {
+                skvm::F32 y = arg(1, i);
+                x = b->sub(x, b->mul(y, b->floor(b->div(x, y))));
+                break;
+            }
+            case Intrinsic::kMix:
+                if (base_kind(c.fArguments[2]->fType) == BaseKind::kBool) {
+                    x = b->select(this->i32(args[2].size() == 1 ? args[2][0] : args[2][i]),
+                                  arg(1, i), x);
+                } else {
+                    x = b->lerp(x, arg(1, i), arg(2, i));
+                }
+                break;
+            case Intrinsic::kStep:
+                // step(edge, x): 0 if x < edge, else 1.
+                x = b->select(b->lt(arg(1, i), x), b->splat(0.0f), b->splat(1.0f));
+                break;
+            case Intrinsic::kSmoothstep: {
+                skvm::F32 t = b->div(b->sub(arg(2, i), x), b->sub(arg(1, i), x));
+                t = b->clamp(t, b->splat(0.0f), b->splat(1.0f));
+                x = b->mul(b->mul(t, t), b->sub(b->splat(3.0f), b->mul(b->splat(2.0f), t)));
+                break;
+            }
+            default:
+                this->fail();  // unsupported intrinsic
+                return {};
+        }
+        result.push_back(x.id);
+    }
+    return result;
+}
+
+}  // namespace
+
+bool ProgramToSkVM(const Program& program,
+                   const FunctionDefinition& function,
+                   skvm::Builder* builder,
+                   SkSpan<skvm::Val> uniforms,
+                   SkSpan<skvm::Val> arguments,
+                   SampleChildFn sampleChild) {
+    SkASSERT(program.fIsOptimized);
+    SkVMGenerator generator(program, builder, uniforms, std::move(sampleChild));
+    return generator.generateCode(function, arguments);
+}
+
+}  // namespace SkSL
+
+#endif
@@ -0,0 +1,51 @@
+/*
+ * Copyright 2020 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SKSL_VMGENERATOR
+#define SKSL_VMGENERATOR
+
+#include "src/core/SkSpan.h"
+#include "src/core/SkVM.h"
+
+#include <functional>
+
+namespace SkSL {
+
+class FunctionDefinition;
+struct Program;
+
+/**
+ * Emits the color of child 'index' (the index-th fragmentProcessor declared by the program),
+ * sampled at (x, y).
+ */
+using SampleChildFn = std::function<skvm::Color(int index, skvm::F32 x, skvm::F32 y)>;
+
+/**
+ * Lowers 'function' (normally main) of an optimized pipeline-stage program into 'builder', so a
+ * runtime effect can be JIT-compiled as part of a larger SkVM program instead of being run by the
+ * interpreter.
+ *
+ * 'uniforms' holds one F32 per float slot of the program's uniforms, in declaration order (the
+ * same layout as SkRuntimeEffect's uniform block). 'arguments' holds one value per slot of the
+ * function's parameters; they are read on entry and updated with any out/inout results. A value
+ * of skvm::NA marks an argument as unknown; the program fails to generate if it reads one.
+ *
+ * Only the subset of SkSL that maps cleanly onto SkVM is supported: straight-line code, if/else,
+ * ternaries, constant-bound for loops (unrolled), and calls to user functions (inlined). Returns
+ * false, leaving junk instructions in 'builder', if the program uses anything else; callers are
+ * expected to fall back to the interpreter.
+ */
+bool ProgramToSkVM(const Program& program,
+                   const FunctionDefinition& function,
+                   skvm::Builder* builder,
+                   SkSpan<skvm::Val> uniforms,
+                   SkSpan<skvm::Val> arguments,
+                   SampleChildFn sampleChild = nullptr);
+
+}  // namespace SkSL
+
+#endif
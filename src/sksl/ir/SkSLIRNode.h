@@ -9,6 +9,7 @@
 #define SKSL_IRNODE
 
 #include "src/sksl/SkSLLexer.h"
+#include "src/sksl/SkSLPool.h"
 #include "src/sksl/SkSLString.h"
 
 namespace SkSL {
@@ -23,6 +24,15 @@ struct IRNode {
 
     virtual ~IRNode() {}
 
+    // IR nodes come from the Pool attached to the current thread, if there is one.
+    static void* operator new(size_t size) {
+        return Pool::AllocIRNode(size);
+    }
+
+    static void operator delete(void* node) {
+        Pool::FreeIRNode(node);
+    }
+
 #ifdef SK_DEBUG
     virtual String description() const = 0;
 #endif
@@ -11,6 +11,7 @@
 #include <vector>
 #include <memory>
 
+#include "src/sksl/SkSLPool.h"
 #include "src/sksl/ir/SkSLBoolLiteral.h"
 #include "src/sksl/ir/SkSLExpression.h"
 #include "src/sksl/ir/SkSLFloatLiteral.h"
@@ -234,8 +235,10 @@ struct Program {
             std::vector<std::unique_ptr<ProgramElement>>* inheritedElements,
             std::vector<std::unique_ptr<ProgramElement>> elements,
             std::shared_ptr<SymbolTable> symbols,
-            Inputs inputs)
-    : fKind(kind)
+            Inputs inputs,
+            std::shared_ptr<Pool> pool = nullptr)
+    : fPool(std::move(pool))
+    , fKind(kind)
     , fSource(std::move(source))
     , fSettings(settings)
     , fContext(context)
@@ -276,6 +279,9 @@ struct Program {
         return const_iterator(fElements.end(), fElements.end(), fElements.end(), fElements.end());
     }
 
+    // the memory for this program's IR nodes (or null if they came from the heap); declared first,
+    // so that it's destroyed after everything which might hold those nodes
+    std::shared_ptr<Pool> fPool;
     Kind fKind;
     std::unique_ptr<String> fSource;
     Settings fSettings;
@@ -6,6 +6,7 @@
  */
 
 #include "src/sksl/ir/SkSLSymbolTable.h"
+
 #include "src/sksl/ir/SkSLUnresolvedFunction.h"
 
 namespace SkSL {
@@ -51,6 +52,9 @@ const Symbol* SymbolTable::operator[](StringFragment name) {
                 }
                 if (modified) {
                     SkASSERT(functions.size() > 1);
+                    // This table may belong to a module that outlives the program being compiled,
+                    // so the new symbol must not come from the program's pool.
+                    Pool::AutoAttach detach(nullptr);
                     return this->takeOwnership(std::unique_ptr<Symbol>(
                                                                 new UnresolvedFunction(functions)));
                 }
@@ -60,13 +64,21 @@ const Symbol* SymbolTable::operator[](StringFragment name) {
     return entry->second;
 }
 
+bool SymbolTable::canHold(const IRNode* node) const {
+    // Nodes are only ever carved out of the attached pool, so that's the one to check.
+    Pool* attached = Pool::Attached();
+    return !attached || attached == fPool || !attached->contains(node);
+}
+
 Symbol* SymbolTable::takeOwnership(std::unique_ptr<Symbol> s) {
+    SkASSERT(this->canHold(s.get()));
     Symbol* result = s.get();
     fOwnedSymbols.push_back(std::move(s));
     return result;
 }
 
 IRNode* SymbolTable::takeOwnership(std::unique_ptr<IRNode> n) {
+    SkASSERT(this->canHold(n.get()));
     IRNode* result = n.get();
     fOwnedNodes.push_back(std::move(n));
     return result;
@@ -78,6 +90,7 @@ void SymbolTable::add(StringFragment name, std::unique_ptr<Symbol> symbol) {
 }
 
 void SymbolTable::addWithoutOwnership(StringFragment name, const Symbol* symbol) {
+    SkASSERT(this->canHold(symbol));
     const auto& existing = fSymbols.find(name);
     if (existing == fSymbols.end()) {
         fSymbols[name] = symbol;
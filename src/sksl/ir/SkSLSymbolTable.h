@@ -12,6 +12,7 @@
 #include <memory>
 #include <vector>
 #include "src/sksl/SkSLErrorReporter.h"
+#include "src/sksl/SkSLPool.h"
 #include "src/sksl/ir/SkSLSymbol.h"
 
 namespace SkSL {
@@ -52,6 +53,9 @@ public:
 private:
     static std::vector<const FunctionDeclaration*> GetFunctions(const Symbol& s);
 
+    // Whether node may be stored here: it must not come from a pool other than ours.
+    bool canHold(const IRNode* node) const;
+
     std::vector<std::unique_ptr<Symbol>> fOwnedSymbols;
 
     std::vector<std::unique_ptr<IRNode>> fOwnedNodes;
@@ -59,6 +63,10 @@ private:
     std::unordered_map<StringFragment, const Symbol*> fSymbols;
 
     ErrorReporter& fErrorReporter;
+
+    // The pool attached when this table was made. The modules' tables are made with none attached,
+    // as they outlive every program's pool.
+    Pool* const fPool = Pool::Attached();
 };
 
 } // namespace
@@ -0,0 +1,234 @@
+/*
+ * Copyright 2020 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/utils/SkAnimFrameDecoder.h"
+
+#include "include/codec/SkCodecAnimation.h"
+#include "include/core/SkImage.h"
+#include "include/core/SkPixmap.h"
+#include "include/private/SkTArray.h"
+#include "src/core/SkTaskGroup.h"
+
+#include <algorithm>
+#include <cstring>
+
+std::unique_ptr<SkAnimFrameDecoder> SkAnimFrameDecoder::Make(sk_sp<SkData> data,
+                                                             const Options& options) {
+    std::unique_ptr<SkCodec> codec = SkCodec::MakeFromData(data);
+    if (!codec) {
+        return nullptr;
+    }
+    return std::unique_ptr<SkAnimFrameDecoder>(
+            new SkAnimFrameDecoder(std::move(data), std::move(codec), options));
+}
+
+SkAnimFrameDecoder::SkAnimFrameDecoder(sk_sp<SkData> data, std::unique_ptr<SkCodec> codec,
+                                       const Options& options)
+        : fData(std::move(data))
+        , fOptions(options)
+        , fInfo(codec->getInfo())
+        , fFrameInfos(codec->getFrameInfo())
+        , fFrameCount(std::max(1, SkToInt(fFrameInfos.size())))
+        , fFrames(fFrameCount)
+        , fCurrent(0)
+        , fWaiters(0) {
+    fCodecs.push_back(std::move(codec));
+    if (fOptions.fExecutor) {
+        fTasks = std::make_unique<SkTaskGroup>(*fOptions.fExecutor);
+    }
+}
+
+SkAnimFrameDecoder::~SkAnimFrameDecoder() {
+    if (fTasks) {
+        fTasks->wait();
+    }
+}
+
+int SkAnimFrameDecoder::requiredFrame(int index) const {
+    return index < SkToInt(fFrameInfos.size()) ? fFrameInfos[index].fRequiredFrame
+                                               : SkCodec::kNoFrame;
+}
+
+bool SkAnimFrameDecoder::isKept(int index) const {
+    if (fOptions.fKeyframeInterval > 0 && index % fOptions.fKeyframeInterval == 0) {
+        return true;
+    }
+    const int lookahead = fTasks ? fOptions.fLookahead : 0;
+    return (index - fCurrent + fFrameCount) % fFrameCount <= lookahead;
+}
+
+void SkAnimFrameDecoder::waitForFrame() {
+    fWaiters++;
+    fMutex.release();
+    fFrameDone.wait();
+    fMutex.acquire();
+}
+
+void SkAnimFrameDecoder::signalFrames() {
+    if (fWaiters > 0) {
+        fFrameDone.signal(fWaiters);
+        fWaiters = 0;
+    }
+}
+
+std::unique_ptr<SkCodec> SkAnimFrameDecoder::acquireCodec() {
+    {
+        SkAutoMutexExclusive lock(fMutex);
+        if (!fCodecs.empty()) {
+            std::unique_ptr<SkCodec> codec = std::move(fCodecs.back());
+            fCodecs.pop_back();
+            return codec;
+        }
+    }
+    // SkCodec is not thread safe, so each concurrent decode needs one of its own.
+    return SkCodec::MakeFromData(fData);
+}
+
+void SkAnimFrameDecoder::releaseCodec(std::unique_ptr<SkCodec> codec) {
+    if (codec) {
+        SkAutoMutexExclusive lock(fMutex);
+        fCodecs.push_back(std::move(codec));
+    }
+}
+
+sk_sp<SkImage> SkAnimFrameDecoder::decode(int index, bool onlyIfQueued) {
+    // The frames to decode, from index back to one that needs no prior frame or can start from
+    // priorImage.
+    SkSTArray<8, int, true> chain;
+    sk_sp<SkImage> priorImage;
+    int priorFrame = SkCodec::kNoFrame;
+
+    fMutex.acquire();
+    if (onlyIfQueued && fFrames[index].fState != State::kQueued) {
+        fMutex.release();
+        return nullptr;
+    }
+    while (fFrames[index].fState == State::kDecoding) {
+        this->waitForFrame();
+    }
+    if (sk_sp<SkImage> image = fFrames[index].fImage) {
+        fMutex.release();
+        return image;
+    }
+
+    for (int frame = index;;) {
+        SkASSERT(!fFrames[frame].fImage && fFrames[frame].fState != State::kDecoding);
+        fFrames[frame].fState = State::kDecoding;
+        chain.push_back(frame);
+
+        const int required = this->requiredFrame(frame);
+        if (required == SkCodec::kNoFrame) {
+            break;
+        }
+
+        // Any frame from the required one on can be the starting point, unless it restores the
+        // frame before it. Take the latest that is decoded, waiting for it if it is in progress.
+        int start;
+        for (;;) {
+            start = SkCodec::kNoFrame;
+            for (int i = frame - 1; i >= required; --i) {
+                if (fFrameInfos[i].fDisposalMethod !=
+                        SkCodecAnimation::DisposalMethod::kRestorePrevious &&
+                    (fFrames[i].fImage || fFrames[i].fState == State::kDecoding)) {
+                    start = i;
+                    break;
+                }
+            }
+            if (start == SkCodec::kNoFrame || fFrames[start].fImage) {
+                break;
+            }
+            this->waitForFrame();
+        }
+        if (start != SkCodec::kNoFrame) {
+            priorImage = fFrames[start].fImage;
+            priorFrame = start;
+            break;
+        }
+        frame = required;
+    }
+    fMutex.release();
+
+    std::unique_ptr<SkCodec> codec = this->acquireCodec();
+    const size_t rowBytes = fInfo.minRowBytes(),
+                 size     = fInfo.computeByteSize(rowBytes);
+    sk_sp<SkImage> image;
+    int i = chain.count() - 1;
+    for (; i >= 0; --i) {
+        const int frame = chain[i];
+        sk_sp<SkData> pixels = SkData::MakeUninitialized(size);
+
+        SkCodec::Options opts;
+        opts.fFrameIndex = frame;
+        if (priorImage) {
+            SkPixmap prior;
+            SkAssertResult(priorImage->peekPixels(&prior));
+            memcpy(pixels->writable_data(), prior.addr(), size);
+            opts.fPriorFrame = priorFrame;
+        }
+        if (!codec || SkCodec::kSuccess != codec->getPixels(fInfo, pixels->writable_data(),
+                                                            rowBytes, &opts)) {
+            break;
+        }
+        image = SkImage::MakeRasterData(fInfo, std::move(pixels), rowBytes);
+
+        {
+            SkAutoMutexExclusive lock(fMutex);
+            fFrames[frame].fState = State::kIdle;
+            if (this->isKept(frame)) {
+                fFrames[frame].fImage = image;
+            }
+            this->signalFrames();
+        }
+        priorImage = image;
+        priorFrame = frame;
+    }
+    this->releaseCodec(std::move(codec));
+
+    if (i >= 0) {
+        // Give up the frames that were not decoded. Anyone waiting on them will try for
+        // themselves.
+        SkAutoMutexExclusive lock(fMutex);
+        for (; i >= 0; --i) {
+            fFrames[chain[i]].fState = State::kIdle;
+        }
+        this->signalFrames();
+        return nullptr;
+    }
+    return image;
+}
+
+sk_sp<SkImage> SkAnimFrameDecoder::getFrame(int index) {
+    if (index < 0 || index >= fFrameCount) {
+        return nullptr;
+    }
+
+    SkSTArray<4, int, true> queued;
+    {
+        SkAutoMutexExclusive lock(fMutex);
+        fCurrent = index;
+        for (int i = 0; i < fFrameCount; ++i) {
+            if (fFrames[i].fImage && !this->isKept(i)) {
+                fFrames[i].fImage = nullptr;
+            }
+        }
+        if (fTasks) {
+            for (int i = 1; i <= fOptions.fLookahead && i < fFrameCount; ++i) {
+                const int next = (index + i) % fFrameCount;
+                if (!fFrames[next].fImage && fFrames[next].fState == State::kIdle) {
+                    fFrames[next].fState = State::kQueued;
+                    queued.push_back(next);
+                }
+            }
+        }
+    }
+    // Added outside the lock, in case the executor runs them right away.
+    for (int next : queued) {
+        fTasks->add([this, next] { this->decode(next, true); });
+    }
+
+    return this->decode(index, false);
+}
@@ -0,0 +1,326 @@
+/*
+ * Copyright 2010 The Android Open Source Project
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "src/utils/SkDeflate.h"
+
+#include "include/core/SkData.h"
+#include "include/core/SkExecutor.h"
+#include "include/private/SkMalloc.h"
+#include "include/private/SkSemaphore.h"
+#include "include/private/SkTemplates.h"
+#include "include/private/SkTo.h"
+#include "src/core/SkTraceEvent.h"
+
+#include "zlib.h"
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+
+namespace {
+
+// Different zlib implementations use different T.
+// We've seen size_t and unsigned.
+template <typename T> void* skia_alloc_func(void*, T items, T size) {
+    return sk_calloc_throw(SkToSizeT(items) * SkToSizeT(size));
+}
+
+void skia_free_func(void*, void* address) { sk_free(address); }
+
+}  // namespace
+
+#define SKDEFLATEWSTREAM_INPUT_BUFFER_SIZE 4096
+#define SKDEFLATEWSTREAM_OUTPUT_BUFFER_SIZE 4224  // 4096 + 128, usually big
+                                                  // enough to always do a
+                                                  // single loop.
+
+// called by both write() and finalize()
+static void do_deflate(int flush,
+                       z_stream* zStream,
+                       SkWStream* out,
+                       unsigned char* inBuffer,
+                       size_t inBufferSize) {
+    zStream->next_in = inBuffer;
+    zStream->avail_in = SkToInt(inBufferSize);
+    unsigned char outBuffer[SKDEFLATEWSTREAM_OUTPUT_BUFFER_SIZE];
+    SkDEBUGCODE(int returnValue;)
+    do {
+        zStream->next_out = outBuffer;
+        zStream->avail_out = sizeof(outBuffer);
+        SkDEBUGCODE(returnValue =) deflate(zStream, flush);
+        SkASSERT(!zStream->msg);
+
+        out->write(outBuffer, sizeof(outBuffer) - zStream->avail_out);
+    } while (zStream->avail_in || !zStream->avail_out);
+    SkASSERT(flush == Z_FINISH
+                 ? returnValue == Z_STREAM_END
+                 : returnValue == Z_OK);
+}
+
+static constexpr size_t kParallelBlockSize = 128 * 1024;
+static constexpr size_t kDictionarySize = 32 * 1024;  // The deflate window.
+static constexpr int kDefaultMaxBlocksInFlight = 8;
+
+namespace {
+
+// With an executor, input is split into blocks compressed independently, as pigz does.  Each
+// block is raw deflate data, primed with the last 32K of the previous block's input and ended
+// with a sync flush (the last with a finish), so the blocks can simply be concatenated.  We
+// write the zlib or gzip header and trailer around them ourselves.
+struct DeflateBlock {
+    DeflateBlock(int level, bool gzip) : fLevel(level), fGzip(gzip) {}
+
+    uint8_t* input() { return fInput.get() + fDictionarySize; }
+
+    // Input space grows as it is written, so short streams never hold a whole block.
+    void reserve(size_t inputSize) {
+        if (inputSize > fInputCapacity) {
+            fInputCapacity = std::min(std::max(inputSize, 2 * fInputCapacity), kParallelBlockSize);
+            fInput.realloc(fDictionarySize + fInputCapacity);
+        }
+    }
+
+    // Called on an executor thread.  Does nothing if the writing thread got here first.
+    void run() {
+        if (!fClaimed.exchange(true)) {
+            this->compress();
+            fDone.signal();
+        }
+    }
+
+    // Called on the writing thread.  Compresses the block here if no thread has started on it,
+    // so that we never wait on work queued behind our own task on a busy executor.
+    void finish() {
+        if (!fClaimed.exchange(true)) {
+            this->compress();
+        } else {
+            fDone.wait();
+        }
+    }
+
+    void compress() {
+        TRACE_EVENT0("skia", TRACE_FUNC);
+        z_stream zStream;
+        zStream.next_in = nullptr;
+        zStream.zalloc = &skia_alloc_func;
+        zStream.zfree = &skia_free_func;
+        zStream.opaque = nullptr;
+        SkDEBUGCODE(int r =) deflateInit2(&zStream, fLevel, Z_DEFLATED, -15,
+                                          8, Z_DEFAULT_STRATEGY);
+        SkASSERT(Z_OK == r);
+        if (fDictionarySize > 0) {
+            deflateSetDictionary(&zStream, fInput.get(), SkToUInt(fDictionarySize));
+        }
+        do_deflate(fLast ? Z_FINISH : Z_SYNC_FLUSH, &zStream, &fOutput,
+                   this->input(), fInputSize);
+        (void)deflateEnd(&zStream);
+
+        fCheck = fGzip ? crc32 (crc32 (0, nullptr, 0), this->input(), SkToUInt(fInputSize))
+                       : adler32(adler32(0, nullptr, 0), this->input(), SkToUInt(fInputSize));
+    }
+
+    SkAutoTMalloc<uint8_t>  fInput;  // fDictionarySize bytes of dictionary, then the input.
+    size_t                  fDictionarySize = 0;
+    size_t                  fInputSize = 0;
+    size_t                  fInputCapacity = 0;
+    const int               fLevel;
+    const bool              fGzip;
+    bool                    fLast = false;
+
+    SkDynamicMemoryWStream  fOutput;
+    uLong                   fCheck = 0;
+    std::atomic<bool>       fClaimed{false};
+    SkSemaphore             fDone;
+};
+
+}  // namespace
+
+// Hide all zlib impl details.
+struct SkDeflateWStream::Impl {
+    SkWStream* fOut;
+    unsigned char fInBuffer[SKDEFLATEWSTREAM_INPUT_BUFFER_SIZE];
+    size_t fInBufferIndex;
+    z_stream fZStream;
+
+    // Used instead of the above when compressing in parallel.
+    SkExecutor* fExecutor = nullptr;
+    int fCompressionLevel;
+    bool fGzip;
+    int fMaxBlocksInFlight;
+    std::shared_ptr<DeflateBlock> fFilling;
+    std::deque<std::shared_ptr<DeflateBlock>> fPending;
+    uLong fCheck;
+    size_t fTotalIn = 0;
+
+    void submitBlock();
+    void writeFrontBlock();
+};
+
+void SkDeflateWStream::Impl::submitBlock() {
+    std::shared_ptr<DeflateBlock> block = std::move(fFilling);
+    fFilling = std::make_shared<DeflateBlock>(fCompressionLevel, fGzip);
+    if (fCompressionLevel != 0) {
+        // Stored blocks make no use of a dictionary.
+        size_t dictionarySize = std::min(kDictionarySize,
+                                         block->fDictionarySize + block->fInputSize);
+        fFilling->fInput.realloc(dictionarySize);
+        memcpy(fFilling->fInput.get(),
+               block->input() + block->fInputSize - dictionarySize, dictionarySize);
+        fFilling->fDictionarySize = dictionarySize;
+    }
+
+    fPending.push_back(block);
+    fExecutor->add([block] { block->run(); });
+    while ((int)fPending.size() > fMaxBlocksInFlight) {
+        this->writeFrontBlock();
+    }
+}
+
+void SkDeflateWStream::Impl::writeFrontBlock() {
+    std::shared_ptr<DeflateBlock> block = std::move(fPending.front());
+    fPending.pop_front();
+    block->finish();
+    block->fOutput.writeToAndReset(fOut);
+    fCheck = fGzip ? crc32_combine (fCheck, block->fCheck, (z_off_t)block->fInputSize)
+                   : adler32_combine(fCheck, block->fCheck, (z_off_t)block->fInputSize);
+}
+
+SkDeflateWStream::SkDeflateWStream(SkWStream* out,
+                                   int compressionLevel,
+                                   bool gzip,
+                                   SkExecutor* executor,
+                                   int maxBlocksInFlight)
+    : fImpl(std::make_unique<SkDeflateWStream::Impl>()) {
+    fImpl->fOut = out;
+    fImpl->fInBufferIndex = 0;
+    if (!fImpl->fOut) {
+        return;
+    }
+    SkASSERT(compressionLevel <= 9 && compressionLevel >= -1);
+    if (executor) {
+        fImpl->fExecutor = executor;
+        fImpl->fCompressionLevel = compressionLevel;
+        fImpl->fGzip = gzip;
+        fImpl->fMaxBlocksInFlight = maxBlocksInFlight > 0 ? maxBlocksInFlight
+                                                          : kDefaultMaxBlocksInFlight;
+        fImpl->fFilling = std::make_shared<DeflateBlock>(compressionLevel, gzip);
+        if (gzip) {
+            // Magic, deflate, no flags, no modification time, no extra flags, and Unix,
+            // which is what zlib writes.
+            static const uint8_t kGzipHeader[] = { 0x1f, 0x8b, 8, 0, 0, 0, 0, 0, 0, 3 };
+            out->write(kGzipHeader, sizeof(kGzipHeader));
+            fImpl->fCheck = crc32(0, nullptr, 0);
+        } else {
+            // A 32K window and deflate, then the level hint zlib would choose, padded so that
+            // the header is a multiple of 31.
+            int level = compressionLevel == -1 ? 6 : compressionLevel;
+            unsigned levelFlags = level < 2 ? 0 : level < 6 ? 1 : level == 6 ? 2 : 3;
+            unsigned header = (0x78 << 8) | (levelFlags << 6);
+            header += 31 - header % 31;
+            const uint8_t zlibHeader[] = { (uint8_t)(header >> 8), (uint8_t)(header >> 0) };
+            out->write(zlibHeader, sizeof(zlibHeader));
+            fImpl->fCheck = adler32(0, nullptr, 0);
+        }
+        return;
+    }
+    fImpl->fZStream.next_in = nullptr;
+    fImpl->fZStream.zalloc = &skia_alloc_func;
+    fImpl->fZStream.zfree = &skia_free_func;
+    fImpl->fZStream.opaque = nullptr;
+    SkASSERT(compressionLevel <= 9 && compressionLevel >= -1);
+    SkDEBUGCODE(int r =) deflateInit2(&fImpl->fZStream, compressionLevel,
+                                      Z_DEFLATED, gzip ? 0x1F : 0x0F,
+                                      8, Z_DEFAULT_STRATEGY);
+    SkASSERT(Z_OK == r);
+}
+
+SkDeflateWStream::~SkDeflateWStream() { this->finalize(); }
+
+void SkDeflateWStream::finalize() {
+    TRACE_EVENT0("skia", TRACE_FUNC);
+    if (!fImpl->fOut) {
+        return;
+    }
+    if (fImpl->fExecutor) {
+        // The last block is compressed here, as we have to wait on everything anyway.
+        fImpl->fFilling->fLast = true;
+        fImpl->fPending.push_back(std::move(fImpl->fFilling));
+        while (!fImpl->fPending.empty()) {
+            fImpl->writeFrontBlock();
+        }
+
+        uint32_t check = SkToU32(fImpl->fCheck);
+        if (fImpl->fGzip) {
+            // CRC-32 and input size mod 2^32, little endian.
+            uint32_t size = SkToU32(fImpl->fTotalIn & 0xffffffff);
+            const uint8_t trailer[] = { (uint8_t)(check >>  0), (uint8_t)(check >>  8),
+                                        (uint8_t)(check >> 16), (uint8_t)(check >> 24),
+                                        (uint8_t)(size  >>  0), (uint8_t)(size  >>  8),
+                                        (uint8_t)(size  >> 16), (uint8_t)(size  >> 24) };
+            fImpl->fOut->write(trailer, sizeof(trailer));
+        } else {
+            // Adler-32, big endian.
+            const uint8_t adler[] = { (uint8_t)(check >> 24), (uint8_t)(check >> 16),
+                                      (uint8_t)(check >>  8), (uint8_t)(check >>  0) };
+            fImpl->fOut->write(adler, sizeof(adler));
+        }
+        fImpl->fOut = nullptr;
+        return;
+    }
+    do_deflate(Z_FINISH, &fImpl->fZStream, fImpl->fOut, fImpl->fInBuffer,
+               fImpl->fInBufferIndex);
+    (void)deflateEnd(&fImpl->fZStream);
+    fImpl->fOut = nullptr;
+}
+
+bool SkDeflateWStream::write(const void* void_buffer, size_t len) {
+    TRACE_EVENT0("skia", TRACE_FUNC);
+    if (!fImpl->fOut) {
+        return false;
+    }
+    const char* buffer = (const char*)void_buffer;
+    if (fImpl->fExecutor) {
+        fImpl->fTotalIn += len;
+        while (len > 0) {
+            DeflateBlock* block = fImpl->fFilling.get();
+            size_t tocopy = std::min(len, kParallelBlockSize - block->fInputSize);
+            block->reserve(block->fInputSize + tocopy);
+            memcpy(block->input() + block->fInputSize, buffer, tocopy);
+            len -= tocopy;
+            buffer += tocopy;
+            block->fInputSize += tocopy;
+            if (block->fInputSize == kParallelBlockSize) {
+                fImpl->submitBlock();
+            }
+        }
+        return true;
+    }
+    while (len > 0) {
+        size_t tocopy =
+                std::min(len, sizeof(fImpl->fInBuffer) - fImpl->fInBufferIndex);
+        memcpy(fImpl->fInBuffer + fImpl->fInBufferIndex, buffer, tocopy);
+        len -= tocopy;
+        buffer += tocopy;
+        fImpl->fInBufferIndex += tocopy;
+        SkASSERT(fImpl->fInBufferIndex <= sizeof(fImpl->fInBuffer));
+
+        // if the buffer isn't filled, don't call into zlib yet.
+        if (sizeof(fImpl->fInBuffer) == fImpl->fInBufferIndex) {
+            do_deflate(Z_NO_FLUSH, &fImpl->fZStream, fImpl->fOut,
+                       fImpl->fInBuffer, fImpl->fInBufferIndex);
+            fImpl->fInBufferIndex = 0;
+        }
+    }
+    return true;
+}
+
+size_t SkDeflateWStream::bytesWritten() const {
+    if (fImpl->fExecutor) {
+        return fImpl->fTotalIn;
+    }
+    return fImpl->fZStream.total_in + fImpl->fInBufferIndex;
+}
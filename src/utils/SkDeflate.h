@@ -11,6 +11,8 @@
 
 #include "include/core/SkStream.h"
 
+class SkExecutor;
+
 /**
   * Wrap a stream in this class to compress the information written to
   * this stream using the Deflate algorithm.
@@ -29,10 +31,23 @@ public:
         a wrapper, documented in RFC 1952, around a deflate stream."
         gzip adds a header with a magic number to the beginning of the
         stream, allowing a client to identify a gzip file.
+
+        @param executor if not null, split the input into blocks that
+        are compressed independently on the executor's threads, then
+        concatenated into one stream.  Each block is primed with the
+        end of the block before it, so the output is only a little
+        larger than the serial encoder's.
+
+        @param maxBlocksInFlight the most blocks to hold at once when
+        using an executor, bounding both the threads used and the
+        memory held (up to 160K of input per block, allocated as it
+        is written).  0 picks a default.
      */
     SkDeflateWStream(SkWStream*,
                      int compressionLevel = -1,
-                     bool gzip = false);
+                     bool gzip = false,
+                     SkExecutor* executor = nullptr,
+                     int maxBlocksInFlight = 0);
 
     /** The destructor calls finalize(). */
     ~SkDeflateWStream() override;
@@ -16,8 +16,11 @@
 #include "include/core/SkImageInfo.h"
 #include "include/core/SkRefCnt.h"
 #include "include/core/SkSize.h"
+#include "include/core/SkStream.h"
 #include "include/core/SkString.h"
 #include "include/core/SkTypes.h"
+#include "include/encode/SkJpegEncoder.h"
+#include "include/encode/SkPngEncoder.h"
 #include "include/third_party/skcms/skcms.h"
 #include "src/codec/SkCodecImageGenerator.h"
 #include "src/core/SkPixmapPriv.h"
@@ -299,3 +302,123 @@ DEF_TEST(AndroidCodec_sampledOrientation, r) {
         ERRORF(r, "got result \"%s\"\n", SkCodec::ResultToString(result));
     }
 }
+
+// Checks that the interior of a resampled horizontal and vertical ramp is still a ramp, within
+// tolerance, which any normalized, symmetric filter should preserve.
+static void check_resampled_ramp(skiatest::Reporter* r, const char* name, SkAndroidCodec* codec,
+                                 SkISize dims, SkAndroidCodec::ResampleFilter filter,
+                                 int tolerance) {
+    const SkISize srcDims = codec->getInfo().dimensions();
+    SkBitmap bm;
+    bm.allocPixels(SkImageInfo::Make(dims, kRGBA_8888_SkColorType, kPremul_SkAlphaType));
+    auto result = codec->getResampledPixels(bm.info(), bm.getPixels(), bm.rowBytes(), filter);
+    if (result != SkCodec::kSuccess) {
+        ERRORF(r, "%s: resampling to %dx%d failed: %s", name, dims.width(), dims.height(),
+               SkCodec::ResultToString(result));
+        return;
+    }
+
+    const float scaleX = (float)srcDims.width()  / dims.width(),
+                scaleY = (float)srcDims.height() / dims.height();
+    constexpr int kMargin = 4;
+    for (int y = kMargin; y < dims.height() - kMargin; ++y)
+    for (int x = kMargin; x < dims.width()  - kMargin; ++x) {
+        const float srcX = (x + 0.5f) * scaleX - 0.5f,
+                    srcY = (y + 0.5f) * scaleY - 0.5f;
+        const int expectedR = SkScalarRoundToInt(srcX * 255 / (srcDims.width()  - 1)),
+                  expectedG = SkScalarRoundToInt(srcY * 255 / (srcDims.height() - 1));
+        const uint8_t* px = static_cast<const uint8_t*>(bm.getAddr(x, y));
+        if (SkTAbs(px[0] - expectedR) > tolerance || SkTAbs(px[1] - expectedG) > tolerance ||
+                px[3] != 0xFF) {
+            ERRORF(r, "%s at %dx%d: pixel %d, %d is %02x%02x%02x%02x, expected r %02x g %02x",
+                   name, dims.width(), dims.height(), x, y, px[0], px[1], px[2], px[3],
+                   expectedR, expectedG);
+            return;
+        }
+    }
+}
+
+DEF_TEST(AndroidCodec_resample, r) {
+    SkBitmap ramp;
+    ramp.allocPixels(SkImageInfo::Make(1000, 750, kRGBA_8888_SkColorType, kOpaque_SkAlphaType));
+    for (int y = 0; y < ramp.height(); ++y)
+    for (int x = 0; x < ramp.width();  ++x) {
+        uint8_t* px = static_cast<uint8_t*>(ramp.getAddr(x, y));
+        px[0] = SkToU8(SkScalarRoundToInt(x * 255.0f / (ramp.width()  - 1)));
+        px[1] = SkToU8(SkScalarRoundToInt(y * 255.0f / (ramp.height() - 1)));
+        px[2] = 0x80;
+        px[3] = 0xFF;
+    }
+
+    SkDynamicMemoryWStream png;
+    REPORTER_ASSERT(r, SkPngEncoder::Encode(&png, ramp.pixmap(), SkPngEncoder::Options()));
+
+    SkJpegEncoder::Options jpegOptions;
+    jpegOptions.fQuality = 100;
+    jpegOptions.fDownsample = SkJpegEncoder::Downsample::k444;
+    SkDynamicMemoryWStream jpeg;
+    REPORTER_ASSERT(r, SkJpegEncoder::Encode(&jpeg, ramp.pixmap(), jpegOptions));
+
+    struct {
+        const char*   fName;
+        sk_sp<SkData> fData;
+        int           fTolerance;
+    } images[] = {
+        { "png",  png.detachAsData(),  2 },
+        // JPEG starts from a natively scaled decode, which is not exactly a ramp.
+        { "jpeg", jpeg.detachAsData(), 4 },
+    };
+
+    for (const auto& image : images) {
+        auto codec = SkAndroidCodec::MakeFromData(image.fData);
+        if (!codec) {
+            ERRORF(r, "failed to create a codec for %s", image.fName);
+            continue;
+        }
+        for (auto filter : { SkAndroidCodec::ResampleFilter::kMitchell,
+                             SkAndroidCodec::ResampleFilter::kLanczos3 }) {
+            for (SkISize dims : { SkISize{1000, 750}, SkISize{999, 500}, SkISize{300, 225},
+                                  SkISize{123, 97}, SkISize{64, 200} }) {
+                check_resampled_ramp(r, image.fName, codec.get(), dims, filter,
+                                     image.fTolerance);
+            }
+        }
+
+        SkBitmap bm;
+        bm.allocPixels(SkImageInfo::Make(1001, 10, kRGBA_8888_SkColorType, kPremul_SkAlphaType));
+        REPORTER_ASSERT(r, SkCodec::kInvalidScale ==
+                           codec->getResampledPixels(bm.info(), bm.getPixels(), bm.rowBytes()));
+        bm.allocPixels(SkImageInfo::Make(100, 75, kRGB_565_SkColorType, kOpaque_SkAlphaType));
+        REPORTER_ASSERT(r, SkCodec::kInvalidConversion ==
+                           codec->getResampledPixels(bm.info(), bm.getPixels(), bm.rowBytes()));
+
+        // Whatever is missing is filled in, and resampled along with the rest.
+        auto truncated = SkData::MakeSubset(image.fData.get(), 0, image.fData->size() / 2);
+        codec = SkAndroidCodec::MakeFromData(std::move(truncated));
+        bm.allocPixels(SkImageInfo::Make(100, 75, kRGBA_8888_SkColorType, kPremul_SkAlphaType));
+        if (codec) {
+            REPORTER_ASSERT(r, SkCodec::kIncompleteInput ==
+                               codec->getResampledPixels(bm.info(), bm.getPixels(),
+                                                         bm.rowBytes()));
+        }
+    }
+
+    if (GetResourcePath().isEmpty()) {
+        return;
+    }
+
+    // kRightTop_SkEncodedOrigin    = 6, // Rotated 90 CW
+    auto path = "images/orientation/6.jpg";
+    auto androidCodec = SkAndroidCodec::MakeFromCodec(
+            SkCodec::MakeFromData(GetResourceAsData(path)),
+            SkAndroidCodec::ExifOrientationBehavior::kRespect);
+    if (!androidCodec) {
+        ERRORF(r, "failed to create a codec for %s", path);
+        return;
+    }
+    SkBitmap bm;
+    bm.allocPixels(androidCodec->getInfo().makeWH(33, 57));
+    auto result = androidCodec->getResampledPixels(bm.info(), bm.getPixels(), bm.rowBytes());
+    REPORTER_ASSERT(r, result == SkCodec::kSuccess, "got result \"%s\"",
+                    SkCodec::ResultToString(result));
+}
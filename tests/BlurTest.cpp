@@ -31,9 +31,11 @@
 #include "include/effects/SkLayerDrawLooper.h"
 #include "include/effects/SkPerlinNoiseShader.h"
 #include "include/private/SkFloatBits.h"
+#include "include/utils/SkRandom.h"
 #include "src/core/SkBlurMask.h"
 #include "src/core/SkBlurPriv.h"
 #include "src/core/SkMask.h"
+#include "src/core/SkMaskBlurFilter.h"
 #include "src/core/SkMaskFilterBase.h"
 #include "src/core/SkMathPriv.h"
 #include "src/effects/SkEmbossMaskFilter.h"
@@ -702,6 +704,41 @@ DEF_TEST(BlurZeroSigma, reporter) {
     }
 }
 
+extern thread_local bool gSkSerialMaskBlur;
+
+// Masks over 65536 pixels are split across threads, and lines are blurred four at a time when
+// the sums fit; both must match blurring one line at a time on one thread.
+DEF_TEST(BlurMaskSplitMatchesSerial, reporter) {
+    SkRandom rand;
+    for (SkIRect bounds : { SkIRect::MakeWH(37, 23), SkIRect::MakeWH(601, 403) }) {
+        SkMask src;
+        src.fBounds = bounds;
+        src.fRowBytes = bounds.width();
+        src.fFormat = SkMask::kA8_Format;
+        src.fImage = SkMask::AllocImage(src.computeImageSize());
+        SkAutoMaskFreeImage srcFree(src.fImage);
+        for (size_t i = 0; i < src.computeImageSize(); ++i) {
+            src.fImage[i] = (uint8_t)rand.nextU();
+        }
+
+        for (double sigma : { 2.5, 7.0, 100.0 }) {
+            SkMaskBlurFilter filter(sigma, sigma * 0.5);
+            SkMask split, serial;
+            filter.blur(src, &split);
+            SkAutoMaskFreeImage splitFree(split.fImage);
+            gSkSerialMaskBlur = true;
+            filter.blur(src, &serial);
+            gSkSerialMaskBlur = false;
+            SkAutoMaskFreeImage serialFree(serial.fImage);
+
+            REPORTER_ASSERT(reporter, split.fBounds == serial.fBounds);
+            REPORTER_ASSERT(reporter, split.fRowBytes == serial.fRowBytes);
+            REPORTER_ASSERT(reporter, !memcmp(split.fImage, serial.fImage,
+                                              split.computeImageSize()),
+                            "%dx%d, sigma %g", bounds.width(), bounds.height(), sigma);
+        }
+    }
+}
 
 ///////////////////////////////////////////////////////////////////////////////////////////
 
@@ -10,6 +10,7 @@
 #include "include/codec/SkCodecAnimation.h"
 #include "include/core/SkBitmap.h"
 #include "include/core/SkData.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkImage.h"
 #include "include/core/SkImageInfo.h"
 #include "include/core/SkRect.h"
@@ -18,6 +19,7 @@
 #include "include/core/SkString.h"
 #include "include/core/SkTypes.h"
 #include "include/utils/SkAnimCodecPlayer.h"
+#include "include/utils/SkAnimFrameDecoder.h"
 #include "tests/CodecPriv.h"
 #include "tests/Test.h"
 #include "tools/Resources.h"
@@ -496,3 +498,70 @@ DEF_TEST(AnimCodecPlayer, r) {
         REPORTER_ASSERT(r, f1->bounds().size() == test.fSize);
     }
 }
+
+DEF_TEST(AnimFrameDecoder, r) {
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+
+    for (const char* file : { "images/required.gif",
+                              "images/alphabetAnim.gif",
+                              "images/randPixelsAnim.gif",
+                              "images/blendBG.webp",
+                              "images/required.webp",
+                              "images/webp-animated.webp",
+                              "images/randPixels.png" }) {
+        sk_sp<SkData> data(GetResourceAsData(file));
+        if (!data) {
+            continue;
+        }
+
+        // Decode each frame from scratch to compare against.
+        std::unique_ptr<SkCodec> codec = SkCodec::MakeFromData(data);
+        if (!codec) {
+            ERRORF(r, "Failed to create an SkCodec from '%s'", file);
+            continue;
+        }
+        const int frameCount = codec->getFrameCount();
+        std::vector<SkBitmap> expected(frameCount);
+        for (int i = 0; i < frameCount; ++i) {
+            expected[i].allocPixels(codec->getInfo());
+            SkCodec::Options opts;
+            opts.fFrameIndex = i;
+            REPORTER_ASSERT(r, SkCodec::kSuccess == codec->getPixels(expected[i].pixmap(), &opts));
+        }
+
+        // Play through twice, then seek backwards one frame at a time, then skip around.
+        std::vector<int> order;
+        for (int i = 0; i < 2 * frameCount; ++i) {
+            order.push_back(i % frameCount);
+        }
+        for (int i = frameCount - 1; i >= 0; --i) {
+            order.push_back(i);
+        }
+        for (int i = 0; i < frameCount; ++i) {
+            order.push_back((i * 5) % frameCount);
+        }
+
+        for (SkExecutor* exec : { static_cast<SkExecutor*>(nullptr), executor.get() }) {
+            SkAnimFrameDecoder::Options options;
+            options.fExecutor = exec;
+            options.fLookahead = 3;
+            options.fKeyframeInterval = 4;
+            std::unique_ptr<SkAnimFrameDecoder> decoder = SkAnimFrameDecoder::Make(data, options);
+            REPORTER_ASSERT(r, decoder);
+            REPORTER_ASSERT(r, decoder->frameCount() == frameCount);
+
+            for (int i : order) {
+                sk_sp<SkImage> frame = decoder->getFrame(i);
+                SkPixmap pixmap;
+                if (!frame || !frame->peekPixels(&pixmap)) {
+                    ERRORF(r, "%s: could not decode frame %d", file, i);
+                    break;
+                }
+                if (!ToolUtils::equal_pixels(expected[i].pixmap(), pixmap)) {
+                    ERRORF(r, "%s: frame %d does not match", file, i);
+                    break;
+                }
+            }
+        }
+    }
+}
@@ -13,6 +13,7 @@
 #include "include/core/SkColorSpace.h"
 #include "include/core/SkData.h"
 #include "include/core/SkEncodedImageFormat.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkImage.h"
 #include "include/core/SkImageEncoder.h"
 #include "include/core/SkImageGenerator.h"
@@ -961,6 +962,73 @@ DEF_TEST(Codec_wbmp_max_size, r) {
     REPORTER_ASSERT(r, !codec);
 }
 
+extern thread_local int gSkJpegBandedDecodes;
+
+DEF_TEST(Codec_jpeg_restart_bands, r) {
+    // Noise, so that every band has detail in all of its channels right up to its edges.
+    SkBitmap src;
+    src.allocN32Pixels(1200, 900);
+    SkRandom random;
+    for (int y = 0; y < src.height(); y++) {
+        for (int x = 0; x < src.width(); x++) {
+            *src.getAddr32(x, y) = random.nextU() | 0xFF000000;
+        }
+    }
+
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+    for (auto downsample : { SkJpegEncoder::Downsample::k420, SkJpegEncoder::Downsample::k422,
+                             SkJpegEncoder::Downsample::k444 }) {
+        for (int restartRows : { 1, 3 }) {
+            SkJpegEncoder::Options options;
+            options.fQuality = 90;
+            options.fDownsample = downsample;
+            options.fRestartRows = restartRows;
+            SkDynamicMemoryWStream stream;
+            REPORTER_ASSERT(r, SkJpegEncoder::Encode(&stream, src.pixmap(), options));
+            sk_sp<SkData> data = stream.detachAsData();
+
+            std::unique_ptr<SkCodec> codec = SkCodec::MakeFromData(data);
+            REPORTER_ASSERT(r, codec);
+            const SkImageInfo info = codec->getInfo();
+            for (const SkImageInfo& dstInfo : { info.makeColorType(kN32_SkColorType),
+                                                info.makeColorType(kRGB_565_SkColorType),
+                                                info.makeColorType(kRGBA_8888_SkColorType)
+                                                    .makeColorSpace(SkColorSpace::MakeRGB(
+                                                        SkNamedTransferFn::kSRGB,
+                                                        SkNamedGamut::kDCIP3)) }) {
+                SkBitmap serial, banded;
+                serial.allocPixels(dstInfo);
+                banded.allocPixels(dstInfo);
+
+                int bandedDecodes = gSkJpegBandedDecodes;
+                REPORTER_ASSERT(r, SkCodec::kSuccess == codec->getPixels(serial.pixmap()));
+                REPORTER_ASSERT(r, gSkJpegBandedDecodes == bandedDecodes);
+                SkCodec::Options opts;
+                opts.fExecutor = executor.get();
+                REPORTER_ASSERT(r, SkCodec::kSuccess == codec->getPixels(banded.pixmap(), &opts));
+                REPORTER_ASSERT(r, gSkJpegBandedDecodes == bandedDecodes + 1,
+                                "downsample %d, restart rows %d, color type %d",
+                                (int) downsample, restartRows, dstInfo.colorType());
+                REPORTER_ASSERT(r, ToolUtils::equal_pixels(serial, banded),
+                                "downsample %d, restart rows %d, color type %d",
+                                (int) downsample, restartRows, dstInfo.colorType());
+            }
+
+            // Truncated data cannot be decoded in bands, and decodes as far as it can serially.
+            std::unique_ptr<SkCodec> truncated =
+                    SkCodec::MakeFromData(SkData::MakeSubset(data.get(), 0, data->size() / 2));
+            SkBitmap bm;
+            bm.allocPixels(info);
+            SkCodec::Options opts;
+            opts.fExecutor = executor.get();
+            int bandedDecodes = gSkJpegBandedDecodes;
+            REPORTER_ASSERT(r, SkCodec::kIncompleteInput == truncated->getPixels(bm.pixmap(),
+                                                                                 &opts));
+            REPORTER_ASSERT(r, gSkJpegBandedDecodes == bandedDecodes);
+        }
+    }
+}
+
 DEF_TEST(Codec_jpeg_rewind, r) {
     const char* path = "images/mandrill_512_q075.jpg";
     sk_sp<SkData> data(GetResourceAsData(path));
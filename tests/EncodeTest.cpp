@@ -11,6 +11,7 @@
 #include "include/core/SkBitmap.h"
 #include "include/core/SkColorPriv.h"
 #include "include/core/SkEncodedImageFormat.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkImage.h"
 #include "include/core/SkStream.h"
 #include "include/core/SkSurface.h"
@@ -100,6 +101,76 @@ DEF_TEST(Encode, r) {
     test_encode(r, SkEncodedImageFormat::kPNG);
 }
 
+static std::unique_ptr<SkEncoder> make(SkEncodedImageFormat format, SkWStream* dst,
+                                       const SkImageInfo& info) {
+    switch (format) {
+        case SkEncodedImageFormat::kJPEG:
+            return SkJpegEncoder::Make(dst, info, SkJpegEncoder::Options());
+        case SkEncodedImageFormat::kPNG:
+            return SkPngEncoder::Make(dst, info, SkPngEncoder::Options());
+        default:
+            return nullptr;
+    }
+}
+
+static void test_encode_bands(skiatest::Reporter* r, SkEncodedImageFormat format) {
+    SkBitmap bitmap;
+    if (!GetResourceAsBitmap("images/mandrill_128.png", &bitmap)) {
+        return;
+    }
+
+    SkPixmap src;
+    REPORTER_ASSERT(r, bitmap.peekPixels(&src));
+
+    SkDynamicMemoryWStream dst;
+    auto encoder = make(format, &dst, src.info());
+    REPORTER_ASSERT(r, encoder);
+    if (!encoder) {
+        return;
+    }
+
+    // Without pixels, rows must be passed in.
+    REPORTER_ASSERT(r, !encoder->encodeRows(1));
+
+    // Bands that don't match the image are rejected.
+    SkPixmap wrongBand;
+    REPORTER_ASSERT(r, src.extractSubset(&wrongBand, SkIRect::MakeWH(src.width() / 2, 7)));
+    REPORTER_ASSERT(r, !encoder->encodeRows(wrongBand));
+
+    // Feed the image in bands of 7 rows. 128 isn't a multiple of 7, so the last band is trimmed
+    // to the 2 rows that are left.
+    constexpr int kBandHeight = 7;
+    SkBitmap band;
+    band.allocPixels(src.info().makeWH(src.width(), kBandHeight));
+    for (int y = 0; y < src.height(); y += kBandHeight) {
+        int rows = std::min(kBandHeight, src.height() - y);
+        REPORTER_ASSERT(r, src.readPixels(band.pixmap(), 0, y));
+        SkPixmap rowsPixmap;
+        REPORTER_ASSERT(r, band.pixmap().extractSubset(&rowsPixmap,
+                                                       SkIRect::MakeWH(src.width(), rows)));
+        REPORTER_ASSERT(r, encoder->encodeRows(rowsPixmap));
+    }
+
+    sk_sp<SkData> data = dst.detachAsData();
+    if (format == SkEncodedImageFormat::kPNG) {
+        // PNG streams exactly what a whole-image encode would.
+        SkDynamicMemoryWStream whole;
+        REPORTER_ASSERT(r, encode(format, &whole, src));
+        REPORTER_ASSERT(r, whole.detachAsData()->equals(data.get()));
+    }
+
+    sk_sp<SkImage> image = SkImage::MakeFromEncoded(data);
+    REPORTER_ASSERT(r, image);
+    if (image) {
+        REPORTER_ASSERT(r, image->width() == src.width() && image->height() == src.height());
+    }
+}
+
+DEF_TEST(Encode_Bands, r) {
+    test_encode_bands(r, SkEncodedImageFormat::kJPEG);
+    test_encode_bands(r, SkEncodedImageFormat::kPNG);
+}
+
 static inline bool almost_equals(SkPMColor a, SkPMColor b, int tolerance) {
     if (SkTAbs((int)SkGetPackedR32(a) - (int)SkGetPackedR32(b)) > tolerance) {
         return false;
@@ -330,6 +401,38 @@ DEF_TEST(Encode_PngOptions, r) {
     REPORTER_ASSERT(r, almost_equals(bm0, bm2, 0));
 }
 
+DEF_TEST(Encode_PngParallelDeflate, r) {
+    SkBitmap bitmap;
+    if (!GetResourceAsBitmap("images/mandrill_512.png", &bitmap)) {
+        return;
+    }
+
+    SkDynamicMemoryWStream serial;
+    REPORTER_ASSERT(r, SkPngEncoder::Encode(&serial, bitmap.pixmap(), SkPngEncoder::Options()));
+    SkBitmap bm0;
+    SkImage::MakeFromEncoded(serial.detachAsData())->asLegacyBitmap(&bm0);
+
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+    for (auto filters : { SkPngEncoder::FilterFlag::kNone, SkPngEncoder::FilterFlag::kPaeth,
+                          SkPngEncoder::FilterFlag::kAll }) {
+        SkPngEncoder::Options options;
+        options.fFilterFlags = filters;
+        options.fExecutor = executor.get();
+
+        SkDynamicMemoryWStream dst;
+        REPORTER_ASSERT(r, SkPngEncoder::Encode(&dst, bitmap.pixmap(), options));
+
+        sk_sp<SkImage> image = SkImage::MakeFromEncoded(dst.detachAsData());
+        REPORTER_ASSERT(r, image);
+        if (!image) {
+            continue;
+        }
+        SkBitmap bm1;
+        image->asLegacyBitmap(&bm1);
+        REPORTER_ASSERT(r, almost_equals(bm0, bm1, 0));
+    }
+}
+
 #ifndef SK_BUILD_FOR_GOOGLE3
 DEF_TEST(Encode_WebpQuality, r) {
     SkBitmap bm;
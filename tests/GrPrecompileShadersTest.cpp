@@ -0,0 +1,67 @@
+/*
+ * Copyright 2020 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/core/SkExecutor.h"
+#include "include/gpu/GrContext.h"
+#include "src/gpu/GrPersistentCacheUtils.h"
+#include "tests/Test.h"
+#include "tools/gpu/MemoryCache.h"
+
+static constexpr SkFourByteTag kSKSL_Tag = SkSetFourByteTag('S', 'K', 'S', 'L');
+
+static sk_sp<SkData> make_sksl_entry(const char* vs, const char* fs) {
+    SkSL::String shaders[kGrShaderTypeCount];
+    shaders[kVertex_GrShaderType] = vs;
+    shaders[kFragment_GrShaderType] = fs;
+    SkSL::Program::Inputs inputs;
+    SkSL::Program::Settings settings;
+    GrPersistentCacheUtils::ShaderMetadata meta;
+    meta.fSettings = &settings;
+    return GrPersistentCacheUtils::PackCachedShaders(kSKSL_Tag, shaders, &inputs, 1, &meta);
+}
+
+// Translates the entries with a mock context, which stops after the SkSL front end, and returns
+// what ended up in the cache.
+static int precompile(SkExecutor* executor, const sk_sp<SkData> keys[], const sk_sp<SkData> data[],
+                      int count, sk_gpu_test::MemoryCache* cache) {
+    GrContextOptions options;
+    options.fExecutor = executor;
+    options.fPersistentCache = cache;
+    sk_sp<GrContext> context = GrContext::MakeMock(nullptr, options);
+    return context->precompileShaders(keys, data, count);
+}
+
+DEF_GPUTEST(GrPrecompileShaders, reporter, /* options */) {
+    static constexpr int kCount = 64;
+    static const char* kVS = "void main() { sk_Position = float4(1); }";
+    sk_sp<SkData> keys[kCount], data[kCount];
+    for (int i = 0; i < kCount; ++i) {
+        keys[i] = SkData::MakeWithCopy(&i, sizeof(i));
+        // Every eighth entry doesn't compile, and must be left out of the cache.
+        SkString fs = (i % 8 == 7) ? SkStringPrintf("void main() { sk_FragColor = %d; }", i)
+                                   : SkStringPrintf("void main() { sk_FragColor = half4(%d); }",
+                                                    i);
+        data[i] = make_sksl_entry(kVS, fs.c_str());
+    }
+
+    sk_gpu_test::MemoryCache serialCache;
+    int serial = precompile(nullptr, keys, data, kCount, &serialCache);
+    REPORTER_ASSERT(reporter, serial == kCount - kCount / 8);
+
+    for (int threads : {1, 4}) {
+        std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(threads);
+        sk_gpu_test::MemoryCache cache;
+        int stored = precompile(executor.get(), keys, data, kCount, &cache);
+        REPORTER_ASSERT(reporter, stored == serial, "threads: %d", threads);
+        for (int i = 0; i < kCount; ++i) {
+            sk_sp<SkData> expected = serialCache.load(*keys[i]);
+            sk_sp<SkData> actual = cache.load(*keys[i]);
+            REPORTER_ASSERT(reporter, SkToBool(expected) == SkToBool(actual));
+            REPORTER_ASSERT(reporter, !expected || expected->equals(actual.get()));
+        }
+    }
+}
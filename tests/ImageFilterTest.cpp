@@ -18,6 +18,7 @@
 #include "include/effects/SkImageFilters.h"
 #include "include/effects/SkPerlinNoiseShader.h"
 #include "include/effects/SkTableColorFilter.h"
+#include "src/core/SkImageFilterCache.h"
 #include "src/core/SkImageFilter_Base.h"
 #include "src/core/SkReadBuffer.h"
 #include "src/core/SkSpecialImage.h"
@@ -26,6 +27,10 @@
 #include "tools/Resources.h"
 #include "tools/ToolUtils.h"
 
+#include <atomic>
+#include <chrono>
+#include <thread>
+
 #include "include/gpu/GrContext.h"
 #include "src/gpu/GrCaps.h"
 #include "src/gpu/GrContextPriv.h"
@@ -792,6 +797,58 @@ DEF_TEST(ImageFilterDrawTiled, reporter) {
     }
 }
 
+DEF_TEST(ImageFilterTiledSurface, reporter) {
+    // Surfaces that evaluate image filters in tiles must match those that don't. The content
+    // straddles the tile boundaries, and the surface is not a multiple of the tile size.
+    const int width = 1100, height = 600;
+    const SkImageInfo info = SkImageInfo::MakeN32Premul(width, height);
+    const SkSurfaceProps tiledProps(SkSurfaceProps::kTiledImageFilters_Flag,
+                                    kUnknown_SkPixelGeometry);
+    const SkSurfaceProps untiledProps(0, kUnknown_SkPixelGeometry);
+    sk_sp<SkSurface> tiled(SkSurface::MakeRaster(info, &tiledProps)),
+                     untiled(SkSurface::MakeRaster(info, &untiledProps));
+
+    FilterList filters(nullptr);
+
+    SkFont font(ToolUtils::create_portable_typeface(), 64);
+    SkBitmap tiledResult, untiledResult;
+    tiledResult.allocPixels(info);
+    untiledResult.allocPixels(info);
+
+    auto check = [&](const char* name, sk_sp<SkImageFilter> filter) {
+        SkPaint paint;
+        paint.setColor(SK_ColorWHITE);
+        paint.setImageFilter(std::move(filter));
+
+        for (SkSurface* surface : {tiled.get(), untiled.get()}) {
+            SkCanvas* canvas = surface->getCanvas();
+            canvas->clear(SK_ColorTRANSPARENT);
+            canvas->save();
+            canvas->translate(460, 480);
+            canvas->scale(2, 2);
+            canvas->drawString("ABC", 0, 32, font, paint);
+            canvas->restore();
+        }
+
+        tiled->readPixels(tiledResult, 0, 0);
+        untiled->readPixels(untiledResult, 0, 0);
+        if (!ToolUtils::equal_pixels(untiledResult, tiledResult)) {
+            REPORTER_ASSERT(reporter, false, name);
+        }
+    };
+
+    for (int i = 0; i < filters.count(); ++i) {
+        check(filters.getName(i), sk_ref_sp(filters.getFilter(i)));
+    }
+
+    // The FilterList lights a flat surface; a bumpy one makes normals depend on the neighbors.
+    const SkPoint3 location = SkPoint3::Make(0, 0, 32);
+    check("diffuse lighting with surface scale",
+          SkImageFilters::PointLitDiffuse(location, SK_ColorGREEN, 2, 1, nullptr));
+    check("specular lighting with surface scale",
+          SkImageFilters::PointLitSpecular(location, SK_ColorGREEN, 2, 1, 4, nullptr));
+}
+
 static void draw_saveLayer_picture(int width, int height, int tileSize,
                                    SkBBHFactory* factory, SkBitmap* result) {
 
@@ -1007,6 +1064,101 @@ DEF_GPUTEST_FOR_RENDERING_CONTEXTS(ImageFilterMergeResultSize_Gpu, reporter, ctx
     test_imagefilter_merge_result_size(reporter, ctxInfo.grContext());
 }
 
+DEF_TEST(ImageFilterMergePrefilteredInputs, reporter) {
+    // Merge evaluates its distinct inputs up front into the cache; the result must match the
+    // one computed input by input without a cache.
+    SkBitmap bitmap;
+    bitmap.allocN32Pixels(64, 64);
+    bitmap.eraseColor(SK_ColorTRANSPARENT);
+    bitmap.erase(SK_ColorRED, SkIRect::MakeXYWH(16, 16, 32, 32));
+    sk_sp<SkSpecialImage> srcImg(SkSpecialImage::MakeFromRaster(SkIRect::MakeWH(64, 64), bitmap));
+
+    sk_sp<SkImageFilter> blur(SkImageFilters::Blur(2, 2, nullptr));
+    sk_sp<SkImageFilter> inputs[] = {
+        blur,
+        SkImageFilters::Blur(6, 1, nullptr),
+        SkImageFilters::Offset(3, 5, blur),
+        blur,
+    };
+    sk_sp<SkImageFilter> merge(SkImageFilters::Merge(inputs, SK_ARRAY_COUNT(inputs)));
+
+    auto filter = [&](SkImageFilterCache* cache, SkBitmap* result) {
+        SkImageFilter_Base::Context ctx(SkMatrix::I(), SkIRect::MakeWH(64, 64), cache,
+                                        kN32_SkColorType, nullptr, srcImg.get());
+        SkIPoint offset;
+        sk_sp<SkSpecialImage> image(as_IFB(merge)->filterImage(ctx).imageAndOffset(&offset));
+        return image && image->getROPixels(result);
+    };
+
+    sk_sp<SkImageFilterCache> cache(SkImageFilterCache::Create(1024 * 1024));
+    SkBitmap uncached, cached;
+    REPORTER_ASSERT(reporter, filter(nullptr, &uncached));
+    REPORTER_ASSERT(reporter, filter(cache.get(), &cached));
+    // Merge, its three distinct inputs, and the blur under the offset, which sees a different clip.
+    SkDEBUGCODE(REPORTER_ASSERT(reporter, 5 == cache->count());)
+
+    REPORTER_ASSERT(reporter, uncached.dimensions() == cached.dimensions());
+    for (int y = 0; y < cached.height(); ++y) {
+        REPORTER_ASSERT(reporter, !memcmp(uncached.getAddr32(0, y), cached.getAddr32(0, y),
+                                          cached.width() * sizeof(uint32_t)));
+    }
+}
+
+// Passes its source through and counts how many times it has been computed. It takes a moment, so
+// that inputs evaluated concurrently get to it while it is still being computed.
+class CountingImageFilter : public SkImageFilter_Base {
+public:
+    CountingImageFilter() : INHERITED(nullptr, 0, nullptr) {}
+
+    int count() const { return fCount.load(); }
+
+private:
+    Factory getFactory() const override { return nullptr; }
+    const char* getTypeName() const override { return nullptr; }
+
+    sk_sp<SkSpecialImage> onFilterImage(const Context& ctx, SkIPoint* offset) const override {
+        fCount++;
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        offset->fX = offset->fY = 0;
+        return sk_ref_sp<SkSpecialImage>(ctx.sourceImage());
+    }
+
+    mutable std::atomic<int> fCount{0};
+
+    typedef SkImageFilter_Base INHERITED;
+};
+
+DEF_TEST(ImageFilterSharedNodeComputedOnce, reporter) {
+    // One node is shared by several inputs of merges, some of which are evaluated concurrently.
+    // With a cache, it must only be computed once however the inputs are scheduled.
+    SkBitmap bitmap;
+    bitmap.allocN32Pixels(64, 64);
+    bitmap.eraseColor(SK_ColorRED);
+    sk_sp<SkSpecialImage> srcImg(SkSpecialImage::MakeFromRaster(SkIRect::MakeWH(64, 64), bitmap));
+
+    for (int i = 0; i < 8; ++i) {
+        sk_sp<CountingImageFilter> shared(new CountingImageFilter);
+        auto tint = [&](SkColor color) {
+            return SkImageFilters::ColorFilter(
+                    SkColorFilters::Blend(color, SkBlendMode::kModulate), shared);
+        };
+        sk_sp<SkImageFilter> inner[] = { tint(SK_ColorGREEN), shared };
+        sk_sp<SkImageFilter> inputs[] = {
+            tint(SK_ColorWHITE),
+            tint(SK_ColorBLUE),
+            SkImageFilters::Merge(inner, SK_ARRAY_COUNT(inner)),
+        };
+        sk_sp<SkImageFilter> merge(SkImageFilters::Merge(inputs, SK_ARRAY_COUNT(inputs)));
+
+        sk_sp<SkImageFilterCache> cache(SkImageFilterCache::Create(1024 * 1024));
+        SkImageFilter_Base::Context ctx(SkMatrix::I(), SkIRect::MakeWH(64, 64), cache.get(),
+                                        kN32_SkColorType, nullptr, srcImg.get());
+        SkIPoint offset;
+        REPORTER_ASSERT(reporter, as_IFB(merge)->filterImage(ctx).imageAndOffset(&offset));
+        REPORTER_ASSERT(reporter, 1 == shared->count(), "computed %d times", shared->count());
+    }
+}
+
 static void draw_blurred_rect(SkCanvas* canvas) {
     SkPaint filterPaint;
     filterPaint.setColor(SK_ColorWHITE);
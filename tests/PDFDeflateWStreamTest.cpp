@@ -9,9 +9,10 @@
 
 #ifdef SK_SUPPORT_PDF
 
+#include "include/core/SkExecutor.h"
 #include "include/private/SkTo.h"
 #include "include/utils/SkRandom.h"
-#include "src/pdf/SkDeflate.h"
+#include "src/utils/SkDeflate.h"
 
 namespace {
 
@@ -45,9 +46,10 @@ std::unique_ptr<SkStreamAsset> stream_inflate(skiatest::Reporter* reporter, SkSt
     flateData.next_out = outputBuffer;
     flateData.avail_out = kBufferSize;
     int rc;
-    rc = inflateInit(&flateData);
+    // A 32K window, accepting either a zlib or a gzip header.
+    rc = inflateInit2(&flateData, 15 + 32);
     if (rc != Z_OK) {
-        ERRORF(reporter, "Zlib: inflateInit failed");
+        ERRORF(reporter, "Zlib: inflateInit2 failed");
         return nullptr;
     }
     uint8_t* input = (uint8_t*)src->getMemoryBase();
@@ -167,4 +169,86 @@ DEF_TEST(SkPDF_DeflateWStream, r) {
     REPORTER_ASSERT(r, !emptyDeflateWStream.writeText("FOO"));
 }
 
+DEF_TEST(SkPDF_DeflateWStream_Parallel, r) {
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+    SkRandom random(654321);
+    // Sizes around and across the 128K block size.
+    for (uint32_t size : { 0u, 100u, 131072u, 131073u, 600000u }) {
+        // Compressible, so that blocks make use of their dictionaries.
+        SkAutoTMalloc<uint8_t> buffer(size);
+        for (uint32_t j = 0; j < size; ++j) {
+            buffer[j] = (random.nextU() % 8) * 16;
+        }
+
+        for (int level : { -1, 0, 9 }) {
+            for (int maxBlocksInFlight : { 0, 1 }) {
+                SkDynamicMemoryWStream dynamicMemoryWStream;
+                {
+                    SkDeflateWStream deflateWStream(&dynamicMemoryWStream, level, false,
+                                                    executor.get(), maxBlocksInFlight);
+                    uint32_t j = 0;
+                    while (j < size) {
+                        uint32_t writeSize = std::min(size - j, random.nextRangeU(1, 50000));
+                        REPORTER_ASSERT(r, deflateWStream.write(&buffer[j], writeSize));
+                        j += writeSize;
+                    }
+                    REPORTER_ASSERT(r, deflateWStream.bytesWritten() == size);
+                }
+                std::unique_ptr<SkStreamAsset> compressed(dynamicMemoryWStream.detachAsStream());
+                std::unique_ptr<SkStreamAsset> decompressed(stream_inflate(r, compressed.get()));
+                if (!decompressed) {
+                    ERRORF(r, "Decompression failed.");
+                    return;
+                }
+                sk_sp<SkData> data = SkData::MakeFromStream(decompressed.get(),
+                                                            decompressed->getLength());
+                REPORTER_ASSERT(r, data->size() == size);
+                REPORTER_ASSERT(r, data->size() != size || size == 0 ||
+                                   0 == memcmp(data->data(), buffer.get(), size));
+            }
+        }
+    }
+}
+
+DEF_TEST(SkPDF_DeflateWStream_Gzip, r) {
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+    SkRandom random(135791);
+    for (uint32_t size : { 0u, 100u, 131073u, 300000u }) {
+        SkAutoTMalloc<uint8_t> buffer(size);
+        for (uint32_t j = 0; j < size; ++j) {
+            buffer[j] = (random.nextU() % 8) * 16;
+        }
+
+        // Serially through zlib, then with our own header and trailer around parallel blocks.
+        for (SkExecutor* e : { (SkExecutor*)nullptr, executor.get() }) {
+            SkDynamicMemoryWStream dynamicMemoryWStream;
+            {
+                SkDeflateWStream deflateWStream(&dynamicMemoryWStream, -1, true, e);
+                uint32_t j = 0;
+                while (j < size) {
+                    uint32_t writeSize = std::min(size - j, random.nextRangeU(1, 50000));
+                    REPORTER_ASSERT(r, deflateWStream.write(&buffer[j], writeSize));
+                    j += writeSize;
+                }
+                REPORTER_ASSERT(r, deflateWStream.bytesWritten() == size);
+            }
+            sk_sp<SkData> compressed = dynamicMemoryWStream.detachAsData();
+            const uint8_t* bytes = compressed->bytes();
+            REPORTER_ASSERT(r, compressed->size() > 2 && bytes[0] == 0x1f && bytes[1] == 0x8b);
+
+            SkMemoryStream compressedStream(compressed);
+            std::unique_ptr<SkStreamAsset> decompressed(stream_inflate(r, &compressedStream));
+            if (!decompressed) {
+                ERRORF(r, "Decompression failed.");
+                return;
+            }
+            sk_sp<SkData> data = SkData::MakeFromStream(decompressed.get(),
+                                                        decompressed->getLength());
+            REPORTER_ASSERT(r, data->size() == size);
+            REPORTER_ASSERT(r, data->size() != size || size == 0 ||
+                               0 == memcmp(data->data(), buffer.get(), size));
+        }
+    }
+}
+
 #endif
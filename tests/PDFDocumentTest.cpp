@@ -6,10 +6,13 @@
  */
 #include "tests/Test.h"
 
+#include "include/core/SkBitmap.h"
 #include "include/core/SkCanvas.h"
 #include "include/core/SkExecutor.h"
+#include "include/core/SkImage.h"
 #include "include/core/SkStream.h"
 #include "include/docs/SkPDFDocument.h"
+#include "include/utils/SkRandom.h"
 #include "src/core/SkOSFile.h"
 #include "src/utils/SkOSPath.h"
 #include "tools/Resources.h"
@@ -239,6 +242,54 @@ DEF_TEST(SkPDF_multiple_pages, r) {
     }
 }
 
+static sk_sp<SkData> make_multipage_pdf(SkExecutor* executor) {
+    SkBitmap bm;
+    bm.allocN32Pixels(64, 64);
+    SkPDF::Metadata metadata;
+    metadata.fExecutor = executor;
+    SkDynamicMemoryWStream stream;
+    auto doc = SkPDF::MakeDocument(&stream, metadata);
+    for (int i = 0; i < 20; ++i) {
+        SkCanvas* canvas = doc->beginPage(612, 792);
+        canvas->drawColor(SkColorSetARGB(0xFF, 0x00, (uint8_t)(i * 12), 0x00));
+        // Half the pages get an image with a soft mask, half an opaque one.
+        bm.eraseColor(SkColorSetARGB(i % 2 ? 0x80 : 0xFF, (uint8_t)(i * 12), 0x00, 0x00));
+        canvas->drawImage(SkImage::MakeFromBitmap(bm), 10, 10);
+        for (int j = 0; j < 50; ++j) {
+            canvas->drawRect(SkRect::MakeXYWH(j * 10, i * 10, 8, 8), SkPaint());
+        }
+        doc->endPage();
+    }
+    // An image and a content stream that are both larger than a block of the block deflater.
+    SkBitmap noise;
+    noise.allocN32Pixels(256, 256);
+    SkRandom rand;
+    for (int y = 0; y < noise.height(); ++y) {
+        for (int x = 0; x < noise.width(); ++x) {
+            *noise.getAddr32(x, y) = rand.nextU() | 0xFF000000;
+        }
+    }
+    SkCanvas* canvas = doc->beginPage(612, 792);
+    canvas->drawImage(SkImage::MakeFromBitmap(noise), 0, 0);
+    for (int j = 0; j < 8000; ++j) {
+        canvas->drawRect(SkRect::MakeXYWH(rand.nextRangeF(0, 600), rand.nextRangeF(0, 780), 8, 8),
+                         SkPaint());
+    }
+    doc->endPage();
+    doc->close();
+    return stream.detachAsData();
+}
+
+DEF_TEST(SkPDF_executor_reproducible, r) {
+    REQUIRE_PDF_DOCUMENT(SkPDF_executor_reproducible, r);
+    sk_sp<SkData> serial = make_multipage_pdf(nullptr);
+    for (int threads : {1, 4}) {
+        std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(threads);
+        sk_sp<SkData> parallel = make_multipage_pdf(executor.get());
+        REPORTER_ASSERT(r, serial->equals(parallel.get()), "threads: %d", threads);
+    }
+}
+
 // Test to make sure that jobs launched by PDF backend don't cause a segfault
 // after calling abort().
 DEF_TEST(SkPDF_abort_jobs, rep) {
@@ -0,0 +1,85 @@
+/*
+ * Copyright 2020 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/core/SkBBHFactory.h"
+#include "include/core/SkBitmap.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkExecutor.h"
+#include "include/core/SkPictureRecorder.h"
+#include "include/core/SkRRect.h"
+#include "src/core/SkParallelPlayback.h"
+#include "tests/Test.h"
+
+static sk_sp<SkPicture> make_picture(SkBBHFactory* factory) {
+    SkPictureRecorder recorder;
+    SkCanvas* canvas = recorder.beginRecording(SkRect::MakeWH(300, 300), factory);
+
+    SkPaint paint;
+    paint.setAntiAlias(true);
+
+    // Small AA draws scattered over (and straddling) many tiles, leaving some tiles empty.
+    for (int i = 0; i < 30; ++i) {
+        paint.setColor(SkColorSetARGB(0xC0, (i * 37) & 0xFF, (i * 91) & 0xFF, (i * 13) & 0xFF));
+        canvas->drawRect(SkRect::MakeXYWH(i * 7.3f, i * 4.7f, 30.5f, 17.25f), paint);
+        canvas->drawCircle(280 - i * 3.1f, 15 + i * 9.2f, 7.5f, paint);
+    }
+
+    // Nested save/clip/concat state that must be replayed in every tile it touches.
+    canvas->save();
+    canvas->clipRect(SkRect::MakeLTRB(40, 150, 260, 290), true);
+    canvas->rotate(23, 150, 220);
+    paint.setStyle(SkPaint::kStroke_Style);
+    paint.setStrokeWidth(4.5f);
+    paint.setColor(SK_ColorBLUE);
+    canvas->drawRRect(SkRRect::MakeRectXY(SkRect::MakeLTRB(60, 160, 240, 280), 20, 30), paint);
+    canvas->restore();
+
+    canvas->saveLayerAlpha(nullptr, 0x80);
+    paint.setStyle(SkPaint::kFill_Style);
+    paint.setColor(SK_ColorGREEN);
+    canvas->drawOval(SkRect::MakeLTRB(120, 30, 290, 130), paint);
+    canvas->restore();
+
+    return recorder.finishRecordingAsPicture();
+}
+
+DEF_TEST(ParallelPlayback, reporter) {
+    const SkImageInfo info = SkImageInfo::MakeN32Premul(256, 256);
+    const SkMatrix matrix = SkMatrix::Concat(SkMatrix::MakeTrans(-10.5f, 3),
+                                             SkMatrix::MakeScale(0.9f, 0.8f));
+
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+
+    SkRTreeFactory factory;
+    for (SkBBHFactory* bbh : {(SkBBHFactory*)nullptr, (SkBBHFactory*)&factory}) {
+        sk_sp<SkPicture> picture = make_picture(bbh);
+
+        SkBitmap expected;
+        expected.allocPixels(info);
+        expected.eraseColor(SK_ColorWHITE);
+        {
+            SkCanvas canvas(expected);
+            canvas.drawPicture(picture, &matrix, nullptr);
+        }
+
+        for (SkISize tileSize : {SkISize{256, 256}, SkISize{64, 64}, SkISize{37, 91}}) {
+            SkBitmap actual;
+            actual.allocPixels(info);
+            actual.eraseColor(SK_ColorWHITE);
+            SkParallelPlayback(picture.get(), actual.pixmap(), matrix, tileSize, executor.get());
+
+            for (int y = 0; y < info.height(); ++y) {
+                if (0 != memcmp(expected.getAddr(0, y), actual.getAddr(0, y),
+                                info.minRowBytes())) {
+                    ERRORF(reporter, "%s bbh, %dx%d tiles: row %d differs from drawPicture()",
+                           bbh ? "with" : "without", tileSize.width(), tileSize.height(), y);
+                    break;
+                }
+            }
+        }
+    }
+}
@@ -6,6 +6,9 @@
  */
 
 #include "include/core/SkBitmap.h"
+#include "include/core/SkExecutor.h"
+#include "include/utils/SkRandom.h"
+#include "src/pathops/SkPathOpsCommon.h"
 #include "tests/PathOpsExtendedTest.h"
 #include "tests/PathOpsTestCommon.h"
 #include "tests/Test.h"
@@ -361,3 +364,74 @@ SkOpBuilder builder;
     builder.add(path1, SkPathOp::kUnion_SkPathOp);
     builder.resolve(&path);
 }
+
+static SkPath random_polygon(SkRandom* rand) {
+    SkScalar cx = rand->nextRangeScalar(0, 200);
+    SkScalar cy = rand->nextRangeScalar(0, 200);
+    int sides = 3 + rand->nextULessThan(5);
+    SkPath path;
+    for (int i = 0; i < sides; ++i) {
+        SkScalar angle = SK_ScalarPI * 2 * i / sides;
+        SkScalar radius = rand->nextRangeScalar(5, 30);
+        SkPoint pt = {cx + radius * SkScalarCos(angle), cy + radius * SkScalarSin(angle)};
+        if (!i) {
+            path.moveTo(pt);
+        } else {
+            path.lineTo(pt);
+        }
+    }
+    path.close();
+    return path;
+}
+
+// Work spread over an executor must not change the result, whatever the number of threads.
+DEF_TEST(SkOpBuilderExecutor, reporter) {
+    std::unique_ptr<SkExecutor> executors[] = {
+        SkExecutor::MakeFIFOThreadPool(1),
+        SkExecutor::MakeFIFOThreadPool(4),
+    };
+    for (int seed = 0; seed < 4; ++seed) {
+        SkRandom rand(seed);
+        SkTArray<SkPath> paths, rects;
+        SkPath all;
+        for (int i = 0; i < 40; ++i) {
+            paths.push_back(random_polygon(&rand));
+            all.addPath(paths.back());
+            SkScalar x = rand.nextRangeScalar(0, 200), y = rand.nextRangeScalar(0, 200);
+            rects.push_back().addRect({x, y, x + rand.nextRangeScalar(5, 30),
+                                             y + rand.nextRangeScalar(5, 30)});
+        }
+        SkPath simplified;
+        bool simplifyOK = Simplify(all, &simplified);
+        SkPath opped;
+        bool opOK = Op(paths[0], all, kXOR_SkPathOp, &opped);
+        // Convex rects take the all-union path of resolve(); the polygons do not.
+        enum { kRects, kPolygons, kMixed };
+        for (int mode : {kRects, kPolygons, kMixed}) {
+            const SkTArray<SkPath>& operands = kRects == mode ? rects : paths;
+            auto add = [&](SkOpBuilder* builder) {
+                for (int i = 0; i < operands.count(); ++i) {
+                    builder->add(operands[i], kMixed == mode && i % 7 == 3 ? kDifference_SkPathOp
+                                                                           : kUnion_SkPathOp);
+                }
+            };
+            SkOpBuilder builder;
+            add(&builder);
+            SkPath serial;
+            bool serialOK = builder.resolve(&serial);
+            for (auto& executor : executors) {
+                SkPath result;
+                REPORTER_ASSERT(reporter, simplifyOK ==
+                        SimplifyWithExecutor(all, &result, executor.get()));
+                REPORTER_ASSERT(reporter, result == simplified);
+                REPORTER_ASSERT(reporter, opOK ==
+                        OpWithExecutor(paths[0], all, kXOR_SkPathOp, &result, executor.get()));
+                REPORTER_ASSERT(reporter, result == opped);
+
+                add(&builder);
+                REPORTER_ASSERT(reporter, serialOK == builder.resolve(&result, executor.get()));
+                REPORTER_ASSERT(reporter, result == serial);
+            }
+        }
+    }
+}
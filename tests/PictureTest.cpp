@@ -12,6 +12,7 @@
 #include "include/core/SkColor.h"
 #include "include/core/SkData.h"
 #include "include/core/SkFontStyle.h"
+#include "include/core/SkImage.h"
 #include "include/core/SkImageInfo.h"
 #include "include/core/SkMatrix.h"
 #include "include/core/SkPaint.h"
@@ -25,6 +26,7 @@
 #include "include/core/SkStream.h"
 #include "include/core/SkTypeface.h"
 #include "include/core/SkTypes.h"
+#include "include/utils/SkNoDrawCanvas.h"
 #include "include/utils/SkRandom.h"
 #include "src/core/SkBigPicture.h"
 #include "src/core/SkClipOpPriv.h"
@@ -32,6 +34,7 @@
 #include "src/core/SkPicturePriv.h"
 #include "src/core/SkRectPriv.h"
 #include "tests/Test.h"
+#include "tools/ToolUtils.h"
 
 #include <memory>
 
@@ -870,6 +873,141 @@ DEF_TEST(Picture_empty_serial, reporter) {
     REPORTER_ASSERT(reporter, pic2);
 }
 
+DEF_TEST(Picture_MakeFromData_SharesPayloads, r) {
+    SkBitmap bm;
+    make_bm(&bm, 16, 16, SK_ColorBLUE, true);
+    bm.eraseArea(SkIRect::MakeWH(8, 8), SK_ColorRED);
+    sk_sp<SkImage> image = SkImage::MakeFromEncoded(
+            SkImage::MakeFromBitmap(bm)->encodeToData(SkEncodedImageFormat::kPNG, 100));
+    REPORTER_ASSERT(r, image);
+
+    // A nested picture makes sure the payloads of sub-pictures are shared too.
+    SkPictureRecorder rec;
+    SkCanvas* canvas = rec.beginRecording(32, 32);
+    canvas->drawImage(image, 16, 16);
+    canvas->drawRect({0, 16, 16, 32}, SkPaint{});
+    sk_sp<SkPicture> inner = rec.finishRecordingAsPicture();
+    canvas = rec.beginRecording(32, 32);
+    canvas->drawImage(image, 0, 0);
+    canvas->drawRect({16, 0, 32, 16}, SkPaint{});
+    canvas->drawPicture(inner);
+    sk_sp<SkPicture> pic = rec.finishRecordingAsPicture();
+
+    auto draw = [](const SkPicture* p) {
+        SkBitmap dst;
+        make_bm(&dst, 32, 32, SK_ColorTRANSPARENT, false);
+        SkCanvas(dst).drawPicture(p);
+        return dst;
+    };
+
+    // Collects the encoded data of every image a picture draws.
+    struct EncodedDataCanvas : public SkNoDrawCanvas {
+        EncodedDataCanvas() : SkNoDrawCanvas(32, 32) {}
+        void onDrawImage(const SkImage* img, SkScalar, SkScalar, const SkPaint*) override {
+            fEncoded.push_back(img->refEncodedData());
+        }
+        void onDrawPicture(const SkPicture* p, const SkMatrix* m, const SkPaint* paint) override {
+            this->SkCanvas::onDrawPicture(p, m, paint);
+        }
+        std::vector<sk_sp<SkData>> fEncoded;
+    };
+
+    sk_sp<SkData> data = pic->serialize();
+    // Copying the serialized picture one byte into a larger buffer misaligns all its payloads,
+    // which we must handle by copying them instead.
+    sk_sp<SkData> big = SkData::MakeUninitialized(data->size() + 1);
+    memcpy((char*)big->writable_data() + 1, data->data(), data->size());
+    sk_sp<SkData> misaligned = SkData::MakeSubset(big.get(), 1, data->size());
+
+    for (const SkData* src : {data.get(), misaligned.get()}) {
+        sk_sp<SkPicture> loaded = SkPicture::MakeFromData(src);
+        REPORTER_ASSERT(r, loaded);
+        if (!loaded) {
+            continue;
+        }
+        REPORTER_ASSERT(r, ToolUtils::equal_pixels(draw(pic.get()), draw(loaded.get())));
+
+        EncodedDataCanvas images;
+        loaded->playback(&images);
+        REPORTER_ASSERT(r, images.fEncoded.size() == 2);
+        for (const sk_sp<SkData>& encoded : images.fEncoded) {
+            REPORTER_ASSERT(r, encoded);
+            if (!encoded) {
+                continue;
+            }
+            const char* base = (const char*)src->data();
+            const char* ptr  = (const char*)encoded->data();
+            bool inSrc = base <= ptr && ptr + encoded->size() <= base + src->size();
+            REPORTER_ASSERT(r, inSrc == (src == data.get()));
+        }
+    }
+}
+
+DEF_TEST(Picture_MakeFromData_Region, r) {
+    // A grid of 16x16 cells, each drawn with some state changes around it.
+    auto record = [](SkBBHFactory* factory) {
+        SkPictureRecorder rec;
+        SkCanvas* canvas = rec.beginRecording(256, 256, factory);
+        SkRandom rand;
+        for (int y = 0; y < 16; y++)
+        for (int x = 0; x < 16; x++) {
+            SkPaint paint;
+            paint.setColor(rand.nextU() | 0xff000000);
+            canvas->save();
+                canvas->translate(16*x, 16*y);
+                canvas->clipRect({2, 2, 14, 14});
+                canvas->drawRect({0, 0, 16, 16}, paint);
+                canvas->drawCircle(8, 8, 4, SkPaint{});
+            canvas->restore();
+        }
+        return rec.finishRecordingAsPicture();
+    };
+
+    auto draw = [](const SkPicture* pic, const SkRect& clip) {
+        SkBitmap dst;
+        make_bm(&dst, 256, 256, SK_ColorTRANSPARENT, false);
+        SkCanvas canvas(dst);
+        canvas.clipRect(clip);
+        canvas.drawPicture(pic);
+        return dst;
+    };
+
+    const SkRect regions[] = {
+        {  0,   0, 256, 256},
+        { 40,  40,  72,  72},
+        {100, 200, 101, 201},
+        {300, 300, 400, 400},
+    };
+
+    SkRTreeFactory factory;
+    for (SkBBHFactory* f : {(SkBBHFactory*)&factory, (SkBBHFactory*)nullptr}) {
+        sk_sp<SkPicture> pic = record(f);
+        sk_sp<SkData> data = pic->serialize();
+
+        for (const SkRect& region : regions) {
+            sk_sp<SkPicture> part = SkPicture::MakeFromData(data.get(), region);
+            REPORTER_ASSERT(r, part);
+            if (!part) {
+                continue;
+            }
+            REPORTER_ASSERT(r, region.contains(part->cullRect()) || part->cullRect().isEmpty());
+            REPORTER_ASSERT(r, ToolUtils::equal_pixels(draw(pic.get(), region),
+                                                       draw(part.get(), region)));
+
+            // With a BBH, we should load only the cells that touch the region.
+            if (f) {
+                SkIRect cells = region.roundOut();
+                int touched = 0;
+                for (int y = 0; y < 16; y++)
+                for (int x = 0; x < 16; x++) {
+                    touched += SkIRect::Intersects(cells, SkIRect::MakeXYWH(16*x, 16*y, 16, 16));
+                }
+                REPORTER_ASSERT(r, part->approximateOpCount() <= 6 * touched,
+                                "%d ops for %d cells", part->approximateOpCount(), touched);
+            }
+        }
+    }
+}
 
 DEF_TEST(Picture_drawsNothing, r) {
     // Tests that pic->cullRect().isEmpty() is a good way to test a picture
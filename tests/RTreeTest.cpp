@@ -45,11 +45,20 @@ static bool verify_query(SkRect query, SkRect rects[], const std::vector<int>& f
 
 static void run_queries(skiatest::Reporter* reporter, SkRandom& rand, SkRect rects[],
                         const SkRTree& tree) {
+    SkRect queries[NUM_QUERIES];
     for (size_t i = 0; i < NUM_QUERIES; ++i) {
         std::vector<int> hits;
-        SkRect query = random_rect(rand);
-        tree.search(query, &hits);
-        REPORTER_ASSERT(reporter, verify_query(query, rects, hits));
+        queries[i] = random_rect(rand);
+        tree.search(queries[i], &hits);
+        REPORTER_ASSERT(reporter, verify_query(queries[i], rects, hits));
+    }
+
+    // Batched queries should find exactly what individual queries do, in the same order.
+    queries[0] = SkRect::MakeEmpty();
+    std::vector<int> batchHits[NUM_QUERIES];
+    tree.search(queries, NUM_QUERIES, batchHits);
+    for (size_t i = 0; i < NUM_QUERIES; ++i) {
+        REPORTER_ASSERT(reporter, verify_query(queries[i], rects, batchHits[i]));
     }
 }
 
@@ -13,6 +13,7 @@
 #include "src/core/SkBitmapCache.h"
 #include "src/core/SkMipMap.h"
 #include "src/core/SkResourceCache.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/image/SkImage_Base.h"
 #include "src/lazy/SkDiscardableMemoryPool.h"
 #include "tests/Test.h"
@@ -288,3 +289,89 @@ DEF_TEST(ResourceCache_purge, reporter) {
         }
     }
 }
+
+struct ValueRec : SkResourceCache::Rec {
+    TestKey fKey;
+    bool    fStale = false;
+
+    ValueRec(int sharedID, int32_t data) : fKey(sharedID, data) {}
+
+    const Key& getKey() const override { return fKey; }
+    size_t bytesUsed() const override { return 1024; }
+    const char* getCategory() const override { return "test-category"; }
+
+    static bool Visitor(const SkResourceCache::Rec& baseRec, void* context) {
+        const ValueRec& rec = static_cast<const ValueRec&>(baseRec);
+        if (rec.fStale) {
+            return false;
+        }
+        *(int32_t*)context = rec.fKey.fData;
+        return true;
+    }
+};
+
+/*
+ *  Hits through findShared() don't move a Rec in the LRU, but should still save it from purging.
+ */
+DEF_TEST(ResourceCache_findShared, reporter) {
+    SkResourceCache cache(4 * 1024 + 512);
+    ValueRec* staleRec = new ValueRec(0, 3);
+    staleRec->fStale = true;
+    for (int i = 0; i < 3; i++) {
+        cache.add(new ValueRec(0, i));
+    }
+    cache.add(staleRec);
+
+    int32_t value = -1;
+    SkResourceCache::ID stale;
+    REPORTER_ASSERT(reporter, cache.findShared(TestKey(0, 0), ValueRec::Visitor, &value, &stale));
+    REPORTER_ASSERT(reporter, value == 0 && !stale);
+
+    REPORTER_ASSERT(reporter, !cache.findShared(TestKey(0, 3), ValueRec::Visitor, &value, &stale));
+    REPORTER_ASSERT(reporter, stale == staleRec);
+    cache.purgeStale(TestKey(0, 3), stale);
+    REPORTER_ASSERT(reporter, cache.getTotalBytesUsed() == 3 * 1024);
+
+    // Going over budget purges 1, the least recently used, rather than 0.
+    cache.add(new ValueRec(0, 4));
+    cache.add(new ValueRec(0, 5));
+    REPORTER_ASSERT(reporter, cache.find(TestKey(0, 0), ValueRec::Visitor, &value));
+    REPORTER_ASSERT(reporter, !cache.find(TestKey(0, 1), ValueRec::Visitor, &value));
+}
+
+DEF_TEST(ResourceCache_sharded, reporter) {
+    for (int shardCount : { 1, 4 }) {
+        SkShardedResourceCache cache(shardCount, 256 * 1024);
+        REPORTER_ASSERT(reporter, cache.getTotalByteLimit() == 256 * 1024);
+
+        std::atomic<int> wrongValues{0};
+        SkTaskGroup().batch(8, [&](int thread) {
+            for (int i = 0; i < 2000; i++) {
+                int32_t data = (i * 7 + thread) % 500;
+                int sharedID = 1 + data % 8;
+                int32_t value = -1;
+                if (cache.find(TestKey(sharedID, data), ValueRec::Visitor, &value)) {
+                    if (value != data) {
+                        wrongValues++;
+                    }
+                } else {
+                    cache.add(new ValueRec(sharedID, data));
+                }
+                if (i % 500 == 0) {
+                    SkResourceCache::PostPurgeSharedID(sharedID);
+                }
+            }
+        });
+        REPORTER_ASSERT(reporter, wrongValues == 0);
+        REPORTER_ASSERT(reporter, cache.getTotalBytesUsed() <= 256 * 1024);
+
+        // Purge messages are handled by the next find() in each shard.
+        cache.add(new ValueRec(9, 0));
+        SkResourceCache::PostPurgeSharedID(9);
+        int32_t value;
+        REPORTER_ASSERT(reporter, !cache.find(TestKey(9, 0), ValueRec::Visitor, &value));
+
+        cache.purgeAll();
+        REPORTER_ASSERT(reporter, cache.getTotalBytesUsed() == 0);
+    }
+}
@@ -169,3 +169,21 @@ DEF_TEST(SkRuntimeEffectSimple, r) {
 DEF_GPUTEST_FOR_RENDERING_CONTEXTS(SkRuntimeEffectSimple_GPU, r, ctxInfo) {
     test_RuntimeEffect_Shaders(r, ctxInfo.grContext());
 }
+
+DEF_TEST(SkRuntimeEffectCache, r) {
+    SkString src("uniform half4 c; void main(float2 p, inout half4 color) { color = c; }");
+    auto[first, firstErrors] = SkRuntimeEffect::Make(src);
+    auto[second, secondErrors] = SkRuntimeEffect::Make(src);
+    REPORTER_ASSERT(r, first && first == second);
+
+    src.append(" ");
+    auto[third, thirdErrors] = SkRuntimeEffect::Make(src);
+    REPORTER_ASSERT(r, third && third != first);
+
+    // Failures aren't cached; each attempt reports its errors.
+    SkString bad("void main(float2 p, inout half4 color) { color = undefined; }");
+    for (int i = 0; i < 2; ++i) {
+        auto[effect, errorText] = SkRuntimeEffect::Make(bad);
+        REPORTER_ASSERT(r, !effect && errorText.contains("undefined"));
+    }
+}
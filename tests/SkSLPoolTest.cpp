@@ -0,0 +1,53 @@
+/*
+ * Copyright 2020 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "src/sksl/SkSLCompiler.h"
+
+#include "tests/Test.h"
+
+DEF_TEST(SkSLPoolModuleSymbols, r) {
+    // Looking up sample(), which is overloaded in both the pipeline module and its parent, makes
+    // a symbol owned by the module's table. That symbol must outlive each program's pool, or
+    // destroying the compiler afterwards touches freed memory (caught by ASAN).
+    SkSL::Compiler compiler;
+    for (int i = 0; i < 2; ++i) {
+        SkSL::Program::Settings settings;
+        std::unique_ptr<SkSL::Program> program = compiler.convertProgram(
+                SkSL::Program::kPipelineStage_Kind,
+                SkSL::String("in fragmentProcessor child;"
+                             "void main(float2 p, inout half4 color) {"
+                             "    color = sample(child, p);"
+                             "}"),
+                settings);
+        REPORTER_ASSERT(r, program, "%s", compiler.errorText().c_str());
+    }
+}
+
+DEF_TEST(SkSLPoolRecompile, r) {
+    // Each kind of program loads its modules into long-lived symbol tables the first time it is
+    // compiled. Compiling every kind twice, destroying each program before the next, checks that
+    // none of the modules' symbols came from a program's pool: ASAN catches the use after free,
+    // and SymbolTable asserts in debug builds as soon as such a symbol is stored.
+    static const std::pair<SkSL::Program::Kind, const char*> kPrograms[] = {
+        { SkSL::Program::kFragment_Kind, "void main() { sk_FragColor = sqrt(half4(0.25)); }" },
+        { SkSL::Program::kVertex_Kind, "void main() { sk_Position = float4(abs(-1)); }" },
+        { SkSL::Program::kPipelineStage_Kind, "void main(inout half4 color) {"
+                                              "    color = saturate(color.bgra);"
+                                              "}" },
+        { SkSL::Program::kGeneric_Kind, "float main(float x) { return sqrt(x); }" },
+    };
+    SkSL::Compiler compiler;
+    for (int i = 0; i < 2; ++i) {
+        for (const auto& [kind, src] : kPrograms) {
+            SkSL::Program::Settings settings;
+            std::unique_ptr<SkSL::Program> program =
+                    compiler.convertProgram(kind, SkSL::String(src), settings);
+            REPORTER_ASSERT(r, program && compiler.optimize(*program), "%s",
+                            compiler.errorText().c_str());
+        }
+    }
+}
@@ -0,0 +1,270 @@
+/*
+ * Copyright 2020 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/utils/SkRandom.h"
+#include "src/core/SkVM.h"
+#include "src/sksl/SkSLByteCode.h"
+#include "src/sksl/SkSLCompiler.h"
+#include "src/sksl/SkSLInterpreter.h"
+#include "src/sksl/SkSLVMGenerator.h"
+#include "src/sksl/ir/SkSLFunctionDefinition.h"
+
+#include "tests/Test.h"
+
+#include <array>
+
+// Lowers main(inout half4 color) of a pipeline-stage program to SkVM, runs it on one pixel, and
+// returns whether the program could be lowered at all.
+static bool run_color_filter(skiatest::Reporter* r, const char* src, const float in[4],
+                             float out[4], float uniform = 0) {
+    SkSL::Compiler compiler;
+    SkSL::Program::Settings settings;
+    std::unique_ptr<SkSL::Program> program = compiler.convertProgram(
+            SkSL::Program::kPipelineStage_Kind, SkSL::String(src), settings);
+    if (!program || !compiler.optimize(*program)) {
+        REPORT_FAILURE(r, "!program", SkString(compiler.errorText().c_str()));
+        return false;
+    }
+
+    const SkSL::FunctionDefinition* main = nullptr;
+    for (const auto& e : *program) {
+        if (e.fKind == SkSL::ProgramElement::kFunction_Kind &&
+            ((const SkSL::FunctionDefinition&) e).fDeclaration.fName == "main") {
+            main = &(const SkSL::FunctionDefinition&) e;
+        }
+    }
+    REPORTER_ASSERT(r, main);
+
+    skvm::Builder b;
+    skvm::Arg src_ptrs[4], dst_ptrs[4];
+    skvm::Val color[4];
+    for (int i = 0; i < 4; ++i) {
+        src_ptrs[i] = b.varying<float>();
+        color[i] = b.load32(src_ptrs[i]).id;
+    }
+    for (int i = 0; i < 4; ++i) {
+        dst_ptrs[i] = b.varying<float>();
+    }
+    skvm::Val uniforms[] = { b.uniformF(b.uniform(), 0).id };
+    if (!SkSL::ProgramToSkVM(*program, *main, &b, SkMakeSpan(uniforms), SkMakeSpan(color))) {
+        return false;
+    }
+    for (int i = 0; i < 4; ++i) {
+        b.store32(dst_ptrs[i], skvm::I32{color[i]});
+    }
+
+    float px[4] = { in[0], in[1], in[2], in[3] };
+    b.done().eval(1, &px[0], &px[1], &px[2], &px[3], &out[0], &out[1], &out[2], &out[3],
+                  &uniform);
+    return true;
+}
+
+static void test(skiatest::Reporter* r, const char* src, std::array<float, 4> in,
+                 std::array<float, 4> expected, float uniform = 0) {
+    float out[4];
+    if (!run_color_filter(r, src, in.data(), out, uniform)) {
+        REPORT_FAILURE(r, "ProgramToSkVM", SkStringPrintf("failed to lower:\n%s", src));
+        return;
+    }
+    for (int i = 0; i < 4; ++i) {
+        if (!SkScalarNearlyEqual(out[i], expected[i])) {
+            REPORT_FAILURE(r, "ProgramToSkVM",
+                           SkStringPrintf("%s\nexpected (%g %g %g %g), got (%g %g %g %g)", src,
+                                          expected[0], expected[1], expected[2], expected[3],
+                                          out[0], out[1], out[2], out[3]));
+            return;
+        }
+    }
+}
+
+DEF_TEST(SkSLVMGenerator, r) {
+    test(r, "void main(inout half4 color) {"
+            "    color.a = color.r*0.3 + color.g*0.6 + color.b*0.1;"
+            "    color.rgb = half3(0);"
+            "}",
+         {0.25f, 0.75f, 0.5f, 1}, {0, 0, 0, 0.575f});
+
+    // Uniforms, inlined calls with early returns, and unrolled loops with continue.
+    test(r, "uniform half k;"
+            "half sq(half x) { if (x < 0.5) { return 0; } return x*x; }"
+            "void main(inout half4 c) {"
+            "    for (int i = 0; i < 3; i++) { if (i == 1) continue; c[i] = sq(c[i]) + k; }"
+            "    c.a = c.r > 0.2 ? 1 : 2;"
+            "}",
+         {0.25f, 0.75f, 0.5f, 1}, {10, 0.75f, 10.25f, 1}, 10);
+
+    // Both sides of a branch, and break.
+    test(r, "void main(inout half4 c) {"
+            "    half h;"
+            "    if (c.r > 0.5) { h = 1; } else { h = 2; }"
+            "    c.r = h;"
+            "    for (int i = 0; i < 10; ++i) { if (i > 2) break; c.b += 1; }"
+            "}",
+         {0.25f, 0.75f, 0.5f, 1}, {2, 0.75f, 3.5f, 1});
+
+    // A call after a divergent break must not write globals or out params in lanes that broke.
+    test(r, "half g;"
+            "void count(inout half n) { n += 1; g += 1; }"
+            "void main(inout half4 c) {"
+            "    half n = 0;"
+            "    g = 0;"
+            "    for (int i = 0; i < 4; ++i) { if (c.r*4 < half(i)) break; count(n); }"
+            "    c.g = g;"
+            "    c.b = n;"
+            "}",
+         {0.6f, 0.75f, 0.5f, 1}, {0.6f, 3, 3, 1});
+
+    // Matrices and intrinsics.
+    test(r, "void main(inout half4 c) {"
+            "    half2x2 m = half2x2(1, 2, 3, 4);"
+            "    c.xy = m * c.xy;"
+            "    c.z = dot(c.xy, half2(1));"
+            "    c.w = clamp(c.w, 0.1, 0.2) + step(0.5, c.z) + length(half2(3, 4));"
+            "}",
+         {0.25f, 0.75f, 0.5f, 1}, {2.5f, 3.5f, 6, 6.2f});
+
+    // Loops and indexing we can't unroll or resolve fall back.
+    float out[4];
+    const float in[4] = {0, 0, 0, 0};
+    REPORTER_ASSERT(r, !run_color_filter(r, "void main(inout half4 c) {"
+                                            "    while (c.r < 1) { c.r += 1; }"
+                                            "}", in, out));
+    REPORTER_ASSERT(r, !run_color_filter(r, "void main(inout half4 c) {"
+                                            "    int i = int(c.r);"
+                                            "    c[i] = 1;"
+                                            "}", in, out));
+}
+
+#if defined(SK_ENABLE_SKSL_INTERPRETER)
+// Runs main(inout half4 color) of a generic program over random pixels, with the interpreter and
+// lowered to SkVM, and checks that the two agree.
+static void test_matches_interpreter(skiatest::Reporter* r, const char* src) {
+    SkSL::Compiler compiler;
+    SkSL::Program::Settings settings;
+    std::unique_ptr<SkSL::Program> program = compiler.convertProgram(
+            SkSL::Program::kPipelineStage_Kind, SkSL::String(src), settings);
+    if (!program || !compiler.optimize(*program)) {
+        REPORT_FAILURE(r, "!program", SkString(compiler.errorText().c_str()));
+        return;
+    }
+
+    static constexpr int kCount = 1000;
+    std::vector<float> expected(4 * kCount);
+    SkRandom rand;
+    for (float& c : expected) {
+        c = rand.nextF();
+    }
+    const std::vector<float> input = expected;
+    std::vector<float> actual(4 * kCount);
+
+    std::unique_ptr<SkSL::ByteCode> byteCode = compiler.toByteCode(*program);
+    REPORTER_ASSERT(r, byteCode);
+    if (!byteCode) {
+        return;
+    }
+    const SkSL::ByteCodeFunction* mainByteCode = byteCode->getFunction("main");
+    SkSL::Interpreter<16> interpreter(std::move(byteCode));
+    float* args[] = {
+        expected.data() + 0 * kCount,
+        expected.data() + 1 * kCount,
+        expected.data() + 2 * kCount,
+        expected.data() + 3 * kCount,
+    };
+    REPORTER_ASSERT(r, interpreter.runStriped(mainByteCode, kCount, args));
+
+    const SkSL::FunctionDefinition* main = nullptr;
+    for (const auto& e : *program) {
+        if (e.fKind == SkSL::ProgramElement::kFunction_Kind &&
+            ((const SkSL::FunctionDefinition&) e).fDeclaration.fName == "main") {
+            main = &(const SkSL::FunctionDefinition&) e;
+        }
+    }
+    REPORTER_ASSERT(r, main);
+
+    // SkVM may move loads past stores, so it reads and writes separate buffers.
+    skvm::Builder b;
+    skvm::Arg src_ptrs[4], dst_ptrs[4];
+    skvm::Val color[4];
+    for (int i = 0; i < 4; ++i) {
+        src_ptrs[i] = b.varying<float>();
+        color[i] = b.load32(src_ptrs[i]).id;
+    }
+    for (int i = 0; i < 4; ++i) {
+        dst_ptrs[i] = b.varying<float>();
+    }
+    if (!SkSL::ProgramToSkVM(*program, *main, &b, {}, SkMakeSpan(color))) {
+        REPORT_FAILURE(r, "ProgramToSkVM", SkStringPrintf("failed to lower:\n%s", src));
+        return;
+    }
+    for (int i = 0; i < 4; ++i) {
+        b.store32(dst_ptrs[i], skvm::I32{color[i]});
+    }
+    b.done().eval(kCount, input.data() + 0 * kCount,
+                          input.data() + 1 * kCount,
+                          input.data() + 2 * kCount,
+                          input.data() + 3 * kCount,
+                          actual.data() + 0 * kCount,
+                          actual.data() + 1 * kCount,
+                          actual.data() + 2 * kCount,
+                          actual.data() + 3 * kCount);
+
+    // The interpreter and SkVM may round intermediate results differently (e.g. fused
+    // multiply-adds), so allow a little slop.
+    for (int i = 0; i < 4 * kCount; ++i) {
+        if (!SkScalarNearlyEqual(actual[i], expected[i], 1e-5f)) {
+            REPORT_FAILURE(r, "ProgramToSkVM",
+                           SkStringPrintf("%s\nchannel %d of pixel %d: expected %g, got %g",
+                                          src, i / kCount, i % kCount, expected[i], actual[i]));
+            return;
+        }
+    }
+}
+
+DEF_TEST(SkSLVMGeneratorMatchesInterpreter, r) {
+    test_matches_interpreter(r, "void main(inout half4 color) {"
+                                "    color.a = color.r*0.3 + color.g*0.6 + color.b*0.1;"
+                                "    color.rgb = half3(0);"
+                                "}");
+
+    // Branches, early returns from inlined calls, ternaries, loops and sqrt. The interpreter
+    // lacks max() and min() for this kind of program, so it defines its own.
+    test_matches_interpreter(r, "half max(half a, half b) { return a > b ? a : b; }"
+                                "half min(half a, half b) { return a < b ? a : b; }"
+                                "half hue(half p, half q, half t) {"
+                                "    if (t < 0) t += 1;"
+                                "    if (t > 1) t -= 1;"
+                                "    return t < 1/6. ? p + (q - p)*6*t : t < 1/2. ? q : p;"
+                                "}"
+                                "void main(inout half4 c) {"
+                                "    half hi = max(c.r, max(c.g, c.b));"
+                                "    half lo = min(c.r, min(c.g, c.b));"
+                                "    half l = (hi + lo) / 2;"
+                                "    if (hi == lo) {"
+                                "        c.rgb = half3(l);"
+                                "    } else {"
+                                "        c.r = hue(lo, hi, c.g - c.b);"
+                                "        c.g = hue(lo, hi, c.b - c.r);"
+                                "        c.b = sqrt(hue(lo, hi, c.r - c.g));"
+                                "    }"
+                                "    for (int i = 0; i < 3; i++) { c[i] *= c.a; }"
+                                "}");
+
+    // Calls after a break that only some lanes take.
+    test_matches_interpreter(r, "half g;"
+                                "void count(inout half n) { n += 1; g += 1; }"
+                                "void main(inout half4 c) {"
+                                "    half n = 0;"
+                                "    g = 0;"
+                                "    for (int i = 0; i < 4; ++i) {"
+                                "        if (c.r*4 < half(i)) break;"
+                                "        count(n);"
+                                "    }"
+                                "    c.g = g;"
+                                "    c.b = n;"
+                                "}");
+}
+#endif
@@ -0,0 +1,97 @@
+/*
+ * Copyright 2020 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/core/SkData.h"
+#include "include/core/SkFont.h"
+#include "include/core/SkFontMgr.h"
+#include "include/core/SkPaint.h"
+#include "include/core/SkStream.h"
+#include "include/core/SkSurfaceProps.h"
+#include "include/core/SkTypeface.h"
+#include "src/core/SkGlyph.h"
+#include "src/core/SkStrikeBundle.h"
+#include "src/core/SkStrikeCache.h"
+#include "src/core/SkStrikeSpec.h"
+#include "tests/Test.h"
+
+#include <cstring>
+
+static sk_sp<SkData> make_bundle(const SkStrikeSpec& spec, SkSpan<const SkGlyphID> glyphs) {
+    SkStrikeBundle::Writer writer;
+    writer.addStrike(spec, glyphs, true);
+    SkDynamicMemoryWStream stream;
+    writer.writeToStream(&stream);
+    return stream.detachAsData();
+}
+
+DEF_TEST(StrikeBundle_RoundTrip, reporter) {
+    sk_sp<SkFontMgr> fontMgr = SkFontMgr::RefDefault();
+    sk_sp<SkTypeface> typeface(fontMgr->legacyMakeTypeface(nullptr, SkFontStyle()));
+    if (!typeface || typeface->countGlyphs() == 0) {
+        return;
+    }
+    SkString family;
+    typeface->getFamilyName(&family);
+    sk_sp<SkTypeface> matched(fontMgr->matchFamilyStyle(family.c_str(), typeface->fontStyle()));
+    if (!matched || matched->uniqueID() != typeface->uniqueID()) {
+        return;  // The font manager cannot give this typeface back by name.
+    }
+
+    SkFont font(typeface, 16);
+    // The space is empty, but still gets a path.
+    const SkGlyphID glyphs[] = {1, 2, 3, 4, font.unicharToGlyph(' ')};
+    SkStrikeSpec spec = SkStrikeSpec::MakeMask(font, SkPaint(),
+                                               SkSurfaceProps(0, kUnknown_SkPixelGeometry),
+                                               SkScalerContextFlags::kFakeGammaAndBoostContrast,
+                                               SkMatrix::I());
+    sk_sp<SkData> bundle = make_bundle(spec, SkMakeSpan(glyphs, SK_ARRAY_COUNT(glyphs)));
+
+    SkStrikeCache cache;
+    REPORTER_ASSERT(reporter,
+                    SkStrikeBundle::Load(bundle->data(), bundle->size(), &cache, fontMgr.get())
+                    == 1);
+    REPORTER_ASSERT(reporter, cache.getCacheCountUsed() == 1);
+    sk_sp<SkStrike> loaded = cache.findStrike(spec.descriptor());
+    REPORTER_ASSERT(reporter, loaded != nullptr);
+    if (!loaded) {
+        return;
+    }
+
+    // The bundled glyphs must match what the scaler makes now.
+    SkStrikeCache fresh;
+    sk_sp<SkStrike> rasterized = spec.findOrCreateStrike(&fresh);
+    for (SkGlyphID id : glyphs) {
+        SkPackedGlyphID packed{id};
+        const SkGlyph* want;
+        rasterized->prepareImages(SkSpan<const SkPackedGlyphID>{&packed, 1}, &want);
+        const SkGlyph* got;
+        loaded->prepareImages(SkSpan<const SkPackedGlyphID>{&packed, 1}, &got);
+        REPORTER_ASSERT(reporter, got->advanceX() == want->advanceX());
+        REPORTER_ASSERT(reporter, got->width() == want->width());
+        REPORTER_ASSERT(reporter, got->height() == want->height());
+        REPORTER_ASSERT(reporter, (got->image() == nullptr) == (want->image() == nullptr));
+        if (got->image() && want->image()) {
+            REPORTER_ASSERT(reporter,
+                            0 == memcmp(got->image(), want->image(), want->imageSize()));
+        }
+    }
+
+    // Without a font manager the typeface can't be resolved, so nothing is loaded.
+    SkStrikeCache unresolved;
+    REPORTER_ASSERT(reporter,
+                    SkStrikeBundle::Load(bundle->data(), bundle->size(), &unresolved, nullptr)
+                    == 0);
+    REPORTER_ASSERT(reporter, unresolved.getCacheCountUsed() == 0);
+
+    // Truncated bundles are rejected without crashing.
+    for (size_t size = 0; size < bundle->size(); size += 4) {
+        SkStrikeCache truncated;
+        REPORTER_ASSERT(reporter,
+                        SkStrikeBundle::Load(bundle->data(), size, &truncated, fontMgr.get())
+                        == -1);
+    }
+}
@@ -0,0 +1,149 @@
+/*
+ * Copyright 2020 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/core/SkExecutor.h"
+#include "include/core/SkFont.h"
+#include "src/core/SkStrikeCache.h"
+#include "src/core/SkStrikeSpec.h"
+#include "src/core/SkTaskGroup.h"
+#include "tests/Test.h"
+
+#include <memory>
+#include <vector>
+
+DEF_TEST(StrikeCache_ThreadCache, reporter) {
+    SkStrikeCache cache;
+    SkFont font;
+    font.setSize(17);
+    SkStrikeSpec spec = SkStrikeSpec::MakeWithNoDevice(font);
+
+    sk_sp<SkStrike> a = spec.findOrCreateStrike(&cache);
+    sk_sp<SkStrike> b = spec.findOrCreateStrike(&cache);
+    REPORTER_ASSERT(reporter, a == b);
+    REPORTER_ASSERT(reporter, cache.findStrike(spec.descriptor()) == a);
+    REPORTER_ASSERT(reporter, cache.getCacheCountUsed() == 1);
+
+    // Another cache never sees strikes remembered for this one.
+    SkStrikeCache other;
+    sk_sp<SkStrike> c = spec.findOrCreateStrike(&other);
+    REPORTER_ASSERT(reporter, c != a);
+    REPORTER_ASSERT(reporter, c->fStrikeCache == &other);
+
+    // Purging invalidates what this thread remembers.
+    cache.purgeAll();
+    REPORTER_ASSERT(reporter, a->fRemoved);
+    REPORTER_ASSERT(reporter, cache.findStrike(spec.descriptor()) == nullptr);
+    sk_sp<SkStrike> d = spec.findOrCreateStrike(&cache);
+    REPORTER_ASSERT(reporter, d != a);
+    REPORTER_ASSERT(reporter, !d->fRemoved);
+    REPORTER_ASSERT(reporter, cache.getCacheCountUsed() == 1);
+}
+
+#if !defined(SK_BUILD_FOR_IOS) && SK_STRIKE_CACHE_THREAD_MRU_COUNT > 0
+DEF_TEST(StrikeCache_ThreadCacheHitsAreRecent, reporter) {
+    SkStrikeCache cache;
+    SkFont font;
+    font.setSize(17);
+    SkStrikeSpec specA = SkStrikeSpec::MakeWithNoDevice(font);
+    font.setSize(19);
+    SkStrikeSpec specB = SkStrikeSpec::MakeWithNoDevice(font);
+
+    sk_sp<SkStrike> a = specA.findOrCreateStrike(&cache);
+    sk_sp<SkStrike> b = specB.findOrCreateStrike(&cache);
+
+    // This hit is served by the thread cache, so a stays at the tail of the LRU list, but it
+    // must still win over b when the cache shrinks.
+    REPORTER_ASSERT(reporter, specA.findOrCreateStrike(&cache) == a);
+    cache.setCacheCountLimit(1);
+    REPORTER_ASSERT(reporter, !a->fRemoved);
+    REPORTER_ASSERT(reporter, b->fRemoved);
+    REPORTER_ASSERT(reporter, cache.getCacheCountUsed() == 1);
+}
+
+DEF_TEST(StrikeCache_ThreadCachePurgeDuringLookup, reporter) {
+    SkStrikeCache cache;
+    constexpr int kSpecs = 3;
+    std::vector<SkStrikeSpec> specs;
+    SkFont font;
+    for (int i = 0; i < kSpecs; ++i) {
+        font.setSize(10 + i);
+        specs.push_back(SkStrikeSpec::MakeWithNoDevice(font));
+    }
+
+    // The other threads keep looking up the same few strikes, nearly always from their own
+    // entries, while the first purges the cache as fast as it can. A strike must never be freed
+    // while a thread is still taking a ref to it through its entries.
+    std::atomic<int> failures{0};
+    std::atomic<int> lookupsLeft{4};
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(5);
+    SkTaskGroup(*executor).batch(5, [&](int thread) {
+        if (thread == 0) {
+            while (lookupsLeft.load() > 0) {
+                cache.purgeAll();
+            }
+            return;
+        }
+        for (int i = 0; i < 20000; ++i) {
+            const SkStrikeSpec& spec = specs[i % kSpecs];
+            sk_sp<SkStrike> strike = i % 2 ? spec.findOrCreateStrike(&cache)
+                                           : cache.findStrike(spec.descriptor());
+            if (strike && (strike->getDescriptor() != spec.descriptor() ||
+                           strike->fStrikeCache != &cache)) {
+                failures++;
+            }
+        }
+        lookupsLeft--;
+    });
+    REPORTER_ASSERT(reporter, failures == 0);
+
+    // Once nothing is being looked up, a purge lets go of every strike.
+    sk_sp<SkStrike> strike = specs[0].findOrCreateStrike(&cache);
+    cache.purgeAll();
+    REPORTER_ASSERT(reporter, strike->unique());
+    REPORTER_ASSERT(reporter, cache.getCacheCountUsed() == 0);
+}
+
+DEF_TEST(StrikeCache_ThreadCacheDoesNotOwn, reporter) {
+    SkStrikeCache cache;
+    SkFont font;
+    font.setSize(17);
+    SkStrikeSpec spec = SkStrikeSpec::MakeWithNoDevice(font);
+
+    // Once purged, a strike this thread remembers belongs to its other owners alone.
+    sk_sp<SkStrike> a = spec.findOrCreateStrike(&cache);
+    REPORTER_ASSERT(reporter, spec.findOrCreateStrike(&cache) == a);
+    cache.purgeAll();
+    REPORTER_ASSERT(reporter, a->unique());
+}
+#endif
+
+DEF_TEST(StrikeCache_Threaded, reporter) {
+    SkStrikeCache cache;
+    constexpr int kSpecs = 6;
+    std::vector<SkStrikeSpec> specs;
+    SkFont font;
+    for (int i = 0; i < kSpecs; ++i) {
+        font.setSize(10 + i);
+        specs.push_back(SkStrikeSpec::MakeWithNoDevice(font));
+    }
+
+    std::atomic<int> failures{0};
+    SkTaskGroup().batch(8, [&](int thread) {
+        for (int i = 0; i < 1000; ++i) {
+            if (thread == 0 && i % 100 == 0) {
+                cache.purgeAll();
+            }
+            const SkStrikeSpec& spec = specs[(i + thread) % kSpecs];
+            sk_sp<SkStrike> strike = spec.findOrCreateStrike(&cache);
+            if (strike->getDescriptor() != spec.descriptor() || strike->fStrikeCache != &cache) {
+                failures++;
+            }
+        }
+    });
+    REPORTER_ASSERT(reporter, failures == 0);
+    REPORTER_ASSERT(reporter, cache.getCacheCountUsed() <= kSpecs);
+}
@@ -6,10 +6,16 @@
  */
 
 #include "include/core/SkColorPriv.h"
+#include "include/core/SkData.h"
+#include "include/core/SkStream.h"
+#include "include/private/SkMutex.h"
 #include "include/private/SkColorData.h"
 #include "src/core/SkCpu.h"
 #include "src/core/SkMSAN.h"
+#include "src/core/SkOSFile.h"
+#include "src/core/SkOpts.h"
 #include "src/core/SkVM.h"
+#include "src/utils/SkOSPath.h"
 #include "tests/Test.h"
 #include "tools/Resources.h"
 #include "tools/SkVMBuilders.h"
@@ -832,6 +838,52 @@ DEF_TEST(SkVM_hoist, r) {
     });
 }
 
+DEF_TEST(SkVM_evalSpans, r) {
+    // buf[i] += uniform * 3 + 1, where each span has its own uniform.
+    skvm::Builder b;
+    {
+        skvm::Arg uniforms = b.uniform(),
+                  buf      = b.varying<int>();
+        skvm::I32 u = b.add(b.mul(b.uniform32(uniforms, 0), b.splat(3)), b.splat(1));
+        b.store32(buf, b.add(b.load32(buf), u));
+    }
+
+    test_jit_and_interpreter(r, b.done(), [&](const skvm::Program& program) {
+        // Spans of every length from 0 to 39 (covering both the SIMD body and scalar tail),
+        // packed back to back into buf.
+        constexpr int kSpans = 40;
+        int buf[kSpans*(kSpans-1)/2],
+            uniform[kSpans];
+        void* args[kSpans][2];
+        skvm::Program::Span spans[kSpans];
+
+        int* ptr = buf;
+        for (int i = 0; i < kSpans; i++) {
+            uniform[i] = i;
+            args[i][0] = &uniform[i];
+            args[i][1] = ptr;
+            spans[i] = {i, args[i]};
+            ptr += i;
+        }
+        for (int& x : buf) {
+            x = 7;
+        }
+
+        program.evalSpans(spans, 0);
+        for (int x : buf) {
+            REPORTER_ASSERT(r, x == 7);
+        }
+
+        program.evalSpans(spans, kSpans);
+        ptr = buf;
+        for (int i = 0; i < kSpans; i++) {
+            for (int j = 0; j < i; j++) {
+                REPORTER_ASSERT(r, *ptr++ == 7 + 3*i + 1);
+            }
+        }
+    });
+}
+
 DEF_TEST(SkVM_select, r) {
     skvm::Builder b;
     {
@@ -1065,6 +1117,126 @@ static void test_asm(skiatest::Reporter* r, Fn&& fn, std::initializer_list<uint8
     }
 }
 
+DEF_TEST(SkVM_JITCache, r) {
+    // Other tests build Programs concurrently, so this cache must be thread safe and may serve
+    // their Programs too; comparing whole keys keeps it from handing anyone the wrong code.
+    // Our second, identical Program must hit it.
+    struct MemoryJITCache final : public skvm::JITCache {
+        sk_sp<SkData> load(const SkData& key) override {
+            SkAutoMutexExclusive lock(fMutex);
+            Entry* entry = fEntries.find(SkOpts::hash(key.data(), key.size()));
+            if (entry && entry->key->equals(&key)) {
+                fHits++;
+                return entry->code;
+            }
+            return nullptr;
+        }
+        void store(const SkData& key, const SkData& code) override {
+            SkAutoMutexExclusive lock(fMutex);
+            fEntries.set(SkOpts::hash(key.data(), key.size()),
+                         {SkData::MakeWithCopy(key.data(), key.size()),
+                          SkData::MakeWithCopy(code.data(), code.size())});
+        }
+        int hits() {
+            SkAutoMutexExclusive lock(fMutex);
+            return fHits;
+        }
+
+        struct Entry {
+            sk_sp<SkData> key,
+                          code;
+        };
+        SkMutex                     fMutex;
+        SkTHashMap<uint32_t, Entry> fEntries;
+        int                         fHits = 0;
+    };
+    MemoryJITCache cache;
+    skvm::SetJITCache(&cache);
+
+    auto build = [] {
+        skvm::Builder b;
+        skvm::Arg buf = b.varying<int>();
+        b.store32(buf, b.add(b.load32(buf), b.splat(0x1234567)));
+        return b.done();
+    };
+    skvm::Program first  = build(),
+                  second = build();
+    // Once uninstalled, nobody else is using the cache, so it's safe to let it go out of scope.
+    skvm::SetJITCache(nullptr);
+
+    if (first.hasJIT()) {
+        REPORTER_ASSERT(r, second.hasJIT());
+        REPORTER_ASSERT(r, cache.hits() > 0);
+    }
+    for (const skvm::Program* program : {&first, &second}) {
+        int buf[17];
+        for (int i = 0; i < 17; i++) { buf[i] = i; }
+        program->eval(17, buf);
+        for (int i = 0; i < 17; i++) {
+            REPORTER_ASSERT(r, buf[i] == i + 0x1234567);
+        }
+    }
+}
+
+DEF_TEST(SkVM_FileJITCache, r) {
+    SkString tmpDir = skiatest::GetTmpDir();
+    if (tmpDir.isEmpty()) {
+        return;
+    }
+    SkString path = SkOSPath::Join(tmpDir.c_str(), "skvm_jit_cache");
+    {
+        SkFILEWStream empty(path.c_str());
+    }
+
+    sk_sp<SkData> k1 = SkData::MakeWithCString("first key"),
+                  k2 = SkData::MakeWithCString("second key"),
+                  c1 = SkData::MakeWithCopy("0123456789abcdef", 16),
+                  c2 = SkData::MakeWithCopy("fedcba9876543210", 16);
+    auto loads = [&](skvm::JITCache* cache, const sk_sp<SkData>& key, const sk_sp<SkData>& code) {
+        sk_sp<SkData> loaded = cache->load(*key);
+        return loaded && loaded->equals(code.get());
+    };
+
+    {
+        auto cache = skvm::MakeFileJITCache(path.c_str());
+        REPORTER_ASSERT(r, !cache->load(*k1));
+        cache->store(*k1, *c1);
+        REPORTER_ASSERT(r, loads(cache.get(), k1, c1));
+        REPORTER_ASSERT(r, !cache->load(*k2));
+    }
+
+    // Simulate a writer that crashed halfway through appending an entry.
+    if (FILE* f = sk_fopen(path.c_str(), kAppend_SkFILE_Flag)) {
+        const uint32_t torn[] = { 100, 100, 0 };
+        sk_fwrite(torn, sizeof(torn), f);
+        sk_fclose(f);
+    }
+    {
+        auto cache = skvm::MakeFileJITCache(path.c_str());
+        REPORTER_ASSERT(r, loads(cache.get(), k1, c1));
+        cache->store(*k2, *c2);
+    }
+    {
+        auto cache = skvm::MakeFileJITCache(path.c_str());
+        REPORTER_ASSERT(r, loads(cache.get(), k1, c1));
+        REPORTER_ASSERT(r, loads(cache.get(), k2, c2));
+    }
+
+    // Corrupt the last byte of c2; we should notice and refuse to return it.
+    sk_sp<SkData> bytes = SkData::MakeFromFileName(path.c_str());
+    REPORTER_ASSERT(r, bytes && bytes->size() > 0);
+    if (bytes && bytes->size() > 0) {
+        sk_sp<SkData> corrupt = SkData::MakeWithCopy(bytes->data(), bytes->size());
+        ((uint8_t*)corrupt->writable_data())[corrupt->size() - 1] ^= 0xff;
+        bytes = nullptr;
+        SkFILEWStream(path.c_str()).write(corrupt->data(), corrupt->size());
+
+        auto cache = skvm::MakeFileJITCache(path.c_str());
+        REPORTER_ASSERT(r, loads(cache.get(), k1, c1));
+        REPORTER_ASSERT(r, !cache->load(*k2));
+    }
+}
+
 DEF_TEST(SkVM_Assembler, r) {
     // Easiest way to generate test cases is
     //
@@ -1443,6 +1615,186 @@ DEF_TEST(SkVM_Assembler, r) {
         0x4c, 0x8b, 0x78, 0x2a,
     });
 
+    test_asm(r, [&](A& a) {
+        a.movl(A::rdi, A::rbx, 0);
+        a.movl(A::rax, A::rbx, 8);
+        a.movl(A::r8 , A::r9 , 4);
+        a.movl(A::rax, A::rsi, 400);
+
+        a.movq(A::rbx, A::rsi);
+        a.movq(A::rbp, A::rdi);
+        a.movq(A::r8 , A::r9);
+        a.movq(A::rax, A::r10);
+
+        a.push(A::rbx);
+        a.push(A::rbp);
+        a.push(A::r12);
+        a.pop (A::rbx);
+        a.pop (A::r12);
+    },{
+        0x8b, 0x3b,
+        0x8b, 0x43, 0x08,
+        0x45, 0x8b, 0x41, 0x04,
+        0x8b, 0x86, 0x90,0x01,0x00,0x00,
+
+        0x48, 0x89, 0xf3,
+        0x48, 0x89, 0xfd,
+        0x4d, 0x89, 0xc8,
+        0x4c, 0x89, 0xd0,
+
+        0x53,
+        0x55,
+        0x41, 0x54,
+        0x5b,
+        0x41, 0x5c,
+    });
+
+    // AVX-512.  Where llvm-mc would compress a displacement to disp8*N,
+    // vbroadcastss(zmm,ptr,off) intentionally uses an uncompressed disp32 instead.
+    test_asm(r, [&](A& a) {
+        a.vpaddd(A::zmm0, A::zmm1, A::zmm2);
+        a.vpaddd(A::zmm8, A::zmm9, A::zmm15);
+        a.vpsubd(A::zmm3, A::zmm12, A::zmm4);
+        a.vpmulld(A::zmm1, A::zmm2, A::zmm3);
+        a.vpsubw(A::zmm1, A::zmm2, A::zmm3);
+        a.vpmullw(A::zmm1, A::zmm2, A::zmm3);
+
+        a.vpandd(A::zmm1, A::zmm2, A::zmm3);
+        a.vpord(A::zmm1, A::zmm2, A::zmm11);
+        a.vpxord(A::zmm13, A::zmm2, A::zmm3);
+        a.vpandnd(A::zmm1, A::zmm2, A::zmm3);
+        a.vpternlogd(A::zmm1, A::zmm2, A::zmm3, 0xca);
+
+        a.vaddps(A::zmm1, A::zmm2, A::zmm3);
+        a.vsubps(A::zmm1, A::zmm2, A::zmm3);
+        a.vmulps(A::zmm1, A::zmm2, A::zmm3);
+        a.vdivps(A::zmm1, A::zmm2, A::zmm3);
+        a.vminps(A::zmm1, A::zmm2, A::zmm3);
+        a.vmaxps(A::zmm1, A::zmm2, A::zmm3);
+
+        a.vfmadd132ps(A::zmm1, A::zmm2, A::zmm3);
+        a.vfmadd213ps(A::zmm1, A::zmm2, A::zmm3);
+        a.vfmadd231ps(A::zmm1, A::zmm2, A::zmm3);
+    },{
+        0x62,0xf1,0x75,0x48,0xfe,0xc2,
+        0x62,0x51,0x35,0x48,0xfe,0xc7,
+        0x62,0xf1,0x1d,0x48,0xfa,0xdc,
+        0x62,0xf2,0x6d,0x48,0x40,0xcb,
+        0x62,0xf1,0x6d,0x48,0xf9,0xcb,
+        0x62,0xf1,0x6d,0x48,0xd5,0xcb,
+
+        0x62,0xf1,0x6d,0x48,0xdb,0xcb,
+        0x62,0xd1,0x6d,0x48,0xeb,0xcb,
+        0x62,0x71,0x6d,0x48,0xef,0xeb,
+        0x62,0xf1,0x6d,0x48,0xdf,0xcb,
+        0x62,0xf3,0x6d,0x48,0x25,0xcb,0xca,
+
+        0x62,0xf1,0x6c,0x48,0x58,0xcb,
+        0x62,0xf1,0x6c,0x48,0x5c,0xcb,
+        0x62,0xf1,0x6c,0x48,0x59,0xcb,
+        0x62,0xf1,0x6c,0x48,0x5e,0xcb,
+        0x62,0xf1,0x6c,0x48,0x5d,0xcb,
+        0x62,0xf1,0x6c,0x48,0x5f,0xcb,
+
+        0x62,0xf2,0x6d,0x48,0x98,0xcb,
+        0x62,0xf2,0x6d,0x48,0xa8,0xcb,
+        0x62,0xf2,0x6d,0x48,0xb8,0xcb,
+    });
+
+    test_asm(r, [&](A& a) {
+        a.vpcmpeqd(A::k1, A::zmm2, A::zmm3);
+        a.vpcmpgtd(A::k1, A::zmm2, A::zmm10);
+        a.vcmpeqps (A::k1, A::zmm2, A::zmm3);
+        a.vcmpltps (A::k2, A::zmm2, A::zmm3);
+        a.vcmpleps (A::k1, A::zmm2, A::zmm3);
+        a.vcmpneqps(A::k1, A::zmm2, A::zmm3);
+
+        a.vpmovm2d(A::zmm4 , A::k1);
+        a.vpmovm2d(A::zmm12, A::k1);
+        a.kxnorw  (A::k1, A::k1, A::k1);
+        a.kortestw(A::k1, A::k1);
+    },{
+        0x62,0xf1,0x6d,0x48,0x76,0xcb,
+        0x62,0xd1,0x6d,0x48,0x66,0xca,
+        0x62,0xf1,0x6c,0x48,0xc2,0xcb,0x00,
+        0x62,0xf1,0x6c,0x48,0xc2,0xd3,0x01,
+        0x62,0xf1,0x6c,0x48,0xc2,0xcb,0x02,
+        0x62,0xf1,0x6c,0x48,0xc2,0xcb,0x04,
+
+        0x62,0xf2,0x7e,0x48,0x38,0xe1,
+        0x62,0x72,0x7e,0x48,0x38,0xe1,
+        0xc5,0xf4,0x46,0xc9,
+        0xc5,0xf8,0x98,0xc9,
+    });
+
+    test_asm(r, [&](A& a) {
+        a.vpslld(A::zmm1, A::zmm2 , 3);
+        a.vpsrld(A::zmm9, A::zmm2 , 3);
+        a.vpsrad(A::zmm1, A::zmm10, 3);
+        a.vpsrlw(A::zmm1, A::zmm2 , 8);
+        a.vrndscaleps(A::zmm1, A::zmm2, A::FLOOR);
+
+        a.vmovdqa32 (A::zmm1, A::zmm14);
+        a.vcvtdq2ps (A::zmm1, A::zmm2);
+        a.vcvttps2dq(A::zmm1, A::zmm2);
+        a.vsqrtps   (A::zmm1, A::zmm2);
+    },{
+        0x62,0xf1,0x75,0x48,0x72,0xf2,0x03,
+        0x62,0xf1,0x35,0x48,0x72,0xd2,0x03,
+        0x62,0xd1,0x75,0x48,0x72,0xe2,0x03,
+        0x62,0xf1,0x75,0x48,0x71,0xd2,0x08,
+        0x62,0xf3,0x7d,0x48,0x08,0xca,0x01,
+
+        0x62,0xd1,0x7d,0x48,0x6f,0xce,
+        0x62,0xf1,0x7c,0x48,0x5b,0xca,
+        0x62,0xf1,0x7e,0x48,0x5b,0xca,
+        0x62,0xf1,0x7c,0x48,0x51,0xca,
+    });
+
+    test_asm(r, [&](A& a) {
+        a.vbroadcastss(A::zmm1 , A::xmm2);
+        a.vbroadcastss(A::zmm9 , A::xmm10);
+        a.vbroadcastss(A::zmm1 , A::rsi, 0);
+        a.vbroadcastss(A::zmm1 , A::rsi, 4);
+        a.vbroadcastss(A::zmm10, A::r9 , 200);
+
+        a.vmovups  (A::zmm1, A::rsi);
+        a.vmovups  (A::zmm9, A::r8 );
+        a.vpmovzxwd(A::zmm1, A::rsi);
+        a.vpmovzxbd(A::zmm1, A::rdx);
+
+        a.vmovups(A::rsi, A::zmm1 );
+        a.vmovups(A::r9 , A::zmm11);
+        a.vpmovdw(A::rsi, A::zmm1 );
+        a.vpmovdb(A::rcx, A::zmm12);
+    },{
+        0x62,0xf2,0x7d,0x48,0x18,0xca,
+        0x62,0x52,0x7d,0x48,0x18,0xca,
+        0x62,0xf2,0x7d,0x48,0x18,0x0e,
+        0x62,0xf2,0x7d,0x48,0x18,0x8e,0x04,0x00,0x00,0x00,
+        0x62,0x52,0x7d,0x48,0x18,0x91,0xc8,0x00,0x00,0x00,
+
+        0x62,0xf1,0x7c,0x48,0x10,0x0e,
+        0x62,0x51,0x7c,0x48,0x10,0x08,
+        0x62,0xf2,0x7d,0x48,0x33,0x0e,
+        0x62,0xf2,0x7d,0x48,0x31,0x0a,
+
+        0x62,0xf1,0x7c,0x48,0x11,0x0e,
+        0x62,0x51,0x7c,0x48,0x11,0x19,
+        0x62,0xf2,0x7e,0x48,0x33,0x0e,
+        0x62,0x72,0x7e,0x48,0x31,0x21,
+    });
+
+    test_asm(r, [&](A& a) {
+        a.vgatherdps(A::zmm1, A::FOUR, A::zmm2 , A::rax, A::k1);
+        a.vgatherdps(A::zmm9, A::FOUR, A::zmm10, A::rax, A::k1);
+        a.vgatherdps(A::zmm0, A::ONE , A::zmm2 , A::r9 , A::k2);
+    },{
+        0x62,0xf2,0x7d,0x49,0x92,0x0c,0x90,
+        0x62,0x32,0x7d,0x49,0x92,0x0c,0x90,
+        0x62,0xd2,0x7d,0x4a,0x92,0x04,0x11,
+    });
+
     // echo "fmul v4.4s, v3.4s, v1.4s" | llvm-mc -show-encoding -arch arm64
 
     test_asm(r, [&](A& a) {
@@ -1717,6 +2069,20 @@ DEF_TEST(SkVM_Assembler, r) {
         0x00,0x01,0x00,0x3d,
     });
 
+    test_asm(r, [&](A& a) {
+        a.ldrd(A::x8, A::x9,  8);
+        a.ldrd(A::x1, A::x8,  0);
+        a.ldrd(A::x7, A::x8, 48);
+        a.ldrs(A::x0, A::x9,  0);
+        a.ldrs(A::x3, A::x2, 16);
+    },{
+        0x28,0x05,0x40,0xf9,
+        0x01,0x01,0x40,0xf9,
+        0x07,0x19,0x40,0xf9,
+        0x20,0x01,0x40,0xb9,
+        0x43,0x10,0x40,0xb9,
+    });
+
     test_asm(r, [&](A& a) {
         a.tbl(A::v0, A::v1, A::v2);
     },{
@@ -0,0 +1,131 @@
+/*
+ * Copyright 2020 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/core/SkBitmap.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkImage.h"
+#include "include/core/SkPath.h"
+#include "include/core/SkRRect.h"
+#include "include/core/SkSurface.h"
+#include "include/effects/SkGradientShader.h"
+#include "src/core/SkThreadedBMPDevice.h"
+#include "tests/Test.h"
+
+static void draw_scene(SkCanvas* canvas) {
+    canvas->clear(SK_ColorWHITE);
+
+    SkPaint paint;
+    paint.setAntiAlias(true);
+
+    // Lots of small AA draws that straddle tile boundaries.
+    for (int i = 0; i < 40; ++i) {
+        paint.setColor(SkColorSetARGB(0xC0, (i * 37) & 0xFF, (i * 91) & 0xFF, (i * 13) & 0xFF));
+        canvas->drawRect(SkRect::MakeXYWH(i * 6.3f, i * 5.7f, 40.5f, 17.25f), paint);
+        canvas->drawCircle(250 - i * 5.1f, 20 + i * 6.2f, 9.5f, paint);
+    }
+
+    // Strokes, rrects and hairlines under a rotation.
+    canvas->save();
+    canvas->rotate(17, 128, 128);
+    paint.setStyle(SkPaint::kStroke_Style);
+    paint.setStrokeWidth(3.5f);
+    paint.setColor(SK_ColorBLUE);
+    canvas->drawRRect(SkRRect::MakeRectXY(SkRect::MakeLTRB(30, 40, 220, 200), 25, 15), paint);
+    paint.setStrokeWidth(0);
+    SkPoint pts[] = {{10, 10}, {240, 30}, {60, 250}, {200, 180}};
+    canvas->drawPoints(SkCanvas::kPolygon_PointMode, SK_ARRAY_COUNT(pts), pts, paint);
+    canvas->restore();
+
+    // An AA clip, a gradient and a layer.
+    SkPath clip;
+    clip.addOval(SkRect::MakeLTRB(20, 60, 236, 200));
+    canvas->save();
+    canvas->clipPath(clip, true);
+    SkPoint gradPts[] = {{0, 0}, {256, 256}};
+    SkColor colors[] = {SK_ColorRED, SK_ColorGREEN};
+    paint.reset();
+    paint.setShader(SkGradientShader::MakeLinear(gradPts, colors, nullptr, 2,
+                                                 SkTileMode::kClamp));
+    canvas->saveLayerAlpha(nullptr, 0x80);
+    canvas->drawPaint(paint);
+    canvas->restore();
+    canvas->restore();
+
+    // A scaled bitmap.
+    SkBitmap bm;
+    bm.allocN32Pixels(16, 16);
+    bm.eraseColor(SK_ColorMAGENTA);
+    bm.erase(SK_ColorCYAN, SkIRect::MakeLTRB(4, 4, 12, 12));
+    paint.reset();
+    paint.setFilterQuality(kLow_SkFilterQuality);
+    canvas->drawBitmapRect(bm, SkRect::MakeXYWH(100.5f, 90.25f, 77, 101), &paint);
+}
+
+// Draws the same scene with SkBitmapDevice and with SkThreadedBMPDevice, split into each number
+// of tiles, and checks that the pixels match.
+static void test_matches_bitmap_device(skiatest::Reporter* reporter, const SkImageInfo& info,
+                                       void (*draw)(SkCanvas*),
+                                       std::initializer_list<int> tileCounts) {
+    SkBitmap expected;
+    expected.allocPixels(info);
+    {
+        SkCanvas canvas(expected);
+        draw(&canvas);
+    }
+
+    for (int tiles : tileCounts) {
+        SkBitmap actual;
+        actual.allocPixels(info);
+        {
+            SkCanvas canvas(sk_make_sp<SkThreadedBMPDevice>(actual, tiles));
+            draw(&canvas);
+            canvas.flush();
+        }
+
+        for (int y = 0; y < info.height(); ++y) {
+            if (0 != memcmp(expected.getAddr(0, y), actual.getAddr(0, y),
+                            info.minRowBytes())) {
+                ERRORF(reporter, "%dx%d, %d tiles: row %d differs from SkBitmapDevice",
+                       info.width(), info.height(), tiles, y);
+                break;
+            }
+        }
+    }
+}
+
+DEF_TEST(ThreadedBMPDevice, reporter) {
+    test_matches_bitmap_device(reporter, SkImageInfo::MakeN32Premul(256, 256), draw_scene,
+                               {1, 3, 8, 37});
+}
+
+// SkBitmapDevice splits draws on devices larger than 8K into 8K tiles of its own.
+DEF_TEST(ThreadedBMPDevice_Large, reporter) {
+    auto draw = [](SkCanvas* canvas) {
+        canvas->clear(SK_ColorWHITE);
+        SkPaint paint;
+        paint.setAntiAlias(true);
+        paint.setColor(0xC0336699);
+        // Draws that straddle x = 8191 or y = 8191, and one that covers everything.
+        canvas->drawRect(SkRect::MakeLTRB(8150.5f, 8150.5f, 8230.25f, 8230.25f), paint);
+        canvas->drawCircle(8191, 8191, 30.5f, paint);
+        canvas->drawCircle(20, 8191, 60, paint);
+        canvas->drawCircle(8191, 20, 60, paint);
+        SkPoint gradPts[] = {{0, 0}, {8500, 8500}};
+        SkColor colors[] = {0x40FF0000, 0x4000FF00};
+        paint.setShader(SkGradientShader::MakeLinear(gradPts, colors, nullptr, 2,
+                                                     SkTileMode::kClamp));
+        canvas->drawPaint(paint);
+        paint.setShader(nullptr);
+        canvas->rotate(3);
+        paint.setStyle(SkPaint::kStroke_Style);
+        paint.setStrokeWidth(2.5f);
+        canvas->drawRRect(SkRRect::MakeRectXY(SkRect::MakeLTRB(8000, -40, 8400, 8400), 20, 20),
+                          paint);
+    };
+    test_matches_bitmap_device(reporter, SkImageInfo::MakeN32Premul(8500, 48), draw, {1, 5});
+    test_matches_bitmap_device(reporter, SkImageInfo::MakeN32Premul(48, 8500), draw, {1, 5});
+}
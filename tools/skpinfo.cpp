@@ -11,6 +11,7 @@
 #include "src/core/SkFontDescriptor.h"
 #include "src/core/SkPictureCommon.h"
 #include "src/core/SkPictureData.h"
+#include "src/core/SkPicturePriv.h"
 #include "tools/flags/CommandLineFlags.h"
 
 static DEFINE_string2(input, i, "", "skp on which to report");
@@ -31,6 +32,15 @@ static const int kInvalidTag = 3;
 static const int kMissingInput = 4;
 static const int kIOError = 5;
 
+// Since V74, op data and buffer payloads follow a count byte and that many bytes of padding.
+static bool skip_payload_padding(SkStream* stream, const SkPictInfo& info) {
+    if (info.getVersion() < SkPicturePriv::kAlignedPayloads_Version) {
+        return true;
+    }
+    uint8_t pad;
+    return stream->readU8(&pad) && stream->skip(pad) == pad;
+}
+
 int main(int argc, char** argv) {
     CommandLineFlags::SetUsage("Prints information about an skp file");
     CommandLineFlags::Parse(argc, argv);
@@ -104,6 +114,15 @@ int main(int argc, char** argv) {
             if (FLAGS_tags && !FLAGS_quiet) {
                 SkDebugf("SK_PICT_READER_TAG %d\n", chunkSize);
             }
+            if (!skip_payload_padding(&stream, info)) {
+                return kTruncatedFile;
+            }
+            break;
+        case SK_PICT_OP_INDEX_TAG:
+            if (FLAGS_tags && !FLAGS_quiet) {
+                SkDebugf("SK_PICT_OP_INDEX_TAG %d\n", chunkSize);
+            }
+            chunkSize *= sizeof(SkPictureOpIndexEntry);
             break;
         case SK_PICT_FACTORY_TAG:
             if (FLAGS_tags && !FLAGS_quiet) {
@@ -141,6 +160,9 @@ int main(int argc, char** argv) {
             if (FLAGS_tags && !FLAGS_quiet) {
                 SkDebugf("SK_PICT_BUFFER_SIZE_TAG %d\n", chunkSize);
             }
+            if (!skip_payload_padding(&stream, info)) {
+                return kTruncatedFile;
+            }
             break;
         default:
             if (!FLAGS_quiet) {
@@ -0,0 +1,86 @@
+/*
+ * Copyright 2020 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+// Writes a strike bundle for SkGraphics::PreloadFontCache(): the glyphs of --text in each of
+// --family at each of --sizes, rasterized the way an uncolorspaced raster canvas draws them.
+
+#include "include/core/SkFont.h"
+#include "include/core/SkFontMgr.h"
+#include "include/core/SkPaint.h"
+#include "include/core/SkStream.h"
+#include "include/core/SkSurfaceProps.h"
+#include "include/core/SkTypeface.h"
+#include "src/core/SkStrikeBundle.h"
+#include "src/core/SkStrikeSpec.h"
+#include "tools/flags/CommandLineFlags.h"
+
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+static DEFINE_string2(out, o, "strikes.skbundle", "Where to write the bundle.");
+static DEFINE_string(family, "", "Font families to bundle. Empty means the default typeface.");
+static DEFINE_string(sizes, "12 14 16", "Text sizes in points.");
+static DEFINE_string(text, "", "Characters to bundle. Defaults to printable ASCII.");
+static DEFINE_bool(paths, false, "Also bundle glyph outlines.");
+static DEFINE_bool(measure, true, "Also bundle the device-independent strikes used by SkFont "
+                                  "measurement calls.");
+
+int main(int argc, char** argv) {
+    CommandLineFlags::Parse(argc, argv);
+
+    std::string text = FLAGS_text.isEmpty() ? "" : FLAGS_text[0];
+    if (text.empty()) {
+        for (char c = ' '; c <= '~'; ++c) {
+            text.push_back(c);
+        }
+    }
+
+    sk_sp<SkFontMgr> fontMgr = SkFontMgr::RefDefault();
+    std::vector<sk_sp<SkTypeface>> typefaces;
+    if (FLAGS_family.isEmpty()) {
+        typefaces.push_back(SkTypeface::MakeDefault());
+    }
+    for (int i = 0; i < FLAGS_family.count(); ++i) {
+        sk_sp<SkTypeface> typeface(fontMgr->matchFamilyStyle(FLAGS_family[i], SkFontStyle()));
+        if (!typeface) {
+            SkDebugf("Could not find family %s.\n", FLAGS_family[i]);
+            return 1;
+        }
+        typefaces.push_back(std::move(typeface));
+    }
+
+    SkStrikeBundle::Writer writer;
+    const SkSurfaceProps props{SkSurfaceProps::kLegacyFontHost_InitType};
+    for (const sk_sp<SkTypeface>& typeface : typefaces) {
+        for (int i = 0; i < FLAGS_sizes.count(); ++i) {
+            SkFont font(typeface, (SkScalar)atof(FLAGS_sizes[i]));
+
+            std::vector<SkGlyphID> glyphs(font.countText(text.data(), text.size(),
+                                                         SkTextEncoding::kUTF8));
+            font.textToGlyphs(text.data(), text.size(), SkTextEncoding::kUTF8,
+                              glyphs.data(), SkToInt(glyphs.size()));
+
+            SkStrikeSpec mask = SkStrikeSpec::MakeMask(
+                    font, SkPaint(), props, SkScalerContextFlags::kFakeGammaAndBoostContrast,
+                    SkMatrix::I());
+            writer.addStrike(mask, SkMakeSpan(glyphs.data(), glyphs.size()), FLAGS_paths);
+            if (FLAGS_measure) {
+                writer.addStrike(SkStrikeSpec::MakeCanonicalized(font),
+                                 SkMakeSpan(glyphs.data(), glyphs.size()), FLAGS_paths);
+            }
+        }
+    }
+
+    SkFILEWStream out(FLAGS_out[0]);
+    if (!out.isValid() || !writer.writeToStream(&out)) {
+        SkDebugf("Could not write %s.\n", FLAGS_out[0]);
+        return 1;
+    }
+    SkDebugf("Wrote %d strikes to %s.\n", writer.strikeCount(), FLAGS_out[0]);
+    return 0;
+}